@@ -1061,7 +1061,9 @@ def CompileCxx(obj,src,opts):
             else:
                 cmd += "/DWINVER=0x501 "
             cmd += "/Fo" + obj + " /nologo /c"
-            if GetTargetArch() != 'x64' and (not PkgSkip("SSE2") or 'SSE2' in opts):
+            if 'AVX2' in opts:
+                cmd += " /arch:AVX2"
+            elif GetTargetArch() != 'x64' and (not PkgSkip("SSE2") or 'SSE2' in opts):
                 cmd += " /arch:SSE2"
             for x in ipath: cmd += " /I" + x
             for (opt,dir) in INCDIRECTORIES:
@@ -1282,6 +1284,9 @@ def CompileCxx(obj,src,opts):
         if ('SSE2' in opts or not PkgSkip("SSE2")) and not arch.startswith("arm"):
             cmd += " -msse2"
 
+        if 'AVX2' in opts and not arch.startswith("arm"):
+            cmd += " -mavx2 -mfma"
+
         # Needed by both Python, Panda, Eigen, all of which break aliasing rules.
         cmd += " -fno-strict-aliasing"
 
@@ -3510,6 +3515,7 @@ if (not RUNTIME):
   TargetAdd('p3pnmimage_composite1.obj', opts=OPTS, input='p3pnmimage_composite1.cxx')
   TargetAdd('p3pnmimage_composite2.obj', opts=OPTS, input='p3pnmimage_composite2.cxx')
   TargetAdd('p3pnmimage_convert_srgb_sse2.obj', opts=OPTS+['SSE2'], input='convert_srgb_sse2.cxx')
+  TargetAdd('p3pnmimage_convert_srgb_avx2.obj', opts=OPTS+['SSE2', 'AVX2'], input='convert_srgb_avx2.cxx')
 
   OPTS=['DIR:panda/src/pnmimage', 'ZLIB', 'PYTHON']
   IGATEFILES=GetDirectoryContents('panda/src/pnmimage', ["*.h", "*_composite*.cxx"])
@@ -3939,6 +3945,7 @@ if (not RUNTIME):
   TargetAdd('libpanda.dll', input='p3pnmimage_composite1.obj')
   TargetAdd('libpanda.dll', input='p3pnmimage_composite2.obj')
   TargetAdd('libpanda.dll', input='p3pnmimage_convert_srgb_sse2.obj')
+  TargetAdd('libpanda.dll', input='p3pnmimage_convert_srgb_avx2.obj')
   TargetAdd('libpanda.dll', input='p3text_composite1.obj')
   TargetAdd('libpanda.dll', input='p3text_composite2.obj')
   TargetAdd('libpanda.dll', input='p3tform_composite1.obj')
@@ -5461,6 +5468,14 @@ if (PkgSkip("PANDATOOL")==0):
   TargetAdd('bam-info.exe', input=COMMON_PANDA_LIBS)
   TargetAdd('bam-info.exe', opts=['ADVAPI', 'FFTW'])
 
+  TargetAdd('bam-simplify_bamSimplify.obj', opts=OPTS, input='bamSimplify.cxx')
+  TargetAdd('bam-simplify.exe', input='bam-simplify_bamSimplify.obj')
+  TargetAdd('bam-simplify.exe', input='libp3progbase.lib')
+  TargetAdd('bam-simplify.exe', input='libp3pandatoolbase.lib')
+  TargetAdd('bam-simplify.exe', input='libpandaegg.dll')
+  TargetAdd('bam-simplify.exe', input=COMMON_PANDA_LIBS)
+  TargetAdd('bam-simplify.exe', opts=['ADVAPI', 'FFTW'])
+
   TargetAdd('bam2egg_bamToEgg.obj', opts=OPTS, input='bamToEgg.cxx')
   TargetAdd('bam2egg.exe', input='bam2egg_bamToEgg.obj')
   TargetAdd('bam2egg.exe', input=COMMON_EGG2X_LIBS)
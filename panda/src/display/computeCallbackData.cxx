@@ -0,0 +1,185 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file computeCallbackData.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "computeCallbackData.h"
+#include "config_display.h"
+#include "pStatTimer.h"
+#include "paramTexture.h"
+
+PStatCollector ComputeCallbackData::_dispatch_pcollector("Draw:Compute dispatch:CPU");
+TypeHandle ComputeCallbackData::_type_handle;
+
+/**
+ *
+ */
+ComputeCallbackData::
+ComputeCallbackData(const ShaderAttrib *shader_attrib,
+                    const LVecBase3i &num_work_groups, Images *images) :
+  _shader_attrib(shader_attrib),
+  _num_work_groups(num_work_groups),
+  _work_group(0, 0, 0),
+  _images(images)
+{
+}
+
+/**
+ *
+ */
+void ComputeCallbackData::
+output(ostream &out) const {
+  out << get_type() << "(" << _work_group << " of " << _num_work_groups << ")";
+}
+
+/**
+ * Returns a pointer to the uncompressed RAM image of the texture bound to the
+ * indicated shader input, for reading, or NULL if there is no such texture.
+ * The pointer remains valid until the dispatch completes.
+ */
+const unsigned char *ComputeCallbackData::
+get_read_pointer(const InternalName *name) const {
+  Images::Entries::const_iterator ei = _images->_entries.find(name);
+  if (ei == _images->_entries.end()) {
+    return NULL;
+  }
+  return (*ei).second._read_image.p();
+}
+
+/**
+ * Returns a pointer to the uncompressed RAM image of the texture bound to the
+ * indicated shader input, for writing, or NULL if there is no such texture,
+ * or if it was not bound as an image with write access.  The pointer remains
+ * valid until the dispatch completes.
+ */
+unsigned char *ComputeCallbackData::
+get_write_pointer(const InternalName *name) const {
+  Images::Entries::const_iterator ei = _images->_entries.find(name);
+  if (ei == _images->_entries.end()) {
+    return NULL;
+  }
+  return (*ei).second._write_image.p();
+}
+
+/**
+ * Runs the CPU implementation of the compute shader in the indicated
+ * ShaderAttrib for each of the indicated work groups, spread over the
+ * WorkerPool, and returns when all of them have finished.  Returns false if
+ * the shader has no CPU implementation.
+ */
+bool ComputeCallbackData::
+dispatch(const ShaderAttrib *shader_attrib, const LVecBase3i &num_work_groups) {
+  const Shader *shader = shader_attrib->get_shader();
+  if (shader == (const Shader *)NULL || !shader->has_cpu_kernel()) {
+    return false;
+  }
+
+  int count = num_work_groups[0] * num_work_groups[1] * num_work_groups[2];
+  if (count <= 0) {
+    return true;
+  }
+
+  PStatTimer timer(_dispatch_pcollector);
+
+  Images images;
+  images.resolve(shader_attrib);
+
+  DispatchJob job;
+  job._kernel = shader->get_cpu_kernel();
+  job._shader_attrib = shader_attrib;
+  job._num_work_groups = num_work_groups;
+  job._images = &images;
+
+  // Hand out the work groups in batches, so that there are still a few
+  // batches for each thread, to balance the load.
+  WorkerPool *pool = WorkerPool::get_global_ptr();
+  int grain = count / ((pool->get_num_threads() + 1) * 4);
+  pool->run(job, count, max(grain, 1));
+  return true;
+}
+
+/**
+ * Invokes the kernel for each of the work groups in the range, numbered in
+ * x-major order.
+ */
+void ComputeCallbackData::DispatchJob::
+execute(int begin, int end) {
+  ComputeCallbackData cbdata(_shader_attrib, _num_work_groups, _images);
+  int size_x = _num_work_groups[0];
+  int size_xy = size_x * _num_work_groups[1];
+
+  for (int i = begin; i < end; ++i) {
+    cbdata._work_group.set(i % size_x, (i / size_x) % _num_work_groups[1], i / size_xy);
+    _kernel->do_callback(&cbdata);
+  }
+}
+
+/**
+ * Looks up the RAM images of all of the textures bound to the indicated
+ * ShaderAttrib.  The textures that are bound as images with write access are
+ * marked as modified, so that they are uploaded again the next time they are
+ * rendered; the others are only read.
+ */
+void ComputeCallbackData::Images::
+resolve(const ShaderAttrib *shader_attrib) {
+  const ShaderAttrib::Inputs &inputs = shader_attrib->get_shader_inputs();
+
+  // Resolve the writable images first, so that a texture that is also bound
+  // elsewhere for reading is read through the same image.
+  typedef pmap<Texture *, PTA_uchar> Written;
+  Written written;
+
+  ShaderAttrib::Inputs::const_iterator ii;
+  for (ii = inputs.begin(); ii != inputs.end(); ++ii) {
+    const ShaderInput *input = (*ii).second;
+    if (input->get_value_type() != ShaderInput::M_texture_image) {
+      continue;
+    }
+    const ParamTextureImage *param = DCAST(ParamTextureImage, input->get_param());
+    Texture *tex = param->get_texture();
+    if (tex == (Texture *)NULL || !param->has_write_access()) {
+      continue;
+    }
+    Written::iterator wi = written.find(tex);
+    if (wi == written.end()) {
+      if (tex->get_ram_image_compression() != Texture::CM_off) {
+        tex->get_uncompressed_ram_image();
+      }
+      wi = written.insert(Written::value_type(tex, tex->modify_ram_image())).first;
+    }
+    Entry &entry = _entries[(*ii).first];
+    entry._write_image = (*wi).second;
+    entry._read_image = (*wi).second;
+  }
+
+  for (ii = inputs.begin(); ii != inputs.end(); ++ii) {
+    const ShaderInput *input = (*ii).second;
+    switch (input->get_value_type()) {
+    case ShaderInput::M_texture:
+    case ShaderInput::M_texture_sampler:
+    case ShaderInput::M_texture_image:
+      break;
+
+    default:
+      continue;
+    }
+    Texture *tex = input->get_texture();
+    if (tex == (Texture *)NULL || _entries.count((*ii).first) != 0) {
+      continue;
+    }
+    Written::const_iterator wi = written.find(tex);
+    if (wi != written.end()) {
+      _entries[(*ii).first]._read_image = (*wi).second;
+    } else {
+      _entries[(*ii).first]._read_image = tex->get_uncompressed_ram_image();
+    }
+  }
+}
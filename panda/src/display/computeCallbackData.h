@@ -0,0 +1,119 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file computeCallbackData.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef COMPUTECALLBACKDATA_H
+#define COMPUTECALLBACKDATA_H
+
+#include "pandabase.h"
+#include "callbackData.h"
+#include "callbackObject.h"
+#include "shaderAttrib.h"
+#include "texture.h"
+#include "workerPool.h"
+#include "pmap.h"
+#include "pStatCollector.h"
+
+/**
+ * This specialization on CallbackData is passed to the CPU implementation of
+ * a compute shader, which is set via Shader::set_cpu_kernel(), once for each
+ * work group that is dispatched.  The work groups are spread over the threads
+ * of the WorkerPool, so the callback may be invoked from several threads at
+ * once, and should only write to the parts of its outputs that belong to its
+ * own work group.
+ *
+ * The shader inputs are available via get_shader_attrib().  Texture images
+ * should be accessed via get_read_pointer() and get_write_pointer(), which
+ * address the uncompressed RAM image of the texture, rather than via the
+ * Texture itself.  Only textures that are bound as images with write access
+ * may be written to.
+ */
+class EXPCL_PANDA_DISPLAY ComputeCallbackData : public CallbackData {
+private:
+  class Images;
+
+  ComputeCallbackData(const ShaderAttrib *shader_attrib,
+                      const LVecBase3i &num_work_groups, Images *images);
+
+PUBLISHED:
+  virtual void output(ostream &out) const;
+
+  INLINE const ShaderAttrib *get_shader_attrib() const;
+  INLINE const LVecBase3i &get_num_work_groups() const;
+  INLINE const LVecBase3i &get_work_group() const;
+  INLINE Texture *get_texture(const InternalName *name) const;
+
+public:
+  const unsigned char *get_read_pointer(const InternalName *name) const;
+  unsigned char *get_write_pointer(const InternalName *name) const;
+
+  static bool dispatch(const ShaderAttrib *shader_attrib,
+                       const LVecBase3i &num_work_groups);
+
+private:
+  // The RAM images of the textures bound to the shader, indexed by input
+  // name.  These are all looked up before the work groups are dispatched, so
+  // that the threads need not lock anything to access them.
+  class Images {
+  public:
+    class Entry {
+    public:
+      CPTA_uchar _read_image;
+      PTA_uchar _write_image;
+    };
+    typedef pmap<CPT(InternalName), Entry> Entries;
+
+    void resolve(const ShaderAttrib *shader_attrib);
+
+    Entries _entries;
+  };
+
+  class DispatchJob : public WorkerPool::Job {
+  public:
+    virtual void execute(int begin, int end);
+
+    CallbackObject *_kernel;
+    const ShaderAttrib *_shader_attrib;
+    LVecBase3i _num_work_groups;
+    Images *_images;
+  };
+
+  const ShaderAttrib *_shader_attrib;
+  LVecBase3i _num_work_groups;
+  LVecBase3i _work_group;
+  Images *_images;
+
+  static PStatCollector _dispatch_pcollector;
+
+  friend class DispatchJob;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    CallbackData::init_type();
+    register_type(_type_handle, "ComputeCallbackData",
+                  CallbackData::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "computeCallbackData.I"
+
+#endif
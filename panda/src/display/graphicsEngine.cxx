@@ -43,10 +43,12 @@
 #include "vertexDataSaveFile.h"
 #include "vertexDataBook.h"
 #include "vertexDataPage.h"
+#include "texturePool.h"
 #include "config_pgraph.h"
 #include "displayRegionCullCallbackData.h"
 #include "displayRegionDrawCallbackData.h"
 #include "callbackGraphicsWindow.h"
+#include "computeCallbackData.h"
 
 #if defined(WIN32)
   #define WINDOWS_LEAN_AND_MEAN
@@ -90,6 +92,7 @@ PStatCollector GraphicsEngine::_vertex_data_resident_pcollector("Vertex Data:Res
 PStatCollector GraphicsEngine::_vertex_data_compressed_pcollector("Vertex Data:Compressed");
 PStatCollector GraphicsEngine::_vertex_data_unused_disk_pcollector("Vertex Data:Disk:Unused");
 PStatCollector GraphicsEngine::_vertex_data_used_disk_pcollector("Vertex Data:Disk:Used");
+PStatCollector GraphicsEngine::_texture_ram_pcollector("Texture RAM");
 
 // These are counted independently by the collision system; we redefine them
 // here so we can reset them at each frame.
@@ -891,11 +894,18 @@ render_frame() {
       _vertex_data_compressed_pcollector.set_level(compressed);
       _vertex_data_unused_disk_pcollector.set_level(total_disk - used_disk);
       _vertex_data_used_disk_pcollector.set_level(used_disk);
+
+      // Only query the texture LRU when the budget is in effect and PStats
+      // is actually collecting its size.
+      if (texture_ram_budget >= 0 && _texture_ram_pcollector.is_active()) {
+        _texture_ram_pcollector.set_level(TexturePool::get_ram_lru()->get_total_size());
+      }
     }
 
 #endif  // DO_PSTATS
 
     GeomVertexArrayData::lru_epoch();
+    TexturePool::lru_epoch();
 
     // Now signal all of our threads to begin their next frame.
     Threads::const_iterator ti;
@@ -1085,12 +1095,23 @@ extract_texture_data(Texture *tex, GraphicsStateGuardian *gsg) {
  * multithreaded environment.  However, you can call this several consecutive
  * times on different textures for little additional cost.
  *
- * The return value is true if the operation is successful, false otherwise.
+ * If gsg is NULL, the shader's CPU implementation is run instead, if it has
+ * been given one with Shader::set_cpu_kernel().
  */
 void GraphicsEngine::
 dispatch_compute(const LVecBase3i &work_groups, const ShaderAttrib *sattr, GraphicsStateGuardian *gsg) {
   nassertv(sattr->get_shader() != (Shader *)NULL);
 
+  if (gsg == (GraphicsStateGuardian *)NULL) {
+    // Without a GSG, we can only run the CPU implementation of the shader.
+    if (!ComputeCallbackData::dispatch(sattr, work_groups)) {
+      display_cat.error()
+        << "Cannot dispatch compute shader without a GSG, since it has no "
+           "CPU implementation.\n";
+    }
+    return;
+  }
+
   ReMutexHolder holder(_lock);
 
   CPT(RenderState) state = RenderState::make(sattr);
@@ -112,7 +112,7 @@ PUBLISHED:
   bool extract_texture_data(Texture *tex, GraphicsStateGuardian *gsg);
   void dispatch_compute(const LVecBase3i &work_groups,
                         const ShaderAttrib *sattr,
-                        GraphicsStateGuardian *gsg);
+                        GraphicsStateGuardian *gsg = NULL);
 
   static GraphicsEngine *get_global_ptr();
 
@@ -371,6 +371,7 @@ private:
   static PStatCollector _vertex_data_resident_pcollector;
   static PStatCollector _vertex_data_compressed_pcollector;
   static PStatCollector _vertex_data_used_disk_pcollector;
+  static PStatCollector _texture_ram_pcollector;
   static PStatCollector _vertex_data_unused_disk_pcollector;
 
   static PStatCollector _cnode_volume_pcollector;
@@ -58,6 +58,7 @@
 #include "clipPlaneAttrib.h"
 #include "fogAttrib.h"
 #include "config_pstats.h"
+#include "computeCallbackData.h"
 
 #include <algorithm>
 #include <limits.h>
@@ -695,10 +696,21 @@ issue_timer_query(int pstats_index) {
 /**
  * Dispatches a currently bound compute shader using the given work group
  * counts.
+ *
+ * This base implementation runs the CPU implementation of the shader, if one
+ * has been set via Shader::set_cpu_kernel(), for GSGs that do not support
+ * compute shaders.
  */
 void GraphicsStateGuardian::
 dispatch_compute(int num_groups_x, int num_groups_y, int num_groups_z) {
-  nassertv(false /* Compute shaders not supported by GSG */);
+  const ShaderAttrib *sattr;
+  _state_rs->get_attrib_def(sattr);
+
+  if (!ComputeCallbackData::dispatch(sattr, LVecBase3i(num_groups_x, num_groups_y, num_groups_z))) {
+    display_cat.error()
+      << get_type() << " does not support compute shaders, and the shader "
+         "has no CPU implementation.\n";
+  }
 }
 
 /**
@@ -2877,6 +2889,31 @@ determine_target_texture() {
   nassertv(_target_texture->get_num_on_stages() <= max_texture_stages);
 }
 
+/**
+ * Returns the set of attribute slots whose attribs differ between the two
+ * states, which is to say, the attribs that have to be issued to change
+ * from the one state to the other.  The result is cached for recently seen
+ * pairs of states.
+ */
+RenderState::SlotMask GraphicsStateGuardian::
+get_changed_slots(const RenderState *from, const RenderState *to) {
+  unsigned int from_id = (unsigned int)from->get_state_id();
+  unsigned int to_id = (unsigned int)to->get_state_id();
+  if (from_id == 0 || to_id == 0) {
+    // At least one of the states isn't in the state cache.
+    return from->get_changed_slots(to);
+  }
+
+  size_t index = ((from_id * 2654435761u) ^ to_id) % num_state_transitions;
+  StateTransition &entry = _state_transitions[index];
+  if (entry._from != from || entry._to != to) {
+    entry._from = from;
+    entry._to = to;
+    entry._changed = from->get_changed_slots(to);
+  }
+  return entry._changed;
+}
+
 /**
  * Frees some memory that was explicitly allocated within the glgsg.
  */
@@ -2919,6 +2956,11 @@ close_gsg() {
   _pending_timer_queries.clear();
 #endif
 
+  for (int i = 0; i < num_state_transitions; ++i) {
+    _state_transitions[i]._from.clear();
+    _state_transitions[i]._to.clear();
+  }
+
   free_pointers();
 }
 
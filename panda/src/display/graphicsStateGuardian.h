@@ -440,6 +440,8 @@ protected:
   virtual void end_bind_clip_planes();
 
   void determine_target_texture();
+  RenderState::SlotMask get_changed_slots(const RenderState *from,
+                                          const RenderState *to);
 
   virtual void free_pointers();
   virtual void close_gsg();
@@ -472,6 +474,18 @@ protected:
   RenderState::SlotMask _state_mask;
   RenderState::SlotMask _inv_state_mask;
 
+  // A small cache of the result of get_changed_slots(), indexed by the state
+  // numbers of the two states.  The entries hold a reference to both states,
+  // so their numbers can't be reused while they are in the cache.
+  class StateTransition {
+  public:
+    CPT(RenderState) _from;
+    CPT(RenderState) _to;
+    RenderState::SlotMask _changed;
+  };
+  enum { num_state_transitions = 256 };
+  StateTransition _state_transitions[num_state_transitions];
+
   // The current transform, as of the last call to set_state_and_transform().
   CPT(TransformState) _internal_transform;
 
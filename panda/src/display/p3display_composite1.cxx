@@ -1,5 +1,6 @@
 #include "config_display.cxx"
 #include "callbackGraphicsWindow.cxx"
+#include "computeCallbackData.cxx"
 #include "displayInformation.cxx"
 #include "displayRegion.cxx"
 #include "displayRegionCullCallbackData.cxx"
@@ -162,6 +162,25 @@ munge_format_impl(const GeomVertexFormat *orig,
     }
   }
 
+  // Expand any remaining columns in compressed encodings to 32-bit floats,
+  // since the fixed-function pipeline can't decode them.  These are bigger
+  // than the original column, so we move it to the end of the array rather
+  // than overwrite its neighbors; the array is repacked below.
+  for (int i = 0; i < orig->get_num_columns(); ++i) {
+    const GeomVertexColumn *column = orig->get_column(i);
+    if (column->get_numeric_type() == NT_packed_oct ||
+        column->get_numeric_type() == NT_float16 ||
+        column->has_quantization()) {
+      int array = new_format->get_array_with(column->get_name());
+      if (array >= 0) {
+        PT(GeomVertexArrayFormat) array_format = new_format->modify_array(array);
+        array_format->remove_column(column->get_name());
+        array_format->add_column(column->get_name(), column->get_num_values(),
+                                 NT_float32, column->get_contents());
+      }
+    }
+  }
+
   // Now go through the remaining arrays and make sure they are tightly
   // packed.  If not, repack them.
   for (int i = 0; i < new_format->get_num_arrays(); ++i) {
@@ -265,6 +284,25 @@ premunge_format_impl(const GeomVertexFormat *orig) {
     }
   }
 
+  // Expand any remaining columns in compressed encodings to 32-bit floats,
+  // since the fixed-function pipeline can't decode them.  These are bigger
+  // than the original column, so we move it to the end of the array rather
+  // than overwrite its neighbors; the array is repacked below.
+  for (int i = 0; i < orig->get_num_columns(); ++i) {
+    const GeomVertexColumn *column = orig->get_column(i);
+    if (column->get_numeric_type() == NT_packed_oct ||
+        column->get_numeric_type() == NT_float16 ||
+        column->has_quantization()) {
+      int array = new_format->get_array_with(column->get_name());
+      if (array >= 0) {
+        PT(GeomVertexArrayFormat) array_format = new_format->modify_array(array);
+        array_format->remove_column(column->get_name());
+        array_format->add_column(column->get_name(), column->get_num_values(),
+                                 NT_float32, column->get_contents());
+      }
+    }
+  }
+
   // Now go through the remaining arrays and make sure they are tightly
   // packed.  If not, repack them.
   for (int i = 0; i < new_format->get_num_arrays(); ++i) {
@@ -438,6 +438,14 @@ update_shader_vertex_arrays(DXShaderContext9 *prev, GSG *gsg, bool force) {
           continue;
         }
 
+        // Quantized columns can't be passed to the shader directly; the
+        // munger should have expanded them to floats.
+        const GeomVertexColumn *column = gsg->_data_reader->get_format()->get_column(name);
+        if (column != (const GeomVertexColumn *)NULL && column->has_quantization()) {
+          dxgsg9_cat.error() << "VE ERROR: quantized column " << *name << " was not munged\n";
+          continue;
+        }
+
         // If not associated with the array we're working on, move on.
         if (param_array_reader != array_reader) {
           continue;
@@ -70,6 +70,23 @@ ConfigVariableBool egg_combine_geoms
           "when possible.  This usually shouldn't be necessary, since the "
           "egg loader does a pretty good job of combining these by itself."));
 
+ConfigVariableBool egg_optimize_vertex_cache
+("egg-optimize-vertex-cache", false,
+ PRC_DESC("Set this true to reorder the triangles and vertices of each Geom "
+          "after loading an egg file, for better use of the graphics card's "
+          "post-transform vertex cache and better locality of vertex "
+          "fetches.  This slows down egg loading somewhat, so it is best "
+          "used when converting egg files to bam files.  See also "
+          "vertex-cache-size."));
+
+ConfigVariableBool egg_compress_vertices
+("egg-compress-vertices", false,
+ PRC_DESC("Set this true to store the vertex positions, normals and texture "
+          "coordinates of static geometry in compact encodings after loading "
+          "an egg file.  This roughly halves the memory used by the vertex "
+          "data, at the cost of a little precision.  It is best used when "
+          "converting egg files to bam files."));
+
 ConfigVariableBool egg_rigid_geometry
 ("egg-rigid-geometry", false,
  PRC_DESC("Set this true to create rigid pieces of an animated character as "
@@ -39,6 +39,8 @@ extern EXPCL_PANDAEGG ConfigVariableBool egg_flatten;
 extern EXPCL_PANDAEGG ConfigVariableDouble egg_flatten_radius;
 extern EXPCL_PANDAEGG ConfigVariableBool egg_unify;
 extern EXPCL_PANDAEGG ConfigVariableBool egg_combine_geoms;
+extern EXPCL_PANDAEGG ConfigVariableBool egg_optimize_vertex_cache;
+extern EXPCL_PANDAEGG ConfigVariableBool egg_compress_vertices;
 extern EXPCL_PANDAEGG ConfigVariableBool egg_rigid_geometry;
 extern EXPCL_PANDAEGG ConfigVariableBool egg_flat_shading;
 extern EXPCL_PANDAEGG ConfigVariableBool egg_flat_colors;
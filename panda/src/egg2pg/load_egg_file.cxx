@@ -60,6 +60,21 @@ load_from_loader(EggLoader &loader) {
     }
   }
 
+  if (loader._root != (PandaNode *)NULL && egg_optimize_vertex_cache) {
+    // This should happen after unify(), which would otherwise undo the
+    // triangle ordering.
+    SceneGraphReducer gr;
+    gr.optimize_vertex_cache(loader._root);
+    egg2pg_cat.info()
+      << "Optimized vertex cache: ACMR " << gr.get_acmr_before()
+      << " -> " << gr.get_acmr_after() << "\n";
+  }
+
+  if (loader._root != (PandaNode *)NULL && egg_compress_vertices) {
+    SceneGraphReducer gr;
+    gr.compress_vertices(loader._root);
+  }
+
   return loader._root;
 }
 
@@ -56,6 +56,8 @@ PUBLISHED:
   INLINE bool test_ref_count_nonzero() const;
 
 public:
+  INLINE bool ref_if_nonzero() const;
+
   INLINE void local_object();
   INLINE bool has_weak_list() const;
   INLINE WeakReferenceList *get_weak_list() const;
@@ -117,6 +117,23 @@ munge_format_impl(const GeomVertexFormat *orig,
   }
 #endif  // !OPENGLES
 
+  // Expand the compressed encodings that OpenGL can't decode by itself to
+  // 32-bit floats.  These are bigger than the original column, so we move it
+  // to the end of the array rather than overwrite its neighbors.
+  for (int i = 0; i < orig->get_num_columns(); ++i) {
+    const GeomVertexColumn *column = orig->get_column(i);
+    if (column->get_numeric_type() == NT_packed_oct ||
+        column->has_quantization() ||
+        (column->get_numeric_type() == NT_float16 &&
+         !glgsg->_supports_half_float_vertex)) {
+      int array = orig->get_array_with(column->get_name());
+      PT(GeomVertexArrayFormat) array_format = new_format->modify_array(array);
+      array_format->remove_column(column->get_name());
+      array_format->add_column(column->get_name(), column->get_num_values(),
+                               NT_float32, column->get_contents());
+    }
+  }
+
   const GeomVertexColumn *color_type = orig->get_color_column();
   if (color_type != (GeomVertexColumn *)NULL &&
       color_type->get_numeric_type() == NT_packed_dabc &&
@@ -303,6 +320,23 @@ premunge_format_impl(const GeomVertexFormat *orig) {
   }
 #endif  // !OPENGLES
 
+  // Expand the compressed encodings that OpenGL can't decode by itself to
+  // 32-bit floats.  These are bigger than the original column, so we move it
+  // to the end of the array rather than overwrite its neighbors.
+  for (int i = 0; i < orig->get_num_columns(); ++i) {
+    const GeomVertexColumn *column = orig->get_column(i);
+    if (column->get_numeric_type() == NT_packed_oct ||
+        column->has_quantization() ||
+        (column->get_numeric_type() == NT_float16 &&
+         !glgsg->_supports_half_float_vertex)) {
+      int array = orig->get_array_with(column->get_name());
+      PT(GeomVertexArrayFormat) array_format = new_format->modify_array(array);
+      array_format->remove_column(column->get_name());
+      array_format->add_column(column->get_name(), column->get_num_values(),
+                               NT_float32, column->get_contents());
+    }
+  }
+
   CPT(GeomVertexFormat) format = GeomVertexFormat::register_format(new_format);
 
   if ((_flags & F_parallel_arrays) != 0) {
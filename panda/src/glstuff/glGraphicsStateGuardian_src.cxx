@@ -1118,12 +1118,15 @@ reset() {
 #ifdef OPENGLES
   _supports_packed_dabc = false;
   _supports_packed_ufloat = false;
+  _supports_half_float_vertex = false;
 #else
   _supports_packed_dabc = is_at_least_gl_version(3, 2) ||
                           has_extension("GL_ARB_vertex_array_bgra") ||
                           has_extension("GL_EXT_vertex_array_bgra");
   _supports_packed_ufloat = is_at_least_gl_version(4, 4) ||
                             has_extension("GL_ARB_vertex_type_10f_11f_11f_rev");
+  _supports_half_float_vertex = is_at_least_gl_version(3, 0) ||
+                                has_extension("GL_ARB_half_float_vertex");
 #endif
 
 #ifdef OPENGLES
@@ -5530,7 +5533,11 @@ prepare_vertex_buffer(GeomVertexArrayData *data) {
     }
 
     report_my_gl_errors();
-    update_vertex_buffer(gvbc, data->get_handle(), false);
+    if (_prepared_objects->get_upload_budget() == (size_t)-1) {
+      update_vertex_buffer(gvbc, data->get_handle(), false);
+    }
+    // Otherwise, leave the first upload to the update_vertex_buffer() call
+    // made when the buffer is drawn, which knows whether it may be deferred.
     return gvbc;
   }
 
@@ -5554,6 +5561,13 @@ update_vertex_buffer(CLP(VertexBufferContext) *gvbc,
 
   if (gvbc->was_modified(reader)) {
     int num_bytes = reader->get_data_size_bytes();
+    if (!force && _effective_incomplete_render &&
+        gvbc->get_modified() == UpdateSeq::initial() &&
+        !_prepared_objects->reserve_upload(gvbc, num_bytes, reader->get_current_thread())) {
+      // The buffer has never been uploaded, and this frame's upload budget has
+      // been spent.  Skip drawing it for now.
+      return false;
+    }
     if (GLCAT.is_debug() && gl_debug_buffers) {
       GLCAT.debug()
         << "copying " << num_bytes
@@ -5717,8 +5731,12 @@ prepare_index_buffer(GeomPrimitive *data) {
     }
 
     report_my_gl_errors();
-    GeomPrimitivePipelineReader reader(data, Thread::get_current_thread());
-    apply_index_buffer(gibc, &reader, false);
+    if (_prepared_objects->get_upload_budget() == (size_t)-1) {
+      GeomPrimitivePipelineReader reader(data, Thread::get_current_thread());
+      apply_index_buffer(gibc, &reader, false);
+    }
+    // Otherwise, leave the first upload to the apply_index_buffer() call made
+    // when the buffer is drawn, which knows whether it may be deferred.
     return gibc;
   }
 
@@ -5740,6 +5758,16 @@ apply_index_buffer(IndexBufferContext *ibc,
 
   CLP(IndexBufferContext) *gibc = DCAST(CLP(IndexBufferContext), ibc);
 
+  if (!force && _effective_incomplete_render &&
+      gibc->get_modified() == UpdateSeq::initial() &&
+      gibc->was_modified(reader) &&
+      !_prepared_objects->reserve_upload(gibc, reader->get_data_size_bytes(),
+                                         reader->get_current_thread())) {
+    // The buffer has never been uploaded, and this frame's upload budget has
+    // been spent.  Skip drawing it for now.
+    return false;
+  }
+
   if (_current_ibuffer_index != gibc->_index) {
     if (GLCAT.is_spam() && gl_debug_buffers) {
       GLCAT.spam()
@@ -5999,11 +6027,15 @@ issue_timer_query(int pstats_index) {
  */
 void CLP(GraphicsStateGuardian)::
 dispatch_compute(int num_groups_x, int num_groups_y, int num_groups_z) {
+  if (!_supports_compute_shaders || _current_shader_context == NULL) {
+    // Fall back to the CPU implementation, if the shader has one.
+    GraphicsStateGuardian::dispatch_compute(num_groups_x, num_groups_y, num_groups_z);
+    return;
+  }
+
   maybe_gl_finish();
 
   PStatGPUTimer timer(this, _compute_dispatch_pcollector);
-  nassertv(_supports_compute_shaders);
-  nassertv(_current_shader_context != NULL);
   _glDispatchCompute(num_groups_x, num_groups_y, num_groups_z);
 
   maybe_gl_finish();
@@ -8068,6 +8100,17 @@ get_numeric_type(Geom::NumericType numeric_type) {
 #else
     break;
 #endif
+
+  case Geom::NT_float16:
+#ifndef OPENGLES
+    return GL_HALF_FLOAT;
+#else
+    break;
+#endif
+
+  case Geom::NT_packed_oct:
+    // Should have been decoded by the munger.
+    break;
   }
 
   GLCAT.error()
@@ -10104,6 +10147,10 @@ set_state_and_transform(const RenderState *target,
   }
   _target_rs = target;
 
+  // Find out which attribs differ from the current state.  This is cached
+  // for recently seen pairs of states.
+  RenderState::SlotMask changed = get_changed_slots(_state_rs, _target_rs);
+
 #ifndef OPENGLES_1
   _target_shader = (const ShaderAttrib *)
     _target_rs->get_attrib_def(ShaderAttrib::get_class_slot());
@@ -10129,7 +10176,7 @@ set_state_and_transform(const RenderState *target,
 
 #ifdef SUPPORT_FIXED_FUNCTION
   int alpha_test_slot = AlphaTestAttrib::get_class_slot();
-  if (_target_rs->get_attrib(alpha_test_slot) != _state_rs->get_attrib(alpha_test_slot) ||
+  if (changed.get_bit(alpha_test_slot) ||
       !_state_mask.get_bit(alpha_test_slot)
 #ifndef OPENGLES_1
       || (_target_shader->get_flag(ShaderAttrib::F_subsume_alpha_test) !=
@@ -10143,7 +10190,7 @@ set_state_and_transform(const RenderState *target,
 #endif
 
   int antialias_slot = AntialiasAttrib::get_class_slot();
-  if (_target_rs->get_attrib(antialias_slot) != _state_rs->get_attrib(antialias_slot) ||
+  if (changed.get_bit(antialias_slot) ||
       !_state_mask.get_bit(antialias_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_antialias_pcollector);
     do_issue_antialias();
@@ -10151,7 +10198,7 @@ set_state_and_transform(const RenderState *target,
   }
 
   int clip_plane_slot = ClipPlaneAttrib::get_class_slot();
-  if (_target_rs->get_attrib(clip_plane_slot) != _state_rs->get_attrib(clip_plane_slot) ||
+  if (changed.get_bit(clip_plane_slot) ||
       !_state_mask.get_bit(clip_plane_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_clip_plane_pcollector);
     do_issue_clip_plane();
@@ -10160,8 +10207,8 @@ set_state_and_transform(const RenderState *target,
 
   int color_slot = ColorAttrib::get_class_slot();
   int color_scale_slot = ColorScaleAttrib::get_class_slot();
-  if (_target_rs->get_attrib(color_slot) != _state_rs->get_attrib(color_slot) ||
-      _target_rs->get_attrib(color_scale_slot) != _state_rs->get_attrib(color_scale_slot) ||
+  if (changed.get_bit(color_slot) ||
+      changed.get_bit(color_scale_slot) ||
       !_state_mask.get_bit(color_slot) ||
       !_state_mask.get_bit(color_scale_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_color_pcollector);
@@ -10172,7 +10219,7 @@ set_state_and_transform(const RenderState *target,
   }
 
   int cull_face_slot = CullFaceAttrib::get_class_slot();
-  if (_target_rs->get_attrib(cull_face_slot) != _state_rs->get_attrib(cull_face_slot) ||
+  if (changed.get_bit(cull_face_slot) ||
       !_state_mask.get_bit(cull_face_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_cull_face_pcollector);
     do_issue_cull_face();
@@ -10180,7 +10227,7 @@ set_state_and_transform(const RenderState *target,
   }
 
   int depth_offset_slot = DepthOffsetAttrib::get_class_slot();
-  if (_target_rs->get_attrib(depth_offset_slot) != _state_rs->get_attrib(depth_offset_slot) ||
+  if (changed.get_bit(depth_offset_slot) ||
       !_state_mask.get_bit(depth_offset_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_depth_offset_pcollector);
     do_issue_depth_offset();
@@ -10188,7 +10235,7 @@ set_state_and_transform(const RenderState *target,
   }
 
   int depth_test_slot = DepthTestAttrib::get_class_slot();
-  if (_target_rs->get_attrib(depth_test_slot) != _state_rs->get_attrib(depth_test_slot) ||
+  if (changed.get_bit(depth_test_slot) ||
       !_state_mask.get_bit(depth_test_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_depth_test_pcollector);
     do_issue_depth_test();
@@ -10196,7 +10243,7 @@ set_state_and_transform(const RenderState *target,
   }
 
   int depth_write_slot = DepthWriteAttrib::get_class_slot();
-  if (_target_rs->get_attrib(depth_write_slot) != _state_rs->get_attrib(depth_write_slot) ||
+  if (changed.get_bit(depth_write_slot) ||
       !_state_mask.get_bit(depth_write_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_depth_write_pcollector);
     do_issue_depth_write();
@@ -10204,7 +10251,7 @@ set_state_and_transform(const RenderState *target,
   }
 
   int render_mode_slot = RenderModeAttrib::get_class_slot();
-  if (_target_rs->get_attrib(render_mode_slot) != _state_rs->get_attrib(render_mode_slot) ||
+  if (changed.get_bit(render_mode_slot) ||
       !_state_mask.get_bit(render_mode_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_render_mode_pcollector);
     do_issue_render_mode();
@@ -10213,7 +10260,7 @@ set_state_and_transform(const RenderState *target,
 
 #ifdef SUPPORT_FIXED_FUNCTION
   int rescale_normal_slot = RescaleNormalAttrib::get_class_slot();
-  if (_target_rs->get_attrib(rescale_normal_slot) != _state_rs->get_attrib(rescale_normal_slot) ||
+  if (changed.get_bit(rescale_normal_slot) ||
       !_state_mask.get_bit(rescale_normal_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_rescale_normal_pcollector);
     do_issue_rescale_normal();
@@ -10223,7 +10270,7 @@ set_state_and_transform(const RenderState *target,
 
 #ifdef SUPPORT_FIXED_FUNCTION
   int shade_model_slot = ShadeModelAttrib::get_class_slot();
-  if (_target_rs->get_attrib(shade_model_slot) != _state_rs->get_attrib(shade_model_slot) ||
+  if (changed.get_bit(shade_model_slot) ||
       !_state_mask.get_bit(shade_model_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_shade_model_pcollector);
     do_issue_shade_model();
@@ -10233,7 +10280,7 @@ set_state_and_transform(const RenderState *target,
 
 #if !defined(OPENGLES) || defined(OPENGLES_1)
   int logic_op_slot = LogicOpAttrib::get_class_slot();
-  if (_target_rs->get_attrib(logic_op_slot) != _state_rs->get_attrib(logic_op_slot) ||
+  if (changed.get_bit(logic_op_slot) ||
       !_state_mask.get_bit(logic_op_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_logic_op_pcollector);
     do_issue_logic_op();
@@ -10244,9 +10291,9 @@ set_state_and_transform(const RenderState *target,
   int transparency_slot = TransparencyAttrib::get_class_slot();
   int color_write_slot = ColorWriteAttrib::get_class_slot();
   int color_blend_slot = ColorBlendAttrib::get_class_slot();
-  if (_target_rs->get_attrib(transparency_slot) != _state_rs->get_attrib(transparency_slot) ||
-      _target_rs->get_attrib(color_write_slot) != _state_rs->get_attrib(color_write_slot) ||
-      _target_rs->get_attrib(color_blend_slot) != _state_rs->get_attrib(color_blend_slot) ||
+  if (changed.get_bit(transparency_slot) ||
+      changed.get_bit(color_write_slot) ||
+      changed.get_bit(color_blend_slot) ||
       !_state_mask.get_bit(transparency_slot) ||
       !_state_mask.get_bit(color_write_slot) ||
       !_state_mask.get_bit(color_blend_slot)
@@ -10263,7 +10310,7 @@ set_state_and_transform(const RenderState *target,
   }
 
   int texture_slot = TextureAttrib::get_class_slot();
-  if (_target_rs->get_attrib(texture_slot) != _state_rs->get_attrib(texture_slot) ||
+  if (changed.get_bit(texture_slot) ||
       !_state_mask.get_bit(texture_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_texture_pcollector);
     determine_target_texture();
@@ -10285,8 +10332,8 @@ set_state_and_transform(const RenderState *target,
   if (_tex_gen_modifies_mat) {
     int tex_gen_slot = TexGenAttrib::get_class_slot();
     int tex_matrix_slot = TexMatrixAttrib::get_class_slot();
-    if (_target_rs->get_attrib(tex_gen_slot) != _state_rs->get_attrib(tex_gen_slot) ||
-        _target_rs->get_attrib(tex_matrix_slot) != _state_rs->get_attrib(tex_matrix_slot) ||
+    if (changed.get_bit(tex_gen_slot) ||
+        changed.get_bit(tex_matrix_slot) ||
         !_state_mask.get_bit(tex_gen_slot) ||
         !_state_mask.get_bit(tex_matrix_slot)) {
       _state_mask.clear_bit(tex_gen_slot);
@@ -10295,7 +10342,7 @@ set_state_and_transform(const RenderState *target,
   }
 
   int tex_matrix_slot = TexMatrixAttrib::get_class_slot();
-  if (_target_rs->get_attrib(tex_matrix_slot) != _state_rs->get_attrib(tex_matrix_slot) ||
+  if (changed.get_bit(tex_matrix_slot) ||
       !_state_mask.get_bit(tex_matrix_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_tex_matrix_pcollector);
 #ifdef SUPPORT_FIXED_FUNCTION
@@ -10321,7 +10368,7 @@ set_state_and_transform(const RenderState *target,
 #endif
 
   int material_slot = MaterialAttrib::get_class_slot();
-  if (_target_rs->get_attrib(material_slot) != _state_rs->get_attrib(material_slot) ||
+  if (changed.get_bit(material_slot) ||
       !_state_mask.get_bit(material_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_material_pcollector);
 #ifdef SUPPORT_FIXED_FUNCTION
@@ -10331,7 +10378,7 @@ set_state_and_transform(const RenderState *target,
   }
 
   int light_slot = LightAttrib::get_class_slot();
-  if (_target_rs->get_attrib(light_slot) != _state_rs->get_attrib(light_slot) ||
+  if (changed.get_bit(light_slot) ||
       !_state_mask.get_bit(light_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_light_pcollector);
 #ifdef SUPPORT_FIXED_FUNCTION
@@ -10341,7 +10388,7 @@ set_state_and_transform(const RenderState *target,
   }
 
   int stencil_slot = StencilAttrib::get_class_slot();
-  if (_target_rs->get_attrib(stencil_slot) != _state_rs->get_attrib(stencil_slot) ||
+  if (changed.get_bit(stencil_slot) ||
       !_state_mask.get_bit(stencil_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_stencil_pcollector);
     do_issue_stencil();
@@ -10349,7 +10396,7 @@ set_state_and_transform(const RenderState *target,
   }
 
   int fog_slot = FogAttrib::get_class_slot();
-  if (_target_rs->get_attrib(fog_slot) != _state_rs->get_attrib(fog_slot) ||
+  if (changed.get_bit(fog_slot) ||
       !_state_mask.get_bit(fog_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_fog_pcollector);
 #ifdef SUPPORT_FIXED_FUNCTION
@@ -10359,7 +10406,7 @@ set_state_and_transform(const RenderState *target,
   }
 
   int scissor_slot = ScissorAttrib::get_class_slot();
-  if (_target_rs->get_attrib(scissor_slot) != _state_rs->get_attrib(scissor_slot) ||
+  if (changed.get_bit(scissor_slot) ||
       !_state_mask.get_bit(scissor_slot)) {
     // PStatGPUTimer timer(this, _draw_set_state_scissor_pcollector);
     do_issue_scissor();
@@ -11456,6 +11503,17 @@ upload_texture(CLP(TextureContext) *gtc, bool force, bool uses_mipmaps) {
         return true;
       }
     }
+
+    if (!gtc->_has_storage &&
+        !_prepared_objects->reserve_upload(gtc, tex->get_expected_ram_image_size(),
+                                           Thread::get_current_thread())) {
+      // This frame's upload budget has been spent.  Try again next frame, and
+      // show the simple image in the meantime, if we have one.
+      if (tex->has_simple_ram_image() && gtc->was_simple_image_modified()) {
+        return upload_simple_texture(gtc);
+      }
+      return true;
+    }
   }
 
   CPTA_uchar image;
@@ -765,6 +765,7 @@ public:
   bool _supports_bgr;
   bool _supports_packed_dabc;
   bool _supports_packed_ufloat;
+  bool _supports_half_float_vertex;
 
 #ifdef SUPPORT_FIXED_FUNCTION
   bool _supports_rescale_normal;
@@ -355,14 +355,24 @@ do_evict_to(size_t target_size, bool hard_evict) {
           // the first attempt
 
         } else {
-          // We must release the lock while we call evict_lru().
-          _lock.release();
-          page->evict_lru();
-          _lock.acquire();
-
-          if (_total_size <= target_size) {
-            // We've evicted enough to satisfy our target.
-            return;
+          // We must release the lock while we call evict_lru().  If the page
+          // belongs to a reference-counted object, hold a reference to it
+          // meanwhile, so it can't be destructed out from under us.  If it is
+          // already being destructed, leave it alone; its destructor will
+          // remove the page from the LRU as soon as we release the lock.
+          ReferenceCount *owner = page->get_lru_owner();
+          if (owner == (ReferenceCount *)NULL || owner->ref_if_nonzero()) {
+            _lock.release();
+            page->evict_lru();
+            if (owner != (ReferenceCount *)NULL) {
+              unref_delete(owner);
+            }
+            _lock.acquire();
+
+            if (_total_size <= target_size) {
+              // We've evicted enough to satisfy our target.
+              return;
+            }
           }
         }
         if (node == end) {
@@ -509,6 +519,20 @@ evict_lru() {
   dequeue_lru();
 }
 
+/**
+ * If the page is a part of a reference-counted object, returns that object.
+ * The AdaptiveLru uses this to hold a reference to the object while it calls
+ * evict_lru() without holding its lock.  The default implementation returns
+ * NULL, meaning the page's lifetime is managed some other way.
+ *
+ * This is called with the AdaptiveLru's lock held, so it must not attempt to
+ * acquire any locks.
+ */
+ReferenceCount *AdaptiveLruPage::
+get_lru_owner() const {
+  return NULL;
+}
+
 /**
  *
  */
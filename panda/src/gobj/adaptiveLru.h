@@ -19,6 +19,7 @@
 #include "namable.h"
 #include "lightMutex.h"
 #include "lightMutexHolder.h"
+#include "referenceCount.h"
 
 class AdaptiveLruPage;
 
@@ -156,6 +157,10 @@ PUBLISHED:
   virtual void output(ostream &out) const;
   virtual void write(ostream &out, int indent_level) const;
 
+public:
+  virtual ReferenceCount *get_lru_owner() const;
+
+PUBLISHED:
   // Not defined in SimpleLruPage.
   unsigned int get_num_frames() const;
   unsigned int get_num_inactive_frames() const;
@@ -112,6 +112,18 @@ ConfigVariableBool keep_texture_ram
           "texture image from disk; but it will consume memory somewhat "
           "wastefully."));
 
+ConfigVariableInt64 texture_ram_budget
+("texture-ram-budget", -1,
+ PRC_DESC("Specifies the maximum number of bytes of texture images that may "
+          "be held in system RAM at one time, or -1 for no limit.  When "
+          "this is exceeded, the ram images of the least-recently-used "
+          "textures are discarded, but only for textures that can be "
+          "reloaded again from disk or the model cache; they are "
+          "transparently reloaded the next time they are needed.  "
+          "Textures that have set_keep_ram_image() enabled are never "
+          "evicted.  This is most useful in conjunction with "
+          "keep-texture-ram, to keep only the recently-used images."));
+
 ConfigVariableBool driver_compress_textures
 ("driver-compress-textures", false,
  PRC_DESC("Set this true to ask the graphics driver to compress textures, "
@@ -241,6 +253,16 @@ ConfigVariableBool preserve_triangle_strips
           "effective at combining multiple Geoms together, but they will "
           "not implicitly decompose triangle strips."));
 
+ConfigVariableInt vertex_cache_size
+("vertex-cache-size", 32,
+ PRC_DESC("This is the number of entries assumed for the graphics card's "
+          "post-transform vertex cache, used by "
+          "GeomPrimitive::optimize_vertex_cache() when reordering triangles "
+          "for better vertex reuse.  It is also used when computing the "
+          "average cache miss ratio (ACMR) of a primitive.  Most modern "
+          "hardware behaves roughly like a cache of 16 to 32 entries; "
+          "overestimating this is more harmful than underestimating it."));
+
 ConfigVariableBool dump_generated_shaders
 ("dump-generated-shaders", false,
  PRC_DESC("Set this true to cause all generated shaders to be written "
@@ -451,6 +473,17 @@ ConfigVariableInt vertex_data_page_threads
           "is 0, this work will be done in the main thread, which may "
           "introduce occasional random chugs in rendering."));
 
+ConfigVariableBool vertex_data_mmap
+("vertex-data-mmap", false,
+ PRC_DESC("Set this true to allocate each page of vertex data directly "
+          "within a memory mapping of the vertex save file, instead of in "
+          "anonymous memory.  When such a page is evicted from RAM, it is "
+          "not copied to the save file; instead, the operating system is "
+          "told that it may drop the page from memory, and it is paged "
+          "back in by the kernel when it is next needed.  Pages mapped in "
+          "this way are never compressed in RAM.  This is currently only "
+          "supported on Posix systems."));
+
 ConfigVariableInt graphics_memory_limit
 ("graphics-memory-limit", -1,
  PRC_DESC("This is a default limit that is imposed on each GSG at "
@@ -464,6 +497,19 @@ ConfigVariableInt graphics_memory_limit
           "Set this to -1 to have no limit other than the normal "
           "hardware-imposed limit."));
 
+ConfigVariableInt upload_budget_per_frame
+("upload-budget-per-frame", -1,
+ PRC_DESC("This limits the number of bytes of texture images and vertex "
+          "and index buffers that each GSG will upload to the graphics "
+          "card for the first time in a single frame.  Objects that don't "
+          "fit within the budget are put in a queue, and are uploaded "
+          "during one of the following frames, oldest first; in the "
+          "meantime, Geoms are skipped and textures are drawn with their "
+          "simple image, if any.  This smooths out the frame time when a "
+          "large amount of new geometry comes into view.  This only has an "
+          "effect when allow-incomplete-render is also set.  Set this to -1 "
+          "to have no limit."));
+
 ConfigVariableInt sampler_object_limit
 ("sampler-object-limit", 2048,
  PRC_DESC("This is a default limit that is imposed on each GSG at "
@@ -791,6 +791,140 @@ make_patches_in_place() {
   nassertv(all_is_valid);
 }
 
+/**
+ * Reorders the triangles within this Geom for better use of the post-
+ * transform vertex cache, leaving the results in place.  See
+ * GeomPrimitive::optimize_vertex_cache().
+ *
+ * This does not change the order of the vertices in the GeomVertexData; see
+ * SceneGraphReducer::optimize_vertex_cache() for that.
+ *
+ * Don't call this in a downstream thread unless you don't mind it blowing
+ * away other changes you might have recently made in an upstream thread.
+ */
+void Geom::
+optimize_vertex_cache_in_place(int cache_size) {
+  Thread *current_thread = Thread::get_current_thread();
+  CDWriter cdata(_cycler, true, current_thread);
+
+  bool any_changed = false;
+  Primitives::iterator pi;
+  for (pi = cdata->_primitives.begin(); pi != cdata->_primitives.end(); ++pi) {
+    CPT(GeomPrimitive) old_prim = (*pi).get_read_pointer();
+    CPT(GeomPrimitive) new_prim = old_prim->optimize_vertex_cache(cache_size);
+    if (new_prim != old_prim) {
+      (*pi) = (GeomPrimitive *)new_prim.p();
+      any_changed = true;
+    }
+  }
+
+  if (any_changed) {
+    cdata->_modified = Geom::get_next_modified();
+    clear_cache_stage(current_thread);
+  }
+}
+
+/**
+ * Divides the triangles of this Geom into clusters of up to max_triangles
+ * spatially adjacent triangles each, reordering them so that each cluster
+ * occupies a contiguous range of the index list, and computes a bounding
+ * sphere and normal cone for each cluster.  The cull traversal can then cull
+ * the clusters of a large Geom individually, and render only the parts of it
+ * that are in view and facing the camera.
+ *
+ * This is only possible for a Geom with a single GeomTriangles primitive and
+ * no vertex animation; call decompose_in_place() and unify_in_place() first
+ * if necessary.  It is
+ * also only worthwhile for fairly large Geoms, such as those produced by
+ * flatten_strong().  Returns true if the clusters were made, false if the
+ * Geom is not suitable.
+ *
+ * The clusters are discarded as soon as the Geom or its vertex data are
+ * modified, and they are not written to bam files.
+ */
+bool Geom::
+make_clusters(int max_triangles) {
+  Thread *current_thread = Thread::get_current_thread();
+  CDWriter cdata(_cycler, true, current_thread);
+
+  cdata->_clusters.clear();
+  if (cdata->_primitives.size() != 1) {
+    return false;
+  }
+
+  CPT(GeomVertexData) vertex_data = cdata->_data.get_read_pointer();
+  if (vertex_data->get_format()->get_animation().get_animation_type() != AT_none) {
+    // The vertices of an animated Geom move around, so the bounds of the
+    // clusters wouldn't hold.
+    return false;
+  }
+  CPT(GeomPrimitive) prim = cdata->_primitives[0].get_read_pointer();
+
+  pvector<GeomClusters::Cluster> table;
+  PT(GeomPrimitive) new_prim =
+    GeomClusters::build(prim, vertex_data, max_triangles, table, current_thread);
+  if (new_prim == (GeomPrimitive *)NULL) {
+    return false;
+  }
+
+  cdata->_primitives[0] = new_prim.p();
+  cdata->_modified = Geom::get_next_modified();
+  clear_cache_stage(current_thread);
+
+  PT(GeomClusters) clusters =
+    new GeomClusters(cdata->_modified, vertex_data->get_modified(current_thread));
+  pvector<GeomClusters::Cluster>::const_iterator ci;
+  for (ci = table.begin(); ci != table.end(); ++ci) {
+    clusters->add_cluster(*ci);
+  }
+  cdata->_clusters = clusters;
+  return true;
+}
+
+/**
+ * Returns the clusters computed by make_clusters(), or NULL if there are none
+ * or if the Geom has been modified since they were computed.
+ */
+CPT(GeomClusters) Geom::
+get_clusters(Thread *current_thread) const {
+  CDReader cdata(_cycler, current_thread);
+  if (cdata->_clusters == (GeomClusters *)NULL) {
+    return NULL;
+  }
+
+  CPT(GeomVertexData) vertex_data = cdata->_data.get_read_pointer();
+  if (!cdata->_clusters->is_valid(cdata->_modified,
+                                  vertex_data->get_modified(current_thread))) {
+    return NULL;
+  }
+  return cdata->_clusters;
+}
+
+/**
+ * Returns the average cache miss ratio over all of the primitives within
+ * this Geom, weighted by the number of faces in each.  See
+ * GeomPrimitive::calc_acmr().
+ */
+PN_stdfloat Geom::
+calc_acmr(int cache_size) const {
+  CDReader cdata(_cycler);
+
+  PN_stdfloat total_misses = 0.0f;
+  int total_faces = 0;
+  Primitives::const_iterator pi;
+  for (pi = cdata->_primitives.begin(); pi != cdata->_primitives.end(); ++pi) {
+    CPT(GeomPrimitive) prim = (*pi).get_read_pointer();
+    int num_faces = prim->get_num_faces();
+    total_misses += prim->calc_acmr(cache_size) * num_faces;
+    total_faces += num_faces;
+  }
+
+  if (total_faces == 0) {
+    return 0.0f;
+  }
+  return total_misses / (PN_stdfloat)total_faces;
+}
+
 /**
  * Copies the primitives from the indicated Geom into this one.  This does
  * require that both Geoms contain the same fundamental type primitives, both
@@ -39,6 +39,7 @@
 #include "pStatCollector.h"
 #include "deletedChain.h"
 #include "lightMutex.h"
+#include "geomClusters.h"
 
 class GeomContext;
 class PreparedGraphicsObjects;
@@ -105,6 +106,7 @@ PUBLISHED:
   INLINE PT(Geom) make_points() const;
   INLINE PT(Geom) make_lines() const;
   INLINE PT(Geom) make_patches() const;
+  INLINE PT(Geom) optimize_vertex_cache(int cache_size = -1) const;
 
   void decompose_in_place();
   void doubleside_in_place();
@@ -114,6 +116,12 @@ PUBLISHED:
   void make_points_in_place();
   void make_lines_in_place();
   void make_patches_in_place();
+  void optimize_vertex_cache_in_place(int cache_size = -1);
+  PN_stdfloat calc_acmr(int cache_size = -1) const;
+
+  bool make_clusters(int max_triangles = 64);
+  INLINE void clear_clusters();
+  INLINE bool has_clusters(Thread *current_thread = Thread::get_current_thread()) const;
 
   virtual bool copy_primitives_from(const Geom *other);
 
@@ -171,6 +179,8 @@ public:
                                 const InternalName *column_name,
                                 Thread *current_thread) const;
 
+  CPT(GeomClusters) get_clusters(Thread *current_thread) const;
+
   static UpdateSeq get_next_modified();
 
 private:
@@ -325,6 +335,9 @@ private:
     BoundingVolume::BoundsType _bounds_type;
     CPT(BoundingVolume) _user_bounds;
 
+    // This is not written to the bam file.
+    CPT(GeomClusters) _clusters;
+
   public:
     static TypeHandle get_class_type() {
       return _type_handle;
@@ -0,0 +1,173 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file geomArrayPool.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "geomArrayPool.h"
+#include "lightMutexHolder.h"
+#include "addHash.h"
+
+GeomArrayPool *GeomArrayPool::_global_ptr = (GeomArrayPool *)NULL;
+
+/**
+ * Lists the contents of the array pool to the indicated output stream.
+ */
+void GeomArrayPool::
+write(ostream &out) {
+  get_ptr()->ns_list_contents(out);
+}
+
+/**
+ * The nonstatic implementation of share_array().
+ */
+CPT(GeomVertexArrayData) GeomArrayPool::
+ns_share_array(const GeomVertexArrayData *array) {
+  nassertr(array != (GeomVertexArrayData *)NULL, array);
+
+  Thread *current_thread = Thread::get_current_thread();
+  CPT(GeomVertexArrayDataHandle) handle = array->get_handle(current_thread);
+  size_t hash = hash_array(handle);
+
+  LightMutexHolder holder(_lock);
+  pair<Arrays::iterator, Arrays::iterator> range = _arrays.equal_range(hash);
+  Arrays::iterator ai = range.first;
+  while (ai != range.second) {
+    const GeomVertexArrayData *other = (*ai).second.get_orig();
+    if (other == array) {
+      // This one is already in the table.
+      return array;
+    }
+
+    // The array may be in the process of being deleted by another thread, so
+    // we can only use it if we can still take a reference to it.
+    if ((*ai).second.was_deleted() || !other->ref_if_nonzero()) {
+      _arrays.erase(ai++);
+      continue;
+    }
+    CPT(GeomVertexArrayData) other_array = other;
+    other->unref();
+
+    CPT(GeomVertexArrayDataHandle) other_handle = other_array->get_handle(current_thread);
+    if (compare_arrays(handle, other_handle)) {
+      ++_num_shared;
+      _bytes_saved += handle->get_data_size_bytes();
+      return other_array;
+    }
+    ++ai;
+  }
+
+  _arrays.insert(Arrays::value_type(hash, array));
+
+  if (_arrays.size() >= _purge_size) {
+    // Arrays are only removed from the table when we happen to come across
+    // them again, so sweep out the deleted ones now and then to keep the
+    // table from growing without bound.
+    do_garbage_collect();
+    _purge_size = max(_arrays.size() * 2, (size_t)min_purge_size);
+  }
+  return array;
+}
+
+/**
+ * The nonstatic implementation of garbage_collect().
+ */
+int GeomArrayPool::
+ns_garbage_collect() {
+  LightMutexHolder holder(_lock);
+  return do_garbage_collect();
+}
+
+/**
+ * Removes the entries for deleted arrays from the table.  Assumes the lock is
+ * already held.
+ */
+int GeomArrayPool::
+do_garbage_collect() {
+  int num_released = 0;
+  Arrays::iterator ai = _arrays.begin();
+  while (ai != _arrays.end()) {
+    if ((*ai).second.was_deleted()) {
+      _arrays.erase(ai++);
+      ++num_released;
+    } else {
+      ++ai;
+    }
+  }
+  return num_released;
+}
+
+/**
+ * The nonstatic implementation of list_contents().
+ */
+void GeomArrayPool::
+ns_list_contents(ostream &out) const {
+  LightMutexHolder holder(_lock);
+
+  int num_live = 0;
+  size_t live_bytes = 0;
+  Arrays::const_iterator ai;
+  for (ai = _arrays.begin(); ai != _arrays.end(); ++ai) {
+    const GeomVertexArrayData *array = (*ai).second.get_orig();
+    if (!(*ai).second.was_deleted() && array->ref_if_nonzero()) {
+      ++num_live;
+      live_bytes += array->get_data_size_bytes();
+      unref_delete(array);
+    }
+  }
+
+  out << "GeomArrayPool contains " << num_live << " arrays ("
+      << live_bytes << " bytes); " << _num_shared
+      << " duplicate arrays replaced, saving " << _bytes_saved << " bytes.\n";
+}
+
+/**
+ * Computes a hash of the contents of the indicated array, along with its
+ * size, so that only arrays with matching hashes need to be compared.
+ */
+size_t GeomArrayPool::
+hash_array(const GeomVertexArrayDataHandle *handle) {
+  size_t num_bytes = handle->get_data_size_bytes();
+  size_t hash = size_t_hash::add_hash(0, num_bytes);
+  hash = size_t_hash::add_hash(hash, (size_t)handle->get_usage_hint());
+  return AddHash::add_hash(hash, (const uint8_t *)handle->get_read_pointer(true), num_bytes);
+}
+
+/**
+ * Returns true if the two arrays have the same format, usage hint and
+ * contents.
+ */
+bool GeomArrayPool::
+compare_arrays(const GeomVertexArrayDataHandle *a,
+               const GeomVertexArrayDataHandle *b) {
+  size_t num_bytes = a->get_data_size_bytes();
+  if (num_bytes != b->get_data_size_bytes() ||
+      a->get_usage_hint() != b->get_usage_hint()) {
+    return false;
+  }
+  const GeomVertexArrayFormat *a_format = a->get_array_format();
+  const GeomVertexArrayFormat *b_format = b->get_array_format();
+  if (a_format != b_format && a_format->compare_to(*b_format) != 0) {
+    return false;
+  }
+  return memcmp(a->get_read_pointer(true), b->get_read_pointer(true), num_bytes) == 0;
+}
+
+/**
+ * Initializes and/or returns the global pointer to the one GeomArrayPool
+ * object in the system.
+ */
+GeomArrayPool *GeomArrayPool::
+get_ptr() {
+  if (_global_ptr == (GeomArrayPool *)NULL) {
+    _global_ptr = new GeomArrayPool;
+  }
+  return _global_ptr;
+}
@@ -0,0 +1,85 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file geomArrayPool.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef GEOMARRAYPOOL_H
+#define GEOMARRAYPOOL_H
+
+#include "pandabase.h"
+#include "geomVertexArrayData.h"
+#include "geomVertexData.h"
+#include "geomPrimitive.h"
+#include "weakPointerTo.h"
+#include "lightMutex.h"
+#include "pmap.h"
+
+/**
+ * A weak table of the vertex and index arrays that have been loaded, keyed
+ * by a hash of their contents.  Passing a newly loaded array through
+ * share_array() returns a previously registered array with identical
+ * contents, if there is one still in use, so that many models that contain
+ * the same mesh need only store it (and upload it to the graphics card) once.
+ *
+ * Since arrays are copy-on-write, a shared array is silently unshared again
+ * if one of its users modifies it.
+ *
+ * The Loader applies this to each model it loads when share-geom-arrays is
+ * enabled; see also SceneGraphReducer::share_arrays().
+ */
+class EXPCL_PANDA_GOBJ GeomArrayPool {
+PUBLISHED:
+  INLINE static CPT(GeomVertexArrayData) share_array(const GeomVertexArrayData *array);
+  INLINE static CPT(GeomVertexData) share_vertex_data(const GeomVertexData *data);
+  INLINE static CPT(GeomPrimitive) share_primitive(const GeomPrimitive *prim);
+
+  INLINE static int get_num_arrays();
+  INLINE static int get_num_shared();
+  INLINE static size_t get_bytes_saved();
+
+  INLINE static int garbage_collect();
+
+  INLINE static void list_contents(ostream &out);
+  INLINE static void list_contents();
+  static void write(ostream &out);
+
+private:
+  INLINE GeomArrayPool();
+
+  CPT(GeomVertexArrayData) ns_share_array(const GeomVertexArrayData *array);
+  int ns_garbage_collect();
+  int do_garbage_collect();
+  void ns_list_contents(ostream &out) const;
+
+  static size_t hash_array(const GeomVertexArrayDataHandle *handle);
+  static bool compare_arrays(const GeomVertexArrayDataHandle *a,
+                             const GeomVertexArrayDataHandle *b);
+
+  static GeomArrayPool *get_ptr();
+
+  static GeomArrayPool *_global_ptr;
+
+  LightMutex _lock;
+  typedef pmultimap<size_t, WCPT(GeomVertexArrayData)> Arrays;
+  Arrays _arrays;
+
+  int _num_shared;
+  size_t _bytes_saved;
+
+  // When the table reaches this many entries, the entries for deleted arrays
+  // are purged from it, and this is reset to twice the number that remain.
+  size_t _purge_size;
+  static const size_t min_purge_size = 256;
+};
+
+#include "geomArrayPool.I"
+
+#endif
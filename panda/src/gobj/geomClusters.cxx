@@ -0,0 +1,338 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file geomClusters.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "geomClusters.h"
+#include "geom.h"
+#include "geomTriangles.h"
+#include "geomVertexReader.h"
+#include "geomVertexWriter.h"
+#include "boundingSphere.h"
+#include "lightMutexHolder.h"
+
+// The number of different culled versions of a Geom that are kept at once.
+static const size_t max_culled_geoms = 8;
+
+/**
+ * Creates an empty table for a Geom and vertex data with the indicated
+ * modification counts.
+ */
+GeomClusters::
+GeomClusters(UpdateSeq geom_modified, UpdateSeq data_modified) :
+  _geom_modified(geom_modified),
+  _data_modified(data_modified)
+{
+}
+
+/**
+ * Tests each of the clusters of the indicated Geom, which must be the Geom
+ * that this table was computed for, against the view frustum, which is in the
+ * Geom's coordinate space.  If cull_backfaces is true, clusters whose
+ * triangles all face away from camera_pos are culled as well.
+ *
+ * Returns the Geom itself if all of the clusters are visible, or NULL if none
+ * of them are.  Otherwise, returns a new Geom that contains only the
+ * triangles of the visible clusters.
+ */
+CPT(Geom) GeomClusters::
+cull(const Geom *geom, const GeometricBoundingVolume *view_frustum,
+     bool cull_backfaces, const LPoint3 &camera_pos,
+     Thread *current_thread) const {
+  int num_clusters = (int)_clusters.size();
+  BitArray visible;
+  int num_visible = 0;
+
+  for (int i = 0; i < num_clusters; ++i) {
+    const Cluster &cluster = _clusters[i];
+    if (view_frustum != (const GeometricBoundingVolume *)NULL) {
+      BoundingSphere sphere(cluster._center, cluster._radius);
+      if (view_frustum->contains(&sphere) == BoundingVolume::IF_no_intersection) {
+        continue;
+      }
+    }
+
+    if (cull_backfaces) {
+      // If every direction within the normal cone points away from the
+      // camera, as seen from anywhere within the bounding sphere, the whole
+      // cluster is backfacing.
+      LVector3 view = cluster._center - camera_pos;
+      if (view.dot(cluster._cone_axis) >=
+          cluster._cone_cutoff * view.length() + cluster._radius) {
+        continue;
+      }
+    }
+
+    visible.set_bit(i);
+    ++num_visible;
+  }
+
+  if (num_visible == num_clusters) {
+    return geom;
+  }
+  if (num_visible == 0) {
+    return NULL;
+  }
+
+  LightMutexHolder holder(_lock);
+  CulledGeoms::iterator gi = _culled_geoms.find(visible);
+  if (gi != _culled_geoms.end()) {
+    return (*gi).second;
+  }
+
+  if (_culled_geoms.size() >= max_culled_geoms) {
+    // The camera is moving; the old results aren't likely to be needed
+    // again.
+    _culled_geoms.clear();
+  }
+  CPT(Geom) culled_geom = make_culled_geom(geom, visible, current_thread);
+  _culled_geoms[visible] = culled_geom;
+  return culled_geom;
+}
+
+/**
+ * Reorders the triangles of the indicated primitive, which should be a
+ * GeomTriangles, so that they form clusters of up to max_triangles spatially
+ * adjacent triangles each, and fills in the table of clusters.  Returns the
+ * new primitive, or NULL if the primitive cannot be divided into clusters.
+ *
+ * Each cluster is grown outward from a seed triangle, one ring of neighboring
+ * triangles at a time, which tends to produce compact, roughly disc-shaped
+ * patches with tight bounding spheres and normal cones.
+ */
+PT(GeomPrimitive) GeomClusters::
+build(const GeomPrimitive *prim, const GeomVertexData *vertex_data,
+      int max_triangles, pvector<Cluster> &clusters,
+      Thread *current_thread) {
+  nassertr(max_triangles > 0, NULL);
+  if (!prim->is_of_type(GeomTriangles::get_class_type())) {
+    return NULL;
+  }
+
+  GeomVertexReader vertex(vertex_data, InternalName::get_vertex(),
+                          current_thread);
+  if (!vertex.has_column()) {
+    return NULL;
+  }
+
+  int num_rows = vertex_data->get_num_rows();
+  pvector<LPoint3> points;
+  points.reserve(num_rows);
+  while (!vertex.is_at_end()) {
+    points.push_back(vertex.get_data3());
+  }
+
+  int num_indices = prim->get_num_vertices();
+  int num_triangles = num_indices / 3;
+  if (num_triangles <= max_triangles) {
+    // Not worth it.
+    return NULL;
+  }
+
+  pvector<int> indices;
+  indices.reserve(num_indices);
+  for (int i = 0; i < num_indices; ++i) {
+    int v = prim->get_vertex(i);
+    nassertr(v >= 0 && v < num_rows, NULL);
+    indices.push_back(v);
+  }
+
+  // Build the table of triangles that use each vertex.
+  pvector<int> vertex_tris_start(num_rows + 1, 0);
+  for (int i = 0; i < num_indices; ++i) {
+    ++vertex_tris_start[indices[i] + 1];
+  }
+  for (int v = 0; v < num_rows; ++v) {
+    vertex_tris_start[v + 1] += vertex_tris_start[v];
+  }
+  pvector<int> vertex_tris(num_indices);
+  pvector<int> fill(vertex_tris_start);
+  for (int i = 0; i < num_indices; ++i) {
+    vertex_tris[fill[indices[i]]++] = i / 3;
+  }
+
+  // Grow the clusters.
+  pvector<bool> assigned(num_triangles, false);
+  pvector<int> order;
+  order.reserve(num_triangles);
+  pvector<int> cluster_starts;
+  pvector<int> queue;
+
+  for (int seed = 0; seed < num_triangles; ++seed) {
+    if (assigned[seed]) {
+      continue;
+    }
+    cluster_starts.push_back((int)order.size());
+    int cluster_size = 0;
+
+    queue.clear();
+    queue.push_back(seed);
+    size_t qi = 0;
+    while (qi < queue.size() && cluster_size < max_triangles) {
+      int tri = queue[qi++];
+      if (assigned[tri]) {
+        continue;
+      }
+      assigned[tri] = true;
+      order.push_back(tri);
+      ++cluster_size;
+
+      for (int c = 0; c < 3; ++c) {
+        int v = indices[tri * 3 + c];
+        for (int ti = vertex_tris_start[v]; ti < vertex_tris_start[v + 1]; ++ti) {
+          if (!assigned[vertex_tris[ti]]) {
+            queue.push_back(vertex_tris[ti]);
+          }
+        }
+      }
+    }
+  }
+  cluster_starts.push_back(num_triangles);
+
+  // Now compute the bounds and normal cone of each cluster.
+  clusters.clear();
+  int num_clusters = (int)cluster_starts.size() - 1;
+  clusters.reserve(num_clusters);
+
+  pvector<LVector3> normals;
+  for (int ci = 0; ci < num_clusters; ++ci) {
+    Cluster cluster;
+    cluster._first_index = cluster_starts[ci] * 3;
+    cluster._num_indices = (cluster_starts[ci + 1] - cluster_starts[ci]) * 3;
+
+    LPoint3 min_point = points[indices[order[cluster_starts[ci]] * 3]];
+    LPoint3 max_point = min_point;
+    LVector3 normal_sum = LVector3::zero();
+    normals.clear();
+
+    for (int oi = cluster_starts[ci]; oi < cluster_starts[ci + 1]; ++oi) {
+      int tri = order[oi];
+      const LPoint3 &p0 = points[indices[tri * 3]];
+      const LPoint3 &p1 = points[indices[tri * 3 + 1]];
+      const LPoint3 &p2 = points[indices[tri * 3 + 2]];
+      for (int c = 0; c < 3; ++c) {
+        const LPoint3 &p = points[indices[tri * 3 + c]];
+        min_point.set(min(min_point[0], p[0]), min(min_point[1], p[1]), min(min_point[2], p[2]));
+        max_point.set(max(max_point[0], p[0]), max(max_point[1], p[1]), max(max_point[2], p[2]));
+      }
+
+      LVector3 normal = (p1 - p0).cross(p2 - p0);
+      if (normal.normalize()) {
+        normals.push_back(normal);
+        normal_sum += normal;
+      }
+    }
+
+    cluster._center = (min_point + max_point) * 0.5f;
+    PN_stdfloat sq_radius = 0.0f;
+    for (int oi = cluster_starts[ci]; oi < cluster_starts[ci + 1]; ++oi) {
+      int tri = order[oi];
+      for (int c = 0; c < 3; ++c) {
+        sq_radius = max(sq_radius, (points[indices[tri * 3 + c]] - cluster._center).length_squared());
+      }
+    }
+    cluster._radius = csqrt(sq_radius);
+
+    // A cutoff of 1 means that the cone is too wide to ever be culled.
+    cluster._cone_axis = LVector3::up();
+    cluster._cone_cutoff = 1.0f;
+    if (normal_sum.normalize()) {
+      PN_stdfloat min_dot = 1.0f;
+      pvector<LVector3>::const_iterator ni;
+      for (ni = normals.begin(); ni != normals.end(); ++ni) {
+        min_dot = min(min_dot, normal_sum.dot(*ni));
+      }
+      if (min_dot > 0.1f) {
+        cluster._cone_axis = normal_sum;
+        cluster._cone_cutoff = csqrt(1.0f - min_dot * min_dot);
+      }
+    }
+
+    clusters.push_back(cluster);
+  }
+
+  // Finally, write out the reordered triangles.
+  PT(GeomPrimitive) new_prim = prim->make_copy();
+  PT(GeomVertexArrayData) new_vertices = new_prim->make_index_data();
+  new_vertices->unclean_set_num_rows(num_triangles * 3);
+  {
+    GeomVertexWriter writer(new_vertices, 0, current_thread);
+    pvector<int>::const_iterator oi;
+    for (oi = order.begin(); oi != order.end(); ++oi) {
+      writer.set_data1i(indices[(*oi) * 3]);
+      writer.set_data1i(indices[(*oi) * 3 + 1]);
+      writer.set_data1i(indices[(*oi) * 3 + 2]);
+    }
+  }
+  new_prim->set_vertices(new_vertices, num_triangles * 3);
+  return new_prim;
+}
+
+/**
+ * Returns a copy of the Geom that includes only the indicated clusters.
+ * Consecutive visible clusters are copied as a single range of indices.
+ */
+CPT(Geom) GeomClusters::
+make_culled_geom(const Geom *geom, const BitArray &visible,
+                 Thread *current_thread) const {
+  CPT(GeomPrimitive) prim = geom->get_primitive(0);
+  CPT(GeomVertexArrayData) vertices = prim->get_vertices();
+  nassertr(vertices != (GeomVertexArrayData *)NULL, geom);
+
+  int num_clusters = (int)_clusters.size();
+  int num_indices = 0;
+  for (int i = 0; i < num_clusters; ++i) {
+    if (visible.get_bit(i)) {
+      num_indices += _clusters[i]._num_indices;
+    }
+  }
+
+  CPT(GeomVertexArrayDataHandle) from = vertices->get_handle(current_thread);
+  const unsigned char *from_pointer = from->get_read_pointer(true);
+  size_t stride = from->get_array_format()->get_stride();
+
+  PT(GeomVertexArrayData) new_vertices =
+    new GeomVertexArrayData(vertices->get_array_format(), GeomEnums::UH_stream);
+  new_vertices->unclean_set_num_rows(num_indices);
+  {
+    PT(GeomVertexArrayDataHandle) to = new_vertices->modify_handle(current_thread);
+    unsigned char *to_pointer = to->get_write_pointer();
+
+    int i = 0;
+    while (i < num_clusters) {
+      if (!visible.get_bit(i)) {
+        ++i;
+        continue;
+      }
+      int begin = _clusters[i]._first_index;
+      int j = i + 1;
+      while (j < num_clusters && visible.get_bit(j)) {
+        ++j;
+      }
+      int end = _clusters[j - 1]._first_index + _clusters[j - 1]._num_indices;
+      size_t num_bytes = (size_t)(end - begin) * stride;
+      memcpy(to_pointer, from_pointer + begin * stride, num_bytes);
+      to_pointer += num_bytes;
+      i = j;
+    }
+  }
+
+  PT(GeomPrimitive) new_prim = prim->make_copy();
+  new_prim->set_vertices(new_vertices, num_indices);
+
+  PT(Geom) new_geom = geom->make_copy();
+  new_geom->set_primitive(0, new_prim);
+  new_geom->clear_clusters();
+
+  // The original bounding volume is still a valid, if conservative, bound.
+  new_geom->set_bounds(geom->get_bounds(current_thread));
+  return new_geom;
+}
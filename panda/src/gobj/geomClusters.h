@@ -0,0 +1,93 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file geomClusters.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef GEOMCLUSTERS_H
+#define GEOMCLUSTERS_H
+
+#include "pandabase.h"
+#include "referenceCount.h"
+#include "luse.h"
+#include "pvector.h"
+#include "pmap.h"
+#include "pointerTo.h"
+#include "updateSeq.h"
+#include "bitArray.h"
+#include "lightMutex.h"
+
+class Geom;
+class GeomPrimitive;
+class GeomVertexData;
+class GeometricBoundingVolume;
+
+/**
+ * The table of clusters, or meshlets, that a Geom's triangles have been
+ * divided into by Geom::make_clusters().  Each cluster is a small run of
+ * spatially adjacent triangles within the Geom's index list, with its own
+ * bounding sphere and normal cone.  This allows the cull traversal to cull a
+ * large, flattened Geom piece by piece, against the view frustum as well as
+ * by facing direction, and to draw only the index ranges that survive.
+ *
+ * This is an internal object; it is only valid as long as the Geom and its
+ * vertex data are not modified after the clusters are computed.
+ */
+class EXPCL_PANDA_GOBJ GeomClusters : public ReferenceCount {
+public:
+  class Cluster {
+  public:
+    int _first_index;
+    int _num_indices;
+    LPoint3 _center;
+    PN_stdfloat _radius;
+    LVector3 _cone_axis;
+    PN_stdfloat _cone_cutoff;
+  };
+
+  GeomClusters(UpdateSeq geom_modified, UpdateSeq data_modified);
+
+  INLINE int get_num_clusters() const;
+  INLINE const Cluster &get_cluster(int n) const;
+  INLINE void add_cluster(const Cluster &cluster);
+
+  INLINE bool is_valid(UpdateSeq geom_modified, UpdateSeq data_modified) const;
+
+  CPT(Geom) cull(const Geom *geom, const GeometricBoundingVolume *view_frustum,
+                 bool cull_backfaces, const LPoint3 &camera_pos,
+                 Thread *current_thread) const;
+
+  static PT(GeomPrimitive)
+  build(const GeomPrimitive *prim, const GeomVertexData *vertex_data,
+        int max_triangles, pvector<Cluster> &clusters,
+        Thread *current_thread);
+
+private:
+  CPT(Geom) make_culled_geom(const Geom *geom, const BitArray &visible,
+                             Thread *current_thread) const;
+
+  typedef pvector<Cluster> Clusters;
+  Clusters _clusters;
+
+  UpdateSeq _geom_modified;
+  UpdateSeq _data_modified;
+
+  // The recently culled Geoms, keyed by the set of visible clusters, which
+  // are returned again as long as the same set of clusters is visible.  This
+  // keeps us from uploading a new index buffer every frame while the camera
+  // stays still, even if the Geom is seen by several cameras at once.
+  typedef pmap<BitArray, CPT(Geom) > CulledGeoms;
+  LightMutex _lock;
+  mutable CulledGeoms _culled_geoms;
+};
+
+#include "geomClusters.I"
+
+#endif
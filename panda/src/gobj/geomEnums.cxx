@@ -109,6 +109,12 @@ operator << (ostream &out, GeomEnums::NumericType numeric_type) {
 
   case GeomEnums::NT_packed_ufloat:
     return out << "packed_ufloat";
+
+  case GeomEnums::NT_float16:
+    return out << "float16";
+
+  case GeomEnums::NT_packed_oct:
+    return out << "packed_oct";
   }
 
   return out << "**invalid numeric type (" << (int)numeric_type << ")**";
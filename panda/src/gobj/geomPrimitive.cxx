@@ -39,6 +39,322 @@ PStatCollector GeomPrimitive::_decompose_pcollector("*:Munge:Decompose");
 PStatCollector GeomPrimitive::_doubleside_pcollector("*:Munge:Doubleside");
 PStatCollector GeomPrimitive::_reverse_pcollector("*:Munge:Reverse");
 PStatCollector GeomPrimitive::_rotate_pcollector("*:Munge:Rotate");
+PStatCollector GeomPrimitive::_optimize_vertex_cache_pcollector("*:Munge:Optimize vertex cache");
+
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define GEOMPRIMITIVE_USE_SSE2
+#endif
+
+// The following are used by calc_tight_bounds() and calc_sphere_radius() to
+// walk directly through a position column of float32 or float64 values,
+// which is far cheaper than going through a GeomVertexReader one vertex at a
+// time.  A "Rows" object yields the vertex rows referenced by a primitive.
+
+// Yields the consecutive rows of a nonindexed primitive.
+class SequentialBoundsRows {
+public:
+  SequentialBoundsRows(int begin, int end) : _row(begin), _end(end) {}
+  bool next(int &row) {
+    if (_row < _end) {
+      row = _row++;
+      return true;
+    }
+    return false;
+  }
+
+private:
+  int _row;
+  int _end;
+};
+
+// Yields the rows referenced by the index array of an indexed primitive,
+// skipping the strip-cut index and any index that is out of range.
+template<class Index>
+class IndexedBoundsRows {
+public:
+  IndexedBoundsRows(const unsigned char *indices, int num_indices,
+                    int num_rows) :
+    _ptr((const Index *)indices),
+    _end((const Index *)indices + num_indices),
+    _num_rows(num_rows) {}
+  bool next(int &row) {
+    while (_ptr < _end) {
+      Index index = *_ptr++;
+      if (index != (Index)~(Index)0 && (int)index < _num_rows) {
+        row = (int)index;
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  const Index *_ptr;
+  const Index *_end;
+  int _num_rows;
+};
+
+// Expands min_point, max_point and sq_center_dist to include the vertices.
+class TightBoundsKernel {
+public:
+  TightBoundsKernel(LPoint3 &min_point, LPoint3 &max_point,
+                    PN_stdfloat &sq_center_dist, bool &found_any,
+                    bool got_mat, const LMatrix4 &mat) :
+    _min_point(min_point), _max_point(max_point),
+    _sq_center_dist(sq_center_dist), _found_any(found_any),
+    _got_mat(got_mat), _mat(mat) {}
+
+  template<class Float, class Rows>
+  void run(const unsigned char *data, size_t stride, Rows rows);
+
+#ifdef GEOMPRIMITIVE_USE_SSE2
+  template<class Rows>
+  void run_sse2(const unsigned char *data, size_t stride, Rows rows);
+#endif
+
+  LPoint3 &_min_point;
+  LPoint3 &_max_point;
+  PN_stdfloat &_sq_center_dist;
+  bool &_found_any;
+  bool _got_mat;
+  const LMatrix4 &_mat;
+};
+
+template<class Float, class Rows>
+void TightBoundsKernel::
+run(const unsigned char *data, size_t stride, Rows rows) {
+#ifdef GEOMPRIMITIVE_USE_SSE2
+  if (sizeof(Float) == sizeof(float) && !_got_mat) {
+    run_sse2(data, stride, rows);
+    return;
+  }
+#endif
+
+  int row;
+  if (!_found_any) {
+    if (!rows.next(row)) {
+      return;
+    }
+    const Float *v = (const Float *)(data + row * stride);
+    LPoint3 first_vertex((PN_stdfloat)v[0], (PN_stdfloat)v[1], (PN_stdfloat)v[2]);
+    if (_got_mat) {
+      first_vertex = _mat.xform_point(first_vertex);
+    }
+    _min_point = first_vertex;
+    _max_point = first_vertex;
+    _sq_center_dist = first_vertex.length_squared();
+    _found_any = true;
+  }
+
+  if (_got_mat) {
+    while (rows.next(row)) {
+      const Float *v = (const Float *)(data + row * stride);
+      LPoint3 vertex = _mat.xform_point(LPoint3((PN_stdfloat)v[0], (PN_stdfloat)v[1], (PN_stdfloat)v[2]));
+
+      _min_point.set(min(_min_point[0], vertex[0]),
+                     min(_min_point[1], vertex[1]),
+                     min(_min_point[2], vertex[2]));
+      _max_point.set(max(_max_point[0], vertex[0]),
+                     max(_max_point[1], vertex[1]),
+                     max(_max_point[2], vertex[2]));
+      _sq_center_dist = max(_sq_center_dist, vertex.length_squared());
+    }
+    return;
+  }
+
+  // Keep the running values in locals, so that the compiler can keep them
+  // in registers.
+  Float min_x = _min_point[0], min_y = _min_point[1], min_z = _min_point[2];
+  Float max_x = _max_point[0], max_y = _max_point[1], max_z = _max_point[2];
+  Float sq_dist = _sq_center_dist;
+
+  while (rows.next(row)) {
+    const Float *v = (const Float *)(data + row * stride);
+    Float x = v[0], y = v[1], z = v[2];
+    min_x = min(min_x, x);
+    min_y = min(min_y, y);
+    min_z = min(min_z, z);
+    max_x = max(max_x, x);
+    max_y = max(max_y, y);
+    max_z = max(max_z, z);
+    sq_dist = max(sq_dist, x * x + y * y + z * z);
+  }
+
+  _min_point.set((PN_stdfloat)min_x, (PN_stdfloat)min_y, (PN_stdfloat)min_z);
+  _max_point.set((PN_stdfloat)max_x, (PN_stdfloat)max_y, (PN_stdfloat)max_z);
+  _sq_center_dist = (PN_stdfloat)sq_dist;
+}
+
+#ifdef GEOMPRIMITIVE_USE_SSE2
+// Loads the three floats at the indicated address into the first three lanes
+// of an SSE register, without reading past the third one.
+static INLINE __m128
+load_float3_sse2(const float *v) {
+  return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), (const __m64 *)v),
+                       _mm_load_ss(v + 2));
+}
+
+// Returns the squared length of the three-component vector in the first
+// lane.
+static INLINE __m128
+length_squared_sse2(__m128 p) {
+  __m128 sq = _mm_mul_ps(p, p);
+  return _mm_add_ss(sq, _mm_add_ss(_mm_shuffle_ps(sq, sq, _MM_SHUFFLE(1, 1, 1, 1)),
+                                   _mm_movehl_ps(sq, sq)));
+}
+
+template<class Rows>
+void TightBoundsKernel::
+run_sse2(const unsigned char *data, size_t stride, Rows rows) {
+  int row;
+  if (!_found_any) {
+    if (!rows.next(row)) {
+      return;
+    }
+    const float *v = (const float *)(data + row * stride);
+    _min_point.set(v[0], v[1], v[2]);
+    _max_point = _min_point;
+    _sq_center_dist = _min_point.length_squared();
+    _found_any = true;
+  }
+
+  __m128 vmin = _mm_setr_ps(_min_point[0], _min_point[1], _min_point[2], 0.0f);
+  __m128 vmax = _mm_setr_ps(_max_point[0], _max_point[1], _max_point[2], 0.0f);
+  __m128 vsq = _mm_set_ss(_sq_center_dist);
+
+  while (rows.next(row)) {
+    __m128 p = load_float3_sse2((const float *)(data + row * stride));
+    vmin = _mm_min_ps(vmin, p);
+    vmax = _mm_max_ps(vmax, p);
+    vsq = _mm_max_ss(vsq, length_squared_sse2(p));
+  }
+
+  float out_min[4], out_max[4];
+  _mm_storeu_ps(out_min, vmin);
+  _mm_storeu_ps(out_max, vmax);
+  _min_point.set(out_min[0], out_min[1], out_min[2]);
+  _max_point.set(out_max[0], out_max[1], out_max[2]);
+  _sq_center_dist = _mm_cvtss_f32(vsq);
+}
+#endif  // GEOMPRIMITIVE_USE_SSE2
+
+// Expands sq_radius to include the distance of the vertices to the center.
+class SphereRadiusKernel {
+public:
+  SphereRadiusKernel(const LPoint3 &center, PN_stdfloat &sq_radius) :
+    _center(center), _sq_radius(sq_radius) {}
+
+  template<class Float, class Rows>
+  void run(const unsigned char *data, size_t stride, Rows rows);
+
+  const LPoint3 &_center;
+  PN_stdfloat &_sq_radius;
+};
+
+template<class Float, class Rows>
+void SphereRadiusKernel::
+run(const unsigned char *data, size_t stride, Rows rows) {
+  int row;
+#ifdef GEOMPRIMITIVE_USE_SSE2
+  if (sizeof(Float) == sizeof(float)) {
+    __m128 vcenter = _mm_setr_ps(_center[0], _center[1], _center[2], 0.0f);
+    __m128 vsq = _mm_set_ss(_sq_radius);
+    while (rows.next(row)) {
+      __m128 p = load_float3_sse2((const float *)(data + row * stride));
+      vsq = _mm_max_ss(vsq, length_squared_sse2(_mm_sub_ps(p, vcenter)));
+    }
+    _sq_radius = _mm_cvtss_f32(vsq);
+    return;
+  }
+#endif
+
+  Float cx = _center[0], cy = _center[1], cz = _center[2];
+  Float sq_radius = _sq_radius;
+  while (rows.next(row)) {
+    const Float *v = (const Float *)(data + row * stride);
+    Float x = v[0] - cx, y = v[1] - cy, z = v[2] - cz;
+    sq_radius = max(sq_radius, x * x + y * y + z * z);
+  }
+  _sq_radius = (PN_stdfloat)sq_radius;
+}
+
+// Runs the kernel over the given rows of the column, with the appropriate
+// numeric type.
+template<class Kernel, class Rows>
+static void
+run_bounds_kernel(Kernel &kernel, GeomEnums::NumericType numeric_type,
+                  const unsigned char *data, size_t stride, const Rows &rows) {
+  if (numeric_type == GeomEnums::NT_float32) {
+    kernel.template run<float>(data, stride, rows);
+  } else {
+    kernel.template run<double>(data, stride, rows);
+  }
+}
+
+// Runs the kernel over the vertices of a primitive, if the column being read
+// by the reader consists of three native floats or doubles.  Returns false if
+// the column has some other format, in which case the caller should fall back
+// to using the reader.
+template<class Kernel>
+static bool
+run_native_bounds(Kernel &kernel, const GeomVertexReader &reader,
+                  int first_vertex, int num_vertices,
+                  const GeomVertexArrayData *vertices,
+                  GeomEnums::NumericType index_type,
+                  Thread *current_thread) {
+  const GeomVertexColumn *column = reader.get_column();
+  GeomEnums::NumericType numeric_type = column->get_numeric_type();
+  if (column->get_num_components() != 3 ||
+      (numeric_type != GeomEnums::NT_float32 &&
+       numeric_type != GeomEnums::NT_float64)) {
+    return false;
+  }
+
+  const GeomVertexArrayDataHandle *handle = reader.get_array_handle();
+  const unsigned char *data = handle->get_read_pointer(true);
+  if (data == (const unsigned char *)NULL) {
+    return false;
+  }
+  data += column->get_start();
+  size_t stride = reader.get_stride();
+  int num_rows = handle->get_num_rows();
+
+  if (vertices == (const GeomVertexArrayData *)NULL) {
+    // Nonindexed case.
+    SequentialBoundsRows rows(first_vertex, min(first_vertex + num_vertices, num_rows));
+    run_bounds_kernel(kernel, numeric_type, data, stride, rows);
+    return true;
+  }
+
+  // Indexed case.
+  CPT(GeomVertexArrayDataHandle) index_handle = vertices->get_handle(current_thread);
+  const unsigned char *indices = index_handle->get_read_pointer(true);
+  if (indices == (const unsigned char *)NULL) {
+    return false;
+  }
+  int num_indices = index_handle->get_num_rows();
+
+  switch (index_type) {
+  case GeomEnums::NT_uint8:
+    run_bounds_kernel(kernel, numeric_type, data, stride,
+                      IndexedBoundsRows<uint8_t>(indices, num_indices, num_rows));
+    return true;
+
+  case GeomEnums::NT_uint16:
+    run_bounds_kernel(kernel, numeric_type, data, stride,
+                      IndexedBoundsRows<uint16_t>(indices, num_indices, num_rows));
+    return true;
+
+  case GeomEnums::NT_uint32:
+    run_bounds_kernel(kernel, numeric_type, data, stride,
+                      IndexedBoundsRows<uint32_t>(indices, num_indices, num_rows));
+    return true;
+
+  default:
+    return false;
+  }
+}
 
 /**
  * Constructs an invalid object.  Only used when reading from bam.
@@ -1015,6 +1331,82 @@ make_patches() const {
   return patches;
 }
 
+/**
+ * Returns a new primitive that renders the same faces as this one, but with
+ * the faces reordered so as to make the best use of the graphics card's
+ * post-transform vertex cache, using Tom Forsyth's linear-speed vertex cache
+ * optimization algorithm.  The vertex order within each face is preserved,
+ * so the winding order and flat-shading vertex are unaffected.
+ *
+ * cache_size is the assumed number of entries in the vertex cache; if it is
+ * -1, the value of the vertex-cache-size config variable is used.
+ *
+ * This is currently only implemented for indexed GeomTriangles; other
+ * primitive types are returned unchanged (but see decompose()).  Also see
+ * calc_acmr() to measure the effectiveness of this operation.
+ */
+CPT(GeomPrimitive) GeomPrimitive::
+optimize_vertex_cache(int cache_size) const {
+  if (cache_size < 0) {
+    cache_size = vertex_cache_size;
+  }
+  if (gobj_cat.is_debug()) {
+    gobj_cat.debug()
+      << "Optimizing vertex cache for " << get_type() << ": "
+      << (void *)this << "\n";
+  }
+
+  PStatTimer timer(_optimize_vertex_cache_pcollector);
+  return optimize_vertex_cache_impl(max(cache_size, 4));
+}
+
+/**
+ * Returns the average cache miss ratio of this primitive: the average number
+ * of vertices that would have to be transformed per face rendered, given a
+ * FIFO post-transform vertex cache of the indicated size (or of
+ * vertex-cache-size entries, if cache_size is -1).
+ *
+ * The theoretical best value for a closed triangle mesh is about 0.5; the
+ * worst value is 3.0, which is what is achieved by nonindexed triangles.
+ */
+PN_stdfloat GeomPrimitive::
+calc_acmr(int cache_size) const {
+  if (cache_size < 0) {
+    cache_size = vertex_cache_size;
+  }
+  cache_size = max(cache_size, 1);
+
+  GeomPrimitivePipelineReader reader(this, Thread::get_current_thread());
+  int num_vertices = reader.get_num_vertices();
+  if (num_vertices == 0) {
+    return 0.0f;
+  }
+  reader.check_minmax();
+
+  // A vertex is in the cache if fewer than cache_size misses have occurred
+  // since it was last brought into it, which simulates a FIFO cache without
+  // having to store the cache contents explicitly.
+  pvector<int> cache_time(reader.get_max_vertex() + 1, -cache_size);
+  int strip_cut_index = reader.is_indexed() ? reader.get_strip_cut_index() : -1;
+  int misses = 0;
+  for (int i = 0; i < num_vertices; ++i) {
+    int vertex = reader.get_vertex(i);
+    if (vertex == strip_cut_index || vertex >= (int)cache_time.size()) {
+      continue;
+    }
+    if (misses - cache_time[vertex] >= cache_size) {
+      cache_time[vertex] = misses;
+      ++misses;
+    }
+  }
+
+  int num_faces = get_num_faces();
+  if (num_faces == 0) {
+    return 0.0f;
+  }
+  return (PN_stdfloat)misses / (PN_stdfloat)num_faces;
+}
+
 /**
  * Returns the number of bytes consumed by the primitive and its index
  * table(s).
@@ -1570,6 +1962,16 @@ calc_tight_bounds(LPoint3 &min_point, LPoint3 &max_point,
   CDReader cdata(_cycler, current_thread);
   int i = 0;
 
+  // Handle the common case of a native float position column directly.
+  TightBoundsKernel kernel(min_point, max_point, sq_center_dist, found_any,
+                           got_mat, mat);
+  if (run_native_bounds(kernel, reader, cdata->_first_vertex,
+                        cdata->_num_vertices,
+                        cdata->_vertices.get_read_pointer(),
+                        cdata->_index_type, current_thread)) {
+    return;
+  }
+
   if (cdata->_vertices.is_null()) {
     // Nonindexed case.
     nassertv(cdata->_num_vertices != -1);
@@ -1717,6 +2119,25 @@ calc_sphere_radius(const LPoint3 &center, PN_stdfloat &sq_radius,
 
   CDReader cdata(_cycler, current_thread);
 
+  if (cdata->_vertices.is_null()) {
+    nassertv(cdata->_num_vertices != -1);
+    if (cdata->_num_vertices == 0) {
+      return;
+    }
+  } else if (cdata->_vertices.get_read_pointer()->get_num_rows() == 0) {
+    return;
+  }
+
+  // Handle the common case of a native float position column directly.
+  SphereRadiusKernel kernel(center, sq_radius);
+  if (run_native_bounds(kernel, reader, cdata->_first_vertex,
+                        cdata->_num_vertices,
+                        cdata->_vertices.get_read_pointer(),
+                        cdata->_index_type, current_thread)) {
+    found_any = true;
+    return;
+  }
+
   if (cdata->_vertices.is_null()) {
     // Nonindexed case.
     nassertv(cdata->_num_vertices != -1);
@@ -1796,6 +2217,14 @@ reverse_impl() const {
   return this;
 }
 
+/**
+ * The virtual implementation of optimize_vertex_cache().
+ */
+CPT(GeomPrimitive) GeomPrimitive::
+optimize_vertex_cache_impl(int cache_size) const {
+  return this;
+}
+
 /**
  * Should be redefined to return true in any primitive that implements
  * append_unused_vertices().
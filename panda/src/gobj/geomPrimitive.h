@@ -134,6 +134,8 @@ PUBLISHED:
   CPT(GeomPrimitive) make_points() const;
   CPT(GeomPrimitive) make_lines() const;
   CPT(GeomPrimitive) make_patches() const;
+  CPT(GeomPrimitive) optimize_vertex_cache(int cache_size = -1) const;
+  PN_stdfloat calc_acmr(int cache_size = -1) const;
 
   int get_num_bytes() const;
   INLINE int get_data_size_bytes() const;
@@ -233,6 +235,7 @@ protected:
   virtual CPT(GeomVertexArrayData) rotate_impl() const;
   virtual CPT(GeomPrimitive) doubleside_impl() const;
   virtual CPT(GeomPrimitive) reverse_impl() const;
+  virtual CPT(GeomPrimitive) optimize_vertex_cache_impl(int cache_size) const;
   virtual bool requires_unused_vertices() const;
   virtual void append_unused_vertices(GeomVertexArrayData *vertices,
                                       int vertex);
@@ -309,6 +312,7 @@ private:
   static PStatCollector _doubleside_pcollector;
   static PStatCollector _reverse_pcollector;
   static PStatCollector _rotate_pcollector;
+  static PStatCollector _optimize_vertex_cache_pcollector;
 
 public:
   virtual void write_datagram(BamWriter *manager, Datagram &dg);
@@ -251,6 +251,198 @@ rotate_impl() const {
   return new_vertices;
 }
 
+/**
+ * The virtual implementation of optimize_vertex_cache().  This is an
+ * implementation of Tom Forsyth's "Linear-Speed Vertex Cache Optimisation":
+ * each vertex is given a score based on its position in a simulated LRU
+ * cache and on the number of triangles still waiting to use it, and we
+ * greedily emit the highest-scoring triangle that touches the cache.
+ */
+CPT(GeomPrimitive) GeomTriangles::
+optimize_vertex_cache_impl(int cache_size) const {
+  Thread *current_thread = Thread::get_current_thread();
+  GeomPrimitivePipelineReader from(this, current_thread);
+  if (!from.is_indexed()) {
+    // Nonindexed triangles share no vertices, so there is nothing to gain.
+    return this;
+  }
+
+  int num_vertices = from.get_num_vertices();
+  int num_triangles = num_vertices / 3;
+  if (num_triangles <= 1) {
+    return this;
+  }
+  num_vertices = num_triangles * 3;
+
+  from.check_minmax();
+  int num_rows = from.get_max_vertex() + 1;
+
+  pvector<int> indices(num_vertices);
+  for (int i = 0; i < num_vertices; ++i) {
+    indices[i] = from.get_vertex(i);
+  }
+
+  // Build a table of the triangles that use each vertex.  The first
+  // _num_remaining[v] entries of each vertex's list are the triangles that
+  // have not yet been emitted.
+  pvector<int> tri_begin(num_rows + 1, 0);
+  for (int i = 0; i < num_vertices; ++i) {
+    ++tri_begin[indices[i] + 1];
+  }
+  for (int v = 0; v < num_rows; ++v) {
+    tri_begin[v + 1] += tri_begin[v];
+  }
+  pvector<int> num_remaining(num_rows, 0);
+  pvector<int> tri_list(num_vertices);
+  for (int i = 0; i < num_vertices; ++i) {
+    int v = indices[i];
+    tri_list[tri_begin[v] + num_remaining[v]] = i / 3;
+    ++num_remaining[v];
+  }
+
+  pvector<int> cache_pos(num_rows, -1);
+  pvector<float> vertex_score(num_rows);
+  for (int v = 0; v < num_rows; ++v) {
+    vertex_score[v] = calc_vertex_cache_score(-1, num_remaining[v], cache_size);
+  }
+
+  pvector<bool> tri_added(num_triangles, false);
+  int best_tri = 0;
+  float best_score = -1.0f;
+  for (int t = 0; t < num_triangles; ++t) {
+    float score = vertex_score[indices[t * 3]] +
+      vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+    if (score > best_score) {
+      best_score = score;
+      best_tri = t;
+    }
+  }
+
+  PT(GeomVertexArrayData) new_vertices = make_index_data();
+  new_vertices->unclean_set_num_rows(num_vertices);
+  GeomVertexWriter to(new_vertices, 0, current_thread);
+
+  // The cache holds up to cache_size + 3 entries while it is being updated;
+  // anything that falls past cache_size is evicted.
+  pvector<int> cache, new_cache;
+  cache.reserve(cache_size + 3);
+  new_cache.reserve(cache_size + 3);
+  int next_unadded = 0;
+
+  for (int n = 0; n < num_triangles; ++n) {
+    if (best_tri < 0) {
+      // None of the triangles touching the cache is left; start again from
+      // the first triangle that has not been emitted yet.
+      while (tri_added[next_unadded]) {
+        ++next_unadded;
+      }
+      best_tri = next_unadded;
+    }
+
+    tri_added[best_tri] = true;
+    new_cache.clear();
+    for (int k = 0; k < 3; ++k) {
+      int v = indices[best_tri * 3 + k];
+      to.set_data1i(v);
+
+      // Remove this triangle from the vertex's list of remaining triangles.
+      int *begin = &tri_list[tri_begin[v]];
+      int *end = begin + num_remaining[v];
+      int *ti = find(begin, end, best_tri);
+      nassertr(ti != end, this);
+      *ti = *(end - 1);
+      *(end - 1) = best_tri;
+      --num_remaining[v];
+
+      if (find(new_cache.begin(), new_cache.end(), v) == new_cache.end()) {
+        new_cache.push_back(v);
+      }
+    }
+    size_t num_new = new_cache.size();
+    for (size_t ci = 0; ci < cache.size(); ++ci) {
+      int v = cache[ci];
+      if (find(new_cache.begin(), new_cache.begin() + num_new, v) ==
+          new_cache.begin() + num_new) {
+        new_cache.push_back(v);
+      }
+    }
+
+    // Rescore the vertices that were touched, including the evicted ones.
+    for (int ci = 0; ci < (int)new_cache.size(); ++ci) {
+      int v = new_cache[ci];
+      cache_pos[v] = (ci < cache_size) ? ci : -1;
+      vertex_score[v] = calc_vertex_cache_score(cache_pos[v], num_remaining[v],
+                                                cache_size);
+    }
+
+    // Now rescore the triangles that use those vertices, and choose the best
+    // one to emit next.
+    best_tri = -1;
+    best_score = -1.0f;
+    for (size_t ci = 0; ci < new_cache.size(); ++ci) {
+      int v = new_cache[ci];
+      const int *tv = &tri_list[tri_begin[v]];
+      for (int ti = 0; ti < num_remaining[v]; ++ti) {
+        int t = tv[ti];
+        float score = vertex_score[indices[t * 3]] +
+          vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+        if (score > best_score) {
+          best_score = score;
+          best_tri = t;
+        }
+      }
+    }
+
+    if ((int)new_cache.size() > cache_size) {
+      new_cache.resize(cache_size);
+    }
+    cache.swap(new_cache);
+  }
+
+  nassertr(to.is_at_end(), this);
+
+  PT(GeomPrimitive) result = make_copy();
+  result->set_vertices(new_vertices);
+  return result.p();
+}
+
+/**
+ * Returns the score of a vertex for the purposes of
+ * optimize_vertex_cache_impl(), given its position in the simulated cache
+ * (or -1 if it is not in the cache) and the number of triangles that still
+ * need to use it.  The constants are the ones suggested by Forsyth.
+ */
+float GeomTriangles::
+calc_vertex_cache_score(int cache_pos, int num_remaining, int cache_size) {
+  static const float cache_decay_power = 1.5f;
+  static const float last_tri_score = 0.75f;
+  static const float valence_boost_scale = 2.0f;
+  static const float valence_boost_power = 0.5f;
+
+  if (num_remaining == 0) {
+    // No triangle needs this vertex any more.
+    return -1.0f;
+  }
+
+  float score = 0.0f;
+  if (cache_pos >= 0) {
+    if (cache_pos < 3) {
+      // This vertex was used by the triangle we just emitted.  It gets a
+      // fixed score, so that we don't favor strips over other shapes.
+      score = last_tri_score;
+    } else {
+      float scaler = 1.0f / (float)(cache_size - 3);
+      score = cpow(1.0f - (float)(cache_pos - 3) * scaler, cache_decay_power);
+    }
+  }
+
+  // Boost vertices with few remaining triangles, so that we finish off lone
+  // triangles instead of leaving them for later.
+  score += valence_boost_scale *
+    cpow((float)num_remaining, -valence_boost_power);
+  return score;
+}
+
 /**
  * Tells the BamReader how to create objects of type Geom.
  */
@@ -42,6 +42,11 @@ protected:
   virtual CPT(GeomPrimitive) doubleside_impl() const;
   virtual CPT(GeomPrimitive) reverse_impl() const;
   virtual CPT(GeomVertexArrayData) rotate_impl() const;
+  virtual CPT(GeomPrimitive) optimize_vertex_cache_impl(int cache_size) const;
+
+private:
+  static float calc_vertex_cache_score(int cache_pos, int num_remaining,
+                                       int cache_size);
 
 public:
   static void register_with_read_factory();
@@ -330,8 +330,12 @@ pack_columns() {
   Columns::const_iterator ci;
   for (ci = orig_columns.begin(); ci != orig_columns.end(); ++ci) {
     GeomVertexColumn *column = (*ci);
-    add_column(column->get_name(), column->get_num_components(),
-               column->get_numeric_type(), column->get_contents());
+    int index = add_column(column->get_name(), column->get_num_components(),
+                           column->get_numeric_type(), column->get_contents());
+    if (column->has_quantization()) {
+      _columns[index]->set_quantization(column->get_quantize_scale(),
+                                        column->get_quantize_offset());
+    }
   }
 }
 
@@ -354,17 +358,32 @@ align_columns_for_animation() {
   Columns::const_iterator ci;
   for (ci = orig_columns.begin(); ci != orig_columns.end(); ++ci) {
     GeomVertexColumn *column = (*ci);
-    if ((column->get_contents() == C_point ||
-         column->get_contents() == C_vector ||
-         column->get_contents() == C_normal) &&
+    bool is_animated = (column->get_contents() == C_point ||
+                        column->get_contents() == C_vector ||
+                        column->get_contents() == C_normal);
+    if (is_animated &&
         (column->get_numeric_type() == NT_float32 ||
          column->get_numeric_type() == NT_float64) &&
         column->get_num_components() >= 3) {
       add_column(column->get_name(), 4, column->get_numeric_type(), column->get_contents(), -1, 16);
+
+    } else if (is_animated && column->get_num_values() >= 3 &&
+               (column->has_quantization() ||
+                column->get_numeric_type() == NT_float16 ||
+                column->get_numeric_type() == NT_packed_oct)) {
+      // A compressed column can't hold the results of animation: the
+      // animated positions may fall outside of the quantization range, and
+      // the animated normals may not be unit length.  Expand it to floats.
+      add_column(column->get_name(), 4, NT_float32, column->get_contents(), -1, 16);
+
     } else {
-      add_column(column->get_name(), column->get_num_components(),
-                 column->get_numeric_type(), column->get_contents(),
-                 -1, column->get_column_alignment());
+      int index = add_column(column->get_name(), column->get_num_components(),
+                             column->get_numeric_type(), column->get_contents(),
+                             -1, column->get_column_alignment());
+      if (column->has_quantization()) {
+        _columns[index]->set_quantization(column->get_quantize_scale(),
+                                          column->get_quantize_offset());
+      }
     }
   }
 }
@@ -577,9 +596,14 @@ get_format_string(bool pad) const {
     case NT_uint32:
     case NT_packed_dcba:
     case NT_packed_dabc:
+    case NT_packed_oct:
       fmt_code = 'I';
       break;
 
+    case NT_float16:
+      fmt_code = 'e';
+      break;
+
     case NT_float32:
       fmt_code = 'f';
       break;
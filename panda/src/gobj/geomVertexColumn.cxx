@@ -13,6 +13,7 @@
 
 #include "geomVertexColumn.h"
 #include "geomVertexData.h"
+#include "pack_half.h"
 #include "bamReader.h"
 #include "bamWriter.h"
 
@@ -29,6 +30,9 @@ operator = (const GeomVertexColumn &copy) {
   _column_alignment = copy._column_alignment;
   _num_elements = copy._num_elements;
   _element_stride = copy._element_stride;
+  _quantized = copy._quantized;
+  _quantize_scale = copy._quantize_scale;
+  _quantize_offset = copy._quantize_offset;
 
   setup();
 }
@@ -93,6 +97,39 @@ set_column_alignment(int column_alignment) {
   setup();
 }
 
+/**
+ * Marks the column as containing quantized values.  The column must have an
+ * integer numeric type; each stored integer is multiplied by the
+ * corresponding component of scale and added to offset when it is read, and
+ * the reverse transform is applied when a value is written.  This allows, for
+ * instance, vertex positions to be stored as 16-bit integers that span the
+ * bounding box of the Geom.
+ *
+ * This is only legal on an unregistered format (i.e.  when constructing the
+ * format initially).
+ */
+void GeomVertexColumn::
+set_quantization(const LVecBase4 &scale, const LVecBase4 &offset) {
+  nassertv(_numeric_type == NT_uint8 || _numeric_type == NT_uint16 ||
+           _numeric_type == NT_uint32 || _numeric_type == NT_int8 ||
+           _numeric_type == NT_int16 || _numeric_type == NT_int32);
+  _quantized = true;
+  _quantize_scale = scale;
+  _quantize_offset = offset;
+  setup();
+}
+
+/**
+ * Undoes the effect of a previous call to set_quantization(), so that the
+ * integer values are returned unmodified.  This is only legal on an
+ * unregistered format (i.e.  when constructing the format initially).
+ */
+void GeomVertexColumn::
+clear_quantization() {
+  _quantized = false;
+  setup();
+}
+
 /**
  *
  */
@@ -131,12 +168,24 @@ output(ostream &out) const {
     out << "d";
     break;
 
+  case NT_float16:
+    out << "h";
+    break;
+
+  case NT_packed_oct:
+    out << "o";
+    break;
+
   case NT_stdfloat:
   case NT_packed_ufloat:
     out << "?";
     break;
   }
 
+  if (_quantized) {
+    out << "q";
+  }
+
   out << ")";
 
   if (_num_elements > 1) {
@@ -200,6 +249,15 @@ setup() {
     _component_bytes = 4;  // sizeof(uint32_t)
     _num_values *= 3;
     break;
+
+  case NT_float16:
+    _component_bytes = 2;  // sizeof(uint16_t)
+    break;
+
+  case NT_packed_oct:
+    _component_bytes = 4;  // 2 * sizeof(int16_t)
+    _num_values *= 3;
+    break;
   }
 
   if (_num_elements == 0) {
@@ -239,6 +297,26 @@ setup() {
  */
 GeomVertexColumn::Packer *GeomVertexColumn::
 make_packer() const {
+  // The compressed encodings have their own packers, regardless of the
+  // contents.
+  switch (get_numeric_type()) {
+  case NT_float16:
+    return new Packer_float16;
+
+  case NT_packed_oct:
+    if (get_num_components() != 1) {
+      gobj_cat.error()
+        << "GeomVertexColumn with numeric type NT_packed_oct must have 1 component!\n";
+    }
+    return new Packer_packed_oct;
+
+  default:
+    if (_quantized) {
+      return new Packer_quantized;
+    }
+    break;
+  }
+
   switch (get_contents()) {
   case C_point:
   case C_clip_point:
@@ -391,6 +469,21 @@ write_datagram(BamWriter *manager, Datagram &dg) {
   if (manager->get_file_minor_ver() >= 29) {
     dg.add_uint8(_column_alignment);
   }
+
+  if (manager->get_file_minor_ver() >= 43) {
+    dg.add_bool(_quantized);
+    if (_quantized) {
+      _quantize_scale.write_datagram(dg);
+      _quantize_offset.write_datagram(dg);
+    }
+
+  } else if (_quantized || _numeric_type == NT_float16 ||
+             _numeric_type == NT_packed_oct) {
+    gobj_cat.error()
+      << "Column " << *this << " cannot be represented in bam version "
+      << manager->get_file_major_ver() << "."
+      << manager->get_file_minor_ver() << "\n";
+  }
 }
 
 /**
@@ -431,6 +524,15 @@ fillin(DatagramIterator &scan, BamReader *manager) {
     _column_alignment = scan.get_uint8();
   }
 
+  _quantized = false;
+  if (manager->get_file_minor_ver() >= 43) {
+    _quantized = scan.get_bool();
+    if (_quantized) {
+      _quantize_scale.read_datagram(scan);
+      _quantize_offset.read_datagram(scan);
+    }
+  }
+
   _num_elements = 0;
   _element_stride = 0;
 
@@ -4548,3 +4650,426 @@ set_data1i(unsigned char *pointer, int data) {
   *(uint16_t *)pointer = data;
   nassertv(*(uint16_t *)pointer == data);
 }
+
+/**
+ * Decodes the value in the indicated record into the full four components,
+ * filling in the components not stored in the column according to the
+ * column's contents.  If num is less than 4 and the column stores a
+ * homogeneous point, the result is divided by the fourth component.
+ */
+const LVecBase4d &GeomVertexColumn::Packer_decoded::
+get_values(const unsigned char *pointer, int num) {
+  double values[4] = {0.0, 0.0, 0.0, 0.0};
+  Contents contents = _column->get_contents();
+  if (_column->has_homogeneous_coord() || contents == C_clip_point ||
+      contents == C_color) {
+    values[3] = 1.0;
+  }
+
+  decode(pointer, values);
+  _v4d.set(values[0], values[1], values[2], values[3]);
+
+  if (num < 4 && _column->get_num_values() == 4 &&
+      (_column->has_homogeneous_coord() || contents == C_clip_point) &&
+      values[3] != 0.0) {
+    _v4d /= values[3];
+  }
+  return _v4d;
+}
+
+/**
+ * Encodes the first num components of the indicated value into the record,
+ * supplying the remaining components according to the column's contents.
+ */
+void GeomVertexColumn::Packer_decoded::
+set_values(unsigned char *pointer, LVecBase4d values, int num) {
+  Contents contents = _column->get_contents();
+  bool homogeneous = (_column->has_homogeneous_coord() || contents == C_clip_point);
+
+  if (num < 4) {
+    values[3] = (homogeneous || contents == C_color) ? 1.0 : 0.0;
+
+  } else if (homogeneous && _column->get_num_values() < 4 && values[3] != 0.0) {
+    // We are storing a 4-component point into a smaller column; project it
+    // back to 3-d.
+    values /= values[3];
+  }
+
+  double data[4] = { values[0], values[1], values[2], values[3] };
+  encode(pointer, data);
+}
+
+/**
+ *
+ */
+float GeomVertexColumn::Packer_decoded::
+get_data1f(const unsigned char *pointer) {
+  return (float)get_values(pointer, 1)[0];
+}
+
+/**
+ *
+ */
+const LVecBase2f &GeomVertexColumn::Packer_decoded::
+get_data2f(const unsigned char *pointer) {
+  const LVecBase4d &v4 = get_values(pointer, 2);
+  _v2.set(v4[0], v4[1]);
+  return _v2;
+}
+
+/**
+ *
+ */
+const LVecBase3f &GeomVertexColumn::Packer_decoded::
+get_data3f(const unsigned char *pointer) {
+  const LVecBase4d &v4 = get_values(pointer, 3);
+  _v3.set(v4[0], v4[1], v4[2]);
+  return _v3;
+}
+
+/**
+ *
+ */
+const LVecBase4f &GeomVertexColumn::Packer_decoded::
+get_data4f(const unsigned char *pointer) {
+  const LVecBase4d &v4 = get_values(pointer, 4);
+  _v4.set(v4[0], v4[1], v4[2], v4[3]);
+  return _v4;
+}
+
+/**
+ *
+ */
+double GeomVertexColumn::Packer_decoded::
+get_data1d(const unsigned char *pointer) {
+  return get_values(pointer, 1)[0];
+}
+
+/**
+ *
+ */
+const LVecBase2d &GeomVertexColumn::Packer_decoded::
+get_data2d(const unsigned char *pointer) {
+  const LVecBase4d &v4 = get_values(pointer, 2);
+  _v2d.set(v4[0], v4[1]);
+  return _v2d;
+}
+
+/**
+ *
+ */
+const LVecBase3d &GeomVertexColumn::Packer_decoded::
+get_data3d(const unsigned char *pointer) {
+  const LVecBase4d &v4 = get_values(pointer, 3);
+  _v3d.set(v4[0], v4[1], v4[2]);
+  return _v3d;
+}
+
+/**
+ *
+ */
+const LVecBase4d &GeomVertexColumn::Packer_decoded::
+get_data4d(const unsigned char *pointer) {
+  return get_values(pointer, 4);
+}
+
+/**
+ *
+ */
+int GeomVertexColumn::Packer_decoded::
+get_data1i(const unsigned char *pointer) {
+  return (int)get_values(pointer, 1)[0];
+}
+
+/**
+ *
+ */
+const LVecBase2i &GeomVertexColumn::Packer_decoded::
+get_data2i(const unsigned char *pointer) {
+  const LVecBase4d &v4 = get_values(pointer, 2);
+  _v2i.set((int)v4[0], (int)v4[1]);
+  return _v2i;
+}
+
+/**
+ *
+ */
+const LVecBase3i &GeomVertexColumn::Packer_decoded::
+get_data3i(const unsigned char *pointer) {
+  const LVecBase4d &v4 = get_values(pointer, 3);
+  _v3i.set((int)v4[0], (int)v4[1], (int)v4[2]);
+  return _v3i;
+}
+
+/**
+ *
+ */
+const LVecBase4i &GeomVertexColumn::Packer_decoded::
+get_data4i(const unsigned char *pointer) {
+  const LVecBase4d &v4 = get_values(pointer, 4);
+  _v4i.set((int)v4[0], (int)v4[1], (int)v4[2], (int)v4[3]);
+  return _v4i;
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_decoded::
+set_data1f(unsigned char *pointer, float data) {
+  set_values(pointer, LVecBase4d(data, 0.0, 0.0, 0.0), 1);
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_decoded::
+set_data2f(unsigned char *pointer, const LVecBase2f &data) {
+  set_values(pointer, LVecBase4d(data[0], data[1], 0.0, 0.0), 2);
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_decoded::
+set_data3f(unsigned char *pointer, const LVecBase3f &data) {
+  set_values(pointer, LVecBase4d(data[0], data[1], data[2], 0.0), 3);
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_decoded::
+set_data4f(unsigned char *pointer, const LVecBase4f &data) {
+  set_values(pointer, LVecBase4d(data[0], data[1], data[2], data[3]), 4);
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_decoded::
+set_data1d(unsigned char *pointer, double data) {
+  set_values(pointer, LVecBase4d(data, 0.0, 0.0, 0.0), 1);
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_decoded::
+set_data2d(unsigned char *pointer, const LVecBase2d &data) {
+  set_values(pointer, LVecBase4d(data[0], data[1], 0.0, 0.0), 2);
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_decoded::
+set_data3d(unsigned char *pointer, const LVecBase3d &data) {
+  set_values(pointer, LVecBase4d(data[0], data[1], data[2], 0.0), 3);
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_decoded::
+set_data4d(unsigned char *pointer, const LVecBase4d &data) {
+  set_values(pointer, data, 4);
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_decoded::
+set_data1i(unsigned char *pointer, int data) {
+  set_values(pointer, LVecBase4d(data, 0.0, 0.0, 0.0), 1);
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_decoded::
+set_data2i(unsigned char *pointer, const LVecBase2i &data) {
+  set_values(pointer, LVecBase4d(data[0], data[1], 0.0, 0.0), 2);
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_decoded::
+set_data3i(unsigned char *pointer, const LVecBase3i &data) {
+  set_values(pointer, LVecBase4d(data[0], data[1], data[2], 0.0), 3);
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_decoded::
+set_data4i(unsigned char *pointer, const LVecBase4i &data) {
+  set_values(pointer, LVecBase4d(data[0], data[1], data[2], data[3]), 4);
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_float16::
+decode(const unsigned char *pointer, double values[4]) {
+  const uint16_t *pi = (const uint16_t *)pointer;
+  int num_values = min(_column->get_num_values(), 4);
+  for (int i = 0; i < num_values; ++i) {
+    values[i] = unpack_half(pi[i]);
+  }
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_float16::
+encode(unsigned char *pointer, const double values[4]) {
+  uint16_t *pi = (uint16_t *)pointer;
+  int num_values = min(_column->get_num_values(), 4);
+  for (int i = 0; i < num_values; ++i) {
+    pi[i] = pack_half((float)values[i]);
+  }
+}
+
+/**
+ * Decodes a unit vector from its projection onto the octahedron |x| + |y| +
+ * |z| = 1, with the lower hemisphere folded over the upper one, as stored in
+ * two normalized 16-bit integers.
+ */
+void GeomVertexColumn::Packer_packed_oct::
+decode(const unsigned char *pointer, double values[4]) {
+  const int16_t *pi = (const int16_t *)pointer;
+  double x = max(pi[0] / 32767.0, -1.0);
+  double y = max(pi[1] / 32767.0, -1.0);
+  double z = 1.0 - fabs(x) - fabs(y);
+  if (z < 0.0) {
+    double fx = (1.0 - fabs(y)) * (x >= 0.0 ? 1.0 : -1.0);
+    double fy = (1.0 - fabs(x)) * (y >= 0.0 ? 1.0 : -1.0);
+    x = fx;
+    y = fy;
+  }
+
+  double length = csqrt(x * x + y * y + z * z);
+  values[0] = x / length;
+  values[1] = y / length;
+  values[2] = z / length;
+}
+
+/**
+ * Encodes the direction of the indicated vector.  The vector does not need to
+ * be normalized, but its length is not preserved.
+ */
+void GeomVertexColumn::Packer_packed_oct::
+encode(unsigned char *pointer, const double values[4]) {
+  int16_t *pi = (int16_t *)pointer;
+
+  double sum = fabs(values[0]) + fabs(values[1]) + fabs(values[2]);
+  if (sum == 0.0) {
+    // A zero vector can't be represented; store the +Z axis.
+    pi[0] = 0;
+    pi[1] = 0;
+    return;
+  }
+
+  double x = values[0] / sum;
+  double y = values[1] / sum;
+  if (values[2] < 0.0) {
+    double fx = (1.0 - fabs(y)) * (x >= 0.0 ? 1.0 : -1.0);
+    double fy = (1.0 - fabs(x)) * (y >= 0.0 ? 1.0 : -1.0);
+    x = fx;
+    y = fy;
+  }
+
+  pi[0] = (int16_t)floor(max(min(x, 1.0), -1.0) * 32767.0 + 0.5);
+  pi[1] = (int16_t)floor(max(min(y, 1.0), -1.0) * 32767.0 + 0.5);
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_quantized::
+decode(const unsigned char *pointer, double values[4]) {
+  const LVecBase4 &scale = _column->get_quantize_scale();
+  const LVecBase4 &offset = _column->get_quantize_offset();
+  int num_values = min(_column->get_num_values(), 4);
+
+  for (int i = 0; i < num_values; ++i) {
+    double raw = 0.0;
+    switch (_column->get_numeric_type()) {
+    case NT_uint8:
+      raw = ((const uint8_t *)pointer)[i];
+      break;
+
+    case NT_uint16:
+      raw = ((const uint16_t *)pointer)[i];
+      break;
+
+    case NT_uint32:
+      raw = ((const uint32_t *)pointer)[i];
+      break;
+
+    case NT_int8:
+      raw = ((const int8_t *)pointer)[i];
+      break;
+
+    case NT_int16:
+      raw = ((const int16_t *)pointer)[i];
+      break;
+
+    case NT_int32:
+      raw = ((const int32_t *)pointer)[i];
+      break;
+
+    default:
+      nassertv(false);
+    }
+    values[i] = raw * scale[i] + offset[i];
+  }
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_quantized::
+encode(unsigned char *pointer, const double values[4]) {
+  const LVecBase4 &scale = _column->get_quantize_scale();
+  const LVecBase4 &offset = _column->get_quantize_offset();
+  int num_values = min(_column->get_num_values(), 4);
+
+  for (int i = 0; i < num_values; ++i) {
+    double raw = 0.0;
+    if (scale[i] != 0.0f) {
+      raw = floor((values[i] - offset[i]) / scale[i] + 0.5);
+    }
+
+    // Values outside of the representable range are clamped.
+    switch (_column->get_numeric_type()) {
+    case NT_uint8:
+      ((uint8_t *)pointer)[i] = (uint8_t)max(min(raw, 255.0), 0.0);
+      break;
+
+    case NT_uint16:
+      ((uint16_t *)pointer)[i] = (uint16_t)max(min(raw, 65535.0), 0.0);
+      break;
+
+    case NT_uint32:
+      ((uint32_t *)pointer)[i] = (uint32_t)max(min(raw, 4294967295.0), 0.0);
+      break;
+
+    case NT_int8:
+      ((int8_t *)pointer)[i] = (int8_t)max(min(raw, 127.0), -128.0);
+      break;
+
+    case NT_int16:
+      ((int16_t *)pointer)[i] = (int16_t)max(min(raw, 32767.0), -32768.0);
+      break;
+
+    case NT_int32:
+      ((int32_t *)pointer)[i] = (int32_t)max(min(raw, 2147483647.0), -2147483648.0);
+      break;
+
+    default:
+      nassertv(false);
+    }
+  }
+}
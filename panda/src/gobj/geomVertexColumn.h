@@ -69,6 +69,12 @@ PUBLISHED:
   void set_start(int start);
   void set_column_alignment(int column_alignment);
 
+  void set_quantization(const LVecBase4 &scale, const LVecBase4 &offset);
+  void clear_quantization();
+  INLINE bool has_quantization() const;
+  INLINE const LVecBase4 &get_quantize_scale() const;
+  INLINE const LVecBase4 &get_quantize_offset() const;
+
   void output(ostream &out) const;
 
 public:
@@ -103,6 +109,9 @@ private:
   int _element_stride;
   int _component_bytes;
   int _total_bytes;
+  bool _quantized;
+  LVecBase4 _quantize_scale;
+  LVecBase4 _quantize_offset;
   Packer *_packer;
 
   // This nested class provides the implementation for packing and unpacking
@@ -427,6 +436,90 @@ private:
     }
   };
 
+  // This is a specialization on the generic Packer for the compressed
+  // encodings, which can't be operated on directly and must always be
+  // converted to and from a full set of values.  The subclasses need only
+  // define decode() and encode(); the rest is handled here, following the
+  // same rules for the implicit fourth component as Packer_point and
+  // Packer_color.
+  class Packer_decoded : public Packer {
+  public:
+    virtual float get_data1f(const unsigned char *pointer);
+    virtual const LVecBase2f &get_data2f(const unsigned char *pointer);
+    virtual const LVecBase3f &get_data3f(const unsigned char *pointer);
+    virtual const LVecBase4f &get_data4f(const unsigned char *pointer);
+
+    virtual double get_data1d(const unsigned char *pointer);
+    virtual const LVecBase2d &get_data2d(const unsigned char *pointer);
+    virtual const LVecBase3d &get_data3d(const unsigned char *pointer);
+    virtual const LVecBase4d &get_data4d(const unsigned char *pointer);
+
+    virtual int get_data1i(const unsigned char *pointer);
+    virtual const LVecBase2i &get_data2i(const unsigned char *pointer);
+    virtual const LVecBase3i &get_data3i(const unsigned char *pointer);
+    virtual const LVecBase4i &get_data4i(const unsigned char *pointer);
+
+    virtual void set_data1f(unsigned char *pointer, float data);
+    virtual void set_data2f(unsigned char *pointer, const LVecBase2f &data);
+    virtual void set_data3f(unsigned char *pointer, const LVecBase3f &data);
+    virtual void set_data4f(unsigned char *pointer, const LVecBase4f &data);
+
+    virtual void set_data1d(unsigned char *pointer, double data);
+    virtual void set_data2d(unsigned char *pointer, const LVecBase2d &data);
+    virtual void set_data3d(unsigned char *pointer, const LVecBase3d &data);
+    virtual void set_data4d(unsigned char *pointer, const LVecBase4d &data);
+
+    virtual void set_data1i(unsigned char *pointer, int data);
+    virtual void set_data2i(unsigned char *pointer, const LVecBase2i &data);
+    virtual void set_data3i(unsigned char *pointer, const LVecBase3i &data);
+    virtual void set_data4i(unsigned char *pointer, const LVecBase4i &data);
+
+    virtual const char *get_name() const {
+      return "Packer_decoded";
+    }
+
+  protected:
+    virtual void decode(const unsigned char *pointer, double values[4])=0;
+    virtual void encode(unsigned char *pointer, const double values[4])=0;
+
+  private:
+    const LVecBase4d &get_values(const unsigned char *pointer, int num);
+    void set_values(unsigned char *pointer, LVecBase4d values, int num);
+  };
+
+  class Packer_float16 FINAL : public Packer_decoded {
+  public:
+    virtual const char *get_name() const {
+      return "Packer_float16";
+    }
+
+  protected:
+    virtual void decode(const unsigned char *pointer, double values[4]);
+    virtual void encode(unsigned char *pointer, const double values[4]);
+  };
+
+  class Packer_packed_oct FINAL : public Packer_decoded {
+  public:
+    virtual const char *get_name() const {
+      return "Packer_packed_oct";
+    }
+
+  protected:
+    virtual void decode(const unsigned char *pointer, double values[4]);
+    virtual void encode(unsigned char *pointer, const double values[4]);
+  };
+
+  class Packer_quantized FINAL : public Packer_decoded {
+  public:
+    virtual const char *get_name() const {
+      return "Packer_quantized";
+    }
+
+  protected:
+    virtual void decode(const unsigned char *pointer, double values[4]);
+    virtual void encode(unsigned char *pointer, const double values[4]);
+  };
+
   friend class GeomVertexArrayFormat;
   friend class GeomVertexData;
   friend class GeomVertexReader;
@@ -944,6 +944,109 @@ reverse_normals() const {
   return new_data;
 }
 
+/**
+ * Returns a new GeomVertexData that represents the same contents as this one,
+ * but with some of the columns stored in a more compact encoding, according
+ * to the bits set in flags:
+ *
+ * CF_positions stores 3-component vertex positions as 16-bit integers,
+ * quantized to the bounding box of the data.  This is not done for animated
+ * vertices, since they may move outside of that box.
+ *
+ * CF_normals stores normals, tangents and binormals as NT_packed_oct, which
+ * preserves their direction, but not their length.
+ *
+ * CF_texcoords stores texture coordinates as half-precision floats.  This
+ * gives about three significant decimal digits, which is sufficient for
+ * texture coordinates within a few repeats of the unit square.
+ *
+ * The new columns are transparently decoded by GeomVertexReader and encoded
+ * by GeomVertexWriter.  If nothing can be compressed, this returns the
+ * original GeomVertexData object, unchanged.
+ */
+CPT(GeomVertexData) GeomVertexData::
+compress_vertices(int flags) const {
+  const GeomVertexFormat *orig_format = get_format();
+  bool animated = (orig_format->get_animation().get_animation_type() != AT_none ||
+                   get_transform_blend_table() != (TransformBlendTable *)NULL ||
+                   get_slider_table() != (SliderTable *)NULL);
+
+  PT(GeomVertexFormat) new_format = new GeomVertexFormat(*orig_format);
+  bool any_changed = false;
+
+  for (int ai = 0; ai < orig_format->get_num_arrays(); ++ai) {
+    const GeomVertexArrayFormat *orig_array = orig_format->get_array(ai);
+    PT(GeomVertexArrayFormat) new_array = new GeomVertexArrayFormat;
+    new_array->set_divisor(orig_array->get_divisor());
+    bool array_changed = false;
+
+    for (int ci = 0; ci < orig_array->get_num_columns(); ++ci) {
+      const GeomVertexColumn *column = orig_array->get_column(ci);
+      const InternalName *name = column->get_name();
+      int start = new_array->get_total_bytes();
+
+      bool is_float = (column->get_numeric_type() == NT_float32 ||
+                       column->get_numeric_type() == NT_float64) &&
+                      column->get_num_elements() == 1;
+      bool is_direction = (column->get_contents() == C_normal ||
+                           (column->get_contents() == C_vector &&
+                            (name->get_basename() == "tangent" ||
+                             name->get_basename() == "binormal")));
+
+      if ((flags & CF_normals) != 0 && is_float && is_direction &&
+          column->get_num_values() == 3) {
+        new_array->add_column(GeomVertexColumn(name, 1, NT_packed_oct,
+                                               column->get_contents(), start));
+        array_changed = true;
+
+      } else if ((flags & CF_texcoords) != 0 && is_float &&
+                 column->get_contents() == C_texcoord &&
+                 column->get_num_values() <= 3) {
+        new_array->add_column(GeomVertexColumn(name, column->get_num_components(),
+                                               NT_float16, C_texcoord, start));
+        array_changed = true;
+
+      } else if ((flags & CF_positions) != 0 && is_float && !animated &&
+                 column->get_contents() == C_point &&
+                 column->get_num_values() == 3 && get_num_rows() > 0) {
+        // Find the range of the data, so we can spread the 16-bit values
+        // over it.
+        GeomVertexReader reader(this, name);
+        LPoint3 min_point = reader.get_data3();
+        LPoint3 max_point = min_point;
+        while (!reader.is_at_end()) {
+          const LVecBase3 &p = reader.get_data3();
+          min_point.set(min(min_point[0], p[0]), min(min_point[1], p[1]), min(min_point[2], p[2]));
+          max_point.set(max(max_point[0], p[0]), max(max_point[1], p[1]), max(max_point[2], p[2]));
+        }
+        LVecBase3 scale = (max_point - min_point) / 65535.0f;
+
+        GeomVertexColumn new_column(name, 3, NT_uint16, C_point, start);
+        new_column.set_quantization(LVecBase4(scale, 0.0f),
+                                    LVecBase4(min_point, 0.0f));
+        new_array->add_column(new_column);
+        array_changed = true;
+
+      } else {
+        GeomVertexColumn new_column(*column);
+        new_column.set_start(start);
+        new_array->add_column(new_column);
+      }
+    }
+
+    if (array_changed) {
+      new_format->set_array(ai, new_array);
+      any_changed = true;
+    }
+  }
+
+  if (!any_changed) {
+    return this;
+  }
+
+  return convert_to(GeomVertexFormat::register_format(new_format));
+}
+
 /**
  * Returns a GeomVertexData that represents the results of computing the
  * vertex animation on the CPU for this GeomVertexData.
@@ -1054,6 +1157,9 @@ transform_vertices(const LMatrix4 &mat) {
  * Applies the indicated transform matrix to all of the vertices from
  * begin_row up to but not including end_row.  The transform is applied to all
  * "point" and "vector" type columns described in the format.
+ *
+ * Quantized point columns are requantized to the range of the transformed
+ * points.
  */
 void GeomVertexData::
 transform_vertices(const LMatrix4 &mat, int begin_row, int end_row) {
@@ -1062,6 +1168,7 @@ transform_vertices(const LMatrix4 &mat, int begin_row, int end_row) {
     return;
   }
 
+  bool requantize = do_unquantize_points();
   const GeomVertexFormat *format = get_format();
 
   size_t ci;
@@ -1074,12 +1181,19 @@ transform_vertices(const LMatrix4 &mat, int begin_row, int end_row) {
     GeomVertexRewriter data(this, format->get_vector(ci));
     do_transform_vector_column(format, data, mat, begin_row, end_row);
   }
+
+  if (requantize) {
+    set_format(compress_vertices(CF_positions)->get_format());
+  }
 }
 
 /**
  * Applies the indicated transform matrix to all of the vertices mentioned in
  * the sparse array.  The transform is applied to all "point" and "vector"
  * type columns described in the format.
+ *
+ * Quantized point columns are requantized to the range of the transformed
+ * points.
  */
 void GeomVertexData::
 transform_vertices(const LMatrix4 &mat, const SparseArray &rows) {
@@ -1088,6 +1202,7 @@ transform_vertices(const LMatrix4 &mat, const SparseArray &rows) {
     return;
   }
 
+  bool requantize = do_unquantize_points();
   const GeomVertexFormat *format = get_format();
 
   size_t ci;
@@ -1110,6 +1225,10 @@ transform_vertices(const LMatrix4 &mat, const SparseArray &rows) {
       do_transform_vector_column(format, data, mat, begin_row, end_row);
     }
   }
+
+  if (requantize) {
+    set_format(compress_vertices(CF_positions)->get_format());
+  }
 }
 
 /**
@@ -1793,6 +1912,39 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
   }
 }
 
+/**
+ * If any of the point columns are quantized (see compress_vertices()),
+ * changes the format so that they are stored as floats instead, so that they
+ * may be given values outside of their quantization range.  Returns true if
+ * any columns were changed, false otherwise.
+ */
+bool GeomVertexData::
+do_unquantize_points() {
+  const GeomVertexFormat *orig_format = get_format();
+  PT(GeomVertexFormat) new_format;
+
+  for (size_t ci = 0; ci < orig_format->get_num_points(); ci++) {
+    const InternalName *name = orig_format->get_point(ci);
+    int array_index;
+    const GeomVertexColumn *column;
+    if (orig_format->get_array_info(name, array_index, column) &&
+        column->has_quantization()) {
+      if (new_format == (GeomVertexFormat *)NULL) {
+        new_format = new GeomVertexFormat(*orig_format);
+      }
+      // This replaces the existing column of the same name.
+      new_format->modify_array(array_index)->add_column
+        (name, column->get_num_components(), NT_float32, column->get_contents());
+    }
+  }
+
+  if (new_format == (GeomVertexFormat *)NULL) {
+    return false;
+  }
+
+  set_format(GeomVertexFormat::register_format(new_format));
+  return true;
+}
 
 /**
  * Transforms a range of vertices for one particular column, as a point.
@@ -2509,6 +2661,7 @@ set_num_rows(int n) {
     case NT_int8:
     case NT_int16:
     case NT_int32:
+    case NT_packed_oct:
       // Shouldn't have this type in the format.
       nassertr(false, false);
       break;
@@ -2519,6 +2672,16 @@ set_num_rows(int n) {
         pointer += stride;
       }
       break;
+
+    case NT_float16:
+      while (pointer < stop) {
+        uint16_t *pi = (uint16_t *)pointer;
+        for (int i = 0; i < num_values; i++) {
+          pi[i] = 0x3c00;
+        }
+        pointer += stride;
+      }
+      break;
     }
   }
 
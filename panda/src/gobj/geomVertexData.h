@@ -72,6 +72,14 @@ protected:
   virtual PT(CopyOnWriteObject) make_cow_copy();
 
 PUBLISHED:
+  // Flags for compress_vertices().
+  enum CompressFlags {
+    CF_positions  = 0x0001,
+    CF_normals    = 0x0002,
+    CF_texcoords  = 0x0004,
+    CF_all        = 0x0007,
+  };
+
   explicit GeomVertexData(const string &name,
                           const GeomVertexFormat *format,
                           UsageHint usage_hint);
@@ -151,6 +159,7 @@ PUBLISHED:
               NumericType numeric_type, Contents contents) const;
 
   CPT(GeomVertexData) reverse_normals() const;
+  CPT(GeomVertexData) compress_vertices(int flags = CF_all) const;
 
   CPT(GeomVertexData) animate_vertices(bool force, Thread *current_thread) const;
   void clear_animated_vertices();
@@ -335,6 +344,7 @@ private:
 
 private:
   void update_animated_vertices(CData *cdata, Thread *current_thread);
+  bool do_unquantize_points();
   void do_transform_point_column(const GeomVertexFormat *format, GeomVertexRewriter &data,
                                  const LMatrix4 &mat, int begin_row, int end_row);
   void do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &data,
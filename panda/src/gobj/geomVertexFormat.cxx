@@ -186,20 +186,7 @@ get_union_format(const GeomVertexFormat *other) const {
         bool inserted = column_names.insert(column_a->get_name()).second;
         if (inserted) {
           const GeomVertexColumn *column_b = other->get_column(column_a->get_name());
-          if (column_b != (GeomVertexColumn *)NULL &&
-              column_b->get_total_bytes() > column_a->get_total_bytes()) {
-            // Column b is larger.  Keep it.
-            new_array->add_column(column_b->get_name(),
-                                  column_b->get_num_components(),
-                                  column_b->get_numeric_type(),
-                                  column_b->get_contents());
-          } else {
-            // Column a is larger.  Keep it.
-            new_array->add_column(column_a->get_name(),
-                                  column_a->get_num_components(),
-                                  column_a->get_numeric_type(),
-                                  column_a->get_contents());
-          }
+          add_union_column(new_array, column_a, column_b);
         }
       }
     }
@@ -213,20 +200,7 @@ get_union_format(const GeomVertexFormat *other) const {
         bool inserted = column_names.insert(column_a->get_name()).second;
         if (inserted) {
           const GeomVertexColumn *column_b = get_column(column_a->get_name());
-          if (column_b != (GeomVertexColumn *)NULL &&
-              column_b->get_total_bytes() > column_a->get_total_bytes()) {
-            // Column b is larger.  Keep it.
-            new_array->add_column(column_b->get_name(),
-                                  column_b->get_num_components(),
-                                  column_b->get_numeric_type(),
-                                  column_b->get_contents());
-          } else {
-            // Column a is larger.  Keep it.
-            new_array->add_column(column_a->get_name(),
-                                  column_a->get_num_components(),
-                                  column_a->get_numeric_type(),
-                                  column_a->get_contents());
-          }
+          add_union_column(new_array, column_a, column_b);
         }
       }
     }
@@ -240,6 +214,56 @@ get_union_format(const GeomVertexFormat *other) const {
   return GeomVertexFormat::register_format(new_format);
 }
 
+/**
+ * Adds to new_array a column that can hold the values of column_a as well as
+ * those of column_b, which may be NULL.  This is a helper for
+ * get_union_format().
+ */
+void GeomVertexFormat::
+add_union_column(GeomVertexArrayFormat *new_array,
+                 const GeomVertexColumn *column_a,
+                 const GeomVertexColumn *column_b) {
+  if (column_b == (GeomVertexColumn *)NULL ||
+      column_a->is_bytewise_equivalent(*column_b)) {
+    // Only one definition, or both the same.  Keep it, along with its
+    // quantization, if any.
+    int index = new_array->add_column(column_a->get_name(),
+                                      column_a->get_num_components(),
+                                      column_a->get_numeric_type(),
+                                      column_a->get_contents());
+    if (column_a->has_quantization()) {
+      new_array->_columns[index]->set_quantization(column_a->get_quantize_scale(),
+                                                   column_a->get_quantize_offset());
+    }
+
+  } else if (column_a->has_quantization() || column_b->has_quantization() ||
+             column_a->get_numeric_type() == NT_float16 ||
+             column_b->get_numeric_type() == NT_float16 ||
+             column_a->get_numeric_type() == NT_packed_oct ||
+             column_b->get_numeric_type() == NT_packed_oct) {
+    // The two columns are encoded differently, and at least one of them is
+    // compressed, so neither can hold the values of the other.  Fall back to
+    // an uncompressed column that can hold both.
+    new_array->add_column(column_a->get_name(),
+                          max(column_a->get_num_values(),
+                              column_b->get_num_values()),
+                          NT_float32, column_a->get_contents());
+
+  } else if (column_b->get_total_bytes() > column_a->get_total_bytes()) {
+    // Column b is larger.  Keep it.
+    new_array->add_column(column_b->get_name(),
+                          column_b->get_num_components(),
+                          column_b->get_numeric_type(),
+                          column_b->get_contents());
+  } else {
+    // Column a is larger.  Keep it.
+    new_array->add_column(column_a->get_name(),
+                          column_a->get_num_components(),
+                          column_a->get_numeric_type(),
+                          column_a->get_contents());
+  }
+}
+
 /**
  * Returns a modifiable pointer to the indicated array.  This means
  * duplicating it if it is shared or registered.
@@ -181,6 +181,10 @@ private:
   void do_register();
   void do_unregister();
 
+  static void add_union_column(GeomVertexArrayFormat *new_array,
+                               const GeomVertexColumn *column_a,
+                               const GeomVertexColumn *column_b);
+
   bool _is_registered;
 
   GeomVertexAnimationSpec _animation;
@@ -132,3 +132,206 @@ set_array_column(const GeomVertexColumn *column) {
   _packer = column->_packer;
   return set_pointer(_start_row);
 }
+
+/**
+ * Copies num_rows rows of num_values components each, stored as the numeric
+ * type Source, into the array of Dest values.
+ */
+template<class Dest, class Source>
+static void
+copy_rows(Dest *dest, size_t dest_stride, const unsigned char *&pointer,
+          int stride, int num_values, int num_rows) {
+  unsigned char *dest_pointer = (unsigned char *)dest;
+  for (int i = 0; i < num_rows; ++i) {
+    const Source *source = (const Source *)pointer;
+    Dest *d = (Dest *)dest_pointer;
+    for (int c = 0; c < num_values; ++c) {
+      d[c] = (Dest)source[c];
+    }
+    pointer += stride;
+    dest_pointer += dest_stride;
+  }
+}
+
+/**
+ * Copies the rows of the indicated column into the array of Dest values
+ * directly, if it is stored in one of the simple native formats that don't
+ * need any conversion other than a cast.  Returns true on success, or false
+ * if the caller must go through the Packer instead.
+ */
+template<class Dest>
+static bool
+copy_native_rows(Dest *dest, size_t dest_stride, const unsigned char *&pointer,
+                 int stride, const GeomVertexColumn *column, int num_values,
+                 int num_rows) {
+  if (column->get_num_values() != num_values ||
+      column->get_num_elements() != 1 || column->has_quantization()) {
+    return false;
+  }
+
+  switch (column->get_numeric_type()) {
+  case GeomEnums::NT_float32:
+    copy_rows<Dest, PN_float32>(dest, dest_stride, pointer, stride, num_values, num_rows);
+    return true;
+
+  case GeomEnums::NT_float64:
+    copy_rows<Dest, PN_float64>(dest, dest_stride, pointer, stride, num_values, num_rows);
+    return true;
+
+  default:
+    break;
+  }
+
+  if (column->get_contents() == GeomEnums::C_color) {
+    // Integer colors are scaled to the range 0..1.
+    return false;
+  }
+
+  switch (column->get_numeric_type()) {
+  case GeomEnums::NT_uint8:
+    copy_rows<Dest, uint8_t>(dest, dest_stride, pointer, stride, num_values, num_rows);
+    return true;
+
+  case GeomEnums::NT_uint16:
+    copy_rows<Dest, uint16_t>(dest, dest_stride, pointer, stride, num_values, num_rows);
+    return true;
+
+  case GeomEnums::NT_uint32:
+    copy_rows<Dest, uint32_t>(dest, dest_stride, pointer, stride, num_values, num_rows);
+    return true;
+
+  case GeomEnums::NT_int8:
+    copy_rows<Dest, int8_t>(dest, dest_stride, pointer, stride, num_values, num_rows);
+    return true;
+
+  case GeomEnums::NT_int16:
+    copy_rows<Dest, int16_t>(dest, dest_stride, pointer, stride, num_values, num_rows);
+    return true;
+
+  case GeomEnums::NT_int32:
+    copy_rows<Dest, int32_t>(dest, dest_stride, pointer, stride, num_values, num_rows);
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+/**
+ * The implementation of the get_data*_array() family.  Reads up to num_rows
+ * rows into the array at data, which holds values of the indicated numeric
+ * type (NT_float32, NT_float64 or NT_int32) with num_values components each,
+ * spaced data_stride bytes apart.  Returns the number of rows read.
+ *
+ * The common native formats are copied directly in a tight loop; anything
+ * else still goes through the Packer, one row at a time.
+ */
+int GeomVertexReader::
+get_data_array(void *data, size_t data_stride, int num_values,
+               NumericType data_type, int num_rows) {
+  nassertr(has_column(), 0);
+  nassertr(num_rows >= 0, 0);
+
+  // Don't read past the end of the data.
+  int rows_left = 0;
+  if (_pointer < _pointer_end) {
+    rows_left = (int)((_pointer_end - _pointer) + _stride - 1) / _stride;
+  }
+  num_rows = min(num_rows, rows_left);
+  if (num_rows == 0) {
+    return 0;
+  }
+
+  const GeomVertexColumn *column = _packer->_column;
+  unsigned char *dest = (unsigned char *)data;
+
+  switch (data_type) {
+  case NT_float32:
+    if (copy_native_rows((float *)dest, data_stride, _pointer, _stride,
+                         column, num_values, num_rows)) {
+      return num_rows;
+    }
+    if (num_values == 4 && column->is_uint8_rgba()) {
+      // This is the most common color format.
+      for (int i = 0; i < num_rows; ++i) {
+        const uint8_t *source = (const uint8_t *)_pointer;
+        ((LVecBase4f *)dest)->set(source[0] / 255.0f, source[1] / 255.0f,
+                                  source[2] / 255.0f, source[3] / 255.0f);
+        _pointer += _stride;
+        dest += data_stride;
+      }
+      return num_rows;
+    }
+    for (int i = 0; i < num_rows; ++i) {
+      switch (num_values) {
+      case 1:
+        *(float *)dest = _packer->get_data1f(inc_pointer());
+        break;
+      case 2:
+        *(LVecBase2f *)dest = _packer->get_data2f(inc_pointer());
+        break;
+      case 3:
+        *(LVecBase3f *)dest = _packer->get_data3f(inc_pointer());
+        break;
+      case 4:
+        *(LVecBase4f *)dest = _packer->get_data4f(inc_pointer());
+        break;
+      }
+      dest += data_stride;
+    }
+    break;
+
+  case NT_float64:
+    if (copy_native_rows((double *)dest, data_stride, _pointer, _stride,
+                         column, num_values, num_rows)) {
+      return num_rows;
+    }
+    for (int i = 0; i < num_rows; ++i) {
+      switch (num_values) {
+      case 1:
+        *(double *)dest = _packer->get_data1d(inc_pointer());
+        break;
+      case 2:
+        *(LVecBase2d *)dest = _packer->get_data2d(inc_pointer());
+        break;
+      case 3:
+        *(LVecBase3d *)dest = _packer->get_data3d(inc_pointer());
+        break;
+      case 4:
+        *(LVecBase4d *)dest = _packer->get_data4d(inc_pointer());
+        break;
+      }
+      dest += data_stride;
+    }
+    break;
+
+  case NT_int32:
+    if (copy_native_rows((int *)dest, data_stride, _pointer, _stride,
+                         column, num_values, num_rows)) {
+      return num_rows;
+    }
+    for (int i = 0; i < num_rows; ++i) {
+      switch (num_values) {
+      case 1:
+        *(int *)dest = _packer->get_data1i(inc_pointer());
+        break;
+      case 2:
+        *(LVecBase2i *)dest = _packer->get_data2i(inc_pointer());
+        break;
+      case 3:
+        *(LVecBase3i *)dest = _packer->get_data3i(inc_pointer());
+        break;
+      case 4:
+        *(LVecBase4i *)dest = _packer->get_data4i(inc_pointer());
+        break;
+      }
+      dest += data_stride;
+    }
+    break;
+
+  default:
+    nassertr(false, 0);
+  }
+
+  return num_rows;
+}
@@ -119,6 +119,28 @@ PUBLISHED:
   INLINE const LVecBase3i &get_data3i();
   INLINE const LVecBase4i &get_data4i();
 
+public:
+  INLINE int get_data1f_array(float *data, int num_rows);
+  INLINE int get_data2f_array(LVecBase2f *data, int num_rows);
+  INLINE int get_data3f_array(LVecBase3f *data, int num_rows);
+  INLINE int get_data4f_array(LVecBase4f *data, int num_rows);
+
+  INLINE int get_data1d_array(double *data, int num_rows);
+  INLINE int get_data2d_array(LVecBase2d *data, int num_rows);
+  INLINE int get_data3d_array(LVecBase3d *data, int num_rows);
+  INLINE int get_data4d_array(LVecBase4d *data, int num_rows);
+
+  INLINE int get_data1_array(PN_stdfloat *data, int num_rows);
+  INLINE int get_data2_array(LVecBase2 *data, int num_rows);
+  INLINE int get_data3_array(LVecBase3 *data, int num_rows);
+  INLINE int get_data4_array(LVecBase4 *data, int num_rows);
+
+  INLINE int get_data1i_array(int *data, int num_rows);
+  INLINE int get_data2i_array(LVecBase2i *data, int num_rows);
+  INLINE int get_data3i_array(LVecBase3i *data, int num_rows);
+  INLINE int get_data4i_array(LVecBase4i *data, int num_rows);
+
+PUBLISHED:
   void output(ostream &out) const;
 
 protected:
@@ -131,6 +153,9 @@ private:
   INLINE void quick_set_pointer(int row);
   INLINE const unsigned char *inc_pointer();
 
+  int get_data_array(void *data, size_t data_stride, int num_values,
+                     NumericType data_type, int num_rows);
+
   bool set_vertex_column(int array, const GeomVertexColumn *column,
                          const GeomVertexDataPipelineReader *data_reader);
   bool set_array_column(const GeomVertexColumn *column);
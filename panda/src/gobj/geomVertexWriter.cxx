@@ -167,3 +167,220 @@ set_array_column(const GeomVertexColumn *column) {
 
   return true;
 }
+
+/**
+ * Stores num_rows rows of num_values components each from the array of
+ * Source values into the vertex data, as the numeric type Dest.
+ */
+template<class Dest, class Source>
+static void
+store_rows(unsigned char *&pointer, int stride, const Source *data,
+           size_t data_stride, int num_values, int num_rows) {
+  const unsigned char *data_pointer = (const unsigned char *)data;
+  for (int i = 0; i < num_rows; ++i) {
+    const Source *s = (const Source *)data_pointer;
+    Dest *dest = (Dest *)pointer;
+    for (int c = 0; c < num_values; ++c) {
+      dest[c] = (Dest)s[c];
+    }
+    pointer += stride;
+    data_pointer += data_stride;
+  }
+}
+
+/**
+ * Stores the array of Source values into the indicated column directly, if
+ * it is stored in one of the simple native formats that don't need any
+ * conversion other than a cast.  Floating-point values are only stored this
+ * way into floating-point columns, and integer values also into integer
+ * columns that don't hold colors.  Returns true on success, or false if the
+ * caller must go through the Packer instead.
+ */
+template<class Source>
+static bool
+store_native_rows(unsigned char *&pointer, int stride,
+                  const GeomVertexColumn *column, const Source *data,
+                  size_t data_stride, int num_values, int num_rows,
+                  bool is_integer) {
+  if (column->get_num_values() != num_values ||
+      column->get_num_elements() != 1 || column->has_quantization()) {
+    return false;
+  }
+
+  switch (column->get_numeric_type()) {
+  case GeomEnums::NT_float32:
+    store_rows<PN_float32>(pointer, stride, data, data_stride, num_values, num_rows);
+    return true;
+
+  case GeomEnums::NT_float64:
+    store_rows<PN_float64>(pointer, stride, data, data_stride, num_values, num_rows);
+    return true;
+
+  default:
+    break;
+  }
+
+  if (!is_integer || column->get_contents() == GeomEnums::C_color) {
+    return false;
+  }
+
+  switch (column->get_numeric_type()) {
+  case GeomEnums::NT_uint8:
+    store_rows<uint8_t>(pointer, stride, data, data_stride, num_values, num_rows);
+    return true;
+
+  case GeomEnums::NT_uint16:
+    store_rows<uint16_t>(pointer, stride, data, data_stride, num_values, num_rows);
+    return true;
+
+  case GeomEnums::NT_uint32:
+    store_rows<uint32_t>(pointer, stride, data, data_stride, num_values, num_rows);
+    return true;
+
+  case GeomEnums::NT_int8:
+    store_rows<int8_t>(pointer, stride, data, data_stride, num_values, num_rows);
+    return true;
+
+  case GeomEnums::NT_int16:
+    store_rows<int16_t>(pointer, stride, data, data_stride, num_values, num_rows);
+    return true;
+
+  case GeomEnums::NT_int32:
+    store_rows<int32_t>(pointer, stride, data, data_stride, num_values, num_rows);
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+/**
+ * The implementation of the set_data*_array() and add_data*_array() family.
+ * Writes num_rows rows from the array at data, which holds values of the
+ * indicated numeric type (NT_float32, NT_float64 or NT_int32) with
+ * num_values components each, spaced data_stride bytes apart.  Returns the
+ * number of rows written.
+ *
+ * If add is true, the data is first extended, all at once, to hold all of the
+ * rows; otherwise, writing stops at the end of the data.
+ */
+int GeomVertexWriter::
+set_data_array(const void *data, size_t data_stride, int num_values,
+               NumericType data_type, int num_rows, bool add) {
+  nassertr(has_column(), 0);
+  nassertr(num_rows >= 0, 0);
+  if (num_rows == 0) {
+    return 0;
+  }
+
+  int write_row = get_write_row();
+  int rows_left = 0;
+  if (_pointer < _pointer_end) {
+    rows_left = (int)((_pointer_end - _pointer) + _stride - 1) / _stride;
+  }
+
+  if (add && rows_left < num_rows) {
+    // Grow the data once for the whole batch, rather than once per row as
+    // add_data*() would.
+    if (_vertex_data != (GeomVertexData *)NULL) {
+      _handle = NULL;
+      GeomVertexDataPipelineWriter writer(_vertex_data, true, _current_thread);
+      writer.check_array_writers();
+      writer.set_num_rows(max(write_row + num_rows, writer.get_num_rows()));
+      _handle = writer.get_array_writer(_array);
+
+    } else {
+      _handle->set_num_rows(max(write_row + num_rows, _handle->get_num_rows()));
+    }
+
+    set_pointer(write_row);
+    rows_left = num_rows;
+  }
+
+  num_rows = min(num_rows, rows_left);
+  if (num_rows == 0) {
+    return 0;
+  }
+
+  const GeomVertexColumn *column = _packer->_column;
+  const unsigned char *source = (const unsigned char *)data;
+
+  switch (data_type) {
+  case NT_float32:
+    if (store_native_rows(_pointer, _stride, column, (const float *)data,
+                          data_stride, num_values, num_rows, false)) {
+      return num_rows;
+    }
+    for (int i = 0; i < num_rows; ++i) {
+      switch (num_values) {
+      case 1:
+        _packer->set_data1f(inc_pointer(), *(const float *)source);
+        break;
+      case 2:
+        _packer->set_data2f(inc_pointer(), *(const LVecBase2f *)source);
+        break;
+      case 3:
+        _packer->set_data3f(inc_pointer(), *(const LVecBase3f *)source);
+        break;
+      case 4:
+        _packer->set_data4f(inc_pointer(), *(const LVecBase4f *)source);
+        break;
+      }
+      source += data_stride;
+    }
+    break;
+
+  case NT_float64:
+    if (store_native_rows(_pointer, _stride, column, (const double *)data,
+                          data_stride, num_values, num_rows, false)) {
+      return num_rows;
+    }
+    for (int i = 0; i < num_rows; ++i) {
+      switch (num_values) {
+      case 1:
+        _packer->set_data1d(inc_pointer(), *(const double *)source);
+        break;
+      case 2:
+        _packer->set_data2d(inc_pointer(), *(const LVecBase2d *)source);
+        break;
+      case 3:
+        _packer->set_data3d(inc_pointer(), *(const LVecBase3d *)source);
+        break;
+      case 4:
+        _packer->set_data4d(inc_pointer(), *(const LVecBase4d *)source);
+        break;
+      }
+      source += data_stride;
+    }
+    break;
+
+  case NT_int32:
+    if (store_native_rows(_pointer, _stride, column, (const int *)data,
+                          data_stride, num_values, num_rows, true)) {
+      return num_rows;
+    }
+    for (int i = 0; i < num_rows; ++i) {
+      switch (num_values) {
+      case 1:
+        _packer->set_data1i(inc_pointer(), *(const int *)source);
+        break;
+      case 2:
+        _packer->set_data2i(inc_pointer(), *(const LVecBase2i *)source);
+        break;
+      case 3:
+        _packer->set_data3i(inc_pointer(), *(const LVecBase3i *)source);
+        break;
+      case 4:
+        _packer->set_data4i(inc_pointer(), *(const LVecBase4i *)source);
+        break;
+      }
+      source += data_stride;
+    }
+    break;
+
+  default:
+    nassertr(false, 0);
+  }
+
+  return num_rows;
+}
@@ -174,6 +174,48 @@ PUBLISHED:
   INLINE void add_data4i(int a, int b, int c, int d);
   INLINE void add_data4i(const LVecBase4i &data);
 
+public:
+  INLINE int set_data1f_array(const float *data, int num_rows);
+  INLINE int set_data2f_array(const LVecBase2f *data, int num_rows);
+  INLINE int set_data3f_array(const LVecBase3f *data, int num_rows);
+  INLINE int set_data4f_array(const LVecBase4f *data, int num_rows);
+
+  INLINE int set_data1d_array(const double *data, int num_rows);
+  INLINE int set_data2d_array(const LVecBase2d *data, int num_rows);
+  INLINE int set_data3d_array(const LVecBase3d *data, int num_rows);
+  INLINE int set_data4d_array(const LVecBase4d *data, int num_rows);
+
+  INLINE int set_data1_array(const PN_stdfloat *data, int num_rows);
+  INLINE int set_data2_array(const LVecBase2 *data, int num_rows);
+  INLINE int set_data3_array(const LVecBase3 *data, int num_rows);
+  INLINE int set_data4_array(const LVecBase4 *data, int num_rows);
+
+  INLINE int set_data1i_array(const int *data, int num_rows);
+  INLINE int set_data2i_array(const LVecBase2i *data, int num_rows);
+  INLINE int set_data3i_array(const LVecBase3i *data, int num_rows);
+  INLINE int set_data4i_array(const LVecBase4i *data, int num_rows);
+
+  INLINE void add_data1f_array(const float *data, int num_rows);
+  INLINE void add_data2f_array(const LVecBase2f *data, int num_rows);
+  INLINE void add_data3f_array(const LVecBase3f *data, int num_rows);
+  INLINE void add_data4f_array(const LVecBase4f *data, int num_rows);
+
+  INLINE void add_data1d_array(const double *data, int num_rows);
+  INLINE void add_data2d_array(const LVecBase2d *data, int num_rows);
+  INLINE void add_data3d_array(const LVecBase3d *data, int num_rows);
+  INLINE void add_data4d_array(const LVecBase4d *data, int num_rows);
+
+  INLINE void add_data1_array(const PN_stdfloat *data, int num_rows);
+  INLINE void add_data2_array(const LVecBase2 *data, int num_rows);
+  INLINE void add_data3_array(const LVecBase3 *data, int num_rows);
+  INLINE void add_data4_array(const LVecBase4 *data, int num_rows);
+
+  INLINE void add_data1i_array(const int *data, int num_rows);
+  INLINE void add_data2i_array(const LVecBase2i *data, int num_rows);
+  INLINE void add_data3i_array(const LVecBase3i *data, int num_rows);
+  INLINE void add_data4i_array(const LVecBase4i *data, int num_rows);
+
+PUBLISHED:
   void output(ostream &out) const;
 
 protected:
@@ -189,6 +231,9 @@ private:
   INLINE unsigned char *inc_pointer();
   INLINE unsigned char *inc_add_pointer();
 
+  int set_data_array(const void *data, size_t data_stride, int num_values,
+                     NumericType data_type, int num_rows, bool add);
+
   bool set_vertex_column(int array, const GeomVertexColumn *column,
                          GeomVertexDataPipelineWriter *data_writer);
   bool set_array_column(const GeomVertexColumn *column);
@@ -5,8 +5,10 @@
 #include "bufferResidencyTracker.cxx"
 #include "config_gobj.cxx"
 #include "geom.cxx"
+#include "geomArrayPool.cxx"
 #include "geomCacheEntry.cxx"
 #include "geomCacheManager.cxx"
+#include "geomClusters.cxx"
 #include "geomContext.cxx"
 #include "geomEnums.cxx"
 #include "geomLines.cxx"
@@ -26,9 +26,14 @@
 #include "shaderContext.h"
 #include "config_gobj.h"
 #include "throw_event.h"
+#include "pStatTimer.h"
+#include <algorithm>
 
 int PreparedGraphicsObjects::_name_index = 0;
 
+PStatCollector PreparedGraphicsObjects::_upload_queue_pcollector("Draw:Upload queue");
+PStatCollector PreparedGraphicsObjects::_pending_uploads_pcollector("Pending uploads");
+
 /**
  *
  */
@@ -38,6 +43,9 @@ PreparedGraphicsObjects() :
   _name(init_name()),
   _vertex_buffer_cache_size(0),
   _index_buffer_cache_size(0),
+  _upload_budget(upload_budget_per_frame),
+  _upload_bytes(0),
+  _upload_frame(0),
   _texture_residency(_name, "texture"),
   _vbuffer_residency(_name, "vbuffer"),
   _ibuffer_residency(_name, "ibuffer"),
@@ -1277,21 +1285,51 @@ begin_frame(GraphicsStateGuardianBase *gsg, Thread *current_thread) {
   _vbuffer_residency.begin_frame(current_thread);
   _ibuffer_residency.begin_frame(current_thread);
 
+  PStatTimer timer(_upload_queue_pcollector, current_thread);
+
+  // Start a new upload budget, and hand out the first part of it to the
+  // uploads that have been waiting the longest.
+  ++_upload_frame;
+  _upload_bytes = 0;
+  grant_pending_uploads();
+
   // Now prepare all the textures, geoms, and buffers awaiting preparation.
+  // Textures that don't fit within the upload budget remain in the queue for
+  // the next frame, but only if the GSG is allowed to render without them.
+  bool use_budget = (_upload_budget != (size_t)-1 && gsg->get_incomplete_render());
+  EnqueuedTextures deferred_textures;
   EnqueuedTextures::iterator qti;
   for (qti = _enqueued_textures.begin();
        qti != _enqueued_textures.end();
        ++qti) {
     Texture *tex = (*qti);
+    size_t view_bytes = tex->get_expected_ram_image_size();
+    if (use_budget &&
+        !reserve_upload(NULL, view_bytes * tex->get_num_views(), current_thread)) {
+      deferred_textures.insert(tex);
+      continue;
+    }
     for (int view = 0; view < tex->get_num_views(); ++view) {
       TextureContext *tc = tex->prepare_now(view, this, gsg);
       if (tc != (TextureContext *)NULL) {
+        if (use_budget) {
+          // The upload below is forced, so the GSG doesn't consult the
+          // budget for it.  Should it ask anyway later this frame, for
+          // instance because the image wasn't available yet, it has already
+          // been paid for, and mustn't be charged twice.
+          PendingUpload &pending = _pending_uploads[tc];
+          pending._first_frame = _upload_frame;
+          pending._last_frame = _upload_frame;
+          pending._num_bytes = view_bytes;
+          pending._granted = true;
+        }
+
         gsg->update_texture(tc, true);
       }
     }
   }
 
-  _enqueued_textures.clear();
+  _enqueued_textures.swap(deferred_textures);
 
   EnqueuedSamplers::iterator qsmi;
   for (qsmi = _enqueued_samplers.begin();
@@ -1359,6 +1397,61 @@ end_frame(Thread *current_thread) {
   _texture_residency.end_frame(current_thread);
   _vbuffer_residency.end_frame(current_thread);
   _ibuffer_residency.end_frame(current_thread);
+
+  _pending_uploads_pcollector.set_level(_pending_uploads.size());
+}
+
+/**
+ * Called by the GSG before it uploads the indicated number of bytes to a
+ * texture or buffer for the first time, to ask whether that would exceed this
+ * frame's upload budget.  Returns true if the upload may proceed, or false if
+ * it should be postponed; in the latter case, the context is remembered, and
+ * it will be given precedence in a subsequent frame, provided that the GSG
+ * keeps asking for it.
+ *
+ * The context pointer is used only as a key, and is never dereferenced.  It
+ * may be NULL, in which case the request is not remembered if it is denied.
+ */
+bool PreparedGraphicsObjects::
+reserve_upload(const BufferContext *context, size_t num_bytes,
+               Thread *current_thread) {
+  if (_upload_budget == (size_t)-1) {
+    return true;
+  }
+
+  ReMutexHolder holder(_lock, current_thread);
+
+  PendingUploads::iterator pi = _pending_uploads.end();
+  if (context != (const BufferContext *)NULL) {
+    pi = _pending_uploads.find(context);
+    if (pi != _pending_uploads.end() && (*pi).second._granted) {
+      // This one was already paid for at the start of the frame.
+      _pending_uploads.erase(pi);
+      return true;
+    }
+  }
+
+  // We always allow at least one upload per frame, no matter how large, so
+  // that an object larger than the budget will eventually be uploaded.
+  if (_upload_bytes == 0 || _upload_bytes + num_bytes <= _upload_budget) {
+    _upload_bytes += num_bytes;
+    if (pi != _pending_uploads.end()) {
+      _pending_uploads.erase(pi);
+    }
+    return true;
+  }
+
+  if (context != (const BufferContext *)NULL) {
+    if (pi == _pending_uploads.end()) {
+      PendingUpload pending;
+      pending._first_frame = _upload_frame;
+      pending._granted = false;
+      pi = _pending_uploads.insert(PendingUploads::value_type(context, pending)).first;
+    }
+    (*pi).second._last_frame = _upload_frame;
+    (*pi).second._num_bytes = num_bytes;
+  }
+  return false;
 }
 
 /**
@@ -1372,6 +1465,47 @@ init_name() {
   return strm.str();
 }
 
+/**
+ * Called at the start of each frame to assign the new upload budget to the
+ * pending uploads, in order of the number of frames they have been waiting,
+ * and then by size.  Uploads that were not requested again during the
+ * previous frame, presumably because the object went out of view, are
+ * forgotten.  Assumes the lock is held.
+ */
+void PreparedGraphicsObjects::
+grant_pending_uploads() {
+  typedef pvector<pair<pair<int, size_t>, const BufferContext *> > Order;
+  Order order;
+  order.reserve(_pending_uploads.size());
+
+  PendingUploads::iterator pi = _pending_uploads.begin();
+  while (pi != _pending_uploads.end()) {
+    PendingUpload &pending = (*pi).second;
+    if (pending._last_frame < _upload_frame - 1 || pending._granted) {
+      // Either it wasn't asked for during the last frame, or it was granted
+      // a share of the last frame's budget that it didn't use.
+      _pending_uploads.erase(pi++);
+    } else {
+      pending._granted = false;
+      order.push_back(Order::value_type(pair<int, size_t>(pending._first_frame, pending._num_bytes), (*pi).first));
+      ++pi;
+    }
+  }
+
+  sort(order.begin(), order.end());
+
+  Order::const_iterator oi;
+  for (oi = order.begin(); oi != order.end(); ++oi) {
+    size_t num_bytes = (*oi).first.second;
+    if (_upload_bytes != 0 && _upload_bytes + num_bytes > _upload_budget) {
+      break;
+    }
+    _upload_bytes += num_bytes;
+    _pending_uploads[(*oi).second]._granted = true;
+  }
+}
+
+
 /**
  * Called when a vertex or index buffer is no longer officially "prepared".
  * However, we still have the context on the graphics card, and we might be
@@ -26,6 +26,7 @@
 #include "pStatCollector.h"
 #include "pset.h"
 #include "reMutex.h"
+#include "reMutexHolder.h"
 #include "bufferResidencyTracker.h"
 #include "adaptiveLru.h"
 
@@ -64,6 +65,10 @@ PUBLISHED:
   void show_graphics_memory_lru(ostream &out) const;
   void show_residency_trackers(ostream &out) const;
 
+  INLINE void set_upload_budget(size_t budget);
+  INLINE size_t get_upload_budget() const;
+  INLINE int get_num_pending_uploads() const;
+
   INLINE void release_all();
   INLINE int get_num_queued() const;
   INLINE int get_num_prepared() const;
@@ -147,8 +152,12 @@ public:
                    Thread *current_thread);
   void end_frame(Thread *current_thread);
 
+  bool reserve_upload(const BufferContext *context, size_t num_bytes,
+                      Thread *current_thread);
+
 private:
   static string init_name();
+  void grant_pending_uploads();
 
 private:
   typedef phash_set<TextureContext *, pointer_hash> Textures;
@@ -216,6 +225,25 @@ private:
   BufferCacheLRU _index_buffer_cache_lru;
   size_t _index_buffer_cache_size;
 
+  // A context whose first upload was denied by the per-frame upload budget.
+  // The oldest of these are granted a share of the next frame's budget
+  // before anything else.
+  class PendingUpload {
+  public:
+    int _first_frame;
+    int _last_frame;
+    size_t _num_bytes;
+    bool _granted;
+  };
+  typedef pmap<const BufferContext *, PendingUpload> PendingUploads;
+  PendingUploads _pending_uploads;
+  size_t _upload_budget;
+  size_t _upload_bytes;
+  int _upload_frame;
+
+  static PStatCollector _upload_queue_pcollector;
+  static PStatCollector _pending_uploads_pcollector;
+
 public:
   BufferResidencyTracker _texture_residency;
   BufferResidencyTracker _vbuffer_residency;
@@ -32,6 +32,7 @@
 #include "pta_LVecBase3.h"
 #include "pta_LVecBase2.h"
 #include "epvector.h"
+#include "callbackObject.h"
 
 #ifdef HAVE_CG
 // I don't want to include the Cg header file into panda as a whole.  Instead,
@@ -475,6 +476,13 @@ public:
   };
 
 public:
+  // The CPU implementation is called from several threads at once, so it is
+  // not exposed to the scripting language.
+  INLINE void set_cpu_kernel(CallbackObject *kernel);
+  INLINE void clear_cpu_kernel();
+  INLINE bool has_cpu_kernel() const;
+  INLINE CallbackObject *get_cpu_kernel() const;
+
   // These routines help split the shader into sections, for those shader
   // implementations that need to do so.  Don't use them when you use separate
   // shader programs.
@@ -585,6 +593,8 @@ protected:
   unsigned int _compiled_format;
   string _compiled_binary;
 
+  PT(CallbackObject) _cpu_kernel;
+
   static ShaderCaps _default_caps;
   static int _shaders_generated;
 
@@ -60,6 +60,8 @@ ConfigVariableEnum<Texture::QualityLevel> texture_quality_level
           "renderers.  See Texture::set_quality_level()."));
 
 PStatCollector Texture::_texture_read_pcollector("*:Texture:Read");
+PStatCollector Texture::_texture_reload_pcollector("*:Texture:Reload");
+PStatCollector Texture::_texture_evict_pcollector("*:Texture:Evict RAM");
 TypeHandle Texture::_type_handle;
 TypeHandle Texture::CData::_type_handle;
 AutoTextureScale Texture::_textures_power_2 = ATS_unspecified;
@@ -366,7 +368,8 @@ Texture::
 Texture(const string &name) :
   Namable(name),
   _lock(name),
-  _cvar(_lock)
+  _cvar(_lock),
+  _ram_page(this)
 {
   _reloading = false;
 
@@ -383,7 +386,8 @@ Texture(const Texture &copy) :
   Namable(copy),
   _cycler(copy._cycler),
   _lock(copy.get_name()),
-  _cvar(_lock)
+  _cvar(_lock),
+  _ram_page(this)
 {
   _reloading = false;
 }
@@ -1141,6 +1145,34 @@ get_keep_ram_image() const {
   return cdata->_keep_ram_image;
 }
 
+/**
+ * Discards the system-RAM image for the texture, if it can be transparently
+ * reloaded from disk (or from the bam cache) the next time it is needed.
+ * This is what happens automatically to the least-recently-used textures when
+ * texture-ram-budget is exceeded.  Textures that have set_keep_ram_image()
+ * enabled, or that were not loaded from a file, are not affected.
+ *
+ * Returns true if the image was discarded, false otherwise.
+ */
+bool Texture::
+evict_ram_image() {
+  PStatTimer timer(_texture_evict_pcollector);
+  CDWriter cdata(_cycler, false);
+  _ram_page.dequeue_lru();
+
+  if (cdata->_ram_images.empty() || cdata->_keep_ram_image ||
+      !do_can_reload(cdata)) {
+    return false;
+  }
+
+  if (gobj_cat.is_debug()) {
+    gobj_cat.debug()
+      << "Evicting RAM image for texture " << get_name() << "\n";
+  }
+  do_clear_ram_image(cdata);
+  return true;
+}
+
 /**
  * Returns true if there is enough information in this Texture object to write
  * it to the bam cache successfully, false otherwise.  For most textures, this
@@ -3019,6 +3051,7 @@ do_read_one(CData *cdata, const Filename &fullpath, const Filename &alpha_fullpa
 
   PNMImage image;
   PfmFile pfm;
+  PNMReader *direct_reader = NULL;
   PNMReader *image_reader = image.make_reader(fullpath, NULL, false);
   if (image_reader == NULL) {
     gobj_cat.error()
@@ -3107,19 +3140,42 @@ do_read_one(CData *cdata, const Filename &fullpath, const Filename &alpha_fullpa
         << "\n";
     }
 
-    bool success;
-    if (read_floating_point) {
-      success = pfm.read(image_reader);
+    // If the image needs no rescaling, padding or conversion on the way in,
+    // we can have the reader decode it straight into the ram image later,
+    // without ever filling in the PNMImage.
+    int num_channels = image.get_num_channels();
+    int component_width = (image.get_maxval() > 255) ? 2 : 1;
+    int pad_x_size = image.get_x_size();
+    int pad_y_size = image.get_y_size();
+    if (!read_floating_point && alpha_fullpath.empty() &&
+        image_reader->supports_read_ram_image() &&
+        image.get_x_size() == image.get_read_x_size() &&
+        image.get_y_size() == image.get_read_y_size() &&
+        (auto_texture_scale != ATS_pad ||
+         !do_adjust_this_size(cdata, pad_x_size, pad_y_size, fullpath.get_basename(), true)) &&
+        (n != 0 || primary_file_num_channels == 0 ||
+         primary_file_num_channels >= num_channels ||
+         (num_channels == 3 && primary_file_num_channels == 2)) &&
+        ((z == 0 && n == 0 && cdata->_ram_images.size() <= 1) ||
+         (cdata->_num_components == num_channels &&
+          cdata->_component_width == component_width))) {
+      direct_reader = image_reader;
+
     } else {
-      success = image.read(image_reader);
-    }
+      bool success;
+      if (read_floating_point) {
+        success = pfm.read(image_reader);
+      } else {
+        success = image.read(image_reader);
+      }
 
-    if (!success) {
-      gobj_cat.error()
-        << "Texture::read() - couldn't read: " << fullpath << endl;
-      return false;
+      if (!success) {
+        gobj_cat.error()
+          << "Texture::read() - couldn't read: " << fullpath << endl;
+        return false;
+      }
+      Thread::consider_yield();
     }
-    Thread::consider_yield();
   }
 
   PNMImage alpha_image;
@@ -3259,6 +3315,16 @@ do_read_one(CData *cdata, const Filename &fullpath, const Filename &alpha_fullpa
     if (!do_load_one(cdata, pfm, fullpath.get_basename(), z, n, options)) {
       return false;
     }
+  } else if (direct_reader != (PNMReader *)NULL) {
+    bool success = do_load_one_from_reader(cdata, direct_reader, fullpath.get_basename(), z, n, options);
+    delete direct_reader;
+    if (!success) {
+      gobj_cat.error()
+        << "Texture::read() - couldn't read: " << fullpath << endl;
+      return false;
+    }
+
+    do_set_pad_size(cdata, 0, 0, 0);
   } else {
     // Now see if we want to pad the image within a larger power-of-2 image.
     int pad_x_size = 0;
@@ -3360,6 +3426,72 @@ do_load_one(CData *cdata, const PNMImage &pnmimage, const string &name, int z, i
   return true;
 }
 
+/**
+ * Internal method to load a single page or mipmap level directly from the
+ * indicated PNMReader, which has not yet been prepared for reading.  The
+ * image is decoded straight into the ram image, in its final layout, without
+ * going through a PNMImage.  The caller must already have established that
+ * the image needs no rescaling or conversion.  The reader is not deleted.
+ */
+bool Texture::
+do_load_one_from_reader(CData *cdata, PNMReader *reader, const string &name,
+                        int z, int n, const LoaderOptions &options) {
+  reader->prepare_read();
+
+  int x_size = reader->get_x_size();
+  int y_size = reader->get_y_size();
+  int num_channels = reader->get_num_channels();
+  ComponentType component_type = T_unsigned_byte;
+  int component_width = 1;
+  if (reader->get_maxval() > 255) {
+    component_type = T_unsigned_short;
+    component_width = 2;
+  }
+
+  if (cdata->_ram_images.size() <= 1 && n == 0) {
+    // As in do_load_one(), mipmap level 0 determines the image properties.
+    if (!do_reconsider_z_size(cdata, z, options)) {
+      return false;
+    }
+    nassertr(z >= 0 && z < cdata->_z_size * cdata->_num_views, false);
+
+    if (z == 0) {
+      if (!do_reconsider_image_properties(cdata, x_size, y_size,
+                                          num_channels, component_type,
+                                          z, options)) {
+        return false;
+      }
+    }
+
+    do_modify_ram_image(cdata);
+    cdata->_loaded_from_image = true;
+  }
+
+  do_modify_ram_mipmap_image(cdata, n);
+
+  nassertr(x_size == do_get_expected_mipmap_x_size(cdata, n) &&
+           y_size == do_get_expected_mipmap_y_size(cdata, n), false);
+  nassertr(num_channels == cdata->_num_components &&
+           component_width == cdata->_component_width, false);
+
+  size_t page_size = do_get_expected_ram_mipmap_page_size(cdata, n);
+  PTA_uchar &image = cdata->_ram_images[n]._image;
+  nassertr(page_size * (z + 1) <= image.size(), false);
+
+  int num_rows = reader->read_ram_image(&image[page_size * z]);
+  if (num_rows == 0) {
+    return false;
+  }
+  if (num_rows < y_size) {
+    gobj_cat.warning()
+      << name << " is truncated; read only " << num_rows << " of "
+      << y_size << " rows.\n";
+  }
+  Thread::consider_yield();
+
+  return true;
+}
+
 /**
  * Internal method to load a single page or mipmap level.
  */
@@ -3629,8 +3761,6 @@ do_read_dds(CData *cdata, istream &in, const string &filename, bool header_only)
   }
 
   // Determine the function to use to read the DDS image.
-  typedef PTA_uchar (*ReadDDSLevelFunc)(Texture *tex, Texture::CData *cdata,
-                                        const DDSHeader &header, int n, istream &in);
   ReadDDSLevelFunc func = NULL;
 
   Format format = F_rgb;
@@ -3958,29 +4088,29 @@ do_read_dds(CData *cdata, istream &in, const string &filename, bool header_only)
         // all the depth slices for mipmap level 1, and so on.
         for (int n = 0; n < (int)header.num_levels; ++n) {
           int z_size = do_get_expected_mipmap_z_size(cdata, n);
-          pvector<PTA_uchar> pages;
+          PTA_uchar image;
           size_t page_size = 0;
-          int z;
-          for (z = 0; z < z_size; ++z) {
+          for (int z = 0; z < z_size; ++z) {
             PTA_uchar page = func(this, cdata, header, n, in);
             if (page.is_null()) {
               return false;
             }
-            nassertr(page_size == 0 || page_size == page.size(), false);
-            page_size = page.size();
-            pages.push_back(page);
-          }
-          // Now reassemble the pages into one big image.  Because this is a
-          // Microsoft format, the images are stacked in reverse order; re-
-          // reverse them.
-          PTA_uchar image = PTA_uchar::empty_array(page_size * z_size);
-          unsigned char *imagep = (unsigned char *)image.p();
-          for (z = 0; z < z_size; ++z) {
+            if (z == 0) {
+              // Now that we know the page size, allocate the whole level, and
+              // copy each page into place as soon as it has been read, so we
+              // don't have to hold two copies of the level at once.
+              page_size = page.size();
+              image = PTA_uchar::empty_array(page_size * z_size);
+            }
+            nassertr(page_size == page.size(), false);
+
+            // Because this is a Microsoft format, the images are stacked in
+            // reverse order; re-reverse them.
             int fz = z_size - 1 - z;
-            memcpy(imagep + z * page_size, pages[fz].p(), page_size);
+            memcpy(image.p() + fz * page_size, page.p(), page_size);
           }
 
-          do_set_ram_mipmap_image(cdata, n, image, page_size);
+          do_set_ram_mipmap_image(cdata, n, MOVE(image), page_size);
         }
       }
       break;
@@ -3988,41 +4118,13 @@ do_read_dds(CData *cdata, istream &in, const string &filename, bool header_only)
     case TT_cube_map:
       {
         // Cube maps store all the mipmap levels for face 0, then all the
-        // mipmap levels for face 1, and so on.
-        pvector<pvector<PTA_uchar> > pages;
-        pages.reserve(6);
-        int z, n;
-        for (z = 0; z < 6; ++z) {
-          pages.push_back(pvector<PTA_uchar>());
-          pvector<PTA_uchar> &levels = pages.back();
-          levels.reserve(header.num_levels);
-
-          for (n = 0; n < (int)header.num_levels; ++n) {
-            PTA_uchar image = func(this, cdata, header, n, in);
-            if (image.is_null()) {
-              return false;
-            }
-            levels.push_back(image);
-          }
-        }
-
-        // Now, for each level, reassemble the pages into one big image.
-        // Because this is a Microsoft format, the levels are arranged in a
-        // rotated order.
-        static const int level_remap[6] = {
-          0, 1, 5, 4, 2, 3
+        // mipmap levels for face 1, and so on.  Because this is a Microsoft
+        // format, the faces are arranged in a rotated order.
+        static const int face_remap[6] = {
+          0, 1, 4, 5, 3, 2
         };
-        for (n = 0; n < (int)header.num_levels; ++n) {
-          size_t page_size = pages[0][n].size();
-          PTA_uchar image = PTA_uchar::empty_array(page_size * 6);
-          unsigned char *imagep = (unsigned char *)image.p();
-          for (z = 0; z < 6; ++z) {
-            int fz = level_remap[z];
-            nassertr(pages[fz][n].size() == page_size, false);
-            memcpy(imagep + z * page_size, pages[fz][n].p(), page_size);
-          }
-
-          do_set_ram_mipmap_image(cdata, n, image, page_size);
+        if (!do_read_dds_pages(cdata, header, 6, face_remap, func, in)) {
+          return false;
         }
       }
       break;
@@ -4032,34 +4134,8 @@ do_read_dds(CData *cdata, istream &in, const string &filename, bool header_only)
       {
         // Texture arrays store all the mipmap levels for layer 0, then all
         // the mipmap levels for layer 1, and so on.
-        pvector<pvector<PTA_uchar> > pages;
-        pages.reserve(header.depth);
-        int z, n;
-        for (z = 0; z < (int)header.depth; ++z) {
-          pages.push_back(pvector<PTA_uchar>());
-          pvector<PTA_uchar> &levels = pages.back();
-          levels.reserve(header.num_levels);
-
-          for (n = 0; n < (int)header.num_levels; ++n) {
-            PTA_uchar image = func(this, cdata, header, n, in);
-            if (image.is_null()) {
-              return false;
-            }
-            levels.push_back(image);
-          }
-        }
-
-        // Now, for each level, reassemble the pages into one big image.
-        for (n = 0; n < (int)header.num_levels; ++n) {
-          size_t page_size = pages[0][n].size();
-          PTA_uchar image = PTA_uchar::empty_array(page_size * header.depth);
-          unsigned char *imagep = (unsigned char *)image.p();
-          for (z = 0; z < (int)header.depth; ++z) {
-            nassertr(pages[z][n].size() == page_size, false);
-            memcpy(imagep + z * page_size, pages[z][n].p(), page_size);
-          }
-
-          do_set_ram_mipmap_image(cdata, n, image, page_size);
+        if (!do_read_dds_pages(cdata, header, header.depth, NULL, func, in)) {
+          return false;
         }
       }
       break;
@@ -4093,6 +4169,46 @@ do_read_dds(CData *cdata, istream &in, const string &filename, bool header_only)
   return true;
 }
 
+/**
+ * Called by do_read_dds() to read a texture whose pages are stored one after
+ * the other, each with its full chain of mipmap levels.  The pages are copied
+ * into the ram image for each level as soon as they are read, rather than
+ * being collected and reassembled afterwards.  If remap is not NULL, it gives
+ * the ram image page in which to store each file page.
+ *
+ * Assumes the lock is already held.
+ */
+bool Texture::
+do_read_dds_pages(CData *cdata, const DDSHeader &header, int num_pages,
+                  const int *remap, ReadDDSLevelFunc func, istream &in) {
+  int num_levels = (int)header.num_levels;
+  pvector<PTA_uchar> images(num_levels);
+  pvector<size_t> page_sizes(num_levels, 0);
+
+  for (int z = 0; z < num_pages; ++z) {
+    int fz = (remap != NULL) ? remap[z] : z;
+
+    for (int n = 0; n < num_levels; ++n) {
+      PTA_uchar page = func(this, cdata, header, n, in);
+      if (page.is_null()) {
+        return false;
+      }
+      if (z == 0) {
+        // The first page tells us how big each level is.
+        page_sizes[n] = page.size();
+        images[n] = PTA_uchar::empty_array(page_sizes[n] * num_pages);
+      }
+      nassertr(page.size() == page_sizes[n], false);
+      memcpy(images[n].p() + fz * page_sizes[n], page.p(), page_sizes[n]);
+    }
+  }
+
+  for (int n = 0; n < num_levels; ++n) {
+    do_set_ram_mipmap_image(cdata, n, MOVE(images[n]), page_sizes[n]);
+  }
+  return true;
+}
+
 /**
  * Called internally when read() detects a KTX file.  Assumes the lock is
  * already held.
@@ -5236,6 +5352,7 @@ unlocked_ensure_ram_image(bool allow_compression) {
  */
 void Texture::
 do_reload_ram_image(CData *cdata, bool allow_compression) {
+  PStatTimer timer(_texture_reload_pcollector);
   BamCache *cache = BamCache::get_global_ptr();
   PT(BamCacheRecord) record;
 
@@ -7125,6 +7242,7 @@ do_get_ram_image(CData *cdata) {
     return CPTA_uchar(get_class_type());
   }
 
+  do_mark_ram_used(cdata);
   return cdata->_ram_images[0]._image;
 }
 
@@ -7141,6 +7259,7 @@ do_get_uncompressed_ram_image(CData *cdata) {
         gobj_cat.debug()
           << "Uncompressed " << get_name() << "\n";
       }
+      do_mark_ram_used(cdata);
       return cdata->_ram_images[0]._image;
     }
   }
@@ -7155,6 +7274,7 @@ do_get_uncompressed_ram_image(CData *cdata) {
     if (do_uncompress_ram_image(cdata)) {
       gobj_cat.info()
         << "Uncompressed " << get_name() << "\n";
+      do_mark_ram_used(cdata);
       return cdata->_ram_images[0]._image;
     }
   }
@@ -7163,6 +7283,7 @@ do_get_uncompressed_ram_image(CData *cdata) {
     return CPTA_uchar(get_class_type());
   }
 
+  do_mark_ram_used(cdata);
   return cdata->_ram_images[0]._image;
 }
 
@@ -7669,6 +7790,33 @@ do_reload(CData *cdata) {
   return false;
 }
 
+/**
+ * Records that the ram image has just been accessed, which keeps it from
+ * being evicted by the TexturePool's RAM LRU for a while.  Only textures
+ * whose ram image can be reloaded later are tracked; this does nothing if
+ * texture-ram-budget is not set.
+ */
+void Texture::
+do_mark_ram_used(const CData *cdata) {
+  if (texture_ram_budget < 0 || cdata->_keep_ram_image ||
+      !do_can_reload(cdata)) {
+    return;
+  }
+
+  size_t size = 0;
+  RamImages::const_iterator ri;
+  for (ri = cdata->_ram_images.begin(); ri != cdata->_ram_images.end(); ++ri) {
+    size += (*ri)._image.size();
+  }
+
+  if (size == 0) {
+    _ram_page.dequeue_lru();
+  } else {
+    _ram_page.set_lru_size(size);
+    _ram_page.mark_used_lru(TexturePool::get_ram_lru());
+  }
+}
+
 /**
  * Returns true if there is a rawdata image that we have available to write to
  * the bam stream.  For a normal Texture, this is the same thing as
@@ -9016,6 +9164,15 @@ do_filter_2d_mipmap_pages(const CData *cdata,
     --num_color_components;
   }
 
+  // sRGB rows are filtered a whole row at a time, so that the encoding back
+  // to sRGB can be vectorized.  This requires that the alpha channel, if any,
+  // is the last component.
+  pvector<float> srgb_row;
+  if (is_srgb(cdata->_format) && x_size != 1 &&
+      alpha == (cdata->_num_components == 2 || cdata->_num_components == 4)) {
+    srgb_row.resize((size_t)to_x_size * cdata->_num_components);
+  }
+
   int num_pages = cdata->_z_size * cdata->_num_views;
   for (int z = 0; z < num_pages; ++z) {
     // For each level.
@@ -9029,7 +9186,13 @@ do_filter_2d_mipmap_pages(const CData *cdata,
         // For each row.
         nassertv(p == to._image.p() + z * to._page_size + (y / 2) * to_row_size);
         nassertv(q == from._image.p() + z * from._page_size + y * row_size);
-        if (x_size != 1) {
+        if (!srgb_row.empty()) {
+          filter_2d_unsigned_byte_srgb_row(p, q, &srgb_row[0], to_x_size,
+                                           cdata->_num_components, row_size);
+          p += to_row_size;
+          q += row_size;
+
+        } else if (x_size != 1) {
           int x;
           for (x = 0; x < x_size - 1; x += 2) {
             // For each pixel.
@@ -9374,6 +9537,47 @@ filter_2d_unsigned_byte_srgb(unsigned char *&p, const unsigned char *&q,
   ++q;
 }
 
+/**
+ * Averages each 2x2 block of pixels of a pair of rows of an sRGB image into a
+ * single pixel, producing a whole row of the next mipmap level at once.  The
+ * averages are collected in the indicated buffer, which must have room for
+ * to_x_size * num_components floats, and then converted back to sRGB in one
+ * go.  If num_components is 2 or 4, the last component is a linear alpha.
+ */
+void Texture::
+filter_2d_unsigned_byte_srgb_row(unsigned char *p, const unsigned char *q,
+                                 float *buffer, int to_x_size,
+                                 int num_components, size_t row_size) {
+  size_t pixel_size = num_components;
+  int num_color_components = num_components;
+  if (num_components == 2 || num_components == 4) {
+    --num_color_components;
+  }
+
+  float *r = buffer;
+  for (int x = 0; x < to_x_size; ++x) {
+    int c;
+    for (c = 0; c < num_color_components; ++c) {
+      r[c] = (decode_sRGB_float(q[c]) +
+              decode_sRGB_float(q[c + pixel_size]) +
+              decode_sRGB_float(q[c + row_size]) +
+              decode_sRGB_float(q[c + pixel_size + row_size])) * 0.25f;
+    }
+    if (c < num_components) {
+      // Alpha is always linear.
+      unsigned int result = ((unsigned int)q[c] +
+                             (unsigned int)q[c + pixel_size] +
+                             (unsigned int)q[c + row_size] +
+                             (unsigned int)q[c + pixel_size + row_size]) >> 2;
+      r[c] = (float)result * (1.0f / 255.0f);
+    }
+    r += num_components;
+    q += pixel_size * 2;
+  }
+
+  encode_sRGB_uchar(buffer, p, (size_t)to_x_size * num_components, num_components);
+}
+
 /**
  * Averages a 2x2 block of pixel components into a single pixel component, for
  * producing the next mipmap level.  Increments p and q to the next component.
@@ -10393,6 +10597,35 @@ void Texture::CData::
 fillin(DatagramIterator &scan, BamReader *manager) {
 }
 
+/**
+ *
+ */
+Texture::RamPage::
+RamPage(Texture *texture) :
+  AdaptiveLruPage(0),
+  _texture(texture)
+{
+}
+
+/**
+ * Evicts the page from the LRU.  Called internally when the LRU determines
+ * that it is full.  May also be called externally when necessary to
+ * explicitly evict the page.
+ */
+void Texture::RamPage::
+evict_lru() {
+  _texture->evict_ram_image();
+}
+
+/**
+ * Returns the texture, so that the LRU holds a reference to it while it is
+ * being evicted.
+ */
+ReferenceCount *Texture::RamPage::
+get_lru_owner() const {
+  return _texture;
+}
+
 /**
  *
  */
@@ -43,8 +43,10 @@
 #include "colorSpace.h"
 #include "geomEnums.h"
 #include "bamCacheRecord.h"
+#include "adaptiveLru.h"
 
 class PNMImage;
+class PNMReader;
 class PfmFile;
 class TextureContext;
 class FactoryParams;
@@ -455,6 +457,7 @@ PUBLISHED:
   EXTEND void set_ram_image_as(PyObject *image, const string &provided_format);
 #endif
   INLINE void clear_ram_image();
+  bool evict_ram_image();
   INLINE void set_keep_ram_image(bool keep_ram_image);
   virtual bool get_keep_ram_image() const;
   virtual bool is_cacheable() const;
@@ -663,12 +666,19 @@ protected:
   virtual bool do_load_one(CData *cdata,
                            const PfmFile &pfm, const string &name,
                            int z, int n, const LoaderOptions &options);
+  bool do_load_one_from_reader(CData *cdata, PNMReader *reader,
+                               const string &name, int z, int n,
+                               const LoaderOptions &options);
   virtual bool do_load_sub_image(CData *cdata, const PNMImage &image,
                                  int x, int y, int z, int n);
   bool do_read_txo_file(CData *cdata, const Filename &fullpath);
   bool do_read_txo(CData *cdata, istream &in, const string &filename);
   bool do_read_dds_file(CData *cdata, const Filename &fullpath, bool header_only);
   bool do_read_dds(CData *cdata, istream &in, const string &filename, bool header_only);
+  typedef PTA_uchar (*ReadDDSLevelFunc)(Texture *tex, CData *cdata,
+                                        const DDSHeader &header, int n, istream &in);
+  bool do_read_dds_pages(CData *cdata, const DDSHeader &header, int num_pages,
+                         const int *remap, ReadDDSLevelFunc func, istream &in);
   bool do_read_ktx_file(CData *cdata, const Filename &fullpath, bool header_only);
   bool do_read_ktx(CData *cdata, istream &in, const string &filename, bool header_only);
 
@@ -770,6 +780,7 @@ protected:
   void do_set_pad_size(CData *cdata, int x, int y, int z);
   virtual bool do_can_reload(const CData *cdata) const;
   bool do_reload(CData *cdata);
+  void do_mark_ram_used(const CData *cdata);
 
   INLINE AutoTextureScale do_get_auto_texture_scale(const CData *cdata) const;
 
@@ -882,6 +893,11 @@ private:
   static void filter_2d_unsigned_byte_srgb_sse2(unsigned char *&p,
                                                 const unsigned char *&q,
                                                 size_t pixel_size, size_t row_size);
+  static void filter_2d_unsigned_byte_srgb_row(unsigned char *p,
+                                               const unsigned char *q,
+                                               float *buffer, int to_x_size,
+                                               int num_components,
+                                               size_t row_size);
   static void filter_2d_unsigned_short(unsigned char *&p,
                                        const unsigned char *&q,
                                        size_t pixel_size, size_t row_size);
@@ -1044,6 +1060,19 @@ protected:
   typedef pmap<CPT(InternalName), PT(Texture)> RelatedTextures;
   RelatedTextures _related_textures;
 
+  // This records the texture's ram image in TexturePool's RAM budget, so
+  // that it may be evicted again when texture-ram-budget is exceeded.
+  class EXPCL_PANDA_GOBJ RamPage : public AdaptiveLruPage {
+  public:
+    RamPage(Texture *texture);
+    virtual void evict_lru();
+    virtual ReferenceCount *get_lru_owner() const;
+
+  private:
+    Texture *_texture;
+  };
+  RamPage _ram_page;
+
   // The TexturePool finds this useful.
   Filename _texture_pool_key;
 
@@ -1054,6 +1083,8 @@ private:
 
   static AutoTextureScale _textures_power_2;
   static PStatCollector _texture_read_pcollector;
+  static PStatCollector _texture_reload_pcollector;
+  static PStatCollector _texture_evict_pcollector;
 
   // Datagram stuff
 public:
@@ -29,6 +29,7 @@
 #include "dcast.h"
 
 TexturePool *TexturePool::_global_ptr;
+AtomicAdjust::Pointer TexturePool::_ram_lru;
 
 /**
  * Lists the contents of the texture pool to the indicated output stream.  For
@@ -134,6 +135,45 @@ write_texture_types(ostream &out, int indent_level) const {
   }
 }
 
+/**
+ * Returns the LRU that tracks the system-RAM images of textures, when
+ * texture-ram-budget is in effect.  When the total size of the images on
+ * this LRU exceeds the budget, the least-recently-used ones are evicted.
+ */
+AdaptiveLru *TexturePool::
+get_ram_lru() {
+  AdaptiveLru *lru = (AdaptiveLru *)AtomicAdjust::get_ptr(_ram_lru);
+  if (lru == (AdaptiveLru *)NULL) {
+    // Several threads may load textures at once, so the LRU must be created
+    // under the lock.
+    TexturePool *pool = get_global_ptr();
+    MutexHolder holder(pool->_lock);
+    lru = (AdaptiveLru *)AtomicAdjust::get_ptr(_ram_lru);
+    if (lru == (AdaptiveLru *)NULL) {
+      size_t max_size = (size_t)-1;
+      if (texture_ram_budget >= 0) {
+        max_size = (size_t)texture_ram_budget;
+      }
+      lru = new AdaptiveLru("texture-ram", max_size);
+      AtomicAdjust::set_ptr(_ram_lru, lru);
+    }
+  }
+  return lru;
+}
+
+/**
+ * Marks that an epoch has passed in the texture RAM LRU.  Asks the LRU to
+ * consider whether it should evict any ram images.  This is normally called
+ * once per frame by the GraphicsEngine.
+ */
+void TexturePool::
+lru_epoch() {
+  AdaptiveLru *lru = (AdaptiveLru *)AtomicAdjust::get_ptr(_ram_lru);
+  if (lru != (AdaptiveLru *)NULL) {
+    lru->begin_epoch();
+  }
+}
+
 /**
  * Initializes and/or returns the global pointer to the one TexturePool object
  * in the system.
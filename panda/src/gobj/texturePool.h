@@ -23,6 +23,7 @@
 #include "loaderOptions.h"
 #include "pmutex.h"
 #include "pmap.h"
+#include "atomicAdjust.h"
 #include "textureCollection.h"
 
 class TexturePoolFilter;
@@ -82,6 +83,9 @@ PUBLISHED:
 
   static void write(ostream &out);
 
+  static AdaptiveLru *get_ram_lru();
+  static void lru_epoch();
+
 public:
   typedef Texture::MakeTextureFunc MakeTextureFunc;
   void register_texture_type(MakeTextureFunc *func, const string &extensions);
@@ -147,6 +151,7 @@ private:
   void load_filters();
 
   static TexturePool *_global_ptr;
+  static AtomicAdjust::Pointer _ram_lru;  // AdaptiveLru *_ram_lru;
 
   Mutex _lock;
   typedef pmap<Filename, PT(Texture)> Textures;
@@ -116,6 +116,7 @@ VertexDataPage(size_t book_size) :
   _uncompressed_size = 0;
   _ram_class = RC_resident;
   _pending_ram_class = RC_resident;
+  _mapped = false;
 }
 
 /**
@@ -130,7 +131,10 @@ VertexDataPage(VertexDataBook *book, size_t page_size, size_t block_size) :
   _book(book)
 {
   _allocated_size = round_up(page_size);
-  _page_data = alloc_page_data(_allocated_size);
+  _mapped = false;
+  if (!vertex_data_mmap || !map_page_data()) {
+    _page_data = alloc_page_data(_allocated_size);
+  }
   _size = page_size;
 
   _uncompressed_size = _size;
@@ -155,7 +159,13 @@ VertexDataPage::
     }
   }
 
-  if (_page_data != NULL) {
+  if (_mapped) {
+    // The mapping goes away with the save block.
+    _saved_block.clear();
+    _page_data = NULL;
+    _size = 0;
+
+  } else if (_page_data != NULL) {
     free_page_data(_page_data, _allocated_size);
     _size = 0;
   }
@@ -268,7 +278,7 @@ evict_lru() {
 
   switch (_ram_class) {
   case RC_resident:
-    if (_compressed_lru.get_max_size() == 0) {
+    if (_compressed_lru.get_max_size() == 0 || _mapped) {
       request_ram_class(RC_disk);
     } else {
       request_ram_class(RC_compressed);
@@ -301,9 +311,10 @@ VertexDataBlock *VertexDataPage::
 do_alloc(size_t size) {
   VertexDataBlock *block = (VertexDataBlock *)SimpleAllocator::do_alloc(size);
 
-  if (block != (VertexDataBlock *)NULL && _ram_class != RC_disk) {
+  if (block != (VertexDataBlock *)NULL && _ram_class != RC_disk && !_mapped) {
     // When we allocate a new block within a resident page, we have to clear
-    // the disk cache (since we have just invalidated it).
+    // the disk cache (since we have just invalidated it).  This doesn't
+    // apply to a mapped page, whose save block *is* the page data.
     _saved_block.clear();
   }
 
@@ -438,6 +449,13 @@ make_compressed() {
     return;
   }
 
+  if (_mapped) {
+    // A mapped page can't be compressed in place; let the OS page it out
+    // instead.
+    make_disk();
+    return;
+  }
+
   if (_ram_class == RC_disk) {
     do_restore_from_disk();
   }
@@ -563,6 +581,15 @@ make_disk() {
     return;
   }
 
+  if (_mapped) {
+    // There's no need to copy anything; the data already lives in the save
+    // file.  Just let the OS know it may drop the pages from RAM.
+    PStatTimer timer(_vdata_save_pcollector);
+    get_save_file()->flush_mapped_data(_saved_block);
+    set_ram_class(RC_disk);
+    return;
+  }
+
   if (_ram_class == RC_resident || _ram_class == RC_compressed) {
     if (!do_save_to_disk()) {
       // Can't save it to disk for some reason.
@@ -590,6 +617,11 @@ make_disk() {
  */
 bool VertexDataPage::
 do_save_to_disk() {
+  if (_mapped) {
+    // A mapped page is always backed by the save file.
+    return true;
+  }
+
   if (_ram_class == RC_resident || _ram_class == RC_compressed) {
     PStatTimer timer(_vdata_save_pcollector);
 
@@ -625,6 +657,17 @@ do_save_to_disk() {
  */
 void VertexDataPage::
 do_restore_from_disk() {
+  if (_ram_class == RC_disk && _mapped) {
+    // The page is still mapped; we only need to ask the OS to start reading
+    // it back in.  Any pages that haven't arrived by the time they are
+    // touched will be faulted in on demand.
+    PStatTimer timer(_vdata_restore_pcollector);
+    get_save_file()->prefetch_mapped_data(_saved_block);
+    set_lru_size(_size);
+    set_ram_class(RC_resident);
+    return;
+  }
+
   if (_ram_class == RC_disk) {
     nassertv(_saved_block != (VertexDataSaveBlock *)NULL);
     nassertv(_page_data == (unsigned char *)NULL && _size == 0);
@@ -735,6 +778,29 @@ make_save_file() {
                                       vertex_save_file_prefix, max_size);
 }
 
+/**
+ * Attempts to allocate the page data as a mapping of a new block of the save
+ * file, so that it can later be paged out by the OS without copying.  Returns
+ * true on success, or false if the page should be allocated in ordinary
+ * memory instead.  Called only from the constructor.
+ */
+bool VertexDataPage::
+map_page_data() {
+  VertexDataSaveFile *save_file = get_save_file();
+  if (!save_file->is_valid()) {
+    return false;
+  }
+
+  _saved_block = save_file->map_data(_allocated_size);
+  if (_saved_block == (VertexDataSaveBlock *)NULL) {
+    return false;
+  }
+
+  _page_data = _saved_block->get_pointer();
+  _mapped = true;
+  return true;
+}
+
 /**
  * Allocates and returns a freshly-allocated buffer of at least the indicated
  * size for holding vertex data.
@@ -105,6 +105,7 @@ private:
   static void make_save_file();
 
   INLINE size_t round_up(size_t page_size) const;
+  bool map_page_data();
   unsigned char *alloc_page_data(size_t page_size) const;
   void free_page_data(unsigned char *page_data, size_t page_size) const;
 
@@ -159,6 +160,12 @@ private:
   size_t _size, _allocated_size, _uncompressed_size;
   RamClass _ram_class;
   PT(VertexDataSaveBlock) _saved_block;
+
+  // True if _page_data is mapped directly from _saved_block, rather than
+  // allocated in anonymous memory.  Such a page is never compressed, and
+  // remains mapped even while it is in RC_disk.
+  bool _mapped;
+
   size_t _book_size;
   size_t _block_size;
 
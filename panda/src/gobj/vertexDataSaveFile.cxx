@@ -15,10 +15,12 @@
 #include "mutexHolder.h"
 #include "clockObject.h"
 #include "config_gobj.h"
+#include "memoryHook.h"
 
 #ifndef _WIN32
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <errno.h>
 #endif  // _WIN32
@@ -340,6 +342,107 @@ read_data(unsigned char *data, size_t size, VertexDataSaveBlock *block) {
   return true;
 }
 
+/**
+ * Allocates a block of the indicated size on the file, and maps it directly
+ * into memory, so that the data may be read and written in-place through
+ * VertexDataSaveBlock::get_pointer().  The contents of the block are paged in
+ * and out of RAM by the operating system as needed; see flush_mapped_data().
+ *
+ * The block need not begin on a page boundary; if it doesn't, the mapping
+ * begins at the start of the page containing it.  Returns NULL if the block
+ * cannot be mapped, in which case the caller should fall back to allocating
+ * the memory in some other way.  This is currently not supported on Windows.
+ */
+PT(VertexDataSaveBlock) VertexDataSaveFile::
+map_data(size_t size) {
+#ifdef _WIN32
+  return NULL;
+
+#else
+  // The block pointer is declared before the holder, so that if we return
+  // early, the lock is released before the block is freed again.
+  PT(VertexDataSaveBlock) block;
+  MutexHolder holder(_lock);
+
+  if (!_is_valid) {
+    return NULL;
+  }
+
+  block = (VertexDataSaveBlock *)SimpleAllocator::do_alloc(size);
+  if (block == (VertexDataSaveBlock *)NULL) {
+    return NULL;
+  }
+  size_t end = block->get_start() + size;
+  if (end > _total_file_size) {
+    // Extend the file to cover the new block.  This doesn't actually consume
+    // any disk space until the pages are written back.
+    if (ftruncate(_fd, end) < 0) {
+      gobj_cat.error()
+        << "Couldn't extend save file to " << end << " bytes.  Disk full?\n";
+      return NULL;
+    }
+    _total_file_size = end;
+  }
+
+  // mmap() requires the file offset to be a multiple of the page size, so
+  // we map from the start of the page containing the block, and offset the
+  // pointer to the block's data within it.
+  size_t page_size = memory_hook->get_page_size();
+  size_t map_start = block->get_start() - (block->get_start() % page_size);
+  size_t map_size = end - map_start;
+
+  void *ptr = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   _fd, (off_t)map_start);
+  if (ptr == MAP_FAILED) {
+    gobj_cat.error()
+      << "Couldn't map " << size << " bytes of save file.\n";
+    return NULL;
+  }
+
+  block->_map_base = (unsigned char *)ptr;
+  block->_map_size = map_size;
+  block->_pointer = block->_map_base + (block->get_start() - map_start);
+  return block;
+#endif  // _WIN32
+}
+
+/**
+ * Tells the operating system that the indicated block, which must have been
+ * returned by map_data(), is not likely to be needed again soon.  Modified
+ * pages are written back to the file, and the memory may be reclaimed; it
+ * will be transparently paged in again if the data is accessed.
+ */
+void VertexDataSaveFile::
+flush_mapped_data(VertexDataSaveBlock *block) {
+  nassertv(block->get_pointer() != (unsigned char *)NULL);
+
+#ifndef _WIN32
+#ifdef MADV_PAGEOUT
+  // Newer Linux kernels can reclaim the pages immediately.
+  if (madvise(block->_map_base, block->_map_size, MADV_PAGEOUT) == 0) {
+    return;
+  }
+#endif
+  // Otherwise, the pages are dropped from our address space, and remain in
+  // the page cache until the kernel needs the memory.
+  madvise(block->_map_base, block->_map_size, MADV_DONTNEED);
+#endif  // _WIN32
+}
+
+/**
+ * Tells the operating system that the indicated block, which must have been
+ * returned by map_data(), will be needed soon, so that it may begin reading
+ * it back in asynchronously.
+ */
+void VertexDataSaveFile::
+prefetch_mapped_data(VertexDataSaveBlock *block) {
+  nassertv(block->get_pointer() != (unsigned char *)NULL);
+
+#ifndef _WIN32
+  madvise(block->_map_base, block->_map_size, MADV_WILLNEED);
+#endif  // _WIN32
+}
+
 /**
  * Creates a new SimpleAllocatorBlock object.  Override this function to
  * specialize the block type returned.
@@ -348,3 +451,30 @@ SimpleAllocatorBlock *VertexDataSaveFile::
 make_block(size_t start, size_t size) {
   return new VertexDataSaveBlock(this, start, size);
 }
+
+/**
+ * Unmaps the block from memory, if it was mapped.
+ */
+VertexDataSaveBlock::
+~VertexDataSaveBlock() {
+#ifndef _WIN32
+  if (_map_base != (unsigned char *)NULL) {
+#ifdef MADV_REMOVE
+    // Release the disk space as well, since the data is no longer needed.
+    // We may only do this for the pages that lie entirely within this block,
+    // since the pages at either end may be shared with a neighboring block.
+    size_t page_size = memory_hook->get_page_size();
+    size_t begin = (size_t)(_pointer - _map_base);
+    begin = ((begin + page_size - 1) / page_size) * page_size;
+    size_t end = (size_t)(_pointer - _map_base) + get_size();
+    end -= end % page_size;
+    if (end > begin) {
+      madvise(_map_base + begin, end - begin, MADV_REMOVE);
+    }
+#endif
+    munmap(_map_base, _map_size);
+    _map_base = NULL;
+    _pointer = NULL;
+  }
+#endif  // _WIN32
+}
@@ -51,6 +51,10 @@ public:
   bool read_data(unsigned char *data, size_t size,
                  VertexDataSaveBlock *block);
 
+  PT(VertexDataSaveBlock) map_data(size_t size);
+  void flush_mapped_data(VertexDataSaveBlock *block);
+  void prefetch_mapped_data(VertexDataSaveBlock *block);
+
 protected:
   virtual SimpleAllocatorBlock *make_block(size_t start, size_t size);
 
@@ -75,6 +79,9 @@ protected:
   INLINE VertexDataSaveBlock(VertexDataSaveFile *file,
                              size_t start, size_t size);
 
+public:
+  ~VertexDataSaveBlock();
+
 public:
   INLINE void set_compressed(bool compressed);
   INLINE bool get_compressed() const;
@@ -85,6 +92,15 @@ private:
 public:
   INLINE unsigned char *get_pointer() const;
 
+private:
+  // If the block has been mapped into memory by map_data(), this is the
+  // address of the block's data within the mapping.  The mapping itself
+  // begins at _map_base, which is rounded down to a page boundary, and spans
+  // _map_size bytes.
+  unsigned char *_pointer;
+  unsigned char *_map_base;
+  size_t _map_size;
+
   friend class VertexDataSaveFile;
 };
 
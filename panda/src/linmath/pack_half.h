@@ -0,0 +1,27 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file pack_half.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef PACK_HALF_H
+#define PACK_HALF_H
+
+#include "pandabase.h"
+#include "numeric_types.h"
+
+// These convert between 32-bit floats and IEEE 754 half-precision floats,
+// which are used to store vertex columns and images compactly.
+INLINE_LINMATH uint16_t pack_half(float value);
+INLINE_LINMATH float unpack_half(uint16_t data);
+
+#include "pack_half.I"
+
+#endif
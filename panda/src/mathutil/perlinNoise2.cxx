@@ -13,45 +13,257 @@
 
 #include "perlinNoise2.h"
 #include "cmath.h"
+#include "workerPool.h"
+#include "thread.h"
+
+// The number of points that are evaluated together by the batch functions.
+static const int perlin2_batch_size = 64;
+
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+
+/**
+ * Returns a mask with all bits set in each lane for which the corresponding
+ * bit is 1.
+ */
+static INLINE __m128d
+_perlin2_select_mask(int b0, int b1) {
+  return _mm_castsi128_pd(_mm_set_epi32(-b1, -b1, -b0, -b0));
+}
+
+/**
+ * Returns a mask with just the sign bit set in each lane for which the
+ * corresponding bit is 1.
+ */
+static INLINE __m128d
+_perlin2_sign_mask(int b0, int b1) {
+  return _mm_castsi128_pd(_mm_set_epi32((int)((unsigned int)b1 << 31), 0,
+                                        (int)((unsigned int)b0 << 31), 0));
+}
+
+/**
+ * The SSE2 equivalent of PerlinNoise2::grad(), for two points at once.  This
+ * computes exactly the same values, without the branches.
+ */
+static INLINE __m128d
+_perlin2_grad(int h0, int h1, __m128d x, __m128d y) {
+  // The four corners are (+/- x) + (+/- y).
+  __m128d corner = _mm_add_pd(_mm_xor_pd(x, _perlin2_sign_mask((h0 >> 1) & 1, (h1 >> 1) & 1)),
+                              _mm_xor_pd(y, _perlin2_sign_mask(h0 & 1, h1 & 1)));
+
+  // The four edges are 1.707 * (+/- x or y).
+  __m128d use_y = _perlin2_select_mask(h0 & 1, h1 & 1);
+  __m128d edge = _mm_or_pd(_mm_and_pd(use_y, y), _mm_andnot_pd(use_y, x));
+  edge = _mm_xor_pd(edge, _perlin2_sign_mask((h0 >> 1) & 1, (h1 >> 1) & 1));
+  edge = _mm_mul_pd(_mm_set1_pd(1.707), edge);
+
+  __m128d use_edge = _perlin2_select_mask((h0 >> 2) & 1, (h1 >> 2) & 1);
+  return _mm_or_pd(_mm_and_pd(use_edge, edge), _mm_andnot_pd(use_edge, corner));
+}
+
+/**
+ * The SSE2 equivalent of PerlinNoise::fade().
+ */
+static INLINE __m128d
+_perlin2_fade(__m128d t) {
+  __m128d f = _mm_sub_pd(_mm_set1_pd(3.0), _mm_mul_pd(_mm_set1_pd(2.0), t));
+  return _mm_mul_pd(_mm_mul_pd(f, t), t);
+}
+
+/**
+ * The SSE2 equivalent of PerlinNoise::lerp().
+ */
+static INLINE __m128d
+_perlin2_lerp(__m128d t, __m128d a, __m128d b) {
+  return _mm_add_pd(a, _mm_mul_pd(t, _mm_sub_pd(b, a)));
+}
+#endif
 
 /**
  * Returns the noise function of the three inputs.
  */
 double PerlinNoise2::
 noise(const LVecBase2d &value) const {
-  // Convert the vector to our local coordinate space.
-  LVecBase2d vec = _input_xform.xform_point(value);
+  // This goes through the same code as the batch functions, so that they are
+  // guaranteed to compute exactly the same values.
+  double x = value[0];
+  double y = value[1];
+  double result;
+  compute_noise(&result, &x, &y, 1);
+  return result;
+}
 
-  double x = vec[0];
-  double y = vec[1];
+/**
+ * Computes the noise function at each of the count points (x[i], y[i]) and
+ * stores it in result[i].  This is equivalent to calling noise() on each of
+ * the points, and produces exactly the same values, but is much faster.
+ */
+void PerlinNoise2::
+noise(double *result, const double *x, const double *y, size_t count) const {
+  while (count > 0) {
+    int n = (int)min(count, (size_t)perlin2_batch_size);
+    compute_noise(result, x, y, n);
+    result += n;
+    x += n;
+    y += n;
+    count -= n;
+  }
+}
 
-  // Find unit square that contains point.
-  double xf = cfloor(x);
-  double yf = cfloor(y);
+/**
+ * Computes the noise function at each of the count points (x[i], y[i]),
+ * scales it by amp, and adds it to result[i].  This is used to sum up the
+ * levels of a StackedPerlinNoise2.
+ */
+void PerlinNoise2::
+add_noise(double *result, const double *x, const double *y, size_t count,
+          double amp) const {
+  double noise[perlin2_batch_size];
+  while (count > 0) {
+    int n = (int)min(count, (size_t)perlin2_batch_size);
+    compute_noise(noise, x, y, n);
+    for (int i = 0; i < n; ++i) {
+      result[i] += noise[i] * amp;
+    }
+    result += n;
+    x += n;
+    y += n;
+    count -= n;
+  }
+}
 
-  int X = ((int)xf) & _table_size_mask;
-  int Y = ((int)yf) & _table_size_mask;
+// This job computes a range of rows of noise_grid().
+class PerlinNoise2::GridJob : public WorkerPool::Job {
+public:
+  virtual void execute(int begin, int end) {
+    pvector<double> y(_x_size);
+    for (int yi = begin; yi < end; ++yi) {
+      std::fill(y.begin(), y.end(), _y[yi]);
+      _noise->noise(_result + (size_t)yi * _x_size, _x, &y[0], _x_size);
+      Thread::consider_yield();
+    }
+  }
 
-  // Find relative x,y of point in square.
-  x -= xf;
-  y -= yf;
+  const PerlinNoise2 *_noise;
+  double *_result;
+  const double *_x;
+  const double *_y;
+  int _x_size;
+};
 
-  // Compute fade curves for each of x,y.
-  double u = fade(x);
-  double v = fade(y);
+/**
+ * Computes the noise function at each point of the grid formed by the x_size
+ * values of x and the y_size values of y, and stores it in result, which
+ * must have room for x_size * y_size values, one row of x_size values at a
+ * time.  That is, result[yi * x_size + xi] is noise(x[xi], y[yi]).
+ *
+ * The rows are divided among the threads of the WorkerPool.
+ */
+void PerlinNoise2::
+noise_grid(double *result, const double *x, int x_size,
+           const double *y, int y_size) const {
+  if (x_size <= 0 || y_size <= 0) {
+    return;
+  }
 
-  // Hash coordinates of the 4 square corners (A, B, A + 1, and B + 1)
-  int A = _index[X] + Y;
-  int B = _index[X + 1] + Y;
+  GridJob job;
+  job._noise = this;
+  job._result = result;
+  job._x = x;
+  job._y = y;
+  job._x_size = x_size;
 
-  // and add blended results from 4 corners of square.
-  double result =
-    lerp(v, lerp(u, grad(_index[A], x, y),
-                 grad(_index[B], x - 1, y)),
-         lerp(u, grad(_index[A + 1], x, y - 1),
-              grad(_index[B + 1], x - 1, y - 1)));
+  WorkerPool *pool = WorkerPool::get_global_ptr();
+  int grain = max(1, min(y_size / ((pool->get_num_threads() + 1) * 4),
+                         65536 / max(x_size, 1)));
+  pool->run(job, y_size, grain);
+}
 
-  return result;
+/**
+ * Computes the noise function at each of the n points, where n is no more
+ * than the batch size.
+ */
+void PerlinNoise2::
+compute_noise(double *result, const double *x, const double *y, int n) const {
+  // There is room for one more point, in case we need to pad the batch to an
+  // even number of points.
+  double fx[perlin2_batch_size + 1];
+  double fy[perlin2_batch_size + 1];
+  int h00[perlin2_batch_size + 1];
+  int h10[perlin2_batch_size + 1];
+  int h01[perlin2_batch_size + 1];
+  int h11[perlin2_batch_size + 1];
+  nassertv(n <= perlin2_batch_size);
+
+  // First, look up the hashes of the corners of the unit square that contains
+  // each point.  This part can't be vectorized.
+  for (int i = 0; i < n; ++i) {
+    // Convert the vector to our local coordinate space.
+    LVecBase2d vec = _input_xform.xform_point(LVecBase2d(x[i], y[i]));
+
+    // Find unit square that contains point.
+    double xf = cfloor(vec[0]);
+    double yf = cfloor(vec[1]);
+
+    int X = ((int)xf) & _table_size_mask;
+    int Y = ((int)yf) & _table_size_mask;
+
+    // Find relative x,y of point in square.
+    fx[i] = vec[0] - xf;
+    fy[i] = vec[1] - yf;
+
+    // Hash coordinates of the 4 square corners (A, B, A + 1, and B + 1)
+    int A = _index[X] + Y;
+    int B = _index[X + 1] + Y;
+    h00[i] = _index[A];
+    h10[i] = _index[B];
+    h01[i] = _index[A + 1];
+    h11[i] = _index[B + 1];
+  }
+
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+  // Now blend the gradients at the corners, two points at a time.
+  if (n & 1) {
+    fx[n] = 0.0;
+    fy[n] = 0.0;
+    h00[n] = h10[n] = h01[n] = h11[n] = 0;
+  }
+  __m128d one = _mm_set1_pd(1.0);
+  for (int i = 0; i < n; i += 2) {
+    __m128d x0 = _mm_loadu_pd(fx + i);
+    __m128d y0 = _mm_loadu_pd(fy + i);
+    __m128d x1 = _mm_sub_pd(x0, one);
+    __m128d y1 = _mm_sub_pd(y0, one);
+
+    // Compute fade curves for each of x,y.
+    __m128d u = _perlin2_fade(x0);
+    __m128d v = _perlin2_fade(y0);
+
+    // and add blended results from 4 corners of square.
+    __m128d r =
+      _perlin2_lerp(v, _perlin2_lerp(u, _perlin2_grad(h00[i], h00[i + 1], x0, y0),
+                                     _perlin2_grad(h10[i], h10[i + 1], x1, y0)),
+                    _perlin2_lerp(u, _perlin2_grad(h01[i], h01[i + 1], x0, y1),
+                                  _perlin2_grad(h11[i], h11[i + 1], x1, y1)));
+
+    if (i + 1 < n) {
+      _mm_storeu_pd(result + i, r);
+    } else {
+      _mm_store_sd(result + i, r);
+    }
+  }
+
+#else
+  for (int i = 0; i < n; ++i) {
+    double u = fade(fx[i]);
+    double v = fade(fy[i]);
+    result[i] =
+      lerp(v, lerp(u, grad(h00[i], fx[i], fy[i]),
+                   grad(h10[i], fx[i] - 1, fy[i])),
+           lerp(u, grad(h01[i], fx[i], fy[i] - 1),
+                grad(h11[i], fx[i] - 1, fy[i] - 1)));
+  }
+#endif
 }
 
 /**
@@ -44,10 +44,22 @@ PUBLISHED:
   INLINE float operator ()(const LVecBase2f &value) const;
   INLINE double operator ()(const LVecBase2d &value) const;
 
+public:
+  void noise(double *result, const double *x, const double *y,
+             size_t count) const;
+  void add_noise(double *result, const double *x, const double *y,
+                 size_t count, double amp) const;
+  void noise_grid(double *result, const double *x, int x_size,
+                  const double *y, int y_size) const;
+
 private:
+  void compute_noise(double *result, const double *x, const double *y,
+                     int n) const;
   void init_unscaled_xform();
   INLINE static double grad(int hash, double x, double y);
 
+  class GridJob;
+
 private:
   LMatrix3d _unscaled_xform;
   LMatrix3d _input_xform;
@@ -13,61 +13,303 @@
 
 #include "perlinNoise3.h"
 #include "cmath.h"
+#include "workerPool.h"
+#include "thread.h"
+
+// The number of points that are evaluated together by the batch functions.
+static const int perlin3_batch_size = 64;
+
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+
+/**
+ * Returns a mask with all bits set in each lane for which the corresponding
+ * condition is true.
+ */
+static INLINE __m128d
+_perlin3_select_mask(bool b0, bool b1) {
+  return _mm_castsi128_pd(_mm_set_epi32(-(int)b1, -(int)b1, -(int)b0, -(int)b0));
+}
+
+/**
+ * Returns a mask with just the sign bit set in each lane for which the
+ * corresponding bit is 1.
+ */
+static INLINE __m128d
+_perlin3_sign_mask(int b0, int b1) {
+  return _mm_castsi128_pd(_mm_set_epi32((int)((unsigned int)b1 << 31), 0,
+                                        (int)((unsigned int)b0 << 31), 0));
+}
+
+/**
+ * The SSE2 equivalent of PerlinNoise3::grad(), for two points at once.  This
+ * is Perlin's reference formulation, which computes exactly the same values
+ * as the switch statement, without the branches.
+ */
+static INLINE __m128d
+_perlin3_grad(int h0, int h1, __m128d x, __m128d y, __m128d z) {
+  h0 &= 15;
+  h1 &= 15;
+
+  // u = (h < 8) ? x : y
+  __m128d use_x = _perlin3_select_mask(h0 < 8, h1 < 8);
+  __m128d u = _mm_or_pd(_mm_and_pd(use_x, x), _mm_andnot_pd(use_x, y));
+
+  // v = (h < 4) ? y : ((h == 12 || h == 14) ? x : z)
+  __m128d use_y = _perlin3_select_mask(h0 < 4, h1 < 4);
+  use_x = _perlin3_select_mask(h0 == 12 || h0 == 14, h1 == 12 || h1 == 14);
+  __m128d v = _mm_or_pd(_mm_and_pd(use_x, x), _mm_andnot_pd(use_x, z));
+  v = _mm_or_pd(_mm_and_pd(use_y, y), _mm_andnot_pd(use_y, v));
+
+  return _mm_add_pd(_mm_xor_pd(u, _perlin3_sign_mask(h0 & 1, h1 & 1)),
+                    _mm_xor_pd(v, _perlin3_sign_mask((h0 >> 1) & 1, (h1 >> 1) & 1)));
+}
+
+/**
+ * The SSE2 equivalent of PerlinNoise::fade().
+ */
+static INLINE __m128d
+_perlin3_fade(__m128d t) {
+  __m128d f = _mm_sub_pd(_mm_set1_pd(3.0), _mm_mul_pd(_mm_set1_pd(2.0), t));
+  return _mm_mul_pd(_mm_mul_pd(f, t), t);
+}
+
+/**
+ * The SSE2 equivalent of PerlinNoise::lerp().
+ */
+static INLINE __m128d
+_perlin3_lerp(__m128d t, __m128d a, __m128d b) {
+  return _mm_add_pd(a, _mm_mul_pd(t, _mm_sub_pd(b, a)));
+}
+#endif
 
 /**
  * Returns the noise function of the three inputs.
  */
 double PerlinNoise3::
 noise(const LVecBase3d &value) const {
-  // Convert the vector to our local coordinate space.
-  LVecBase3d vec = _input_xform.xform_point(value);
-
-  double x = vec[0];
-  double y = vec[1];
-  double z = vec[2];
-
-  // Find unit cube that contains point.
-  double xf = cfloor(x);
-  double yf = cfloor(y);
-  double zf = cfloor(z);
-
-  int X = ((int)xf) & _table_size_mask;
-  int Y = ((int)yf) & _table_size_mask;
-  int Z = ((int)zf) & _table_size_mask;
-
-  // Find relative x,y,z of point in cube.
-  x -= xf;
-  y -= yf;
-  z -= zf;
-
-  // Compute fade curves for each of x,y,z.
-  double u = fade(x);
-  double v = fade(y);
-  double w = fade(z);
-
-  // Hash coordinates of the 8 cube corners.  The 8 corners correspond to AA,
-  // BA, AB, BB, AA + 1, BA + 1, AB + 1, and BB + 1.
-  int A = _index[X] + Y;
-  int AA = _index[A] + Z;
-  int AB = _index[A + 1] + Z;
-  int B = _index[X + 1] + Y;
-  int BA = _index[B] + Z;
-  int BB = _index[B + 1] + Z;
-
-  // and add blended results from 8 corners of cube.
-  double result =
-    lerp(w, lerp(v, lerp(u, grad(_index[AA], x, y, z),
-                         grad(_index[BA], x - 1, y, z)),
-                 lerp(u, grad(_index[AB], x, y - 1, z),
-                      grad(_index[BB], x - 1, y - 1, z))),
-         lerp(v, lerp(u, grad(_index[AA + 1], x, y, z - 1),
-                      grad(_index[BA + 1], x - 1, y, z - 1)),
-              lerp(u, grad(_index[AB + 1], x, y - 1, z - 1),
-                   grad(_index[BB + 1], x - 1, y - 1, z - 1))));
-
+  // This goes through the same code as the batch functions, so that they are
+  // guaranteed to compute exactly the same values.
+  double x = value[0];
+  double y = value[1];
+  double z = value[2];
+  double result;
+  compute_noise(&result, &x, &y, &z, 1);
   return result;
 }
 
+/**
+ * Computes the noise function at each of the count points (x[i], y[i], z[i])
+ * and stores it in result[i].  This is equivalent to calling noise() on each
+ * of the points, and produces exactly the same values, but is much faster.
+ */
+void PerlinNoise3::
+noise(double *result, const double *x, const double *y, const double *z,
+      size_t count) const {
+  while (count > 0) {
+    int n = (int)min(count, (size_t)perlin3_batch_size);
+    compute_noise(result, x, y, z, n);
+    result += n;
+    x += n;
+    y += n;
+    z += n;
+    count -= n;
+  }
+}
+
+/**
+ * Computes the noise function at each of the count points (x[i], y[i], z[i]),
+ * scales it by amp, and adds it to result[i].  This is used to sum up the
+ * levels of a StackedPerlinNoise3.
+ */
+void PerlinNoise3::
+add_noise(double *result, const double *x, const double *y, const double *z,
+          size_t count, double amp) const {
+  double noise[perlin3_batch_size];
+  while (count > 0) {
+    int n = (int)min(count, (size_t)perlin3_batch_size);
+    compute_noise(noise, x, y, z, n);
+    for (int i = 0; i < n; ++i) {
+      result[i] += noise[i] * amp;
+    }
+    result += n;
+    x += n;
+    y += n;
+    z += n;
+    count -= n;
+  }
+}
+
+// This job computes a range of rows of noise_grid().  Each row is one value
+// of y and z.
+class PerlinNoise3::GridJob : public WorkerPool::Job {
+public:
+  virtual void execute(int begin, int end) {
+    pvector<double> y(_x_size);
+    pvector<double> z(_x_size);
+    for (int ri = begin; ri < end; ++ri) {
+      std::fill(y.begin(), y.end(), _y[ri % _y_size]);
+      std::fill(z.begin(), z.end(), _z[ri / _y_size]);
+      _noise->noise(_result + (size_t)ri * _x_size, _x, &y[0], &z[0], _x_size);
+      Thread::consider_yield();
+    }
+  }
+
+  const PerlinNoise3 *_noise;
+  double *_result;
+  const double *_x;
+  const double *_y;
+  const double *_z;
+  int _x_size;
+  int _y_size;
+};
+
+/**
+ * Computes the noise function at each point of the grid formed by the x_size
+ * values of x, the y_size values of y and the z_size values of z, and stores
+ * it in result, which must have room for x_size * y_size * z_size values.
+ * That is, result[(zi * y_size + yi) * x_size + xi] is noise(x[xi], y[yi],
+ * z[zi]).
+ *
+ * The rows are divided among the threads of the WorkerPool.
+ */
+void PerlinNoise3::
+noise_grid(double *result, const double *x, int x_size,
+           const double *y, int y_size, const double *z, int z_size) const {
+  if (x_size <= 0 || y_size <= 0 || z_size <= 0) {
+    return;
+  }
+
+  GridJob job;
+  job._noise = this;
+  job._result = result;
+  job._x = x;
+  job._y = y;
+  job._z = z;
+  job._x_size = x_size;
+  job._y_size = y_size;
+
+  int num_rows = y_size * z_size;
+  WorkerPool *pool = WorkerPool::get_global_ptr();
+  int grain = max(1, min(num_rows / ((pool->get_num_threads() + 1) * 4),
+                         65536 / max(x_size, 1)));
+  pool->run(job, num_rows, grain);
+}
+
+/**
+ * Computes the noise function at each of the n points, where n is no more
+ * than the batch size.
+ */
+void PerlinNoise3::
+compute_noise(double *result, const double *x, const double *y,
+              const double *z, int n) const {
+  // There is room for one more point, in case we need to pad the batch to an
+  // even number of points.
+  double fx[perlin3_batch_size + 1];
+  double fy[perlin3_batch_size + 1];
+  double fz[perlin3_batch_size + 1];
+  int hash[8][perlin3_batch_size + 1];
+  nassertv(n <= perlin3_batch_size);
+
+  // First, look up the hashes of the corners of the unit cube that contains
+  // each point.  This part can't be vectorized.
+  for (int i = 0; i < n; ++i) {
+    // Convert the vector to our local coordinate space.
+    LVecBase3d vec = _input_xform.xform_point(LVecBase3d(x[i], y[i], z[i]));
+
+    // Find unit cube that contains point.
+    double xf = cfloor(vec[0]);
+    double yf = cfloor(vec[1]);
+    double zf = cfloor(vec[2]);
+
+    int X = ((int)xf) & _table_size_mask;
+    int Y = ((int)yf) & _table_size_mask;
+    int Z = ((int)zf) & _table_size_mask;
+
+    // Find relative x,y,z of point in cube.
+    fx[i] = vec[0] - xf;
+    fy[i] = vec[1] - yf;
+    fz[i] = vec[2] - zf;
+
+    // Hash coordinates of the 8 cube corners.  The 8 corners correspond to
+    // AA, BA, AB, BB, AA + 1, BA + 1, AB + 1, and BB + 1.
+    int A = _index[X] + Y;
+    int AA = _index[A] + Z;
+    int AB = _index[A + 1] + Z;
+    int B = _index[X + 1] + Y;
+    int BA = _index[B] + Z;
+    int BB = _index[B + 1] + Z;
+    hash[0][i] = _index[AA];
+    hash[1][i] = _index[BA];
+    hash[2][i] = _index[AB];
+    hash[3][i] = _index[BB];
+    hash[4][i] = _index[AA + 1];
+    hash[5][i] = _index[BA + 1];
+    hash[6][i] = _index[AB + 1];
+    hash[7][i] = _index[BB + 1];
+  }
+
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+  // Now blend the gradients at the corners, two points at a time.
+  if (n & 1) {
+    fx[n] = 0.0;
+    fy[n] = 0.0;
+    fz[n] = 0.0;
+    for (int c = 0; c < 8; ++c) {
+      hash[c][n] = 0;
+    }
+  }
+  __m128d one = _mm_set1_pd(1.0);
+  for (int i = 0; i < n; i += 2) {
+    __m128d x0 = _mm_loadu_pd(fx + i);
+    __m128d y0 = _mm_loadu_pd(fy + i);
+    __m128d z0 = _mm_loadu_pd(fz + i);
+    __m128d x1 = _mm_sub_pd(x0, one);
+    __m128d y1 = _mm_sub_pd(y0, one);
+    __m128d z1 = _mm_sub_pd(z0, one);
+
+    // Compute fade curves for each of x,y,z.
+    __m128d u = _perlin3_fade(x0);
+    __m128d v = _perlin3_fade(y0);
+    __m128d w = _perlin3_fade(z0);
+
+    // and add blended results from 8 corners of cube.
+    __m128d r =
+      _perlin3_lerp(w, _perlin3_lerp(v, _perlin3_lerp(u, _perlin3_grad(hash[0][i], hash[0][i + 1], x0, y0, z0),
+                                                      _perlin3_grad(hash[1][i], hash[1][i + 1], x1, y0, z0)),
+                                     _perlin3_lerp(u, _perlin3_grad(hash[2][i], hash[2][i + 1], x0, y1, z0),
+                                                   _perlin3_grad(hash[3][i], hash[3][i + 1], x1, y1, z0))),
+                    _perlin3_lerp(v, _perlin3_lerp(u, _perlin3_grad(hash[4][i], hash[4][i + 1], x0, y0, z1),
+                                                   _perlin3_grad(hash[5][i], hash[5][i + 1], x1, y0, z1)),
+                                  _perlin3_lerp(u, _perlin3_grad(hash[6][i], hash[6][i + 1], x0, y1, z1),
+                                                _perlin3_grad(hash[7][i], hash[7][i + 1], x1, y1, z1))));
+
+    if (i + 1 < n) {
+      _mm_storeu_pd(result + i, r);
+    } else {
+      _mm_store_sd(result + i, r);
+    }
+  }
+
+#else
+  for (int i = 0; i < n; ++i) {
+    double x0 = fx[i], y0 = fy[i], z0 = fz[i];
+    double u = fade(x0);
+    double v = fade(y0);
+    double w = fade(z0);
+    result[i] =
+      lerp(w, lerp(v, lerp(u, grad(hash[0][i], x0, y0, z0),
+                           grad(hash[1][i], x0 - 1, y0, z0)),
+                   lerp(u, grad(hash[2][i], x0, y0 - 1, z0),
+                        grad(hash[3][i], x0 - 1, y0 - 1, z0))),
+           lerp(v, lerp(u, grad(hash[4][i], x0, y0, z0 - 1),
+                        grad(hash[5][i], x0 - 1, y0, z0 - 1)),
+                lerp(u, grad(hash[6][i], x0, y0 - 1, z0 - 1),
+                     grad(hash[7][i], x0 - 1, y0 - 1, z0 - 1))));
+  }
+#endif
+}
+
 /**
  * Come up with a random rotation to apply to the input coordinates.  This
  * will reduce the problem of the singularities on the axes, by sending the
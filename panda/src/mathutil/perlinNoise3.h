@@ -43,10 +43,23 @@ PUBLISHED:
   INLINE float operator ()(const LVecBase3f &value) const;
   INLINE double operator ()(const LVecBase3d &value) const;
 
+public:
+  void noise(double *result, const double *x, const double *y,
+             const double *z, size_t count) const;
+  void add_noise(double *result, const double *x, const double *y,
+                 const double *z, size_t count, double amp) const;
+  void noise_grid(double *result, const double *x, int x_size,
+                  const double *y, int y_size,
+                  const double *z, int z_size) const;
+
 private:
+  void compute_noise(double *result, const double *x, const double *y,
+                     const double *z, int n) const;
   void init_unscaled_xform();
   INLINE static double grad(int hash, double x, double y, double z);
 
+  class GridJob;
+
 private:
   LMatrix4d _unscaled_xform;
   LMatrix4d _input_xform;
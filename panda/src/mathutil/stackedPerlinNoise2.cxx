@@ -12,6 +12,8 @@
  */
 
 #include "stackedPerlinNoise2.h"
+#include "workerPool.h"
+#include "thread.h"
 
 /**
  * Creates num_levels nested PerlinNoise2 objects.  Each stacked Perlin object
@@ -90,3 +92,66 @@ noise(const LVecBase2d &value) {
 
   return result;
 }
+
+/**
+ * Computes the noise function at each of the count points (x[i], y[i]) and
+ * stores it in result[i].  This produces exactly the same values as calling
+ * noise() on each of the points, but evaluates each level on many points at
+ * once.
+ */
+void StackedPerlinNoise2::
+noise(double *result, const double *x, const double *y, size_t count) const {
+  std::fill(result, result + count, 0.0);
+
+  Noises::const_iterator ni;
+  for (ni = _noises.begin(); ni != _noises.end(); ++ni) {
+    (*ni)._noise.add_noise(result, x, y, count, (*ni)._amp);
+  }
+}
+
+// This job computes a range of rows of noise_grid().
+class StackedPerlinNoise2::GridJob : public WorkerPool::Job {
+public:
+  virtual void execute(int begin, int end) {
+    pvector<double> y(_x_size);
+    for (int yi = begin; yi < end; ++yi) {
+      std::fill(y.begin(), y.end(), _y[yi]);
+      _noise->noise(_result + (size_t)yi * _x_size, _x, &y[0], _x_size);
+      Thread::consider_yield();
+    }
+  }
+
+  const StackedPerlinNoise2 *_noise;
+  double *_result;
+  const double *_x;
+  const double *_y;
+  int _x_size;
+};
+
+/**
+ * Computes the noise function at each point of the grid formed by the x_size
+ * values of x and the y_size values of y, and stores it in result, which must
+ * have room for x_size * y_size values.  That is, result[yi * x_size + xi] is
+ * noise(x[xi], y[yi]).
+ *
+ * The rows are divided among the threads of the WorkerPool.
+ */
+void StackedPerlinNoise2::
+noise_grid(double *result, const double *x, int x_size,
+           const double *y, int y_size) const {
+  if (x_size <= 0 || y_size <= 0) {
+    return;
+  }
+
+  GridJob job;
+  job._noise = this;
+  job._result = result;
+  job._x = x;
+  job._y = y;
+  job._x_size = x_size;
+
+  WorkerPool *pool = WorkerPool::get_global_ptr();
+  int grain = max(1, min(y_size / ((pool->get_num_threads() + 1) * 4),
+                         65536 / max(x_size, 1)));
+  pool->run(job, y_size, grain);
+}
@@ -42,7 +42,15 @@ PUBLISHED:
   INLINE float operator ()(const LVecBase2f &value);
   INLINE double operator ()(const LVecBase2d &value);
 
+public:
+  void noise(double *result, const double *x, const double *y,
+             size_t count) const;
+  void noise_grid(double *result, const double *x, int x_size,
+                  const double *y, int y_size) const;
+
 private:
+  class GridJob;
+
   class Noise {
   public:
     PerlinNoise2 _noise;
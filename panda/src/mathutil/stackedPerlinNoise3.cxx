@@ -12,6 +12,8 @@
  */
 
 #include "stackedPerlinNoise3.h"
+#include "workerPool.h"
+#include "thread.h"
 
 /**
  * Creates num_levels nested PerlinNoise3 objects.  Each stacked Perlin object
@@ -91,3 +93,76 @@ noise(const LVecBase3d &value) {
 
   return result;
 }
+
+/**
+ * Computes the noise function at each of the count points (x[i], y[i], z[i])
+ * and stores it in result[i].  This produces exactly the same values as
+ * calling noise() on each of the points, but evaluates each level on many
+ * points at once.
+ */
+void StackedPerlinNoise3::
+noise(double *result, const double *x, const double *y, const double *z,
+      size_t count) const {
+  std::fill(result, result + count, 0.0);
+
+  Noises::const_iterator ni;
+  for (ni = _noises.begin(); ni != _noises.end(); ++ni) {
+    (*ni)._noise.add_noise(result, x, y, z, count, (*ni)._amp);
+  }
+}
+
+// This job computes a range of rows of noise_grid().  Each row is one value
+// of y and z.
+class StackedPerlinNoise3::GridJob : public WorkerPool::Job {
+public:
+  virtual void execute(int begin, int end) {
+    pvector<double> y(_x_size);
+    pvector<double> z(_x_size);
+    for (int ri = begin; ri < end; ++ri) {
+      std::fill(y.begin(), y.end(), _y[ri % _y_size]);
+      std::fill(z.begin(), z.end(), _z[ri / _y_size]);
+      _noise->noise(_result + (size_t)ri * _x_size, _x, &y[0], &z[0], _x_size);
+      Thread::consider_yield();
+    }
+  }
+
+  const StackedPerlinNoise3 *_noise;
+  double *_result;
+  const double *_x;
+  const double *_y;
+  const double *_z;
+  int _x_size;
+  int _y_size;
+};
+
+/**
+ * Computes the noise function at each point of the grid formed by the x_size
+ * values of x, the y_size values of y and the z_size values of z, and stores
+ * it in result, which must have room for x_size * y_size * z_size values.
+ * That is, result[(zi * y_size + yi) * x_size + xi] is noise(x[xi], y[yi],
+ * z[zi]).
+ *
+ * The rows are divided among the threads of the WorkerPool.
+ */
+void StackedPerlinNoise3::
+noise_grid(double *result, const double *x, int x_size,
+           const double *y, int y_size, const double *z, int z_size) const {
+  if (x_size <= 0 || y_size <= 0 || z_size <= 0) {
+    return;
+  }
+
+  GridJob job;
+  job._noise = this;
+  job._result = result;
+  job._x = x;
+  job._y = y;
+  job._z = z;
+  job._x_size = x_size;
+  job._y_size = y_size;
+
+  int num_rows = y_size * z_size;
+  WorkerPool *pool = WorkerPool::get_global_ptr();
+  int grain = max(1, min(num_rows / ((pool->get_num_threads() + 1) * 4),
+                         65536 / max(x_size, 1)));
+  pool->run(job, num_rows, grain);
+}
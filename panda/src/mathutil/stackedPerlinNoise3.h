@@ -42,7 +42,16 @@ PUBLISHED:
   INLINE float operator ()(const LVecBase3f &value);
   INLINE double operator ()(const LVecBase3d &value);
 
+public:
+  void noise(double *result, const double *x, const double *y,
+             const double *z, size_t count) const;
+  void noise_grid(double *result, const double *x, int x_size,
+                  const double *y, int y_size,
+                  const double *z, int z_size) const;
+
 private:
+  class GridJob;
+
   class Noise {
   public:
     PerlinNoise3 _noise;
@@ -301,6 +301,33 @@ ConfigVariableBool flatten_geoms
           "only the NodePath interfaces; you may still make the lower-level "
           "SceneGraphReducer calls directly."));
 
+ConfigVariableBool flatten_atlas_textures
+("flatten-atlas-textures", false,
+ PRC_DESC("When this is true, NodePath::flatten_strong() will pack the "
+          "small textures of the Geoms it flattens onto shared atlas pages, "
+          "using SceneGraphReducer::atlas_textures(), before combining the "
+          "Geoms.  This allows Geoms that use different textures to be "
+          "combined, at the cost of creating new textures."));
+
+ConfigVariableBool share_geom_arrays
+("share-geom-arrays", false,
+ PRC_DESC("When this is true, the Loader will look for vertex and index "
+          "arrays in each newly loaded model that are identical to arrays "
+          "already in use by previously loaded models, and share them, "
+          "using SceneGraphReducer::share_arrays().  This saves memory and "
+          "vertex buffers when the same mesh has been exported into several "
+          "different model files, at the cost of hashing each array as it "
+          "is loaded.  See GeomArrayPool for the number of bytes saved."));
+
+ConfigVariableInt flatten_cluster_size
+("flatten-cluster-size", 0,
+ PRC_DESC("When this is greater than zero, NodePath::flatten_strong() will "
+          "divide each of the large Geoms it produces into clusters of up to "
+          "this many triangles, using SceneGraphReducer::make_clusters(), so "
+          "that the parts of a flattened model that are offscreen or facing "
+          "away from the camera may be culled individually.  Set it to 0 to "
+          "disable this."));
+
 ConfigVariableInt max_lenses
 ("max-lenses", 100,
  PRC_DESC("Specifies an upper limit on the maximum number of lenses "
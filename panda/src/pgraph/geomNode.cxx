@@ -37,12 +37,14 @@
 #include "boundingBox.h"
 #include "boundingSphere.h"
 #include "config_mathutil.h"
+#include "pStatTimer.h"
 
 
 bool allow_flatten_color = ConfigVariableBool
     ("allow-flatten-color", false,
      PRC_DESC("allows color to always be flattened to vertices"));
 
+PStatCollector GeomNode::_cull_clusters_pcollector("Cull:Clusters");
 TypeHandle GeomNode::_type_handle;
 
 /**
@@ -515,7 +517,7 @@ add_for_draw(CullTraverser *trav, CullTraverserData &data) {
   CPT(TransformState) internal_transform = data.get_internal_transform(trav);
 
   for (int i = 0; i < num_geoms; i++) {
-    const Geom *geom = geoms.get_geom(i);
+    CPT(Geom) geom = geoms.get_geom(i);
     if (geom->is_empty()) {
       continue;
     }
@@ -557,12 +559,56 @@ add_for_draw(CullTraverser *trav, CullTraverserData &data) {
       }
     }
 
+    // If the Geom has been divided into clusters, cull them individually, and
+    // draw only the triangles that survive.
+    if (data._view_frustum != (GeometricBoundingVolume *)NULL) {
+      CPT(GeomClusters) clusters = geom->get_clusters(trav->get_current_thread());
+      if (clusters != (GeomClusters *)NULL) {
+        geom = cull_clusters(trav, data, geom, clusters, state);
+        if (geom == (Geom *)NULL) {
+          // Cull.
+          continue;
+        }
+      }
+    }
+
     CullableObject *object =
       new CullableObject(geom, state, internal_transform);
     trav->get_cull_handler()->record_object(object, trav);
   }
 }
 
+/**
+ * Culls the clusters of the indicated Geom, which has been divided by
+ * Geom::make_clusters(), against the view frustum, and against the camera
+ * position if backface culling is in effect.  Returns the Geom to draw, or
+ * NULL if none of its clusters are visible.
+ */
+CPT(Geom) GeomNode::
+cull_clusters(CullTraverser *trav, CullTraverserData &data, const Geom *geom,
+              const GeomClusters *clusters, const RenderState *state) {
+  PStatTimer timer(_cull_clusters_pcollector);
+
+  bool cull_backfaces = false;
+  LPoint3 camera_pos = LPoint3::zero();
+
+  const CullFaceAttrib *cfa;
+  state->get_attrib_def(cfa);
+  if (cfa->get_effective_mode() == CullFaceAttrib::M_cull_clockwise) {
+    // A mirroring transform reverses the winding order, so we only do this
+    // for the common case.
+    CPT(TransformState) modelview = data.get_modelview_transform(trav);
+    if (!modelview->is_singular() &&
+        modelview->get_mat().get_upper_3().determinant() > 0.0f) {
+      camera_pos = modelview->get_inverse()->get_pos();
+      cull_backfaces = true;
+    }
+  }
+
+  return clusters->cull(geom, data._view_frustum, cull_backfaces, camera_pos,
+                        trav->get_current_thread());
+}
+
 /**
  * Returns the subset of CollideMask bits that may be set for this particular
  * type of PandaNode.  For most nodes, this is 0; it doesn't make sense to set
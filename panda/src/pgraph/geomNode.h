@@ -23,6 +23,7 @@
 #include "cycleData.h"
 #include "pvector.h"
 #include "copyOnWritePointer.h"
+#include "pStatCollector.h"
 
 class GraphicsStateGuardianBase;
 
@@ -123,6 +124,10 @@ private:
   bool _preserved;
   typedef pmap<const InternalName *, int> NameCount;
 
+  static CPT(Geom) cull_clusters(CullTraverser *trav, CullTraverserData &data,
+                                 const Geom *geom, const GeomClusters *clusters,
+                                 const RenderState *state);
+
   INLINE void count_name(NameCount &name_count, const InternalName *name);
   INLINE int get_name_count(const NameCount &name_count, const InternalName *name);
 
@@ -214,6 +219,7 @@ public:
   virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
 
 private:
+  static PStatCollector _cull_clusters_pcollector;
   static TypeHandle _type_handle;
 
   friend class GeomTransformer;
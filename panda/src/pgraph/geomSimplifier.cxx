@@ -0,0 +1,626 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file geomSimplifier.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "geomSimplifier.h"
+#include "geomNode.h"
+#include "geomTriangles.h"
+#include "geomVertexReader.h"
+#include "internalName.h"
+#include "config_pgraph.h"
+#include "pStatTimer.h"
+#include "pStatCollector.h"
+
+static PStatCollector simplify_collector("*:Flatten:simplify:Geom");
+
+// The weight of the planes that hold boundary vertices in place, relative to
+// the planes of the triangles themselves.
+static const double boundary_weight = 10.0;
+
+namespace {
+  // An edge between two position groups, used to find the boundary edges.
+  class GroupEdge {
+  public:
+    bool operator < (const GroupEdge &other) const {
+      if (_a != other._a) {
+        return _a < other._a;
+      }
+      return _b < other._b;
+    }
+
+    int _a, _b;
+    int _from, _to;
+    int _tri;
+  };
+
+  // Sorts vertex rows by their position.
+  class PositionCompare {
+  public:
+    PositionCompare(const pvector<LPoint3d> &positions) :
+      _positions(positions) {}
+    bool operator () (int a, int b) const {
+      const LPoint3d &pa = _positions[a];
+      const LPoint3d &pb = _positions[b];
+      if (pa[0] != pb[0]) {
+        return pa[0] < pb[0];
+      }
+      if (pa[1] != pb[1]) {
+        return pa[1] < pb[1];
+      }
+      return pa[2] < pb[2];
+    }
+    const pvector<LPoint3d> &_positions;
+  };
+}
+
+/**
+ *
+ */
+GeomSimplifier::
+GeomSimplifier() :
+  _max_error(-1.0f),
+  _normal_weight(1.0f),
+  _num_triangles_in(0),
+  _num_triangles_out(0),
+  _num_alive(0)
+{
+}
+
+/**
+ *
+ */
+GeomSimplifier::
+~GeomSimplifier() {
+}
+
+/**
+ * Returns a new Geom that approximates the indicated Geom with about
+ * target_ratio times as many triangles, or fewer if set_max_error() prevents
+ * it.  The new Geom shares the GeomVertexData of the original.
+ *
+ * If the Geom does not contain polygons, or cannot be simplified for some
+ * other reason, the original Geom is returned.
+ */
+CPT(Geom) GeomSimplifier::
+simplify_geom(const Geom *geom, PN_stdfloat target_ratio) {
+  if (geom->get_primitive_type() != Geom::PT_polygons) {
+    return geom;
+  }
+
+  PStatTimer timer(simplify_collector);
+  Thread *current_thread = Thread::get_current_thread();
+  CPT(GeomVertexData) vdata = geom->get_vertex_data(current_thread);
+
+  // Gather up all of the triangles into a single list.
+  pvector<int> indices;
+  CPT(GeomPrimitive) model;
+  int num_primitives = geom->get_num_primitives();
+  for (int i = 0; i < num_primitives; ++i) {
+    CPT(GeomPrimitive) prim = geom->get_primitive(i)->decompose();
+    if (!prim->is_of_type(GeomTriangles::get_class_type())) {
+      return geom;
+    }
+    if (model == (GeomPrimitive *)NULL) {
+      model = prim;
+    } else {
+      prim = prim->match_shade_model(model->get_shade_model());
+      if (prim == (GeomPrimitive *)NULL) {
+        return geom;
+      }
+    }
+
+    GeomPrimitivePipelineReader reader(prim, current_thread);
+    int num_vertices = reader.get_num_vertices();
+    num_vertices -= num_vertices % 3;
+    for (int vi = 0; vi < num_vertices; ++vi) {
+      indices.push_back(reader.get_vertex(vi));
+    }
+  }
+
+  int num_triangles = (int)indices.size() / 3;
+  _num_triangles_in += num_triangles;
+
+  int target_triangles = (int)(num_triangles * target_ratio + 0.5f);
+  if (target_triangles >= num_triangles || !setup(vdata, indices)) {
+    _num_triangles_out += num_triangles;
+    return geom;
+  }
+
+  reduce(target_triangles);
+
+  PT(GeomPrimitive) tris = new GeomTriangles(model->get_usage_hint());
+  tris->set_shade_model(model->get_shade_model());
+  tris->set_index_type(model->get_index_type());
+  tris->reserve_num_vertices(_num_alive * 3);
+  for (int t = 0; t < num_triangles; ++t) {
+    if (_tri_alive[t]) {
+      tris->add_vertices(_tris[t * 3], _tris[t * 3 + 1], _tris[t * 3 + 2]);
+    }
+  }
+  _num_triangles_out += _num_alive;
+
+  if (pgraph_cat.is_debug()) {
+    pgraph_cat.debug()
+      << "Simplified " << *geom << " from " << num_triangles << " to "
+      << _num_alive << " triangles.\n";
+  }
+
+  // Release the working state.
+  _positions.clear();
+  _normals.clear();
+  _group.clear();
+  _quadrics.clear();
+  _flags.clear();
+  _alive.clear();
+  _vertex_tris.clear();
+  _tris.clear();
+  _tri_alive.clear();
+  _heap.clear();
+
+  PT(Geom) result = geom->make_copy();
+  result->clear_primitives();
+  if (tris->get_num_vertices() != 0) {
+    result->add_primitive(tris);
+  }
+  return result;
+}
+
+/**
+ * Replaces each Geom of the indicated GeomNode with a simplified version.
+ * See simplify_geom().  Returns the number of Geoms that were changed.
+ */
+int GeomSimplifier::
+simplify(GeomNode *node, PN_stdfloat target_ratio) {
+  int count = 0;
+  int num_geoms = node->get_num_geoms();
+  for (int i = 0; i < num_geoms; ++i) {
+    CPT(Geom) orig_geom = node->get_geom(i);
+    CPT(Geom) new_geom = simplify_geom(orig_geom, target_ratio);
+    if (new_geom != orig_geom) {
+      node->set_geom(i, (Geom *)new_geom.p());
+      ++count;
+    }
+  }
+  return count;
+}
+
+/**
+ * Reads the vertex positions and builds the working state for simplifying
+ * the indicated triangles.  Returns false if the vertex data is unsuitable.
+ */
+bool GeomSimplifier::
+setup(const GeomVertexData *vdata, const pvector<int> &indices) {
+  int num_rows = vdata->get_num_rows();
+  GeomVertexReader vertex(vdata, InternalName::get_vertex());
+  if (!vertex.has_column()) {
+    return false;
+  }
+
+  _positions.resize(num_rows);
+  for (int i = 0; i < num_rows; ++i) {
+    _positions[i] = vertex.get_data3d();
+  }
+
+  _normals.clear();
+  GeomVertexReader normal(vdata, InternalName::get_normal());
+  if (normal.has_column() && _normal_weight != 0.0f) {
+    _normals.resize(num_rows);
+    for (int i = 0; i < num_rows; ++i) {
+      _normals[i] = normal.get_data3d();
+      _normals[i].normalize();
+    }
+  }
+
+  // Vertices that share the same position are assigned to the same group.
+  // They accumulate a common quadric, and they may not be moved, since that
+  // would open a crack at the seam.
+  pvector<int> sorted(num_rows);
+  for (int i = 0; i < num_rows; ++i) {
+    sorted[i] = i;
+  }
+  sort(sorted.begin(), sorted.end(), PositionCompare(_positions));
+
+  _group.resize(num_rows);
+  _flags.assign(num_rows, 0);
+  int num_groups = 0;
+  int begin = 0;
+  while (begin < num_rows) {
+    int end = begin + 1;
+    while (end < num_rows &&
+           _positions[sorted[end]] == _positions[sorted[begin]]) {
+      ++end;
+    }
+    for (int i = begin; i < end; ++i) {
+      _group[sorted[i]] = num_groups;
+      if (end - begin > 1) {
+        _flags[sorted[i]] |= VF_locked;
+      }
+    }
+    ++num_groups;
+    begin = end;
+  }
+
+  // Copy the triangles, discarding any that are already degenerate.
+  int num_triangles = (int)indices.size() / 3;
+  _tris = indices;
+  _tri_alive.assign(num_triangles, false);
+  _alive.assign(num_rows, true);
+  _vertex_tris.clear();
+  _vertex_tris.resize(num_rows);
+  _quadrics.clear();
+  _quadrics.resize(num_groups);
+  _num_alive = 0;
+
+  pvector<GroupEdge> edges;
+  edges.reserve(indices.size());
+
+  for (int t = 0; t < num_triangles; ++t) {
+    int v0 = _tris[t * 3];
+    int v1 = _tris[t * 3 + 1];
+    int v2 = _tris[t * 3 + 2];
+    nassertr(v0 >= 0 && v0 < num_rows && v1 >= 0 && v1 < num_rows &&
+             v2 >= 0 && v2 < num_rows, false);
+    if (_group[v0] == _group[v1] || _group[v1] == _group[v2] ||
+        _group[v2] == _group[v0]) {
+      continue;
+    }
+
+    _tri_alive[t] = true;
+    ++_num_alive;
+    _vertex_tris[v0].push_back(t);
+    _vertex_tris[v1].push_back(t);
+    _vertex_tris[v2].push_back(t);
+
+    // Each triangle contributes its plane, weighted by its area, to the
+    // quadric of each of its corners.
+    LVector3d n = calc_normal(t);
+    double length = n.length();
+    if (length > 0.0) {
+      n /= length;
+      double d = -n.dot(_positions[v0]);
+      Quadric q;
+      q.add_plane(n, d, length * 0.5);
+      _quadrics[_group[v0]] += q;
+      _quadrics[_group[v1]] += q;
+      _quadrics[_group[v2]] += q;
+    }
+
+    for (int k = 0; k < 3; ++k) {
+      GroupEdge edge;
+      edge._from = _tris[t * 3 + k];
+      edge._to = _tris[t * 3 + (k + 1) % 3];
+      edge._a = min(_group[edge._from], _group[edge._to]);
+      edge._b = max(_group[edge._from], _group[edge._to]);
+      edge._tri = t;
+      edges.push_back(edge);
+    }
+  }
+
+  if (_num_alive == 0) {
+    return false;
+  }
+
+  // An edge that is used by only one triangle is on the boundary of the
+  // surface.  We add a plane perpendicular to the triangle through this edge,
+  // to discourage collapses that would pull the boundary inwards.  Edges
+  // shared by more than two triangles are not manifold; we don't touch them.
+  sort(edges.begin(), edges.end());
+  size_t ei = 0;
+  while (ei < edges.size()) {
+    size_t ej = ei + 1;
+    while (ej < edges.size() && edges[ej]._a == edges[ei]._a &&
+           edges[ej]._b == edges[ei]._b) {
+      ++ej;
+    }
+
+    if (ej - ei == 1) {
+      const GroupEdge &edge = edges[ei];
+      _flags[edge._from] |= VF_boundary;
+      _flags[edge._to] |= VF_boundary;
+
+      LVector3d e = _positions[edge._to] - _positions[edge._from];
+      LVector3d n = e.cross(calc_normal(edge._tri));
+      if (n.normalize()) {
+        double d = -n.dot(_positions[edge._from]);
+        Quadric q;
+        q.add_plane(n, d, e.length_squared() * boundary_weight);
+        _quadrics[edge._a] += q;
+        _quadrics[edge._b] += q;
+      }
+
+    } else if (ej - ei > 2) {
+      for (size_t i = ei; i < ej; ++i) {
+        _flags[edges[i]._from] |= VF_locked;
+        _flags[edges[i]._to] |= VF_locked;
+      }
+    }
+    ei = ej;
+  }
+
+  return true;
+}
+
+/**
+ * Collapses edges, cheapest first, until no more than target_triangles
+ * triangles remain, or until no more collapses are possible.
+ */
+void GeomSimplifier::
+reduce(int target_triangles) {
+  _heap.clear();
+  int num_triangles = (int)_tri_alive.size();
+  for (int t = 0; t < num_triangles; ++t) {
+    if (_tri_alive[t]) {
+      add_candidates(t);
+    }
+  }
+
+  while (_num_alive > target_triangles && !_heap.empty()) {
+    pop_heap(_heap.begin(), _heap.end());
+    Collapse collapse = _heap.back();
+    _heap.pop_back();
+
+    if (!_alive[collapse._from] || !_alive[collapse._to]) {
+      continue;
+    }
+
+    // The entry may be stale.  Since quadrics only ever grow, the true cost
+    // is never less than the recorded cost; if it has grown, put it back in
+    // the heap and try the next one.
+    double cost;
+    if (!eval_collapse(collapse._from, collapse._to, cost)) {
+      continue;
+    }
+    if (cost > collapse._cost * 1.000001 + 1.0e-12) {
+      _heap.push_back(Collapse(cost, collapse._from, collapse._to));
+      push_heap(_heap.begin(), _heap.end());
+      continue;
+    }
+
+    if (_max_error >= 0.0f && cost > (double)_max_error) {
+      // Every remaining collapse is at least this expensive.
+      break;
+    }
+
+    if (check_collapse(collapse._from, collapse._to)) {
+      do_collapse(collapse._from, collapse._to);
+    }
+  }
+}
+
+/**
+ * Adds the possible collapses along each of the edges of the indicated
+ * triangle to the heap.
+ */
+void GeomSimplifier::
+add_candidates(int tri) {
+  for (int k = 0; k < 3; ++k) {
+    int a = _tris[tri * 3 + k];
+    int b = _tris[tri * 3 + (k + 1) % 3];
+
+    double cost;
+    if (eval_collapse(a, b, cost)) {
+      _heap.push_back(Collapse(cost, a, b));
+      push_heap(_heap.begin(), _heap.end());
+    }
+    if (eval_collapse(b, a, cost)) {
+      _heap.push_back(Collapse(cost, b, a));
+      push_heap(_heap.begin(), _heap.end());
+    }
+  }
+}
+
+/**
+ * Computes the cost of moving vertex "from" onto vertex "to".  Returns false
+ * if this collapse is not permitted at all.
+ */
+bool GeomSimplifier::
+eval_collapse(int from, int to, double &cost) const {
+  if (from == to || (_flags[from] & VF_locked) != 0) {
+    return false;
+  }
+  if ((_flags[from] & VF_boundary) != 0 &&
+      count_edge_triangles(from, to) != 1) {
+    // A boundary vertex may only slide along the boundary.
+    return false;
+  }
+
+  Quadric q = _quadrics[_group[from]];
+  q += _quadrics[_group[to]];
+  cost = q.evaluate(_positions[to]);
+
+  if (!_normals.empty()) {
+    double dot = _normals[from].dot(_normals[to]);
+    double length_sq = (_positions[to] - _positions[from]).length_squared();
+    cost += _normal_weight * (1.0 - dot) * length_sq;
+  }
+  return true;
+}
+
+/**
+ * Returns true if moving vertex "from" onto vertex "to" would leave the mesh
+ * in a good state: it must not make the surface non-manifold, and it must not
+ * flip any of the triangles that are moved.
+ */
+bool GeomSimplifier::
+check_collapse(int from, int to) const {
+  int edge_tris = count_edge_triangles(from, to);
+  if (edge_tris == 0) {
+    // The edge no longer exists.
+    return false;
+  }
+
+  // The link condition: the two vertices may have no neighbors in common
+  // other than the opposite corners of the triangles on the edge.
+  pvector<int> from_neighbors, to_neighbors;
+  const pvector<int> &from_tris = _vertex_tris[from];
+  for (size_t i = 0; i < from_tris.size(); ++i) {
+    int t = from_tris[i];
+    if (_tri_alive[t]) {
+      for (int k = 0; k < 3; ++k) {
+        int v = _tris[t * 3 + k];
+        if (v != from && v != to) {
+          from_neighbors.push_back(v);
+        }
+      }
+    }
+  }
+  const pvector<int> &to_tris = _vertex_tris[to];
+  for (size_t i = 0; i < to_tris.size(); ++i) {
+    int t = to_tris[i];
+    if (_tri_alive[t]) {
+      for (int k = 0; k < 3; ++k) {
+        int v = _tris[t * 3 + k];
+        if (v != from && v != to) {
+          to_neighbors.push_back(v);
+        }
+      }
+    }
+  }
+  sort(from_neighbors.begin(), from_neighbors.end());
+  from_neighbors.erase(unique(from_neighbors.begin(), from_neighbors.end()),
+                       from_neighbors.end());
+  sort(to_neighbors.begin(), to_neighbors.end());
+  to_neighbors.erase(unique(to_neighbors.begin(), to_neighbors.end()),
+                     to_neighbors.end());
+
+  int num_shared = 0;
+  pvector<int>::const_iterator fi = from_neighbors.begin();
+  pvector<int>::const_iterator ti = to_neighbors.begin();
+  while (fi != from_neighbors.end() && ti != to_neighbors.end()) {
+    if (*fi < *ti) {
+      ++fi;
+    } else if (*ti < *fi) {
+      ++ti;
+    } else {
+      ++num_shared;
+      ++fi;
+      ++ti;
+    }
+  }
+  if (num_shared > edge_tris) {
+    return false;
+  }
+
+  // Now make sure that none of the triangles that will be moved flips over
+  // or becomes degenerate.
+  for (size_t i = 0; i < from_tris.size(); ++i) {
+    int t = from_tris[i];
+    if (!_tri_alive[t]) {
+      continue;
+    }
+    const int *tri = &_tris[t * 3];
+    if (tri[0] == to || tri[1] == to || tri[2] == to) {
+      // This triangle will be removed.
+      continue;
+    }
+
+    LPoint3d p[3];
+    for (int k = 0; k < 3; ++k) {
+      p[k] = _positions[tri[k]];
+    }
+    LVector3d before = (p[1] - p[0]).cross(p[2] - p[0]);
+    for (int k = 0; k < 3; ++k) {
+      if (tri[k] == from) {
+        p[k] = _positions[to];
+      }
+    }
+    LVector3d after = (p[1] - p[0]).cross(p[2] - p[0]);
+
+    double dot = before.dot(after);
+    if (dot <= 0.0 ||
+        after.length_squared() <= before.length_squared() * 1.0e-6) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Moves vertex "from" onto vertex "to", removing the triangles that
+ * referenced both.
+ */
+void GeomSimplifier::
+do_collapse(int from, int to) {
+  pvector<int> &to_tris = _vertex_tris[to];
+  pvector<int> &from_tris = _vertex_tris[from];
+
+  for (size_t i = 0; i < from_tris.size(); ++i) {
+    int t = from_tris[i];
+    if (!_tri_alive[t]) {
+      continue;
+    }
+    int *tri = &_tris[t * 3];
+    if (tri[0] == to || tri[1] == to || tri[2] == to) {
+      _tri_alive[t] = false;
+      --_num_alive;
+    } else {
+      for (int k = 0; k < 3; ++k) {
+        if (tri[k] == from) {
+          tri[k] = to;
+        }
+      }
+      to_tris.push_back(t);
+    }
+  }
+
+  _quadrics[_group[to]] += _quadrics[_group[from]];
+  _alive[from] = false;
+  pvector<int>().swap(from_tris);
+
+  // Prune the dead triangles from the list, and queue up the new collapses
+  // that are now possible around this vertex.
+  pvector<int>::iterator wi = to_tris.begin();
+  for (pvector<int>::iterator ri = to_tris.begin(); ri != to_tris.end(); ++ri) {
+    if (_tri_alive[*ri]) {
+      *wi = *ri;
+      ++wi;
+    }
+  }
+  to_tris.erase(wi, to_tris.end());
+
+  for (size_t i = 0; i < to_tris.size(); ++i) {
+    add_candidates(to_tris[i]);
+  }
+}
+
+/**
+ * Returns the unnormalized normal of the indicated triangle.  Its length is
+ * twice the area of the triangle.
+ */
+LVector3d GeomSimplifier::
+calc_normal(int tri) const {
+  const LPoint3d &p0 = _positions[_tris[tri * 3]];
+  const LPoint3d &p1 = _positions[_tris[tri * 3 + 1]];
+  const LPoint3d &p2 = _positions[_tris[tri * 3 + 2]];
+  return (p1 - p0).cross(p2 - p0);
+}
+
+/**
+ * Returns the number of remaining triangles that include both of the
+ * indicated vertices.
+ */
+int GeomSimplifier::
+count_edge_triangles(int a, int b) const {
+  int count = 0;
+  const pvector<int> &tris = _vertex_tris[a];
+  for (size_t i = 0; i < tris.size(); ++i) {
+    int t = tris[i];
+    if (_tri_alive[t]) {
+      const int *tri = &_tris[t * 3];
+      if (tri[0] == b || tri[1] == b || tri[2] == b) {
+        ++count;
+      }
+    }
+  }
+  return count;
+}
@@ -0,0 +1,134 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file geomSimplifier.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef GEOMSIMPLIFIER_H
+#define GEOMSIMPLIFIER_H
+
+#include "pandabase.h"
+
+#include "luse.h"
+#include "geom.h"
+#include "pvector.h"
+
+class GeomNode;
+
+/**
+ * An object that reduces the number of triangles in a Geom, for instance to
+ * generate the lower levels of an LODNode.  It repeatedly collapses the edge
+ * whose removal introduces the least error, as measured by the quadric error
+ * metric of Garland and Heckbert, until the requested number of triangles
+ * remains.
+ *
+ * Each collapse moves a vertex onto one of its neighbors, so no new vertices
+ * are ever created and the vertex attributes (normals, texture coordinates,
+ * colors, joint weights) never need to be interpolated.  Vertices that share
+ * their position with another vertex, which is how UV seams and hard normal
+ * edges are represented, are never moved; and vertices on an open boundary
+ * may only slide along that boundary.  This keeps seams and silhouettes
+ * intact.
+ *
+ * The resulting Geoms continue to reference the original GeomVertexData, so
+ * that several levels of detail can share the same vertex buffer.  Use
+ * SceneGraphReducer::remove_unused_vertices() if this is not desired.
+ */
+class EXPCL_PANDA_PGRAPH GeomSimplifier {
+PUBLISHED:
+  GeomSimplifier();
+  ~GeomSimplifier();
+
+  INLINE void set_max_error(PN_stdfloat max_error);
+  INLINE PN_stdfloat get_max_error() const;
+  MAKE_PROPERTY(max_error, get_max_error, set_max_error);
+
+  INLINE void set_normal_weight(PN_stdfloat normal_weight);
+  INLINE PN_stdfloat get_normal_weight() const;
+  MAKE_PROPERTY(normal_weight, get_normal_weight, set_normal_weight);
+
+  CPT(Geom) simplify_geom(const Geom *geom, PN_stdfloat target_ratio);
+  int simplify(GeomNode *node, PN_stdfloat target_ratio);
+
+  INLINE int get_num_triangles_in() const;
+  INLINE int get_num_triangles_out() const;
+  INLINE void clear_stats();
+  MAKE_PROPERTY(num_triangles_in, get_num_triangles_in);
+  MAKE_PROPERTY(num_triangles_out, get_num_triangles_out);
+
+private:
+  bool setup(const GeomVertexData *vdata, const pvector<int> &indices);
+  void reduce(int target_triangles);
+
+  void add_candidates(int tri);
+  bool eval_collapse(int from, int to, double &cost) const;
+  bool check_collapse(int from, int to) const;
+  void do_collapse(int from, int to);
+
+  LVector3d calc_normal(int tri) const;
+  int count_edge_triangles(int a, int b) const;
+
+private:
+  // A symmetric 4x4 matrix that measures the sum of squared distances to a
+  // set of planes.
+  class Quadric {
+  public:
+    INLINE Quadric();
+    INLINE void add_plane(const LVector3d &normal, double d, double weight);
+    INLINE void operator += (const Quadric &other);
+    INLINE double evaluate(const LPoint3d &point) const;
+
+    double _a00, _a01, _a02, _a11, _a12, _a22;
+    double _b0, _b1, _b2;
+    double _c;
+  };
+
+  // A candidate edge collapse, stored on a heap.  The ordering operator is
+  // reversed so that the cheapest collapse is at the top of the heap.
+  class Collapse {
+  public:
+    INLINE Collapse(double cost, int from, int to);
+    INLINE bool operator < (const Collapse &other) const;
+
+    double _cost;
+    int _from;
+    int _to;
+  };
+  typedef pvector<Collapse> Heap;
+
+  enum VertexFlags {
+    VF_locked   = 0x01,
+    VF_boundary = 0x02,
+  };
+
+  PN_stdfloat _max_error;
+  PN_stdfloat _normal_weight;
+  int _num_triangles_in;
+  int _num_triangles_out;
+
+  // The working state for the Geom currently being simplified.  Most of
+  // these are indexed by vertex row; _quadrics is indexed by position group,
+  // and _tris (three entries each) and _tri_alive by triangle.
+  pvector<LPoint3d> _positions;
+  pvector<LVector3d> _normals;
+  pvector<int> _group;
+  pvector<Quadric> _quadrics;
+  pvector<int> _flags;
+  pvector<bool> _alive;
+  pvector<pvector<int> > _vertex_tris;
+  pvector<int> _tris;
+  pvector<bool> _tri_alive;
+  int _num_alive;
+  Heap _heap;
+};
+
+#include "geomSimplifier.I"
+
+#endif
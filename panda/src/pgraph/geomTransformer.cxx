@@ -840,6 +840,71 @@ reverse_normals(Geom *geom) {
   return true;
 }
 
+/**
+ * Stores the vertex data of the Geom in a more compact encoding, according to
+ * the indicated GeomVertexData::CompressFlags.  Returns true if the Geom was
+ * changed, false otherwise.
+ */
+bool GeomTransformer::
+compress_vertices(Geom *geom, int flags) {
+  PStatTimer timer(_apply_set_format_collector);
+
+  nassertr(geom != (Geom *)NULL, false);
+  CPT(GeomVertexData) orig_data = geom->get_vertex_data();
+  NewVertexData &new_data = _compressed_vertices[orig_data];
+  if (new_data._vdata.is_null()) {
+    new_data._vdata = orig_data->compress_vertices(flags);
+  }
+
+  if (new_data._vdata == orig_data) {
+    // No change.
+    return false;
+  }
+
+  geom->set_vertex_data(new_data._vdata);
+  if (orig_data->get_ref_count() > 1) {
+    _vdata_assoc[new_data._vdata]._might_have_unused = true;
+    _vdata_assoc[orig_data]._might_have_unused = true;
+  }
+
+  return true;
+}
+
+/**
+ * Compresses the vertex datas within the GeomNode; see above.  Returns true
+ * if the GeomNode was changed, false otherwise.
+ */
+bool GeomTransformer::
+compress_vertices(GeomNode *node, int flags) {
+  bool any_changed = false;
+
+  GeomNode::CDWriter cdata(node->_cycler);
+  GeomNode::GeomList::iterator gi;
+  PT(GeomNode::GeomList) geoms = cdata->modify_geoms();
+  for (gi = geoms->begin(); gi != geoms->end(); ++gi) {
+    GeomNode::GeomEntry &entry = (*gi);
+    CPT(Geom) orig_geom = entry._geom.get_read_pointer();
+
+    // Don't bother copying the Geom unless its vertex data will change.
+    CPT(GeomVertexData) orig_data = orig_geom->get_vertex_data();
+    NewVertexData &new_data = _compressed_vertices[orig_data];
+    if (new_data._vdata.is_null()) {
+      new_data._vdata = orig_data->compress_vertices(flags);
+    }
+    if (new_data._vdata == orig_data) {
+      continue;
+    }
+
+    PT(Geom) new_geom = orig_geom->make_copy();
+    if (compress_vertices(new_geom, flags)) {
+      entry._geom = new_geom;
+      any_changed = true;
+    }
+  }
+
+  return any_changed;
+}
+
 /**
  * Duplicates triangles in this GeomNode so that each triangle is back-to-back
  * with another triangle facing in the opposite direction.  If the geometry
@@ -903,6 +968,29 @@ reverse(GeomNode *node) {
   return (num_geoms != 0);
 }
 
+/**
+ * Reorders the triangles of each Geom in this GeomNode for better use of the
+ * post-transform vertex cache (see GeomPrimitive::optimize_vertex_cache()),
+ * and records the GeomVertexDatas so that finish_apply() will also reorder
+ * their vertices into the order in which they are first referenced.
+ *
+ * Returns true if any Geoms are modified, false otherwise.
+ */
+bool GeomTransformer::
+optimize_vertex_cache(GeomNode *node, int cache_size) {
+  int num_geoms = node->get_num_geoms();
+  for (int i = 0; i < num_geoms; ++i) {
+    PT(Geom) geom = node->modify_geom(i);
+    geom->optimize_vertex_cache_in_place(cache_size);
+
+    VertexDataAssoc &assoc = _vdata_assoc[geom->get_vertex_data()];
+    assoc._geoms.push_back(geom);
+    assoc._reorder_vertices = true;
+  }
+
+  return (num_geoms != 0);
+}
+
 /**
  * Should be called after performing any operations--particularly
  * PandaNode::apply_attribs_to_vertices()--that might result in new
@@ -916,7 +1004,10 @@ finish_apply() {
   for (vi = _vdata_assoc.begin(); vi != _vdata_assoc.end(); ++vi) {
     const GeomVertexData *vdata = (*vi).first;
     VertexDataAssoc &assoc = (*vi).second;
-    if (assoc._might_have_unused) {
+    if (assoc._reorder_vertices) {
+      // This also takes care of removing the unused vertices.
+      assoc.reorder_vertices(vdata);
+    } else if (assoc._might_have_unused) {
       assoc.remove_unused_vertices(vdata);
     }
   }
@@ -927,6 +1018,7 @@ finish_apply() {
   _tcolors.clear();
   _format.clear();
   _reversed_normals.clear();
+  _compressed_vertices.clear();
 }
 
 /**
@@ -1557,3 +1649,154 @@ remove_unused_vertices(const GeomVertexData *vdata) {
     geom->set_vertex_data(new_vdata);
   }
 }
+
+/**
+ * Reorders the vertices of the indicated GeomVertexData into the order in
+ * which they are first referenced by the associated Geoms, so that the
+ * graphics card fetches vertex data as sequentially as possible.  Any
+ * vertices that are not referenced at all are removed.  The associated Geoms
+ * are reindexed accordingly.
+ */
+void GeomTransformer::VertexDataAssoc::
+reorder_vertices(const GeomVertexData *vdata) {
+  if (_geoms.empty()) {
+    // Trivial case.
+    return;
+  }
+
+  if (vdata->get_slider_table() != (SliderTable *)NULL) {
+    // The slider table refers to vertices by row number, and we don't
+    // attempt to remap those.  Just remove the unused vertices, which
+    // preserves the row order.
+    remove_unused_vertices(vdata);
+    return;
+  }
+
+  PT(Thread) current_thread = Thread::get_current_thread();
+
+  // These may be too large to allocate on the stack.
+  int num_vertices = vdata->get_num_rows();
+  pvector<int> remap_array(num_vertices, -1);
+  pvector<int> source_array(num_vertices);
+
+  // Assign the new indices in order of first reference.
+  int new_num_vertices = 0;
+  bool any_referenced = false;
+  GeomList::iterator gi;
+  for (gi = _geoms.begin(); gi != _geoms.end(); ++gi) {
+    Geom *geom = (*gi);
+    if (geom->get_vertex_data() != vdata) {
+      continue;
+    }
+
+    any_referenced = true;
+    int num_primitives = geom->get_num_primitives();
+    for (int i = 0; i < num_primitives; ++i) {
+      CPT(GeomPrimitive) prim = geom->get_primitive(i);
+
+      GeomPrimitivePipelineReader reader(prim, current_thread);
+      int strip_cut_index = reader.is_indexed() ? reader.get_strip_cut_index() : -1;
+      int num_prim_vertices = reader.get_num_vertices();
+      for (int vi = 0; vi < num_prim_vertices; ++vi) {
+        int index = reader.get_vertex(vi);
+        if (index == strip_cut_index) {
+          continue;
+        }
+        nassertv(index >= 0 && index < num_vertices);
+        if (remap_array[index] < 0) {
+          remap_array[index] = new_num_vertices;
+          source_array[new_num_vertices] = index;
+          ++new_num_vertices;
+        }
+      }
+    }
+  }
+
+  if (!any_referenced) {
+    return;
+  }
+
+  bool is_identity = (new_num_vertices == num_vertices);
+  for (int index = 0; index < new_num_vertices && is_identity; ++index) {
+    is_identity = (source_array[index] == index);
+  }
+  if (is_identity) {
+    // The vertices are already in the ideal order.
+    return;
+  }
+
+  // Now recopy the actual vertex data, one array at a time.
+  PT(GeomVertexData) new_vdata = new GeomVertexData(*vdata);
+  new_vdata->unclean_set_num_rows(new_num_vertices);
+
+  int num_arrays = vdata->get_num_arrays();
+  nassertv(num_arrays == new_vdata->get_num_arrays());
+
+  GeomVertexDataPipelineReader reader(vdata, current_thread);
+  reader.check_array_readers();
+  GeomVertexDataPipelineWriter writer(new_vdata, true, current_thread);
+  writer.check_array_writers();
+
+  for (int a = 0; a < num_arrays; ++a) {
+    const GeomVertexArrayDataHandle *array_reader = reader.get_array_reader(a);
+    GeomVertexArrayDataHandle *array_writer = writer.get_array_writer(a);
+
+    int stride = array_reader->get_array_format()->get_stride();
+    nassertv(stride == array_writer->get_array_format()->get_stride());
+
+    for (int new_index = 0; new_index < new_num_vertices; ++new_index) {
+      array_writer->copy_subdata_from(new_index * stride, stride,
+                                      array_reader,
+                                      source_array[new_index] * stride, stride);
+    }
+  }
+
+  // Update the rows in the TransformBlendTable, if any.  Since the vertices
+  // are no longer in their original order, we have to remap them one at a
+  // time.
+  PT(TransformBlendTable) tbtable = new_vdata->modify_transform_blend_table();
+  if (!tbtable.is_null()) {
+    const SparseArray &rows = tbtable->get_rows();
+    SparseArray new_rows;
+    int num_subranges = rows.get_num_subranges();
+    for (int si = 0; si < num_subranges; ++si) {
+      int from = rows.get_subrange_begin(si);
+      int to = min(rows.get_subrange_end(si), num_vertices);
+      for (int index = from; index < to; ++index) {
+        if (remap_array[index] >= 0) {
+          new_rows.set_bit(remap_array[index]);
+        }
+      }
+    }
+    tbtable->set_rows(new_rows);
+  }
+
+  // Finally, reindex the Geoms.
+  for (gi = _geoms.begin(); gi != _geoms.end(); ++gi) {
+    Geom *geom = (*gi);
+    if (geom->get_vertex_data() != vdata) {
+      continue;
+    }
+
+    int num_primitives = geom->get_num_primitives();
+    for (int i = 0; i < num_primitives; ++i) {
+      PT(GeomPrimitive) prim = geom->modify_primitive(i);
+      prim->make_indexed();
+      int strip_cut_index = prim->get_strip_cut_index();
+      PT(GeomVertexArrayData) vertices = prim->modify_vertices();
+      GeomVertexRewriter rewriter(vertices, 0, current_thread);
+
+      while (!rewriter.is_at_end()) {
+        int index = rewriter.get_data1i();
+        if (index != strip_cut_index) {
+          nassertv(index >= 0 && index < num_vertices);
+          index = remap_array[index];
+          nassertv(index >= 0 && index < new_num_vertices);
+        }
+        rewriter.set_data1i(index);
+      }
+    }
+
+    geom->set_vertex_data(new_vdata);
+  }
+}
@@ -82,6 +82,11 @@ public:
   bool doubleside(GeomNode *node);
   bool reverse(GeomNode *node);
 
+  bool optimize_vertex_cache(GeomNode *node, int cache_size);
+
+  bool compress_vertices(Geom *geom, int flags);
+  bool compress_vertices(GeomNode *node, int flags);
+
   void finish_apply();
 
   int collect_vertex_data(Geom *geom, int collect_bits, bool format_only);
@@ -102,8 +107,10 @@ private:
   public:
     INLINE VertexDataAssoc();
     bool _might_have_unused;
+    bool _reorder_vertices;
     GeomList _geoms;
     void remove_unused_vertices(const GeomVertexData *vdata);
+    void reorder_vertices(const GeomVertexData *vdata);
   };
   typedef pmap<CPT(GeomVertexData), VertexDataAssoc> VertexDataAssocMap;
   VertexDataAssocMap _vdata_assoc;
@@ -190,6 +197,10 @@ private:
   typedef pmap<CPT(GeomVertexData), NewVertexData> ReversedNormals;
   ReversedNormals _reversed_normals;
 
+  // The table of GeomVertexData objects that have been compressed.
+  typedef pmap<CPT(GeomVertexData), NewVertexData> CompressedVertices;
+  CompressedVertices _compressed_vertices;
+
   class NewCollectedKey {
   public:
     INLINE bool operator < (const NewCollectedKey &other) const;
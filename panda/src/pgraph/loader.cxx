@@ -27,6 +27,7 @@
 #include "bamCache.h"
 #include "bamCacheRecord.h"
 #include "sceneGraphReducer.h"
+#include "geomArrayPool.h"
 #include "renderState.h"
 #include "bamFile.h"
 #include "configVariableInt.h"
@@ -305,6 +306,10 @@ try_load_file(const Filename &pathname, const LoaderOptions &options,
           sgr.premunge(result, RenderState::make_empty());
         }
 
+        if (share_geom_arrays) {
+          share_arrays(pathname, result);
+        }
+
         if (result->is_of_type(ModelRoot::get_class_type())) {
           ModelRoot *model_root = DCAST(ModelRoot, result.p());
           model_root->set_fullpath(pathname);
@@ -346,6 +351,10 @@ try_load_file(const Filename &pathname, const LoaderOptions &options,
         sgr.premunge(result, RenderState::make_empty());
       }
 
+      if (share_geom_arrays) {
+        share_arrays(pathname, result);
+      }
+
       if (allow_ram_cache && result->is_of_type(ModelRoot::get_class_type())) {
         // Store the loaded model in the RAM cache, and make sure we return a
         // copy so that this node can be modified independently from the RAM
@@ -362,6 +371,25 @@ try_load_file(const Filename &pathname, const LoaderOptions &options,
   return NULL;
 }
 
+/**
+ * Replaces the vertex and index arrays of the newly loaded model with
+ * identical arrays from previously loaded models, where possible.
+ */
+void Loader::
+share_arrays(const Filename &pathname, PandaNode *model) {
+  size_t bytes_before = GeomArrayPool::get_bytes_saved();
+
+  SceneGraphReducer sgr;
+  int num_changed = sgr.share_arrays(model);
+
+  if (loader_cat.is_debug() && num_changed != 0) {
+    loader_cat.debug()
+      << "Model " << pathname << " shares arrays with previously loaded models; "
+      << (GeomArrayPool::get_bytes_saved() - bytes_before)
+      << " bytes saved in " << num_changed << " Geoms.\n";
+  }
+}
+
 /**
  * Saves a scene graph to a single file, if possible.  The file type written
  * is implicit in the filename extension.
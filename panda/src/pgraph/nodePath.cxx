@@ -5449,6 +5449,9 @@ flatten_strong() {
   nassertr_always(!is_empty(), 0);
   SceneGraphReducer gr;
   gr.apply_attribs(node());
+  if (flatten_atlas_textures) {
+    gr.atlas_textures(node());
+  }
   int num_removed = gr.flatten(node(), ~0);
 
   if (flatten_geoms) {
@@ -5457,6 +5460,10 @@ flatten_strong() {
     gr.unify(node(), false);
   }
 
+  if (flatten_cluster_size > 0) {
+    gr.make_clusters(node(), flatten_cluster_size);
+  }
+
   return num_removed;
 }
 
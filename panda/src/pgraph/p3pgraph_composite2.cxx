@@ -19,4 +19,5 @@
 #include "fogAttrib.cxx"
 #include "geomDrawCallbackData.cxx"
 #include "geomNode.cxx"
+#include "geomSimplifier.cxx"
 #include "geomTransformer.cxx"
@@ -18,6 +18,7 @@
 #include "stencilAttrib.cxx"
 #include "texMatrixAttrib.cxx"
 #include "texProjectorEffect.cxx"
+#include "textureAtlas.cxx"
 #include "textureAttrib.cxx"
 #include "texGenAttrib.cxx"
 #include "textureStageCollection.cxx"
@@ -23,6 +23,8 @@ RenderAttrib::Attribs *RenderAttrib::_attribs = NULL;
 TypeHandle RenderAttrib::_type_handle;
 
 int RenderAttrib::_garbage_index = 0;
+int RenderAttrib::_next_attrib_id = 1;
+vector_int *RenderAttrib::_free_attrib_ids = NULL;
 
 PStatCollector RenderAttrib::_garbage_collect_pcollector("*:State Cache:Garbage Collect");
 
@@ -35,6 +37,7 @@ RenderAttrib() {
     init_attribs();
   }
   _saved_entry = -1;
+  _attrib_id = 0;
 }
 
 /**
@@ -399,6 +402,13 @@ return_unique(RenderAttrib *attrib) {
 
   // Save the index and return the input attrib.
   attrib->_saved_entry = si;
+
+  if (!_free_attrib_ids->empty()) {
+    attrib->_attrib_id = _free_attrib_ids->back();
+    _free_attrib_ids->pop_back();
+  } else {
+    attrib->_attrib_id = _next_attrib_id++;
+  }
   return attrib;
 }
 
@@ -516,6 +526,10 @@ release_new() {
     _attribs->remove_element(_saved_entry);
     _saved_entry = -1;
   }
+  if (_attrib_id != 0) {
+    _free_attrib_ids->push_back(_attrib_id);
+    _attrib_id = 0;
+  }
 }
 
 /**
@@ -528,6 +542,7 @@ release_new() {
 void RenderAttrib::
 init_attribs() {
   _attribs = new Attribs;
+  _free_attrib_ids = new vector_int;
 
   // TODO: we should have a global Panda mutex to allow us to safely create
   // _attribs_lock without a startup race condition.  For the meantime, this
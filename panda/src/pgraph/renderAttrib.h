@@ -22,6 +22,7 @@
 #include "simpleHashMap.h"
 #include "lightReMutex.h"
 #include "pStatCollector.h"
+#include "vector_int.h"
 
 class AttribSlots;
 class GraphicsStateGuardianBase;
@@ -70,6 +71,7 @@ public:
 PUBLISHED:
   INLINE int compare_to(const RenderAttrib &other) const;
   INLINE size_t get_hash() const;
+  INLINE int get_attrib_id() const;
   INLINE CPT(RenderAttrib) get_unique() const;
   INLINE CPT(RenderAttrib) get_auto_shader_attrib(const RenderState *state) const;
 
@@ -194,6 +196,13 @@ private:
   int _saved_entry;
   size_t _hash;
 
+  // A small integer that identifies this attrib among all of the attribs in
+  // the above table, or 0 if it is not in the table.  The numbers of deleted
+  // attribs are reused, to keep them small.
+  int _attrib_id;
+  static int _next_attrib_id;
+  static vector_int *_free_attrib_ids;
+
   // This keeps track of our current position through the garbage collection
   // cycle.
   static int _garbage_index;
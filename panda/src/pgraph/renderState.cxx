@@ -24,6 +24,7 @@
 #include "textureAttrib.h"
 #include "texGenAttrib.h"
 #include "shaderAttrib.h"
+#include "colorBlendAttrib.h"
 #include "pStatTimer.h"
 #include "config_pgraph.h"
 #include "bamReader.h"
@@ -41,6 +42,8 @@ RenderState::States *RenderState::_states = NULL;
 const RenderState *RenderState::_empty_state = NULL;
 UpdateSeq RenderState::_last_cycle_detect;
 int RenderState::_garbage_index = 0;
+int RenderState::_next_state_id = 1;
+vector_int *RenderState::_free_state_ids = NULL;
 
 PStatCollector RenderState::_cache_update_pcollector("*:State Cache:Update");
 PStatCollector RenderState::_garbage_collect_pcollector("*:State Cache:Garbage Collect");
@@ -71,6 +74,8 @@ RenderState() :
     init_states();
   }
   _saved_entry = -1;
+  _state_id = 0;
+  _sort_key = 0;
   _last_mi = -1;
   _cache_stats.add_num_states(1);
   _read_overrides = NULL;
@@ -93,6 +98,8 @@ RenderState(const RenderState &copy) :
   }
 
   _saved_entry = -1;
+  _state_id = 0;
+  _sort_key = 0;
   _last_mi = -1;
   _cache_stats.add_num_states(1);
   _read_overrides = NULL;
@@ -213,6 +220,26 @@ compare_mask(const RenderState &other, SlotMask compare_mask) const {
   return 0;
 }
 
+/**
+ * Returns the set of attribute slots in which this state and the other state
+ * have different attribs, comparing them by pointer.  A slot that is filled
+ * in only one of the two states is also included.
+ */
+RenderState::SlotMask RenderState::
+get_changed_slots(const RenderState *other) const {
+  SlotMask changed;
+  SlotMask mask = _filled_slots | other->_filled_slots;
+  int slot = mask.get_lowest_on_bit();
+  while (slot >= 0) {
+    if (_attributes[slot]._attrib != other->_attributes[slot]._attrib) {
+      changed.set_bit(slot);
+    }
+    mask.clear_bit(slot);
+    slot = mask.get_lowest_on_bit();
+  }
+  return changed;
+}
+
 /**
  * Calls cull_callback() on each attrib.  If any attrib returns false,
  * interrupts the list and returns false immediately; otherwise, completes the
@@ -1425,6 +1452,7 @@ return_unique(RenderState *state) {
 
   // Save the index and return the input state.
   state->_saved_entry = si;
+  state->assign_state_id();
   return state;
 }
 
@@ -1709,6 +1737,57 @@ release_new() {
     _states->remove_element(_saved_entry);
     _saved_entry = -1;
   }
+  if (_state_id != 0) {
+    _free_state_ids->push_back(_state_id);
+    _state_id = 0;
+    _sort_key = 0;
+  }
+}
+
+/**
+ * Gives this state, which has just been added to the global state cache, a
+ * state number, and computes its sort key from the attrib numbers of its
+ * shader, texture and blending attribs.  The sort key does not include the
+ * state number.
+ *
+ * You must already be holding _states_lock before you call this method.
+ */
+void RenderState::
+assign_state_id() {
+  nassertv(_states_lock->debug_is_locked());
+
+  if (!_free_state_ids->empty()) {
+    _state_id = _free_state_ids->back();
+    _free_state_ids->pop_back();
+  } else {
+    _state_id = _next_state_id++;
+  }
+
+  // The key is laid out from most to least expensive state change.  If there
+  // are more attribs than fit in a field, the numbers wrap around, which only
+  // makes the sort less effective; CullBinStateSorted falls back to
+  // compare_sort() for states with the same key.
+  uint64_t shader = 0, texture = 0, transparency = 0, color_blend = 0;
+  const RenderAttrib *attrib;
+  if ((attrib = _attributes[ShaderAttrib::get_class_slot()]._attrib) != NULL) {
+    shader = attrib->get_attrib_id();
+  }
+  if ((attrib = _attributes[TextureAttrib::get_class_slot()]._attrib) != NULL) {
+    texture = attrib->get_attrib_id();
+  }
+  if ((attrib = _attributes[TransparencyAttrib::get_class_slot()]._attrib) != NULL) {
+    transparency = attrib->get_attrib_id();
+  }
+  if ((attrib = _attributes[ColorBlendAttrib::get_class_slot()]._attrib) != NULL) {
+    color_blend = attrib->get_attrib_id();
+  }
+
+  // The state number is deliberately not part of the key, so that states
+  // that share these attribs compare equal here and are further ordered by
+  // compare_sort() on their remaining attribs.
+  _sort_key = ((shader & 0xfffff) << 44) |
+              ((texture & 0xfffff) << 24) |
+              (((transparency << 12) ^ color_blend) & 0xffffff);
 }
 
 /**
@@ -1962,6 +2041,7 @@ update_pstats(int old_referenced_bits, int new_referenced_bits) {
 void RenderState::
 init_states() {
   _states = new States;
+  _free_state_ids = new vector_int;
 
   // TODO: we should have a global Panda mutex to allow us to safely create
   // _states_lock without a startup race condition.  For the meantime, this is
@@ -1975,7 +2055,10 @@ init_states() {
   // is declared globally, and lives forever.
   RenderState *state = new RenderState;
   state->local_object();
+
+  LightReMutexHolder holder(*_states_lock);
   state->_saved_entry = _states->store(state, Empty());
+  state->assign_state_id();
   _empty_state = state;
 }
 
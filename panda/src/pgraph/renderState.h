@@ -65,6 +65,8 @@ PUBLISHED:
   int compare_sort(const RenderState &other) const;
   int compare_mask(const RenderState &other, SlotMask compare_mask) const;
   INLINE size_t get_hash() const;
+  INLINE int get_state_id() const;
+  INLINE uint64_t get_sort_key() const;
 
   INLINE bool is_empty() const;
 
@@ -155,6 +157,8 @@ PUBLISHED:
   int get_geom_rendering(int geom_rendering) const;
 
 public:
+  SlotMask get_changed_slots(const RenderState *other) const;
+
   static void bin_removed(int bin_index);
 
   INLINE static void flush_level();
@@ -207,6 +211,7 @@ private:
 
   void determine_bin_index();
   void determine_cull_callback();
+  void assign_state_id();
   void fill_default();
 
   INLINE void set_destructing();
@@ -240,6 +245,15 @@ private:
   // when the RenderState destructs.
   int _saved_entry;
 
+  // A small integer that identifies this state among all of the states in
+  // the above set, or 0 if it is not in the set, and the sort key that is
+  // computed from the expensive attribs when the state is added to the set.
+  // The numbers of deleted states are reused, to keep them small.
+  int _state_id;
+  uint64_t _sort_key;
+  static int _next_state_id;
+  static vector_int *_free_state_ids;
+
   // This data structure manages the job of caching the composition of two
   // RenderStates.  It's complicated because we have to be sure to remove the
   // entry if *either* of the input RenderStates destructs.  To implement
@@ -20,6 +20,8 @@
 #include "plist.h"
 #include "pmap.h"
 #include "geomNode.h"
+#include "textureAtlas.h"
+#include "geomArrayPool.h"
 #include "config_gobj.h"
 #include "thread.h"
 
@@ -31,6 +33,12 @@ PStatCollector SceneGraphReducer::_collect_collector("*:Flatten:collect");
 PStatCollector SceneGraphReducer::_make_nonindexed_collector("*:Flatten:make nonindexed");
 PStatCollector SceneGraphReducer::_unify_collector("*:Flatten:unify");
 PStatCollector SceneGraphReducer::_remove_unused_collector("*:Flatten:remove unused vertices");
+PStatCollector SceneGraphReducer::_vertex_cache_collector("*:Flatten:optimize vertex cache");
+PStatCollector SceneGraphReducer::_simplify_collector("*:Flatten:simplify");
+PStatCollector SceneGraphReducer::_compress_collector("*:Flatten:compress vertices");
+PStatCollector SceneGraphReducer::_atlas_collector("*:Flatten:atlas textures");
+PStatCollector SceneGraphReducer::_clusters_collector("*:Flatten:make clusters");
+PStatCollector SceneGraphReducer::_share_collector("*:Flatten:share arrays");
 PStatCollector SceneGraphReducer::_premunge_collector("*:Premunge");
 
 /**
@@ -202,6 +210,159 @@ remove_unused_vertices(PandaNode *root) {
   Thread::consider_yield();
 }
 
+/**
+ * Reorders the triangles of every Geom at this level and below for better
+ * use of the post-transform vertex cache, using
+ * GeomPrimitive::optimize_vertex_cache(), and then reorders the vertices
+ * within each GeomVertexData into the order in which they are first used,
+ * which improves the locality of vertex fetches.
+ *
+ * cache_size is the assumed number of entries in the graphics card's vertex
+ * cache, or -1 to use the vertex-cache-size config variable.
+ *
+ * This is best called after collect_vertex_data() and unify(), since those
+ * operations can undo the effect of this one.  The average cache miss ratio
+ * before and after the operation may be queried afterwards with
+ * get_acmr_before() and get_acmr_after().
+ *
+ * The return value is the number of GeomNodes modified.
+ */
+int SceneGraphReducer::
+optimize_vertex_cache(PandaNode *root, int cache_size) {
+  nassertr(check_live_flatten(root), 0);
+  PStatTimer timer(_vertex_cache_collector);
+
+  PN_stdfloat misses_before = 0.0f;
+  PN_stdfloat misses_after = 0.0f;
+  int num_faces = 0;
+  int count = r_optimize_vertex_cache(root, cache_size, misses_before,
+                                      misses_after, num_faces);
+  _transformer.finish_apply();
+
+  if (num_faces != 0) {
+    _acmr_before = misses_before / (PN_stdfloat)num_faces;
+    _acmr_after = misses_after / (PN_stdfloat)num_faces;
+  } else {
+    _acmr_before = 0.0f;
+    _acmr_after = 0.0f;
+  }
+
+  if (pgraph_cat.is_debug()) {
+    pgraph_cat.debug()
+      << "optimize_vertex_cache(" << *root << "): " << num_faces
+      << " faces, ACMR " << _acmr_before << " -> " << _acmr_after << "\n";
+  }
+  return count;
+}
+
+/**
+ * Reduces the number of triangles in every Geom at this level and below to
+ * approximately target_ratio times the original number, using a
+ * GeomSimplifier.  If max_error is not negative, it limits the error (as a
+ * squared distance in the coordinate space of each Geom) that any one edge
+ * collapse may introduce, possibly leaving more triangles than requested.
+ *
+ * The simplified Geoms continue to share the original GeomVertexDatas.  Call
+ * remove_unused_vertices() afterwards if the vertex data should be shrunk as
+ * well.
+ *
+ * The return value is the number of Geoms modified.
+ */
+int SceneGraphReducer::
+simplify(PandaNode *root, PN_stdfloat target_ratio, PN_stdfloat max_error) {
+  nassertr(check_live_flatten(root), 0);
+  PStatTimer timer(_simplify_collector);
+
+  GeomSimplifier simplifier;
+  simplifier.set_max_error(max_error);
+  int count = r_simplify(root, target_ratio, simplifier);
+
+  if (pgraph_cat.is_debug()) {
+    pgraph_cat.debug()
+      << "simplify(" << *root << "): " << simplifier.get_num_triangles_in()
+      << " triangles -> " << simplifier.get_num_triangles_out() << "\n";
+  }
+  return count;
+}
+
+/**
+ * Stores the vertex data of all of the Geoms at this level and below in a
+ * more compact encoding, according to the bits set in flags; see
+ * GeomVertexData::compress_vertices().  This roughly halves the memory used
+ * by typical static models, and the size of the bam files they are written
+ * to.
+ *
+ * The return value is the number of GeomNodes modified.
+ */
+int SceneGraphReducer::
+compress_vertices(PandaNode *root, int flags) {
+  nassertr(check_live_flatten(root), 0);
+  PStatTimer timer(_compress_collector);
+
+  int count = r_compress_vertices(root, flags, _transformer);
+  _transformer.finish_apply();
+  return count;
+}
+
+/**
+ * Packs the small textures used by the Geoms at this level and below onto
+ * shared pages of page_size x page_size pixels, and remaps their texture
+ * coordinates to match, using a TextureAtlas.  Geoms that formerly used
+ * different textures may then share the same state, which allows a
+ * subsequent flatten() or unify() to combine them.
+ *
+ * Only textures applied directly to the Geoms are considered, so this should
+ * normally be called after apply_attribs().  Use TextureAtlas directly for
+ * finer control.
+ *
+ * The return value is the number of Geoms modified.
+ */
+int SceneGraphReducer::
+atlas_textures(PandaNode *root, int page_size) {
+  nassertr(check_live_flatten(root), 0);
+  PStatTimer timer(_atlas_collector);
+
+  TextureAtlas atlas(page_size, page_size);
+  return atlas.atlas(root);
+}
+
+/**
+ * Divides each of the large Geoms at this level and below into clusters of
+ * up to max_triangles adjacent triangles, via Geom::make_clusters(), so that
+ * the cull traversal can cull them piece by piece.  This is most useful after
+ * a flatten_strong() has combined many small objects into a few large Geoms.
+ *
+ * The clusters are lost again if the Geoms are subsequently modified, so this
+ * should be the last step of flattening.
+ *
+ * The return value is the number of Geoms modified.
+ */
+int SceneGraphReducer::
+make_clusters(PandaNode *root, int max_triangles) {
+  nassertr(check_live_flatten(root), 0);
+  PStatTimer timer(_clusters_collector);
+
+  return r_make_clusters(root, max_triangles);
+}
+
+/**
+ * Replaces each of the vertex and index arrays used by the Geoms at this
+ * level and below with an identical array that is already in use elsewhere,
+ * if there is one, via the GeomArrayPool.  This allows meshes that appear in
+ * several different models to share the same memory and vertex buffers.
+ *
+ * The return value is the number of Geoms modified.
+ */
+int SceneGraphReducer::
+share_arrays(PandaNode *root) {
+  nassertr(check_live_flatten(root), 0);
+  PStatTimer timer(_share_collector);
+
+  SharedVertexData shared_data;
+  SharedPrimitives shared_prims;
+  return r_share_arrays(root, shared_data, shared_prims);
+}
+
 /**
  * In a non-release build, returns false if the node is correctly not in a
  * live scene graph.  (Calling flatten on a node that is part of a live scene
@@ -930,6 +1091,52 @@ r_register_vertices(PandaNode *node, GeomTransformer &transformer) {
   }
 }
 
+/**
+ * The recursive implementation of optimize_vertex_cache().  Accumulates the
+ * number of cache misses before and after, and the number of faces, for the
+ * purpose of reporting the average cache miss ratio.
+ */
+int SceneGraphReducer::
+r_optimize_vertex_cache(PandaNode *node, int cache_size,
+                        PN_stdfloat &misses_before, PN_stdfloat &misses_after,
+                        int &num_faces) {
+  int count = 0;
+
+  if (node->is_geom_node()) {
+    GeomNode *geom_node = DCAST(GeomNode, node);
+    int num_geoms = geom_node->get_num_geoms();
+    pvector<int> geom_faces(num_geoms, 0);
+    for (int i = 0; i < num_geoms; ++i) {
+      const Geom *geom = geom_node->get_geom(i);
+      int num_primitives = geom->get_num_primitives();
+      for (int j = 0; j < num_primitives; ++j) {
+        geom_faces[i] += geom->get_primitive(j)->get_num_faces();
+      }
+      num_faces += geom_faces[i];
+      misses_before += geom->calc_acmr(cache_size) * geom_faces[i];
+    }
+
+    if (_transformer.optimize_vertex_cache(geom_node, cache_size)) {
+      ++count;
+    }
+
+    // The vertex reordering, which happens later, doesn't affect the ACMR.
+    for (int i = 0; i < num_geoms; ++i) {
+      misses_after += geom_node->get_geom(i)->calc_acmr(cache_size) * geom_faces[i];
+    }
+  }
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    count += r_optimize_vertex_cache(children.get_child(i), cache_size,
+                                     misses_before, misses_after, num_faces);
+  }
+  Thread::consider_yield();
+
+  return count;
+}
+
 /**
  * The recursive implementation of decompose().
  */
@@ -947,6 +1154,143 @@ r_decompose(PandaNode *node) {
   }
 }
 
+/**
+ * The recursive implementation of simplify().
+ */
+int SceneGraphReducer::
+r_simplify(PandaNode *node, PN_stdfloat target_ratio,
+           GeomSimplifier &simplifier) {
+  int count = 0;
+  if (node->is_geom_node()) {
+    GeomNode *geom_node = DCAST(GeomNode, node);
+    count += simplifier.simplify(geom_node, target_ratio);
+  }
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    count += r_simplify(children.get_child(i), target_ratio, simplifier);
+  }
+  Thread::consider_yield();
+
+  return count;
+}
+
+/**
+ * The recursive implementation of compress_vertices().
+ */
+int SceneGraphReducer::
+r_compress_vertices(PandaNode *node, int flags, GeomTransformer &transformer) {
+  int num_changed = 0;
+
+  if (node->is_geom_node()) {
+    if (transformer.compress_vertices(DCAST(GeomNode, node), flags)) {
+      ++num_changed;
+    }
+  }
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    num_changed += r_compress_vertices(children.get_child(i), flags, transformer);
+  }
+
+  return num_changed;
+}
+
+/**
+ * The recursive implementation of make_clusters().
+ */
+int SceneGraphReducer::
+r_make_clusters(PandaNode *node, int max_triangles) {
+  int num_changed = 0;
+
+  if (node->is_geom_node()) {
+    GeomNode *geom_node = DCAST(GeomNode, node);
+    int num_geoms = geom_node->get_num_geoms();
+    for (int i = 0; i < num_geoms; ++i) {
+      CPT(Geom) orig_geom = geom_node->get_geom(i);
+      const GeomVertexFormat *format = orig_geom->get_vertex_data()->get_format();
+      if (orig_geom->get_num_primitives() == 1 &&
+          orig_geom->get_primitive_type() == Geom::PT_polygons &&
+          format->get_animation().get_animation_type() == Geom::AT_none) {
+        // Only replace the Geom if it was actually divided.
+        PT(Geom) new_geom = orig_geom->make_copy();
+        if (new_geom->make_clusters(max_triangles)) {
+          geom_node->set_geom(i, new_geom);
+          ++num_changed;
+        }
+      }
+    }
+  }
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    num_changed += r_make_clusters(children.get_child(i), max_triangles);
+  }
+
+  return num_changed;
+}
+
+/**
+ * The recursive implementation of share_arrays().  The maps record the
+ * replacement for each GeomVertexData and GeomPrimitive already visited, so
+ * that objects that were shared between Geoms remain shared.
+ */
+int SceneGraphReducer::
+r_share_arrays(PandaNode *node, SharedVertexData &shared_data,
+               SharedPrimitives &shared_prims) {
+  int num_changed = 0;
+
+  if (node->is_geom_node()) {
+    GeomNode *geom_node = DCAST(GeomNode, node);
+    int num_geoms = geom_node->get_num_geoms();
+    for (int i = 0; i < num_geoms; ++i) {
+      CPT(Geom) orig_geom = geom_node->get_geom(i);
+      bool any_changed = false;
+
+      CPT(GeomVertexData) orig_data = orig_geom->get_vertex_data();
+      SharedVertexData::iterator di = shared_data.find(orig_data);
+      if (di == shared_data.end()) {
+        di = shared_data.insert(SharedVertexData::value_type(orig_data, GeomArrayPool::share_vertex_data(orig_data))).first;
+      }
+      CPT(GeomVertexData) new_data = (*di).second;
+      any_changed = (new_data != orig_data);
+
+      int num_prims = orig_geom->get_num_primitives();
+      pvector<CPT(GeomPrimitive)> new_prims;
+      new_prims.reserve(num_prims);
+      for (int j = 0; j < num_prims; ++j) {
+        CPT(GeomPrimitive) orig_prim = orig_geom->get_primitive(j);
+        SharedPrimitives::iterator pi = shared_prims.find(orig_prim);
+        if (pi == shared_prims.end()) {
+          pi = shared_prims.insert(SharedPrimitives::value_type(orig_prim, GeomArrayPool::share_primitive(orig_prim))).first;
+        }
+        new_prims.push_back((*pi).second);
+        any_changed = any_changed || ((*pi).second != orig_prim);
+      }
+
+      if (any_changed) {
+        PT(Geom) geom = geom_node->modify_geom(i);
+        geom->set_vertex_data(new_data);
+        for (int j = 0; j < num_prims; ++j) {
+          geom->set_primitive(j, new_prims[j]);
+        }
+        ++num_changed;
+      }
+    }
+  }
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    num_changed += r_share_arrays(children.get_child(i), shared_data, shared_prims);
+  }
+
+  return num_changed;
+}
+
 /**
  * The recursive implementation of premunge().
  */
@@ -20,6 +20,8 @@
 #include "renderState.h"
 #include "accumulatedAttribs.h"
 #include "geomTransformer.h"
+#include "geomSimplifier.h"
+#include "geomVertexData.h"
 #include "pStatCollector.h"
 #include "pStatTimer.h"
 #include "typedObject.h"
@@ -138,6 +140,22 @@ PUBLISHED:
   void unify(PandaNode *root, bool preserve_order);
   void remove_unused_vertices(PandaNode *root);
 
+  int optimize_vertex_cache(PandaNode *root, int cache_size = -1);
+  INLINE PN_stdfloat get_acmr_before() const;
+  INLINE PN_stdfloat get_acmr_after() const;
+
+  int simplify(PandaNode *root, PN_stdfloat target_ratio,
+               PN_stdfloat max_error = -1.0f);
+
+  int compress_vertices(PandaNode *root,
+                        int flags = GeomVertexData::CF_all);
+
+  int atlas_textures(PandaNode *root, int page_size = 1024);
+
+  int make_clusters(PandaNode *root, int max_triangles = 64);
+
+  int share_arrays(PandaNode *root);
+
   INLINE void premunge(PandaNode *root, const RenderState *initial_state);
   bool check_live_flatten(PandaNode *node);
 
@@ -176,13 +194,28 @@ protected:
   int r_make_nonindexed(PandaNode *node, int collect_bits);
   void r_unify(PandaNode *node, int max_indices, bool preserve_order);
   void r_register_vertices(PandaNode *node, GeomTransformer &transformer);
+  int r_optimize_vertex_cache(PandaNode *node, int cache_size,
+                              PN_stdfloat &misses_before,
+                              PN_stdfloat &misses_after, int &num_faces);
   void r_decompose(PandaNode *node);
+  int r_simplify(PandaNode *node, PN_stdfloat target_ratio,
+                 GeomSimplifier &simplifier);
+  int r_compress_vertices(PandaNode *node, int flags,
+                          GeomTransformer &transformer);
+  int r_make_clusters(PandaNode *node, int max_triangles);
+
+  typedef pmap<CPT(GeomVertexData), CPT(GeomVertexData) > SharedVertexData;
+  typedef pmap<CPT(GeomPrimitive), CPT(GeomPrimitive) > SharedPrimitives;
+  int r_share_arrays(PandaNode *node, SharedVertexData &shared_data,
+                     SharedPrimitives &shared_prims);
 
   void r_premunge(PandaNode *node, const RenderState *state);
 
 private:
   PT(GraphicsStateGuardianBase) _gsg;
   PN_stdfloat _combine_radius;
+  PN_stdfloat _acmr_before;
+  PN_stdfloat _acmr_after;
   GeomTransformer _transformer;
 
   static PStatCollector _flatten_collector;
@@ -193,6 +226,12 @@ private:
   static PStatCollector _make_nonindexed_collector;
   static PStatCollector _unify_collector;
   static PStatCollector _remove_unused_collector;
+  static PStatCollector _vertex_cache_collector;
+  static PStatCollector _simplify_collector;
+  static PStatCollector _compress_collector;
+  static PStatCollector _atlas_collector;
+  static PStatCollector _clusters_collector;
+  static PStatCollector _share_collector;
   static PStatCollector _premunge_collector;
 };
 
@@ -119,6 +119,9 @@ PUBLISHED:
   MAKE_PROPERTY(instance_count, get_instance_count);
 
 public:
+  typedef pmap<CPT_InternalName, CPT(ShaderInput)> Inputs;
+  INLINE const Inputs &get_shader_inputs() const;
+
   virtual void output(ostream &out) const;
 
 protected:
@@ -143,7 +146,6 @@ private:
   bool        _auto_ramp_on;
   bool        _auto_shadow_on;
 
-  typedef pmap<CPT_InternalName, CPT(ShaderInput)> Inputs;
   Inputs _inputs;
 
 PUBLISHED:
@@ -0,0 +1,628 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file textureAtlas.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "textureAtlas.h"
+#include "geomNode.h"
+#include "geomVertexReader.h"
+#include "geomVertexRewriter.h"
+#include "textureAttrib.h"
+#include "texMatrixAttrib.h"
+#include "texGenAttrib.h"
+#include "renderState.h"
+#include "pnmImage.h"
+#include "config_pgraph.h"
+#include <algorithm>
+
+// Texture coordinates are allowed to stray this far outside the range 0 .. 1
+// and still be considered to address only the one copy of the texture.
+static const PN_stdfloat texcoord_epsilon = 0.001f;
+
+/**
+ * Returns the smallest power of two that is at least x, but no larger than
+ * limit.
+ */
+static int
+round_up_pow2(int x, int limit) {
+  int result = 1;
+  while (result < x) {
+    result <<= 1;
+  }
+  return min(result, limit);
+}
+
+/**
+ *
+ */
+TextureAtlas::
+TextureAtlas(int page_x_size, int page_y_size) :
+  _page_x_size(page_x_size),
+  _page_y_size(page_y_size),
+  _padding(4),
+  _max_texture_size(min(page_x_size, page_y_size) / 2)
+{
+}
+
+/**
+ *
+ */
+TextureAtlas::
+~TextureAtlas() {
+}
+
+/**
+ * Packs the eligible textures used by the Geoms at this node and below onto
+ * as few pages as possible, and rewrites the Geoms to use the pages instead.
+ * New pages are created on each call; they may be retrieved afterwards with
+ * get_page().  A page that would hold only one texture is not created.
+ *
+ * Returns the number of Geoms modified.
+ */
+int TextureAtlas::
+atlas(PandaNode *root) {
+  _placements.clear();
+  _placement_index.clear();
+  _uses.clear();
+  _checked_texcoords.clear();
+
+  r_collect(root);
+  int count = 0;
+  if (!_placements.empty()) {
+    size_t first_page = _pages.size();
+    pack();
+    make_pages(first_page);
+    count = apply();
+
+    if (pgraph_cat.is_debug()) {
+      pgraph_cat.debug()
+        << "atlas(" << *root << "): placed " << get_num_placed_textures()
+        << " of " << _placements.size() << " textures on "
+        << _pages.size() - first_page << " pages, modified " << count
+        << " Geoms\n";
+    }
+  }
+
+  _uses.clear();
+  _checked_texcoords.clear();
+  return count;
+}
+
+/**
+ * Records the Geoms at this node and below whose textures might be packed,
+ * and the textures they use.
+ */
+void TextureAtlas::
+r_collect(PandaNode *node) {
+  if (node->is_geom_node()) {
+    GeomNode *geom_node = DCAST(GeomNode, node);
+    int num_geoms = geom_node->get_num_geoms();
+    for (int gi = 0; gi < num_geoms; ++gi) {
+      TextureStage *stage;
+      Texture *tex;
+      if (get_candidate(geom_node, gi, stage, tex)) {
+        CPT(GeomVertexData) vdata = geom_node->get_geom(gi)->get_vertex_data();
+        if (check_texcoords(vdata, stage->get_texcoord_name())) {
+          Use use;
+          use._node = geom_node;
+          use._geom_index = gi;
+          _uses.push_back(use);
+
+          if (_placement_index.find(tex) == _placement_index.end()) {
+            Placement placement;
+            placement._source = tex;
+            placement._x_size = tex->get_x_size();
+            placement._y_size = tex->get_y_size();
+            placement._page = -1;
+            placement._x = 0;
+            placement._y = 0;
+            _placement_index[tex] = (int)_placements.size();
+            _placements.push_back(placement);
+          }
+        }
+      }
+    }
+  }
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    r_collect(children.get_child(i));
+  }
+}
+
+/**
+ * If the nth Geom of the indicated GeomNode has a single texture that is a
+ * candidate for packing, fills in its stage and texture and returns true.
+ * Otherwise, returns false.
+ */
+bool TextureAtlas::
+get_candidate(const GeomNode *node, int gi, TextureStage *&stage,
+              Texture *&tex) const {
+  const RenderState *state = node->get_geom_state(gi);
+
+  const TextureAttrib *ta;
+  if (!state->get_attrib(ta) || ta->get_num_on_stages() != 1) {
+    return false;
+  }
+  stage = ta->get_on_stage(0);
+  tex = ta->get_on_texture(stage);
+  if (tex == (Texture *)NULL) {
+    return false;
+  }
+
+  // We can't remap texture coordinates that are transformed or generated.
+  const TexMatrixAttrib *tma;
+  if (state->get_attrib(tma) && tma->has_stage(stage)) {
+    return false;
+  }
+  const TexGenAttrib *tga;
+  if (state->get_attrib(tga) && tga->has_stage(stage)) {
+    return false;
+  }
+
+  return is_candidate_texture(tex);
+}
+
+/**
+ * Returns true if the indicated texture is of a kind that can be packed onto
+ * a page.
+ */
+bool TextureAtlas::
+is_candidate_texture(Texture *tex) const {
+  if (tex->get_texture_type() != Texture::TT_2d_texture ||
+      tex->get_num_views() != 1 ||
+      tex->get_component_type() != Texture::T_unsigned_byte) {
+    return false;
+  }
+
+  if (tex->get_pad_x_size() != 0 || tex->get_pad_y_size() != 0) {
+    // The texture coordinates have already been scaled to address part of
+    // the texture.
+    return false;
+  }
+
+  int x_size = tex->get_x_size();
+  int y_size = tex->get_y_size();
+  if (x_size <= 0 || y_size <= 0 ||
+      x_size > _max_texture_size || y_size > _max_texture_size ||
+      x_size + _padding * 2 > _page_x_size ||
+      y_size + _padding * 2 > _page_y_size) {
+    return false;
+  }
+
+  return tex->might_have_ram_image();
+}
+
+/**
+ * Returns true if the named texture coordinates of the indicated vertex data
+ * all fall within the range 0 .. 1, so that they may be remapped onto a
+ * page.  The result is cached.
+ */
+bool TextureAtlas::
+check_texcoords(const GeomVertexData *vdata, const InternalName *name) {
+  TexcoordKey key(vdata, name);
+  CheckedTexcoords::const_iterator ci = _checked_texcoords.find(key);
+  if (ci != _checked_texcoords.end()) {
+    return (*ci).second;
+  }
+
+  bool result = true;
+  GeomVertexReader reader(vdata, name);
+  if (!reader.has_column()) {
+    result = false;
+  }
+  while (result && !reader.is_at_end()) {
+    const LVecBase2 &uv = reader.get_data2();
+    if (uv[0] < -texcoord_epsilon || uv[0] > 1.0f + texcoord_epsilon ||
+        uv[1] < -texcoord_epsilon || uv[1] > 1.0f + texcoord_epsilon) {
+      result = false;
+    }
+  }
+
+  _checked_texcoords[key] = result;
+  return result;
+}
+
+/**
+ * Assigns each of the textures in _placements to a position on one of the
+ * pages, creating new pages as needed.  Pages that end up holding only one
+ * texture are discarded again, along with their placement.
+ */
+void TextureAtlas::
+pack() {
+  size_t first_page = _pages.size();
+
+  // Place the tallest textures first, which gives the skyline packer the
+  // best chance to fill each page.
+  typedef pvector<pair<int, int> > Order;
+  Order order;
+  order.reserve(_placements.size());
+  for (size_t i = 0; i < _placements.size(); ++i) {
+    order.push_back(pair<int, int>(-_placements[i]._y_size, (int)i));
+  }
+  sort(order.begin(), order.end());
+
+  pvector<Skyline> skylines;
+  Order::const_iterator oi;
+  for (oi = order.begin(); oi != order.end(); ++oi) {
+    Placement &placement = _placements[(*oi).second];
+    PageGroup group(placement._source);
+    int x_size = placement._x_size + _padding * 2;
+    int y_size = placement._y_size + _padding * 2;
+
+    int x, y;
+    for (size_t si = 0; si < skylines.size(); ++si) {
+      const PageGroup &page_group = _page_groups[first_page + si];
+      if (!(group < page_group) && !(page_group < group) &&
+          skylines[si].insert(x_size, y_size, x, y)) {
+        placement._page = (int)(first_page + si);
+        break;
+      }
+    }
+
+    if (placement._page < 0) {
+      // It didn't fit on any existing page; start a new one.
+      skylines.push_back(Skyline(_page_x_size, _page_y_size));
+      if (skylines.back().insert(x_size, y_size, x, y)) {
+        placement._page = (int)_pages.size();
+        _pages.push_back(NULL);
+        _page_groups.push_back(group);
+      } else {
+        skylines.pop_back();
+        continue;
+      }
+    }
+
+    placement._x = x + _padding;
+    placement._y = y + _padding;
+  }
+
+  // Now count the textures on each new page, and drop the pages that don't
+  // accomplish anything.
+  pvector<int> counts(_pages.size() - first_page, 0);
+  pvector<Placement>::iterator pi;
+  for (pi = _placements.begin(); pi != _placements.end(); ++pi) {
+    if ((*pi)._page >= 0) {
+      ++counts[(*pi)._page - first_page];
+    }
+  }
+
+  pvector<int> remap(counts.size(), -1);
+  size_t num_pages = first_page;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    if (counts[i] >= 2) {
+      _page_groups[num_pages] = _page_groups[first_page + i];
+      remap[i] = (int)num_pages;
+      ++num_pages;
+    }
+  }
+  _pages.resize(num_pages);
+  _page_groups.resize(num_pages, PageGroup(NULL));
+
+  for (pi = _placements.begin(); pi != _placements.end(); ++pi) {
+    if ((*pi)._page >= 0) {
+      (*pi)._page = remap[(*pi)._page - first_page];
+    }
+  }
+}
+
+/**
+ * Creates the Textures for the pages assigned by pack(), beginning at the
+ * indicated page, and copies the source textures into them.
+ */
+void TextureAtlas::
+make_pages(size_t first_page) {
+  for (size_t p = first_page; p < _pages.size(); ++p) {
+    const PageGroup &group = _page_groups[p];
+
+    // Shrink the page to the area actually used, rounded up to a power of
+    // two.
+    int used_x = 1;
+    int used_y = 1;
+    pvector<Placement>::iterator pi;
+    for (pi = _placements.begin(); pi != _placements.end(); ++pi) {
+      const Placement &placement = (*pi);
+      if (placement._page == (int)p) {
+        used_x = max(used_x, placement._x + placement._x_size + _padding);
+        used_y = max(used_y, placement._y + placement._y_size + _padding);
+      }
+    }
+    int x_size = round_up_pow2(used_x, _page_x_size);
+    int y_size = round_up_pow2(used_y, _page_y_size);
+
+    int num_channels = group._alpha ? 4 : 3;
+    PNMImage page(x_size, y_size, num_channels);
+
+    for (pi = _placements.begin(); pi != _placements.end(); ++pi) {
+      Placement &placement = (*pi);
+      if (placement._page != (int)p) {
+        continue;
+      }
+
+      PNMImage image;
+      if (!placement._source->store(image) ||
+          image.get_x_size() != placement._x_size ||
+          image.get_y_size() != placement._y_size) {
+        pgraph_cat.warning()
+          << "Couldn't get image for " << placement._source->get_name()
+          << "; not placing it on an atlas page.\n";
+        placement._page = -1;
+        continue;
+      }
+      if (image.get_num_channels() != num_channels) {
+        image.set_num_channels(num_channels);
+      }
+      page.copy_sub_image(image, placement._x, placement._y);
+
+      // Fill in the border by repeating the edge pixels outward.
+      int x0 = placement._x;
+      int y0 = placement._y;
+      int x1 = x0 + placement._x_size - 1;
+      int y1 = y0 + placement._y_size - 1;
+      for (int y = y0 - _padding; y <= y1 + _padding; ++y) {
+        int sy = max(y0, min(y, y1));
+        for (int x = x0 - _padding; x <= x1 + _padding; ++x) {
+          int sx = max(x0, min(x, x1));
+          if (sx != x || sy != y) {
+            page.set_xel_val(x, y, page.get_xel_val(sx, sy));
+            if (page.has_alpha()) {
+              page.set_alpha_val(x, y, page.get_alpha_val(sx, sy));
+            }
+          }
+        }
+      }
+
+      // The PNMImage is stored upside-down relative to the texture
+      // coordinates.
+      placement._scale.set((PN_stdfloat)placement._x_size / x_size,
+                           (PN_stdfloat)placement._y_size / y_size);
+      placement._offset.set((PN_stdfloat)x0 / x_size,
+                            (PN_stdfloat)(y_size - 1 - y1) / y_size);
+    }
+
+    ostringstream strm;
+    strm << "atlas_" << p;
+    PT(Texture) tex = new Texture(strm.str());
+    tex->load(page);
+    if (group._srgb) {
+      tex->set_format(group._alpha ? Texture::F_srgb_alpha : Texture::F_srgb);
+    }
+    tex->set_minfilter(group._minfilter);
+    tex->set_magfilter(group._magfilter);
+    tex->set_anisotropic_degree(group._anisotropic_degree);
+    tex->set_wrap_u(SamplerState::WM_clamp);
+    tex->set_wrap_v(SamplerState::WM_clamp);
+
+    if (SamplerState::is_mipmap(group._minfilter)) {
+      // Each texel of mipmap level n covers 2^n pixels of the page, and a
+      // sample near the edge of a texture also reads the texel beyond it, so
+      // the border only keeps out the neighboring textures as long as 2^(n+1)
+      // does not exceed the padding.  Don't let the smaller levels be used.
+      int max_level = 0;
+      while ((2 << (max_level + 1)) <= _padding) {
+        ++max_level;
+      }
+      SamplerState sampler = tex->get_default_sampler();
+      sampler.set_max_lod((PN_stdfloat)max_level);
+      tex->set_default_sampler(sampler);
+    }
+    _pages[p] = tex;
+  }
+}
+
+/**
+ * Replaces the texture of each recorded Geom with its page, and remaps its
+ * texture coordinates accordingly.  Returns the number of Geoms modified.
+ */
+int TextureAtlas::
+apply() {
+  // The remapped vertex datas, so that Geoms that share a GeomVertexData and
+  // a texture will continue to share the new GeomVertexData.
+  typedef pair<const GeomVertexData *, Texture *> VDataKey;
+  typedef pmap<VDataKey, CPT(GeomVertexData) > NewVertexDatas;
+  NewVertexDatas new_vdatas;
+
+  int count = 0;
+  Uses::const_iterator ui;
+  for (ui = _uses.begin(); ui != _uses.end(); ++ui) {
+    GeomNode *node = (*ui)._node;
+    int gi = (*ui)._geom_index;
+
+    TextureStage *stage;
+    Texture *tex;
+    if (!get_candidate(node, gi, stage, tex)) {
+      continue;
+    }
+    Placements::const_iterator pi = _placement_index.find(tex);
+    nassertd(pi != _placement_index.end()) continue;
+    const Placement &placement = _placements[(*pi).second];
+    if (placement._page < 0) {
+      continue;
+    }
+
+    CPT(Geom) geom = node->get_geom(gi);
+    CPT(GeomVertexData) vdata = geom->get_vertex_data();
+
+    VDataKey key(vdata, tex);
+    NewVertexDatas::const_iterator vi = new_vdatas.find(key);
+    CPT(GeomVertexData) new_vdata;
+    if (vi != new_vdatas.end()) {
+      new_vdata = (*vi).second;
+
+    } else {
+      PT(GeomVertexData) modify = new GeomVertexData(*vdata);
+      GeomVertexRewriter rewriter(modify, stage->get_texcoord_name());
+      while (!rewriter.is_at_end()) {
+        LVecBase3 uv = rewriter.get_data3();
+        rewriter.set_data3(uv[0] * placement._scale[0] + placement._offset[0],
+                           uv[1] * placement._scale[1] + placement._offset[1],
+                           uv[2]);
+      }
+      new_vdata = modify;
+      new_vdatas[key] = new_vdata;
+    }
+
+    PT(Geom) new_geom = geom->make_copy();
+    new_geom->set_vertex_data(new_vdata);
+
+    CPT(RenderState) state = node->get_geom_state(gi);
+    const TextureAttrib *ta = DCAST(TextureAttrib, state->get_attrib(TextureAttrib::get_class_slot()));
+    CPT(RenderAttrib) new_ta =
+      ta->add_on_stage(stage, _pages[placement._page],
+                       ta->get_on_stage_override(stage));
+
+    node->set_geom(gi, new_geom);
+    node->set_geom_state(gi, state->set_attrib(new_ta));
+    ++count;
+  }
+
+  return count;
+}
+
+/**
+ *
+ */
+TextureAtlas::PageGroup::
+PageGroup(Texture *tex) {
+  if (tex != (Texture *)NULL) {
+    _alpha = Texture::has_alpha(tex->get_format());
+    _srgb = Texture::is_srgb(tex->get_format());
+    _minfilter = tex->get_minfilter();
+    _magfilter = tex->get_magfilter();
+    _anisotropic_degree = tex->get_anisotropic_degree();
+  } else {
+    _alpha = false;
+    _srgb = false;
+    _minfilter = SamplerState::FT_default;
+    _magfilter = SamplerState::FT_default;
+    _anisotropic_degree = 0;
+  }
+}
+
+/**
+ *
+ */
+bool TextureAtlas::PageGroup::
+operator < (const PageGroup &other) const {
+  if (_alpha != other._alpha) {
+    return (int)_alpha < (int)other._alpha;
+  }
+  if (_srgb != other._srgb) {
+    return (int)_srgb < (int)other._srgb;
+  }
+  if (_minfilter != other._minfilter) {
+    return _minfilter < other._minfilter;
+  }
+  if (_magfilter != other._magfilter) {
+    return _magfilter < other._magfilter;
+  }
+  return _anisotropic_degree < other._anisotropic_degree;
+}
+
+/**
+ *
+ */
+TextureAtlas::Skyline::
+Skyline(int x_size, int y_size) :
+  _x_size(x_size),
+  _y_size(y_size)
+{
+  Segment segment;
+  segment._x = 0;
+  segment._y = 0;
+  segment._width = x_size;
+  _segments.push_back(segment);
+}
+
+/**
+ * Finds a place for a rectangle of the indicated size, as low as possible,
+ * and marks it used.  Returns true and fills in x and y on success, or
+ * returns false if there is no room left.
+ */
+bool TextureAtlas::Skyline::
+insert(int x_size, int y_size, int &x, int &y) {
+  int best = -1;
+  int best_y = 0;
+  for (size_t si = 0; si < _segments.size(); ++si) {
+    int sy;
+    if (fit(si, x_size, y_size, sy) && (best < 0 || sy < best_y)) {
+      best = (int)si;
+      best_y = sy;
+    }
+  }
+  if (best < 0) {
+    return false;
+  }
+
+  x = _segments[best]._x;
+  y = best_y;
+
+  // Add a new segment for the top of the rectangle, and trim the segments
+  // that it covers.
+  Segment segment;
+  segment._x = x;
+  segment._y = y + y_size;
+  segment._width = x_size;
+  _segments.insert(_segments.begin() + best, segment);
+
+  int end = x + x_size;
+  size_t si = best + 1;
+  while (si < _segments.size() && _segments[si]._x < end) {
+    Segment &next = _segments[si];
+    int overlap = end - next._x;
+    if (overlap >= next._width) {
+      _segments.erase(_segments.begin() + si);
+    } else {
+      next._x += overlap;
+      next._width -= overlap;
+      break;
+    }
+  }
+
+  // Merge adjacent segments of the same height.
+  si = 0;
+  while (si + 1 < _segments.size()) {
+    if (_segments[si]._y == _segments[si + 1]._y) {
+      _segments[si]._width += _segments[si + 1]._width;
+      _segments.erase(_segments.begin() + si + 1);
+    } else {
+      ++si;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Returns true if a rectangle of the indicated size fits with its left edge
+ * at the start of the indicated segment, and fills in the lowest y at which
+ * it can be placed there.
+ */
+bool TextureAtlas::Skyline::
+fit(size_t si, int x_size, int y_size, int &y) const {
+  if (_segments[si]._x + x_size > _x_size) {
+    return false;
+  }
+
+  y = 0;
+  int width_left = x_size;
+  while (width_left > 0) {
+    nassertr(si < _segments.size(), false);
+    y = max(y, _segments[si]._y);
+    if (y + y_size > _y_size) {
+      return false;
+    }
+    width_left -= _segments[si]._width;
+    ++si;
+  }
+  return true;
+}
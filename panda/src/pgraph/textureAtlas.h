@@ -0,0 +1,157 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file textureAtlas.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include "pandabase.h"
+
+#include "texture.h"
+#include "textureStage.h"
+#include "geomVertexData.h"
+#include "internalName.h"
+#include "pointerTo.h"
+#include "pvector.h"
+#include "pmap.h"
+
+class PandaNode;
+class GeomNode;
+
+/**
+ * Packs the small textures used by the Geoms of a scene graph into a few
+ * larger textures, or pages, and rewrites the texture coordinates of those
+ * Geoms to address the corresponding region of the page.  Since Geoms that
+ * previously used different textures may then share a state, this allows
+ * flatten_strong() to combine many more of them into a single Geom.  This is
+ * a runtime counterpart to egg-palettize.
+ *
+ * Only Geoms with a single texture, applied directly on the Geom's own state,
+ * are considered; call SceneGraphReducer::apply_attribs() first to push the
+ * textures down.  A texture is only packed for a particular GeomVertexData if
+ * all of its texture coordinates fall within the range 0 .. 1, since a
+ * repeating texture cannot be represented in an atlas, and if there is no
+ * TexMatrixAttrib or TexGenAttrib on its stage.
+ *
+ * Each texture is surrounded by a border of padding pixels, which repeat its
+ * edge pixels, so that filtering and the smaller mipmap levels don't bleed in
+ * color from its neighbors.  Textures with different filter settings, or
+ * different alpha or sRGB formats, are never placed on the same page.
+ */
+class EXPCL_PANDA_PGRAPH TextureAtlas {
+PUBLISHED:
+  TextureAtlas(int page_x_size = 1024, int page_y_size = 1024);
+  ~TextureAtlas();
+
+  INLINE int get_page_x_size() const;
+  INLINE int get_page_y_size() const;
+
+  INLINE void set_padding(int padding);
+  INLINE int get_padding() const;
+  MAKE_PROPERTY(padding, get_padding, set_padding);
+
+  INLINE void set_max_texture_size(int max_texture_size);
+  INLINE int get_max_texture_size() const;
+  MAKE_PROPERTY(max_texture_size, get_max_texture_size, set_max_texture_size);
+
+  int atlas(PandaNode *root);
+
+  INLINE int get_num_pages() const;
+  INLINE Texture *get_page(int n) const;
+  MAKE_SEQ(get_pages, get_num_pages, get_page);
+  MAKE_SEQ_PROPERTY(pages, get_num_pages, get_page);
+
+  INLINE int get_num_placed_textures() const;
+  MAKE_PROPERTY(num_placed_textures, get_num_placed_textures);
+
+private:
+  // Textures are only packed onto the same page if they agree on all of
+  // these properties.
+  class PageGroup {
+  public:
+    PageGroup(Texture *tex);
+    bool operator < (const PageGroup &other) const;
+
+    bool _alpha;
+    bool _srgb;
+    SamplerState::FilterType _minfilter;
+    SamplerState::FilterType _magfilter;
+    int _anisotropic_degree;
+  };
+
+  // The position of one source texture within one of the pages.
+  class Placement {
+  public:
+    PT(Texture) _source;
+    int _x_size, _y_size;
+    int _page;
+    int _x, _y;
+    LTexCoord _scale;
+    LTexCoord _offset;
+  };
+  typedef pmap<Texture *, int> Placements;
+
+  // A Geom that might have its texture replaced.
+  class Use {
+  public:
+    PT(GeomNode) _node;
+    int _geom_index;
+  };
+  typedef pvector<Use> Uses;
+
+  // Packs rectangles into a single page, by keeping track of the height of
+  // the highest rectangle at each horizontal position.
+  class Skyline {
+  public:
+    Skyline(int x_size, int y_size);
+    bool insert(int x_size, int y_size, int &x, int &y);
+
+  private:
+    class Segment {
+    public:
+      int _x, _y, _width;
+    };
+    typedef pvector<Segment> Segments;
+    bool fit(size_t si, int x_size, int y_size, int &y) const;
+
+    Segments _segments;
+    int _x_size, _y_size;
+  };
+
+  void r_collect(PandaNode *node);
+  bool get_candidate(const GeomNode *node, int gi, TextureStage *&stage,
+                     Texture *&tex) const;
+  bool is_candidate_texture(Texture *tex) const;
+  bool check_texcoords(const GeomVertexData *vdata, const InternalName *name);
+
+  void pack();
+  void make_pages(size_t first_page);
+  int apply();
+
+  int _page_x_size, _page_y_size;
+  int _padding;
+  int _max_texture_size;
+
+  pvector<PT(Texture)> _pages;
+  pvector<PageGroup> _page_groups;
+  pvector<Placement> _placements;
+  Placements _placement_index;
+  Uses _uses;
+
+  typedef pair<const GeomVertexData *, const InternalName *> TexcoordKey;
+  typedef pmap<TexcoordKey, bool> CheckedTexcoords;
+  CheckedTexcoords _checked_texcoords;
+};
+
+#include "textureAtlas.I"
+
+#endif
@@ -37,6 +37,7 @@
 #include "shaderAttrib.h"
 #include "colorAttrib.h"
 #include "clipPlaneAttrib.h"
+#include "sceneGraphReducer.h"
 
 TypeHandle LODNode::_type_handle;
 
@@ -276,6 +277,33 @@ hide_all_switches() {
   mark_internal_bounds_stale();
 }
 
+/**
+ * Adds a new level of detail, which is a copy of the indicated source
+ * subgraph with its triangle count reduced to approximately target_ratio
+ * times the original, and a switch for it with the indicated in and out
+ * distances.  See SceneGraphReducer::simplify().
+ *
+ * This may be called repeatedly, with decreasing ratios and increasing
+ * distances, to generate a complete set of levels from a single source
+ * model.  All of the levels share the source model's vertex data.  Returns
+ * the new child node.
+ */
+PT(PandaNode) LODNode::
+add_simplified_level(PandaNode *source, PN_stdfloat target_ratio,
+                     PN_stdfloat in, PN_stdfloat out, PN_stdfloat max_error) {
+  nassertr(source != (PandaNode *)NULL, NULL);
+
+  PT(PandaNode) level = source->copy_subgraph();
+  if (target_ratio < 1.0f) {
+    SceneGraphReducer gr;
+    gr.simplify(level, target_ratio, max_error);
+  }
+
+  add_child(level);
+  add_switch(in, out);
+  return level;
+}
+
 /**
  * Returns true if the bounding volumes for the geometry of each fhild node
  * entirely fits within the switch_in radius for that child, or false
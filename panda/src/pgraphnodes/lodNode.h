@@ -91,6 +91,11 @@ PUBLISHED:
 
   bool verify_child_bounds() const;
 
+  PT(PandaNode) add_simplified_level(PandaNode *source,
+                                     PN_stdfloat target_ratio,
+                                     PN_stdfloat in, PN_stdfloat out,
+                                     PN_stdfloat max_error = -1.0f);
+
 protected:
   int compute_child(CullTraverser *trav, CullTraverserData &data);
 
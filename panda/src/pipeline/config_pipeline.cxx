@@ -53,6 +53,15 @@ ConfigVariableInt thread_stack_size
           "created for each newly-created thread.  Not all thread "
           "implementations respect this value."));
 
+ConfigVariableInt worker_pool_threads
+("worker-pool-threads", -1,
+ PRC_DESC("Specifies the number of threads in the global WorkerPool, which "
+          "is used to spread low-level operations on large blocks of data, "
+          "such as image filters, over several CPU cores.  The default, -1, "
+          "means to create one fewer thread than there are CPU cores, since "
+          "the calling thread also takes part.  Set this to 0 to do all of "
+          "this work in the calling thread."));
+
 /**
  * Initializes the library.  This must be called at least once before any of
  * the functions or classes in this library can be used.  Normally it will be
@@ -20,3 +20,4 @@
 #include "threadSimpleManager.cxx"
 #include "threadWin32Impl.cxx"
 #include "threadPriority.cxx"
+#include "workerPool.cxx"
@@ -0,0 +1,204 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file workerPool.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "workerPool.h"
+#include "config_pipeline.h"
+#include "mutexHolder.h"
+#include "atomicAdjust.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+WorkerPool *WorkerPool::_global_ptr = NULL;
+
+/**
+ *
+ */
+WorkerPool::Job::
+~Job() {
+}
+
+/**
+ * Creates a pool with the indicated number of threads, in addition to the
+ * thread that calls run().  If threading is not available, no threads are
+ * created.
+ */
+WorkerPool::
+WorkerPool(int num_threads) :
+  _work_cvar(_lock),
+  _done_cvar(_lock),
+  _job(NULL),
+  _next(0),
+  _count(0),
+  _grain(1),
+  _num_active(0),
+  _shutdown(false)
+{
+  if (!Thread::is_true_threads() || !support_threads) {
+    return;
+  }
+
+  for (int i = 0; i < num_threads; ++i) {
+    ostringstream strm;
+    strm << "worker_" << i;
+    PT(GenericThread) thread = new GenericThread(strm.str(), strm.str(), &thread_func, this);
+    if (!thread->start(TP_normal, true)) {
+      break;
+    }
+    _threads.push_back(thread);
+  }
+}
+
+/**
+ * Stops and joins all of the threads.
+ */
+WorkerPool::
+~WorkerPool() {
+  _lock.acquire();
+  _shutdown = true;
+  _work_cvar.notify_all();
+  _lock.release();
+
+  Threads::iterator ti;
+  for (ti = _threads.begin(); ti != _threads.end(); ++ti) {
+    (*ti)->join();
+  }
+}
+
+/**
+ * Calls job.execute() on subranges of [0, count) of about grain indices each,
+ * spread over the threads of the pool and the calling thread, and returns
+ * when all of them have completed.
+ */
+void WorkerPool::
+run(Job &job, int count, int grain) {
+  if (count <= 0) {
+    return;
+  }
+  grain = max(grain, 1);
+  if (_threads.empty() || count <= grain) {
+    job.execute(0, count);
+    return;
+  }
+
+  _lock.acquire();
+  if (_job != NULL) {
+    // We're already busy.  Just do it ourselves.
+    _lock.release();
+    job.execute(0, count);
+    return;
+  }
+
+  _job = &job;
+  _next = 0;
+  _count = count;
+  _grain = grain;
+  _work_cvar.notify_all();
+
+  while (_next < _count) {
+    int begin = _next;
+    int end = min(begin + _grain, _count);
+    _next = end;
+    ++_num_active;
+    _lock.release();
+    job.execute(begin, end);
+    _lock.acquire();
+    --_num_active;
+  }
+
+  while (_num_active > 0) {
+    _done_cvar.wait();
+  }
+  _job = NULL;
+  _lock.release();
+}
+
+/**
+ * Creates the global WorkerPool.  If another thread beats us to it, the pool
+ * we created is discarded again.
+ */
+void WorkerPool::
+make_global_ptr() {
+  int num_threads = worker_pool_threads;
+  if (num_threads < 0) {
+    num_threads = get_num_cpu_cores() - 1;
+  }
+  WorkerPool *ptr = new WorkerPool(max(num_threads, 0));
+  void *result = AtomicAdjust::compare_and_exchange_ptr
+    ((void * TVOLATILE &)_global_ptr, (void *)NULL, (void *)ptr);
+  if (result != NULL) {
+    // Someone else got there first.
+    delete ptr;
+  }
+  assert(_global_ptr != (WorkerPool *)NULL);
+}
+
+/**
+ * Returns the number of logical CPU cores available to the process, or 1 if
+ * this cannot be determined.
+ */
+int WorkerPool::
+get_num_cpu_cores() {
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return max((int)info.dwNumberOfProcessors, 1);
+#elif defined(_SC_NPROCESSORS_ONLN)
+  long num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+  return max((int)num_cores, 1);
+#else
+  return 1;
+#endif
+}
+
+/**
+ * The entry point of each of the threads in the pool.
+ */
+void WorkerPool::
+thread_func(void *data) {
+  ((WorkerPool *)data)->worker_main();
+}
+
+/**
+ * Waits for a job, and takes ranges of it until there are none left.
+ */
+void WorkerPool::
+worker_main() {
+  _lock.acquire();
+  while (!_shutdown) {
+    if (_job == NULL || _next >= _count) {
+      _work_cvar.wait();
+      continue;
+    }
+
+    Job *job = _job;
+    int begin = _next;
+    int end = min(begin + _grain, _count);
+    _next = end;
+    ++_num_active;
+    _lock.release();
+    job->execute(begin, end);
+    _lock.acquire();
+    --_num_active;
+    if (_num_active == 0 && _next >= _count) {
+      _done_cvar.notify_all();
+    }
+  }
+  _lock.release();
+}
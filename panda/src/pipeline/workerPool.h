@@ -0,0 +1,81 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file workerPool.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include "pandabase.h"
+#include "genericThread.h"
+#include "pmutex.h"
+#include "conditionVarFull.h"
+#include "pointerTo.h"
+#include "pvector.h"
+
+/**
+ * A fixed set of threads that are used to split a loop over a range of
+ * indices into several pieces that run in parallel, for low-level operations
+ * on large blocks of data, such as image filters.
+ *
+ * The calling thread takes part in the work, and run() does not return until
+ * the whole range has been processed.  If the pool is already busy with
+ * another job, for instance if run() is called again from within a job, or if
+ * true threads are not available, the job simply runs in the calling thread.
+ * This is not a general-purpose task system; use AsyncTaskManager for that.
+ */
+class EXPCL_PANDA_PIPELINE WorkerPool {
+public:
+  // Subclass this to define the body of the loop.  execute() is called with
+  // consecutive, non-overlapping subranges of [0, count), from several
+  // threads at once.
+  class EXPCL_PANDA_PIPELINE Job {
+  public:
+    virtual ~Job();
+    virtual void execute(int begin, int end)=0;
+  };
+
+  WorkerPool(int num_threads);
+  ~WorkerPool();
+
+  INLINE int get_num_threads() const;
+
+  void run(Job &job, int count, int grain = 1);
+
+  INLINE static WorkerPool *get_global_ptr();
+  static int get_num_cpu_cores();
+
+private:
+  static void make_global_ptr();
+  static void thread_func(void *data);
+  void worker_main();
+
+  typedef pvector<PT(GenericThread) > Threads;
+  Threads _threads;
+
+  Mutex _lock;
+  ConditionVarFull _work_cvar;
+  ConditionVarFull _done_cvar;
+
+  // These describe the job in progress, and are protected by _lock.
+  Job *_job;
+  int _next;
+  int _count;
+  int _grain;
+  int _num_active;
+  bool _shutdown;
+
+  static WorkerPool *_global_ptr;
+};
+
+#include "workerPool.I"
+
+#endif
@@ -12,6 +12,7 @@
  */
 
 #include "convert_srgb.h"
+#include "config_pnmimage.h"
 
 // Lookup tables for converting from unsigned char formats.
 const
@@ -162,3 +163,220 @@ has_sse2_sRGB_encode() {
 }
 
 #endif  // __SSE2__
+
+#if defined(__SSE2__) || defined(__i386__) || defined(_M_IX86) || defined(_M_X64) || defined(_M_AMD64)
+
+#if defined(__GNUC__)
+#include <cpuid.h>
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+/**
+ * Returns true if the CPU and operating system support the AVX2 and FMA
+ * instruction sets, so that the _avx2 versions of the sRGB conversion
+ * functions may be called.
+ */
+bool
+has_avx2_sRGB_encode() {
+  static int has_support = -1;
+  if (has_support >= 0) {
+    return (has_support != 0);
+  }
+
+  bool supported = false;
+#if defined(__GNUC__)
+  unsigned int a, b, c, d;
+  if (__get_cpuid(1, &a, &b, &c, &d) &&
+      (c & 0x18001000) == 0x18001000 &&  // OSXSAVE, AVX and FMA
+      __get_cpuid_max(0, NULL) >= 7) {
+    // Make sure that the OS saves the YMM registers on a context switch.
+    unsigned int xcr0_lo, xcr0_hi;
+    __asm__ ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+    if ((xcr0_lo & 6) == 6) {
+      __cpuid_count(7, 0, a, b, c, d);
+      supported = (b & 0x20) != 0;
+    }
+  }
+
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  int max_leaf = info[0];
+  __cpuid(info, 1);
+  if ((info[2] & 0x18001000) == 0x18001000 && max_leaf >= 7 &&
+      (_xgetbv(0) & 6) == 6) {
+    __cpuidex(info, 7, 0);
+    supported = (info[1] & 0x20) != 0;
+  }
+#endif
+
+  supported = supported && has_sse2_sRGB_encode();
+
+  if (pnmimage_cat.is_debug()) {
+    pnmimage_cat.debug()
+      << "Runtime detection reports AVX2 instructions "
+      << (supported ? "available" : "unavailable") << ": "
+      << "AVX2-optimized sRGB conversion routines "
+      << (supported ? "enabled" : "disabled") << ".\n";
+  }
+
+  has_support = supported ? 1 : 0;
+  return supported;
+}
+
+#endif
+
+/**
+ * Decodes an array of sRGB-encoded unsigned char values to linearized floats
+ * in the range 0-1.  Alpha components are only scaled to the range 0-1.
+ */
+void
+decode_sRGB_float(const unsigned char *from, float *into, size_t count,
+                  int num_components) {
+  // This is a simple table lookup, which the CPU can already do about as fast
+  // as it can load the values.
+  if (num_components == 2 || num_components == 4) {
+    nassertv(count % num_components == 0);
+    const unsigned char *end = from + count;
+    while (from < end) {
+      for (int c = 0; c < num_components - 1; ++c) {
+        into[c] = to_linear_float_table[from[c]];
+      }
+      into[num_components - 1] = from[num_components - 1] * (1.f / 255.f);
+      from += num_components;
+      into += num_components;
+    }
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      into[i] = to_linear_float_table[from[i]];
+    }
+  }
+}
+
+/**
+ * Decodes an array of sRGB-encoded floats in the range 0-1 to linearized
+ * floats.  Alpha components are passed through unchanged.
+ */
+void
+decode_sRGB_float(const float *from, float *into, size_t count,
+                  int num_components) {
+  nassertv((num_components != 2 && num_components != 4) ||
+            count % num_components == 0);
+#if defined(__SSE2__) || defined(__i386__) || defined(_M_IX86) || defined(_M_X64) || defined(_M_AMD64)
+  if (has_avx2_sRGB_encode()) {
+    decode_sRGB_float_avx2(from, into, count, num_components);
+    return;
+  }
+  if (has_sse2_sRGB_encode()) {
+    decode_sRGB_float_sse2(from, into, count, num_components);
+    return;
+  }
+#endif
+
+  bool has_alpha = (num_components == 2 || num_components == 4);
+  for (size_t i = 0; i < count; ++i) {
+    if (has_alpha && (i % num_components) == (size_t)(num_components - 1)) {
+      into[i] = from[i];
+    } else {
+      into[i] = decode_sRGB_float(from[i]);
+    }
+  }
+}
+
+/**
+ * Decodes an array of sRGB-encoded unsigned char values to linearized
+ * unsigned char values.  Alpha components are copied unchanged.
+ */
+void
+decode_sRGB_uchar(const unsigned char *from, unsigned char *into,
+                  size_t count, int num_components) {
+  bool has_alpha = (num_components == 2 || num_components == 4);
+  nassertv(!has_alpha || count % num_components == 0);
+  for (size_t i = 0; i < count; ++i) {
+    if (has_alpha && (i % num_components) == (size_t)(num_components - 1)) {
+      into[i] = from[i];
+    } else {
+      into[i] = to_linear_uchar_table[from[i]];
+    }
+  }
+}
+
+/**
+ * Encodes an array of linearized floats in the range 0-1 to sRGB-encoded
+ * floats.  Alpha components are passed through unchanged.
+ */
+void
+encode_sRGB_float(const float *from, float *into, size_t count,
+                  int num_components) {
+  nassertv((num_components != 2 && num_components != 4) ||
+            count % num_components == 0);
+#if defined(__SSE2__) || defined(__i386__) || defined(_M_IX86) || defined(_M_X64) || defined(_M_AMD64)
+  if (has_avx2_sRGB_encode()) {
+    encode_sRGB_float_avx2(from, into, count, num_components);
+    return;
+  }
+  if (has_sse2_sRGB_encode()) {
+    encode_sRGB_float_sse2(from, into, count, num_components);
+    return;
+  }
+#endif
+
+  bool has_alpha = (num_components == 2 || num_components == 4);
+  for (size_t i = 0; i < count; ++i) {
+    if (has_alpha && (i % num_components) == (size_t)(num_components - 1)) {
+      into[i] = from[i];
+    } else {
+      into[i] = encode_sRGB_float(from[i]);
+    }
+  }
+}
+
+/**
+ * Encodes an array of linearized unsigned char values to sRGB-encoded
+ * unsigned char values.  Alpha components are copied unchanged.
+ */
+void
+encode_sRGB_uchar(const unsigned char *from, unsigned char *into,
+                  size_t count, int num_components) {
+  bool has_alpha = (num_components == 2 || num_components == 4);
+  nassertv(!has_alpha || count % num_components == 0);
+  for (size_t i = 0; i < count; ++i) {
+    if (has_alpha && (i % num_components) == (size_t)(num_components - 1)) {
+      into[i] = from[i];
+    } else {
+      into[i] = to_srgb8_table[from[i]];
+    }
+  }
+}
+
+/**
+ * Encodes an array of linearized floats in the range 0-1 to sRGB-encoded
+ * unsigned char values.  Alpha components are only scaled to the range 0-255.
+ */
+void
+encode_sRGB_uchar(const float *from, unsigned char *into, size_t count,
+                  int num_components) {
+  nassertv((num_components != 2 && num_components != 4) ||
+            count % num_components == 0);
+#if defined(__SSE2__) || defined(__i386__) || defined(_M_IX86) || defined(_M_X64) || defined(_M_AMD64)
+  if (has_avx2_sRGB_encode()) {
+    encode_sRGB_uchar_avx2(from, into, count, num_components);
+    return;
+  }
+  if (has_sse2_sRGB_encode()) {
+    encode_sRGB_uchar_sse2(from, into, count, num_components);
+    return;
+  }
+#endif
+
+  bool has_alpha = (num_components == 2 || num_components == 4);
+  for (size_t i = 0; i < count; ++i) {
+    if (has_alpha && (i % num_components) == (size_t)(num_components - 1)) {
+      into[i] = (unsigned char)(min(max(from[i], 0.0f), 1.0f) * 255.0f + 0.5f);
+    } else {
+      into[i] = encode_sRGB_uchar(from[i]);
+    }
+  }
+}
@@ -46,6 +46,30 @@ EXPCL_PANDA_PNMIMAGE INLINE void encode_sRGB_uchar(const LColorf &from,
 EXPCL_PANDA_PNMIMAGE INLINE void encode_sRGB_uchar(const LColorf &from,
                                                    xel &into, xelval &into_alpha);
 
+// These functions convert an entire array of count components in one go.
+// If num_components is 2 or 4, the last component of each pixel is taken to
+// be alpha, which is always linear and is therefore not converted, only
+// rescaled as needed.  They automatically use the fastest implementation that
+// the CPU supports, as determined at runtime.
+EXPCL_PANDA_PNMIMAGE void decode_sRGB_float(const unsigned char *from,
+                                            float *into, size_t count,
+                                            int num_components = 1);
+EXPCL_PANDA_PNMIMAGE void decode_sRGB_float(const float *from, float *into,
+                                            size_t count,
+                                            int num_components = 1);
+EXPCL_PANDA_PNMIMAGE void decode_sRGB_uchar(const unsigned char *from,
+                                            unsigned char *into, size_t count,
+                                            int num_components = 1);
+EXPCL_PANDA_PNMIMAGE void encode_sRGB_float(const float *from, float *into,
+                                            size_t count,
+                                            int num_components = 1);
+EXPCL_PANDA_PNMIMAGE void encode_sRGB_uchar(const unsigned char *from,
+                                            unsigned char *into, size_t count,
+                                            int num_components = 1);
+EXPCL_PANDA_PNMIMAGE void encode_sRGB_uchar(const float *from,
+                                            unsigned char *into, size_t count,
+                                            int num_components = 1);
+
 // Use these functions if you know that SSE2 support is available.  Otherwise,
 // they will crash!
 #if defined(__SSE2__) || defined(__i386__) || defined(_M_IX86) || defined(_M_X64) || defined(_M_AMD64)
@@ -55,12 +79,32 @@ EXPCL_PANDA_PNMIMAGE void encode_sRGB_uchar_sse2(const LColorf &from,
 EXPCL_PANDA_PNMIMAGE void encode_sRGB_uchar_sse2(const LColorf &from,
                                                  xel &into, xelval &into_alpha);
 
+EXPCL_PANDA_PNMIMAGE void decode_sRGB_float_sse2(const float *from, float *into,
+                                                 size_t count, int num_components);
+EXPCL_PANDA_PNMIMAGE void encode_sRGB_float_sse2(const float *from, float *into,
+                                                 size_t count, int num_components);
+EXPCL_PANDA_PNMIMAGE void encode_sRGB_uchar_sse2(const float *from,
+                                                 unsigned char *into,
+                                                 size_t count, int num_components);
+
 // Use the following to find out if you can call either of the above.
 EXPCL_PANDA_PNMIMAGE bool has_sse2_sRGB_encode();
+
+// The same goes for these, which require AVX2 and FMA support.
+EXPCL_PANDA_PNMIMAGE void decode_sRGB_float_avx2(const float *from, float *into,
+                                                 size_t count, int num_components);
+EXPCL_PANDA_PNMIMAGE void encode_sRGB_float_avx2(const float *from, float *into,
+                                                 size_t count, int num_components);
+EXPCL_PANDA_PNMIMAGE void encode_sRGB_uchar_avx2(const float *from,
+                                                 unsigned char *into,
+                                                 size_t count, int num_components);
+
+EXPCL_PANDA_PNMIMAGE bool has_avx2_sRGB_encode();
 #else
 // The target architecture can't support the SSE2 extension at all.
 #define encode_sRGB_uchar_sse2 encode_sRGB_uchar
 #define has_sse2_sRGB_encode() (false)
+#define has_avx2_sRGB_encode() (false)
 #endif
 
 #include "convert_srgb.I"
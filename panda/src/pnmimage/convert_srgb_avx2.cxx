@@ -0,0 +1,233 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file convert_srgb_avx2.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+// This file should always be compiled with AVX2 and FMA support.  These
+// functions will only be called when AVX2 support is detected at run-time.
+// Take care not to call any inline functions defined in headers from here,
+// since the compiler might otherwise emit an AVX2 version of them that ends
+// up being used elsewhere as well.
+
+#include "convert_srgb.h"
+
+// MSVC does not define __FMA__, but /arch:AVX2 enables FMA as well.
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+
+#include <immintrin.h>
+
+/**
+ * Returns a mask with all bits set in the lanes that hold an alpha component,
+ * for an array of pixels with the given number of components.
+ */
+static INLINE __m256 _alpha_mask_avx2(int num_components) {
+  switch (num_components) {
+  case 2:
+    return _mm256_castsi256_ps(_mm256_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0));
+  case 4:
+    return _mm256_castsi256_ps(_mm256_set_epi32(-1, 0, 0, 0, -1, 0, 0, 0));
+  default:
+    return _mm256_setzero_ps();
+  }
+}
+
+/**
+ * Computes the base-2 logarithm of eight positive, normalized floats.  This
+ * is the same algorithm as _log2_sse2().
+ */
+static INLINE __m256 _log2_avx2(__m256 x) {
+  __m256i xi = _mm256_castps_si256(x);
+  __m256i e = _mm256_sub_epi32(_mm256_srli_epi32(xi, 23), _mm256_set1_epi32(127));
+  __m256 m = _mm256_castsi256_ps(_mm256_or_si256(
+    _mm256_and_si256(xi, _mm256_set1_epi32(0x007fffff)),
+    _mm256_set1_epi32(0x3f800000)));
+
+  __m256 big = _mm256_cmp_ps(m, _mm256_set1_ps(1.41421356f), _CMP_GT_OQ);
+  m = _mm256_blendv_ps(m, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), big);
+  __m256 ef = _mm256_add_ps(_mm256_cvtepi32_ps(e),
+                            _mm256_and_ps(big, _mm256_set1_ps(1.0f)));
+
+  __m256 t = _mm256_sub_ps(m, _mm256_set1_ps(1.0f));
+  __m256 z = _mm256_mul_ps(t, t);
+  __m256 y = _mm256_set1_ps(7.0376836292e-2f);
+  y = _mm256_fmadd_ps(y, t, _mm256_set1_ps(-1.1514610310e-1f));
+  y = _mm256_fmadd_ps(y, t, _mm256_set1_ps(1.1676998740e-1f));
+  y = _mm256_fmadd_ps(y, t, _mm256_set1_ps(-1.2420140846e-1f));
+  y = _mm256_fmadd_ps(y, t, _mm256_set1_ps(1.4249322787e-1f));
+  y = _mm256_fmadd_ps(y, t, _mm256_set1_ps(-1.6668057665e-1f));
+  y = _mm256_fmadd_ps(y, t, _mm256_set1_ps(2.0000714765e-1f));
+  y = _mm256_fmadd_ps(y, t, _mm256_set1_ps(-2.4999993993e-1f));
+  y = _mm256_fmadd_ps(y, t, _mm256_set1_ps(3.3333331174e-1f));
+  y = _mm256_mul_ps(_mm256_mul_ps(y, t), z);
+  y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+  __m256 ln = _mm256_add_ps(t, y);
+
+  return _mm256_fmadd_ps(ln, _mm256_set1_ps(1.44269504089f), ef);
+}
+
+/**
+ * Computes 2 raised to the power of each of eight floats.  This is the same
+ * algorithm as _exp2_sse2().
+ */
+static INLINE __m256 _exp2_avx2(__m256 y) {
+  y = _mm256_max_ps(y, _mm256_set1_ps(-126.0f));
+  y = _mm256_min_ps(y, _mm256_set1_ps(127.0f));
+
+  __m256i n = _mm256_cvtps_epi32(y);
+  __m256 f = _mm256_sub_ps(y, _mm256_cvtepi32_ps(n));
+
+  __m256 p = _mm256_set1_ps(1.535336188319500e-4f);
+  p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(1.339887440266574e-3f));
+  p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(9.618437357674640e-3f));
+  p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(5.550332471162809e-2f));
+  p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(2.402264791363012e-1f));
+  p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(6.931472028550421e-1f));
+  p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(1.0f));
+
+  __m256 scale = _mm256_castsi256_ps(
+    _mm256_slli_epi32(_mm256_add_epi32(n, _mm256_set1_epi32(127)), 23));
+  return _mm256_mul_ps(p, scale);
+}
+
+/**
+ * This is the same approximation of the sRGB encode function that is used by
+ * the SSE2 version, for eight floats that have already been clamped to the
+ * 0-1 range.  The result is scaled to the 0-255 range.
+ */
+static INLINE __m256 _encode_sRGB_avx2_curve(__m256 val) {
+  __m256 xf = _mm256_mul_ps(val, _mm256_set1_ps(6.3307e18f));
+  xf = _mm256_cvtepi32_ps(_mm256_castps_si256(xf));
+  xf = _mm256_mul_ps(xf, _mm256_set1_ps(2.0f / 3.0f));
+  xf = _mm256_castsi256_ps(_mm256_cvtps_epi32(xf));
+
+  __m256 xover = _mm256_mul_ps(val, xf);
+  __m256 xunder = _mm256_mul_ps(_mm256_mul_ps(val, val), _mm256_rsqrt_ps(xf));
+  __m256 xavg = _mm256_mul_ps(_mm256_add_ps(xover, xunder),
+                              _mm256_set1_ps(0.5286098f));
+
+  xavg = _mm256_mul_ps(xavg, _mm256_rsqrt_ps(xavg));
+  xavg = _mm256_mul_ps(xavg, _mm256_rsqrt_ps(xavg));
+
+  return _mm256_fmsub_ps(xavg, _mm256_set1_ps(269.122f), _mm256_set1_ps(13.55f));
+}
+
+/**
+ * Decodes the sRGB-encoded floats in the range 0-1 to linearized floats.  See
+ * decode_sRGB_float().  Alpha components are passed through unchanged.
+ */
+void
+decode_sRGB_float_avx2(const float *from, float *into, size_t count,
+                       int num_components) {
+  __m256 alpha_mask = _alpha_mask_avx2(num_components);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 val = _mm256_loadu_ps(from + i);
+    __m256 lin = _mm256_mul_ps(val, _mm256_set1_ps(1.f / 12.92f));
+
+    __m256 x = _mm256_max_ps(val, _mm256_set1_ps(0.04045f));
+    x = _mm256_mul_ps(_mm256_add_ps(x, _mm256_set1_ps(0.055f)),
+                      _mm256_set1_ps(1.f / 1.055f));
+    __m256 curve = _exp2_avx2(_mm256_mul_ps(_log2_avx2(x), _mm256_set1_ps(2.4f)));
+
+    __m256 mask = _mm256_cmp_ps(val, _mm256_set1_ps(0.04045f), _CMP_GT_OQ);
+    __m256 result = _mm256_blendv_ps(lin, curve, mask);
+    _mm256_storeu_ps(into + i, _mm256_blendv_ps(result, val, alpha_mask));
+  }
+
+  // The remainder still starts on a pixel boundary.
+  decode_sRGB_float_sse2(from + i, into + i, count - i, num_components);
+}
+
+/**
+ * Encodes the linearized floats in the range 0-1 to sRGB-encoded floats.  See
+ * encode_sRGB_float().  Alpha components are passed through unchanged.
+ */
+void
+encode_sRGB_float_avx2(const float *from, float *into, size_t count,
+                       int num_components) {
+  __m256 alpha_mask = _alpha_mask_avx2(num_components);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 val = _mm256_loadu_ps(from + i);
+    __m256 lin = _mm256_mul_ps(val, _mm256_set1_ps(12.92f));
+
+    __m256 x = _mm256_max_ps(val, _mm256_set1_ps(0.0031308f));
+    __m256 curve = _exp2_avx2(_mm256_mul_ps(_log2_avx2(x), _mm256_set1_ps(0.41666f)));
+    curve = _mm256_fmsub_ps(curve, _mm256_set1_ps(1.055f), _mm256_set1_ps(0.055f));
+
+    __m256 mask = _mm256_cmp_ps(val, _mm256_set1_ps(0.0031308f), _CMP_GE_OQ);
+    __m256 result = _mm256_blendv_ps(lin, curve, mask);
+    _mm256_storeu_ps(into + i, _mm256_blendv_ps(result, val, alpha_mask));
+  }
+
+  encode_sRGB_float_sse2(from + i, into + i, count - i, num_components);
+}
+
+/**
+ * Encodes the linearized floats in the range 0-1 to sRGB-encoded unsigned
+ * chars.  See encode_sRGB_uchar().  Alpha components are only scaled.
+ */
+void
+encode_sRGB_uchar_avx2(const float *from, unsigned char *into, size_t count,
+                       int num_components) {
+  __m256 alpha_mask = _alpha_mask_avx2(num_components);
+  __m256 linear_mul = _mm256_blendv_ps(_mm256_set1_ps(3294.6f),
+                                       _mm256_set1_ps(255.0f), alpha_mask);
+  __m256 threshold = _mm256_blendv_ps(_mm256_set1_ps(0.0031308f),
+                                      _mm256_set1_ps(2.0f), alpha_mask);
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 val = _mm256_loadu_ps(from + i);
+    val = _mm256_max_ps(val, _mm256_set1_ps(0.0f));
+    val = _mm256_min_ps(val, _mm256_set1_ps(1.0f));
+
+    __m256 lval = _mm256_fmadd_ps(val, linear_mul, _mm256_set1_ps(0.5f));
+    __m256 mask = _mm256_cmp_ps(val, threshold, _CMP_GE_OQ);
+    __m256i vals = _mm256_cvttps_epi32(
+      _mm256_blendv_ps(lval, _encode_sRGB_avx2_curve(val), mask));
+
+    __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(vals),
+                                     _mm256_extracti128_si256(vals, 1));
+    _mm_storel_epi64((__m128i *)(into + i), _mm_packus_epi16(packed, packed));
+  }
+
+  encode_sRGB_uchar_sse2(from + i, into + i, count - i, num_components);
+}
+
+#elif defined(__SSE2__) || defined(__i386__) || defined(_M_IX86) || defined(_M_X64) || defined(_M_AMD64)
+// Somehow we're compiling this without AVX2 support.  We still have to define
+// these functions, but they will simply use the SSE2 versions.
+#ifdef _MSC_VER
+#pragma message("convert_srgb_avx2.cxx is being compiled without AVX2 support!")
+#else
+#warning convert_srgb_avx2.cxx is being compiled without AVX2 support!
+#endif
+
+void
+decode_sRGB_float_avx2(const float *from, float *into, size_t count,
+                       int num_components) {
+  decode_sRGB_float_sse2(from, into, count, num_components);
+}
+
+void
+encode_sRGB_float_avx2(const float *from, float *into, size_t count,
+                       int num_components) {
+  encode_sRGB_float_sse2(from, into, count, num_components);
+}
+
+void
+encode_sRGB_uchar_avx2(const float *from, unsigned char *into, size_t count,
+                       int num_components) {
+  encode_sRGB_uchar_sse2(from, into, count, num_components);
+}
+
+#endif
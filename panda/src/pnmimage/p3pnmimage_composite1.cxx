@@ -1,7 +1,10 @@
 #include "config_pnmimage.cxx"
 #include "convert_srgb.cxx"
 #include "pfmFile.cxx"
+#include "pnm-image-composite.cxx"
+#include "pnm-image-distance.cxx"
 #include "pnm-image-filter.cxx"
+#include "pnm-image-histogram.cxx"
 #include "pnmbitio.cxx"
 #include "pnmBrush.cxx"
 #include "pnmFileType.cxx"
@@ -1,7 +1,9 @@
 #include "pnmImage.cxx"
 #include "pnmImageHeader.cxx"
 #include "pnmPainter.cxx"
+#include "pnmPlanarImage.cxx"
 #include "pnmReader.cxx"
+#include "pnmRowPipeline.cxx"
 #include "pnmWriter.cxx"
 #include "pnmFileTypeRegistry.cxx"
 #include "pnmimage_base.cxx" 
@@ -19,10 +19,31 @@
 #include "bigEndian.h"
 #include "cmath.h"
 #include "pnmImage.h"
+#include "convert_srgb.h"
 #include "pnmReader.h"
 #include "pnmWriter.h"
 #include "string_utils.h"
 #include "look_at.h"
+#include "workerPool.h"
+#include "lightMutex.h"
+#include "lightMutexHolder.h"
+
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#endif
+
+// Runs the job over all of the rows of a table of the indicated size,
+// dividing them among the threads of the WorkerPool.  Small tables aren't
+// worth waking up the other threads for.
+static void
+run_row_job(WorkerPool::Job &job, int x_size, int y_size) {
+  if ((size_t)x_size * (size_t)y_size < 65536) {
+    job.execute(0, y_size);
+    return;
+  }
+  WorkerPool *pool = WorkerPool::get_global_ptr();
+  pool->run(job, y_size, max(1, y_size / ((pool->get_num_threads() + 1) * 4)));
+}
 
 /**
  *
@@ -288,6 +309,53 @@ load(const PNMImage &pnmimage) {
   int num_channels = pnmimage.get_num_channels();
 
   clear(pnmimage.get_x_size(), pnmimage.get_y_size(), num_channels);
+
+  if (pnmimage.get_color_space() == CS_sRGB) {
+    // Gather each row of encoded values, and decode it in one go.  This is
+    // much faster than decoding the pixels one at a time.
+    xelval maxval = pnmimage.get_maxval();
+    float inv_maxval = 1.0f / (float)maxval;
+    bool has_alpha = pnmimage.has_alpha();
+    size_t row_size = (size_t)_x_size * num_channels;
+    pvector<unsigned char> buffer;
+    if (maxval == 255) {
+      buffer.resize(row_size);
+    }
+
+    const xel *array = pnmimage.get_array();
+    const xelval *alpha = pnmimage.get_alpha_array();
+    for (int yi = 0; yi < _y_size; ++yi) {
+      const xel *row = array + (size_t)yi * _x_size;
+      const xelval *alpha_row = has_alpha ? alpha + (size_t)yi * _x_size : NULL;
+      PN_float32 *point = &_table[yi * row_size];
+
+      size_t i = 0;
+      for (int xi = 0; xi < _x_size; ++xi) {
+        if (num_channels >= 3) {
+          point[i++] = PPM_GETR(row[xi]);
+          point[i++] = PPM_GETG(row[xi]);
+        }
+        point[i++] = PPM_GETB(row[xi]);
+        if (has_alpha) {
+          point[i++] = alpha_row[xi];
+        }
+      }
+
+      if (maxval == 255) {
+        for (i = 0; i < row_size; ++i) {
+          buffer[i] = (unsigned char)point[i];
+        }
+        decode_sRGB_float(&buffer[0], point, row_size, num_channels);
+      } else {
+        for (i = 0; i < row_size; ++i) {
+          point[i] *= inv_maxval;
+        }
+        decode_sRGB_float(point, point, row_size, num_channels);
+      }
+    }
+    return true;
+  }
+
   switch (num_channels) {
   case 1:
     {
@@ -469,52 +537,55 @@ store_mask(PNMImage &pnmimage, const LVecBase4f &min_point, const LVecBase4f &ma
   return true;
 }
 
-/**
- * Fills the table with all of the same value.
- */
-void PfmFile::
-fill(const LPoint4f &value) {
-  switch (_num_channels) {
-  case 1:
-    {
-      for (int yi = 0; yi < _y_size; ++yi) {
-        for (int xi = 0; xi < _x_size; ++xi) {
-          _table[(yi * _x_size + xi)] = value[0];
-        }
-      }
-    }
-    break;
+// This job fills a range of rows of the table with the same value, either in
+// all channels, or in just one of them.
+class PfmFile::FillJob : public WorkerPool::Job {
+public:
+  virtual void execute(int begin, int end) {
+    int num_channels = _file->_num_channels;
+    size_t start = (size_t)begin * _file->_x_size;
+    size_t count = (size_t)(end - begin) * _file->_x_size;
+    PN_float32 *p = &_file->_table[start * num_channels];
 
-  case 2:
-    {
-      for (int yi = 0; yi < _y_size; ++yi) {
-        for (int xi = 0; xi < _x_size; ++xi) {
-          (*(LPoint2f *)&_table[(yi * _x_size + xi) * _num_channels]).set(value[0], value[1]);
-        }
+    if (_channel >= 0) {
+      p += _channel;
+      for (size_t i = 0; i < count; ++i) {
+        *p = _value[0];
+        p += num_channels;
       }
-    }
-    break;
 
-  case 3:
-    {
-      for (int yi = 0; yi < _y_size; ++yi) {
-        for (int xi = 0; xi < _x_size; ++xi) {
-          (*(LPoint3f *)&_table[(yi * _x_size + xi) * _num_channels]).set(value[0], value[1], value[2]);
-        }
-      }
-    }
-    break;
+    } else if (num_channels == 1) {
+      std::fill(p, p + count, _value[0]);
 
-  case 4:
-    {
-      for (int yi = 0; yi < _y_size; ++yi) {
-        for (int xi = 0; xi < _x_size; ++xi) {
-          *(LPoint4f *)&_table[(yi * _x_size + xi) * _num_channels] = value;
+    } else {
+      for (size_t i = 0; i < count; ++i) {
+        for (int c = 0; c < num_channels; ++c) {
+          p[c] = _value[c];
         }
+        p += num_channels;
       }
     }
-    break;
   }
+
+  PfmFile *_file;
+  LPoint4f _value;
+  int _channel;
+};
+
+/**
+ * Fills the table with all of the same value.
+ */
+void PfmFile::
+fill(const LPoint4f &value) {
+  if (_num_channels == 0) {
+    return;
+  }
+
+  FillJob job;
+  job._file = this;
+  job._value = value;
+  job._channel = -1;
+  run_row_job(job, _x_size, _y_size);
 }
 
 /**
@@ -543,11 +614,11 @@ void PfmFile::
 fill_channel(int channel, PN_float32 value) {
   nassertv(channel >= 0 && channel < _num_channels);
 
-  for (int yi = 0; yi < _y_size; ++yi) {
-    for (int xi = 0; xi < _x_size; ++xi) {
-      _table[(yi * _x_size + xi) * _num_channels + channel] = value;
-    }
-  }
+  FillJob job;
+  job._file = this;
+  job._value.set(value, value, value, value);
+  job._channel = channel;
+  run_row_job(job, _x_size, _y_size);
 }
 
 /**
@@ -720,6 +791,95 @@ calc_bilinear_point(LPoint3f &result, PN_float32 x, PN_float32 y) const {
   return true;
 }
 
+// This job computes the bounding box of the first three components of the
+// points in a range of rows, and merges it with the result so far.
+class PfmFile::BoundsJob : public WorkerPool::Job {
+public:
+  virtual void execute(int begin, int end) {
+    int num_channels = _file->_num_channels;
+    int x_size = _file->_x_size;
+    bool check_points = _file->_has_no_data_value;
+    bool found_any = false;
+    LPoint3f min_point, max_point;
+
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+    if (num_channels >= 3) {
+      __m128 min4 = _mm_setzero_ps();
+      __m128 max4 = _mm_setzero_ps();
+      for (int yi = begin; yi < end; ++yi) {
+        const PN_float32 *p = &_file->_table[(size_t)yi * x_size * num_channels];
+        for (int xi = 0; xi < x_size; ++xi, p += num_channels) {
+          if (check_points && !_file->has_point(xi, yi)) {
+            continue;
+          }
+          // Load exactly three components, so that we never touch the
+          // neighboring point, which another thread may be working on.
+          __m128 v = _mm_movelh_ps(_mm_castpd_ps(_mm_load_sd((const double *)p)),
+                                   _mm_load_ss(p + 2));
+          if (!found_any) {
+            min4 = v;
+            max4 = v;
+            found_any = true;
+          } else {
+            min4 = _mm_min_ps(v, min4);
+            max4 = _mm_max_ps(v, max4);
+          }
+        }
+      }
+      float min_f[4], max_f[4];
+      _mm_storeu_ps(min_f, min4);
+      _mm_storeu_ps(max_f, max4);
+      min_point.set(min_f[0], min_f[1], min_f[2]);
+      max_point.set(max_f[0], max_f[1], max_f[2]);
+    } else
+#endif
+    {
+      for (int yi = begin; yi < end; ++yi) {
+        for (int xi = 0; xi < x_size; ++xi) {
+          if (check_points && !_file->has_point(xi, yi)) {
+            continue;
+          }
+          const LPoint3f &p = _file->get_point(xi, yi);
+          if (!found_any) {
+            min_point = p;
+            max_point = p;
+            found_any = true;
+          } else {
+            min_point.set(min(min_point[0], p[0]),
+                          min(min_point[1], p[1]),
+                          min(min_point[2], p[2]));
+            max_point.set(max(max_point[0], p[0]),
+                          max(max_point[1], p[1]),
+                          max(max_point[2], p[2]));
+          }
+        }
+      }
+    }
+
+    if (found_any) {
+      LightMutexHolder holder(_lock);
+      if (!_found_any) {
+        _min_point = min_point;
+        _max_point = max_point;
+        _found_any = true;
+      } else {
+        _min_point.set(min(_min_point[0], min_point[0]),
+                       min(_min_point[1], min_point[1]),
+                       min(_min_point[2], min_point[2]));
+        _max_point.set(max(_max_point[0], max_point[0]),
+                       max(_max_point[1], max_point[1]),
+                       max(_max_point[2], max_point[2]));
+      }
+    }
+  }
+
+  const PfmFile *_file;
+  LightMutex _lock;
+  bool _found_any;
+  LPoint3f _min_point;
+  LPoint3f _max_point;
+};
+
 /**
  * Calculates the minimum and maximum x, y, and z depth component values,
  * representing the bounding box of depth values, and places them in the
@@ -728,34 +888,16 @@ calc_bilinear_point(LPoint3f &result, PN_float32 x, PN_float32 y) const {
  */
 bool PfmFile::
 calc_min_max(LVecBase3f &min_depth, LVecBase3f &max_depth) const {
-  bool any_points = false;
-
-  min_depth = LVecBase3f::zero();
-  max_depth = LVecBase3f::zero();
+  BoundsJob job;
+  job._file = this;
+  job._found_any = false;
+  job._min_point = LPoint3f::zero();
+  job._max_point = LPoint3f::zero();
+  run_row_job(job, _x_size, _y_size);
 
-  for (int yi = 0; yi < _y_size; ++yi) {
-    for (int xi = 0; xi < _x_size; ++xi) {
-      if (!has_point(xi, yi)) {
-        continue;
-      }
-
-      const LPoint3f &p = get_point(xi, yi);
-      if (!any_points) {
-        min_depth = p;
-        max_depth = p;
-        any_points = true;
-      } else {
-        min_depth[0] = min(min_depth[0], p[0]);
-        min_depth[1] = min(min_depth[1], p[1]);
-        min_depth[2] = min(min_depth[2], p[2]);
-        max_depth[0] = max(max_depth[0], p[0]);
-        max_depth[1] = max(max_depth[1], p[1]);
-        max_depth[2] = max(max_depth[2], p[2]);
-      }
-    }
-  }
-
-  return any_points;
+  min_depth = job._min_point;
+  max_depth = job._max_point;
+  return job._found_any;
 }
 
 /**
@@ -978,6 +1120,81 @@ resize(int new_x_size, int new_y_size) {
   _y_size = new_y_size;
 }
 
+// This job computes a range of rows of the result of quick_filter_from().
+class PfmFile::QuickFilterJob : public WorkerPool::Job {
+public:
+  virtual void execute(int begin, int end) {
+    int num_channels = _to->_num_channels;
+    int x_size = _to->_x_size;
+    PN_float32 orig_x_size = (PN_float32)_from->_x_size;
+    PN_float32 orig_y_size = (PN_float32)_from->_y_size;
+
+    for (int to_y = begin; to_y < end; ++to_y) {
+      // Each edge of the box is computed from scratch, rather than carried
+      // over from the previous row or column, but since it is the same
+      // expression, it has the same value.
+      PN_float32 from_y0 = 0.0;
+      if (to_y > 0) {
+        from_y0 = min((PN_float32)((double)to_y * _y_scale), orig_y_size);
+      }
+      PN_float32 from_y1 = min((PN_float32)((to_y + 1.0) * _y_scale), orig_y_size);
+
+      PN_float32 *to = &_new_data[(size_t)to_y * x_size * num_channels];
+      PN_float32 from_x0 = 0.0;
+      for (int to_x = 0; to_x < x_size; ++to_x) {
+        PN_float32 from_x1 = min((PN_float32)((to_x + 1.0) * _x_scale), orig_x_size);
+
+        // Now the box from (from_x0, from_y0) - (from_x1, from_y1) but not
+        // including (from_x1, from_y1) maps to the pixel (to_x, to_y).
+        switch (num_channels) {
+        case 1:
+          _from->box_filter_region(*to, from_x0, from_y0, from_x1, from_y1);
+          break;
+
+        case 2:
+          {
+            LPoint2f result;
+            _from->box_filter_region(result, from_x0, from_y0, from_x1, from_y1);
+            to[0] = result[0];
+            to[1] = result[1];
+          }
+          break;
+
+        case 3:
+          {
+            LPoint3f result;
+            _from->box_filter_region(result, from_x0, from_y0, from_x1, from_y1);
+            to[0] = result[0];
+            to[1] = result[1];
+            to[2] = result[2];
+          }
+          break;
+
+        case 4:
+          {
+            LPoint4f result;
+            _from->box_filter_region(result, from_x0, from_y0, from_x1, from_y1);
+            to[0] = result[0];
+            to[1] = result[1];
+            to[2] = result[2];
+            to[3] = result[3];
+          }
+          break;
+        }
+
+        to += num_channels;
+        from_x0 = from_x1;
+      }
+      Thread::consider_yield();
+    }
+  }
+
+  const PfmFile *_from;
+  const PfmFile *_to;
+  PN_float32 *_new_data;
+  PN_float32 _x_scale, _y_scale;
+};
+
 /**
  * Resizes from the given image, with a fixed radius of 0.5. This is a very
  * specialized and simple algorithm that doesn't handle dropping below the
@@ -989,142 +1206,30 @@ quick_filter_from(const PfmFile &from) {
   if (_x_size == 0 || _y_size == 0) {
     return;
   }
+  nassertv(_num_channels >= 1 && _num_channels <= 4);
 
-  Table new_data;
-  new_data.reserve(_table.size());
-
-  PN_float32 from_x0, from_x1, from_y0, from_y1;
-
-  int orig_x_size = from.get_x_size();
-  int orig_y_size = from.get_y_size();
-
-  PN_float32 x_scale = 1.0;
-  PN_float32 y_scale = 1.0;
+  // The table is a little bit bigger than the points, to allow safe overflow;
+  // see clear().
+  Table new_data(_table.size(), (PN_float32)0.0);
 
+  QuickFilterJob job;
+  job._from = &from;
+  job._to = this;
+  job._new_data = &new_data[0];
+  job._x_scale = 1.0;
+  job._y_scale = 1.0;
   if (_x_size > 1) {
-    x_scale = (PN_float32)orig_x_size / (PN_float32)_x_size;
+    job._x_scale = (PN_float32)from.get_x_size() / (PN_float32)_x_size;
   }
   if (_y_size > 1) {
-    y_scale = (PN_float32)orig_y_size / (PN_float32)_y_size;
+    job._y_scale = (PN_float32)from.get_y_size() / (PN_float32)_y_size;
   }
 
-  switch (_num_channels) {
-  case 1:
-    {
-      from_y0 = 0.0;
-      for (int to_y = 0; to_y < _y_size; ++to_y) {
-        from_y1 = (to_y + 1.0) * y_scale;
-        from_y1 = min(from_y1, (PN_float32)orig_y_size);
-
-        from_x0 = 0.0;
-        for (int to_x = 0; to_x < _x_size; ++to_x) {
-          from_x1 = (to_x + 1.0) * x_scale;
-          from_x1 = min(from_x1, (PN_float32)orig_x_size);
-
-          // Now the box from (from_x0, from_y0) - (from_x1, from_y1) but not
-          // including (from_x1, from_y1) maps to the pixel (to_x, to_y).
-          PN_float32 result;
-          from.box_filter_region(result, from_x0, from_y0, from_x1, from_y1);
-          new_data.push_back(result);
-
-          from_x0 = from_x1;
-        }
-        from_y0 = from_y1;
-      }
-    }
-    break;
-
-  case 2:
-    {
-      from_y0 = 0.0;
-      for (int to_y = 0; to_y < _y_size; ++to_y) {
-        from_y1 = (to_y + 1.0) * y_scale;
-        from_y1 = min(from_y1, (PN_float32)orig_y_size);
-
-        from_x0 = 0.0;
-        for (int to_x = 0; to_x < _x_size; ++to_x) {
-          from_x1 = (to_x + 1.0) * x_scale;
-          from_x1 = min(from_x1, (PN_float32)orig_x_size);
-
-          // Now the box from (from_x0, from_y0) - (from_x1, from_y1) but not
-          // including (from_x1, from_y1) maps to the pixel (to_x, to_y).
-          LPoint2f result;
-          from.box_filter_region(result, from_x0, from_y0, from_x1, from_y1);
-          new_data.push_back(result[0]);
-          new_data.push_back(result[1]);
-
-          from_x0 = from_x1;
-        }
-        from_y0 = from_y1;
-      }
-    }
-    break;
-
-  case 3:
-    {
-      from_y0 = 0.0;
-      for (int to_y = 0; to_y < _y_size; ++to_y) {
-        from_y1 = (to_y + 1.0) * y_scale;
-        from_y1 = min(from_y1, (PN_float32)orig_y_size);
-
-        from_x0 = 0.0;
-        for (int to_x = 0; to_x < _x_size; ++to_x) {
-          from_x1 = (to_x + 1.0) * x_scale;
-          from_x1 = min(from_x1, (PN_float32)orig_x_size);
-
-          // Now the box from (from_x0, from_y0) - (from_x1, from_y1) but not
-          // including (from_x1, from_y1) maps to the pixel (to_x, to_y).
-          LPoint3f result;
-          from.box_filter_region(result, from_x0, from_y0, from_x1, from_y1);
-          new_data.push_back(result[0]);
-          new_data.push_back(result[1]);
-          new_data.push_back(result[2]);
-
-          from_x0 = from_x1;
-        }
-        from_y0 = from_y1;
-      }
-    }
-    break;
+  // The rows are independent of each other, and each one is expensive enough
+  // to be worth dividing among the threads even for a small table.
+  WorkerPool *pool = WorkerPool::get_global_ptr();
+  pool->run(job, _y_size, max(1, _y_size / ((pool->get_num_threads() + 1) * 4)));
 
-  case 4:
-    {
-      from_y0 = 0.0;
-      for (int to_y = 0; to_y < _y_size; ++to_y) {
-        from_y1 = (to_y + 1.0) * y_scale;
-        from_y1 = min(from_y1, (PN_float32)orig_y_size);
-
-        from_x0 = 0.0;
-        for (int to_x = 0; to_x < _x_size; ++to_x) {
-          from_x1 = (to_x + 1.0) * x_scale;
-          from_x1 = min(from_x1, (PN_float32)orig_x_size);
-
-          // Now the box from (from_x0, from_y0) - (from_x1, from_y1) but not
-          // including (from_x1, from_y1) maps to the pixel (to_x, to_y).
-          LPoint4f result;
-          from.box_filter_region(result, from_x0, from_y0, from_x1, from_y1);
-          new_data.push_back(result[0]);
-          new_data.push_back(result[1]);
-          new_data.push_back(result[2]);
-          new_data.push_back(result[3]);
-
-          from_x0 = from_x1;
-        }
-        from_y0 = from_y1;
-      }
-    }
-    break;
-
-  default:
-    nassertv(false);
-  }
-
-  new_data.push_back(0.0);
-  new_data.push_back(0.0);
-  new_data.push_back(0.0);
-  new_data.push_back(0.0);
-
-  nassertv(new_data.size() == _table.size());
   _table.swap(new_data);
 }
 
@@ -1204,73 +1309,98 @@ flip(bool flip_x, bool flip_y, bool transpose) {
   _table.swap(flipped);
 }
 
-/**
- * Applies the indicated transform matrix to all points in-place.
- */
-void PfmFile::
-xform(const LMatrix4f &transform) {
-  nassertv(is_valid());
-
-  int num_channels = get_num_channels();
-  switch (num_channels) {
-  case 1:
-    {
-      for (int yi = 0; yi < _y_size; ++yi) {
-        for (int xi = 0; xi < _x_size; ++xi) {
-          if (!has_point(xi, yi)) {
+// This job applies a transform matrix to the points in a range of rows.
+class PfmFile::XformJob : public WorkerPool::Job {
+public:
+  virtual void execute(int begin, int end) {
+    int num_channels = _file->_num_channels;
+    int x_size = _file->_x_size;
+    bool check_points = _file->_has_no_data_value;
+
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+    if (num_channels >= 3) {
+      const LMatrix4f &m = _transform;
+      __m128 r0 = _mm_setr_ps(m(0, 0), m(0, 1), m(0, 2), m(0, 3));
+      __m128 r1 = _mm_setr_ps(m(1, 0), m(1, 1), m(1, 2), m(1, 3));
+      __m128 r2 = _mm_setr_ps(m(2, 0), m(2, 1), m(2, 2), m(2, 3));
+      __m128 r3 = _mm_setr_ps(m(3, 0), m(3, 1), m(3, 2), m(3, 3));
+
+      for (int yi = begin; yi < end; ++yi) {
+        PN_float32 *p = &_file->_table[(size_t)yi * x_size * num_channels];
+        for (int xi = 0; xi < x_size; ++xi, p += num_channels) {
+          if (check_points && !_file->has_point(xi, yi)) {
             continue;
           }
-          PN_float32 pi = get_point1(xi, yi);
-          LPoint3f po = transform.xform_point(LPoint3f(pi, 0.0, 0.0));
-          set_point1(xi, yi, po[0]);
-        }
-      }
-    }
-    break;
-
-  case 2:
-    {
-      for (int yi = 0; yi < _y_size; ++yi) {
-        for (int xi = 0; xi < _x_size; ++xi) {
-          if (!has_point(xi, yi)) {
-            continue;
+          __m128 v = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[0]), r0),
+                                _mm_mul_ps(_mm_set1_ps(p[1]), r1));
+          v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(p[2]), r2));
+          if (num_channels == 4) {
+            // A 4-component point is transformed as a homogeneous vector.
+            v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(p[3]), r3));
+            _mm_storeu_ps(p, v);
+          } else {
+            // A 3-component point is transformed as a point, with the
+            // perspective divide, like xform_point_general().
+            v = _mm_add_ps(v, r3);
+            v = _mm_div_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)));
+            _mm_storel_pi((__m64 *)p, v);
+            _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
           }
-          LPoint2f pi = get_point2(xi, yi);
-          LPoint3f po = transform.xform_point(LPoint3f(pi[0], pi[1], 0.0));
-          set_point2(xi, yi, LPoint2f(po[0], po[1]));
         }
       }
+      return;
     }
-    break;
+#endif
 
-  case 3:
-    {
-      for (int yi = 0; yi < _y_size; ++yi) {
-        for (int xi = 0; xi < _x_size; ++xi) {
-          if (!has_point(xi, yi)) {
-            continue;
-          }
-          LPoint3f &p = modify_point3(xi, yi);
-          transform.xform_point_general_in_place(p);
+    for (int yi = begin; yi < end; ++yi) {
+      for (int xi = 0; xi < x_size; ++xi) {
+        if (check_points && !_file->has_point(xi, yi)) {
+          continue;
         }
-      }
-    }
-    break;
+        switch (num_channels) {
+        case 1:
+          {
+            PN_float32 pi = _file->get_point1(xi, yi);
+            LPoint3f po = _transform.xform_point(LPoint3f(pi, 0.0, 0.0));
+            _file->set_point1(xi, yi, po[0]);
+          }
+          break;
 
-  case 4:
-    {
-      for (int yi = 0; yi < _y_size; ++yi) {
-        for (int xi = 0; xi < _x_size; ++xi) {
-          if (!has_point(xi, yi)) {
-            continue;
+        case 2:
+          {
+            LPoint2f pi = _file->get_point2(xi, yi);
+            LPoint3f po = _transform.xform_point(LPoint3f(pi[0], pi[1], 0.0));
+            _file->set_point2(xi, yi, LPoint2f(po[0], po[1]));
           }
-          LPoint4f &p = modify_point4(xi, yi);
-          transform.xform_in_place(p);
+          break;
+
+        case 3:
+          _transform.xform_point_general_in_place(_file->modify_point3(xi, yi));
+          break;
+
+        case 4:
+          _transform.xform_in_place(_file->modify_point4(xi, yi));
+          break;
         }
       }
     }
-    break;
   }
+
+  PfmFile *_file;
+  LMatrix4f _transform;
+};
+
+/**
+ * Applies the indicated transform matrix to all points in-place.
+ */
+void PfmFile::
+xform(const LMatrix4f &transform) {
+  nassertv(is_valid());
+
+  XformJob job;
+  job._file = this;
+  job._transform = transform;
+  run_row_job(job, _x_size, _y_size);
 }
 
 /**
@@ -1441,6 +1571,28 @@ apply_1d_lut(int channel, const PfmFile &lut, PN_float32 x_scale) {
   }
 }
 
+// This job copies the points that are missing in a range of rows from the
+// other file.
+class PfmFile::MergeJob : public WorkerPool::Job {
+public:
+  virtual void execute(int begin, int end) {
+    int num_channels = _file->_num_channels;
+    int x_size = _file->_x_size;
+    size_t point_size = num_channels * sizeof(PN_float32);
+    for (int y = begin; y < end; ++y) {
+      for (int x = 0; x < x_size; ++x) {
+        if (!_file->has_point(x, y) && _other->has_point(x, y)) {
+          size_t i = ((size_t)y * x_size + x) * num_channels;
+          memcpy(&_file->_table[i], &_other->_table[i], point_size);
+        }
+      }
+    }
+  }
+
+  PfmFile *_file;
+  const PfmFile *_other;
+};
+
 /**
  * Wherever there is missing data in this PfmFile (that is, wherever
  * has_point() returns false), copy data from the other PfmFile, which must be
@@ -1456,16 +1608,10 @@ merge(const PfmFile &other) {
     return;
   }
 
-  size_t point_size = _num_channels * sizeof(PN_float32);
-  for (int y = 0; y < _y_size; ++y) {
-    for (int x = 0; x < _x_size; ++x) {
-      if (!has_point(x, y) && other.has_point(x, y)) {
-        memcpy(&_table[(y * _x_size + x) * _num_channels],
-               &other._table[(y * _x_size + x) * _num_channels],
-               point_size);
-      }
-    }
-  }
+  MergeJob job;
+  job._file = this;
+  job._other = &other;
+  run_row_job(job, _x_size, _y_size);
 }
 
 /**
@@ -1633,33 +1779,16 @@ pull_spot(const LPoint4f &delta, float xc, float yc,
  */
 bool PfmFile::
 calc_tight_bounds(LPoint3f &min_point, LPoint3f &max_point) const {
-  min_point.set(0.0f, 0.0f, 0.0f);
-  max_point.set(0.0f, 0.0f, 0.0f);
-
-  bool found_any = false;
-  for (int yi = 0; yi < _y_size; ++yi) {
-    for (int xi = 0; xi < _x_size; ++xi) {
-      if (!has_point(xi, yi)) {
-        continue;
-      }
-
-      const LPoint3f &point = get_point(xi, yi);
-      if (!found_any) {
-        min_point = point;
-        max_point = point;
-        found_any = true;
-      } else {
-        min_point.set(min(min_point[0], point[0]),
-                      min(min_point[1], point[1]),
-                      min(min_point[2], point[2]));
-        max_point.set(max(max_point[0], point[0]),
-                      max(max_point[1], point[1]),
-                      max(max_point[2], point[2]));
-      }
-    }
-  }
-
-  return found_any;
+  BoundsJob job;
+  job._file = this;
+  job._found_any = false;
+  job._min_point = LPoint3f::zero();
+  job._max_point = LPoint3f::zero();
+  run_row_job(job, _x_size, _y_size);
+
+  min_point = job._min_point;
+  max_point = job._max_point;
+  return job._found_any;
 }
 
 /**
@@ -114,8 +114,13 @@ PUBLISHED:
   BLOCKING void resize(int new_x_size, int new_y_size);
   BLOCKING void box_filter_from(float radius, const PfmFile &copy);
   BLOCKING void gaussian_filter_from(float radius, const PfmFile &copy);
+  BLOCKING void bilinear_filter_from(float radius, const PfmFile &copy);
+  BLOCKING void lanczos_filter_from(float radius, const PfmFile &copy);
   BLOCKING void quick_filter_from(const PfmFile &copy);
 
+  BLOCKING void fill_signed_distance(const PfmFile &mask, int channel, PN_float32 threshold);
+  BLOCKING void fill_signed_distance(const PNMImage &mask, float threshold);
+
   BLOCKING void reverse_rows();
   BLOCKING void flip(bool flip_x, bool flip_y, bool transpose);
   BLOCKING void xform(const LMatrix4f &transform);
@@ -248,7 +253,20 @@ private:
   typedef bool HasPointFunc(const PfmFile *file, int x, int y);
   HasPointFunc *_has_point;
 
+  // These divide the bulk operations on the table among the threads of the
+  // WorkerPool, a range of rows at a time.
+  class FillJob;
+  class BoundsJob;
+  class XformJob;
+  class MergeJob;
+  class QuickFilterJob;
+
   friend class PfmVizzer;
+  friend class FillJob;
+  friend class BoundsJob;
+  friend class XformJob;
+  friend class MergeJob;
+  friend class QuickFilterJob;
 };
 
 #include "pfmFile.I"
@@ -0,0 +1,775 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file pnm-image-composite.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+// This file contains copy_sub_image() and the related functions of PNMImage
+// that composite one image onto another.
+//
+// Rather than going through get_xel() and set_xel() for each pixel, these
+// work on a whole row of the sub-image at a time.  When both images have the
+// same maxval and color space, the raw component values are copied or
+// compared directly.  Otherwise, each row is unpacked into an array of
+// linearized floats, combined, and packed up again; for linear images, which
+// are the common case, the unpacking and packing are done with SSE2.  Either
+// way, the results are exactly the same as those of the per-pixel functions.
+// The rows of large sub-images are divided among the threads of the
+// WorkerPool.
+
+#include "pandabase.h"
+#include "thread.h"
+#include "workerPool.h"
+#include "pvector.h"
+
+#include "pnmImage.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#endif
+
+enum CompositeOperation {
+  CO_copy,
+  CO_blend,
+  CO_add,
+  CO_mult,
+  CO_darken,
+  CO_lighten,
+};
+
+/**
+ * Converts the count component values in from to floats in the range 0..1,
+ * as by PNMImage::from_alpha_val(), or by PNMImage::from_val() for a linear
+ * image.  inv_maxval should be 1.0f / maxval.
+ */
+static void
+composite_decode(const xelval *from, float *into, size_t count,
+                 float inv_maxval) {
+  size_t i = 0;
+#if defined(PGM_BIGGRAYS) && (defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64))
+  __m128 scale = _mm_set1_ps(inv_maxval);
+  __m128i zero = _mm_setzero_si128();
+  for (; i + 8 <= count; i += 8) {
+    __m128i vals = _mm_loadu_si128((const __m128i *)(from + i));
+    __m128 lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(vals, zero));
+    __m128 hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(vals, zero));
+    _mm_storeu_ps(into + i, _mm_mul_ps(lo, scale));
+    _mm_storeu_ps(into + i + 4, _mm_mul_ps(hi, scale));
+  }
+#endif
+  for (; i < count; ++i) {
+    into[i] = (float)from[i] * inv_maxval;
+  }
+}
+
+#if defined(PGM_BIGGRAYS) && (defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64))
+/**
+ * Packs eight ints in the range 0..65535 into eight unsigned shorts.
+ */
+static INLINE __m128i
+_composite_pack_epu16(__m128i lo, __m128i hi) {
+  // There is no unsigned saturating pack in SSE2, so we shift the values into
+  // the signed range and back again.
+  __m128i bias32 = _mm_set1_epi32(0x8000);
+  __m128i bias16 = _mm_set1_epi16((short)0x8000);
+  return _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(lo, bias32),
+                                       _mm_sub_epi32(hi, bias32)), bias16);
+}
+#endif
+
+/**
+ * Converts the count floats in from to component values, as by
+ * PNMImage::to_val() for a linear image.
+ */
+static void
+composite_encode(const float *from, xelval *into, size_t count,
+                 xelval maxval) {
+  size_t i = 0;
+#if defined(PGM_BIGGRAYS) && (defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64))
+  // Clamping before the conversion gives the same result as clamping the
+  // converted integer, since the conversion truncates toward zero.  It also
+  // maps NaN to 0, as the integer conversion does.
+  __m128 scale = _mm_set1_ps((float)maxval);
+  __m128 half = _mm_set1_ps(0.5f);
+  __m128 zero = _mm_setzero_ps();
+  for (; i + 8 <= count; i += 8) {
+    __m128 lo = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(from + i), scale), half);
+    __m128 hi = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(from + i + 4), scale), half);
+    lo = _mm_min_ps(_mm_max_ps(lo, zero), scale);
+    hi = _mm_min_ps(_mm_max_ps(hi, zero), scale);
+    _mm_storeu_si128((__m128i *)(into + i),
+                     _composite_pack_epu16(_mm_cvttps_epi32(lo), _mm_cvttps_epi32(hi)));
+  }
+#endif
+  for (; i < count; ++i) {
+    int val = (int)(from[i] * maxval + 0.5f);
+    into[i] = (xelval)min(max(0, val), (int)maxval);
+  }
+}
+
+/**
+ * Converts the count floats in from to alpha values, as by
+ * PNMImage::to_alpha_val().
+ */
+static void
+composite_encode_alpha(const float *from, xelval *into, size_t count,
+                       xelval maxval) {
+  size_t i = 0;
+#if defined(PGM_BIGGRAYS) && (defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64))
+  // to_alpha_val() rounds in double precision.
+  __m128 scale = _mm_set1_ps((float)maxval);
+  __m128d half = _mm_set1_pd(0.5);
+  __m128d zero = _mm_setzero_pd();
+  __m128d dmaxval = _mm_set1_pd((double)maxval);
+  __m128i vals[2];
+  for (; i + 8 <= count; i += 8) {
+    for (int j = 0; j < 2; ++j) {
+      __m128 f = _mm_mul_ps(_mm_loadu_ps(from + i + j * 4), scale);
+      __m128d lo = _mm_add_pd(_mm_cvtps_pd(f), half);
+      __m128d hi = _mm_add_pd(_mm_cvtps_pd(_mm_movehl_ps(f, f)), half);
+      lo = _mm_min_pd(_mm_max_pd(lo, zero), dmaxval);
+      hi = _mm_min_pd(_mm_max_pd(hi, zero), dmaxval);
+      vals[j] = _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+    }
+    _mm_storeu_si128((__m128i *)(into + i), _composite_pack_epu16(vals[0], vals[1]));
+  }
+#endif
+  for (; i < count; ++i) {
+    int val = (int)(from[i] * maxval + 0.5);
+    into[i] = (xelval)min(max(0, val), (int)maxval);
+  }
+}
+
+/**
+ * Stores the lesser of each of the count component values in dest and src
+ * into dest.
+ */
+static void
+composite_min(xelval *dest, const xelval *src, size_t count) {
+  size_t i = 0;
+#if defined(PGM_BIGGRAYS) && (defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64))
+  // SSE2 only has a signed 16-bit min, so we flip the sign bits first.
+  __m128i bias = _mm_set1_epi16((short)0x8000);
+  for (; i + 8 <= count; i += 8) {
+    __m128i d = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(dest + i)), bias);
+    __m128i s = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src + i)), bias);
+    _mm_storeu_si128((__m128i *)(dest + i), _mm_xor_si128(_mm_min_epi16(d, s), bias));
+  }
+#endif
+  for (; i < count; ++i) {
+    dest[i] = min(src[i], dest[i]);
+  }
+}
+
+/**
+ * Stores the greater of each of the count component values in dest and src
+ * into dest.
+ */
+static void
+composite_max(xelval *dest, const xelval *src, size_t count) {
+  size_t i = 0;
+#if defined(PGM_BIGGRAYS) && (defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64))
+  __m128i bias = _mm_set1_epi16((short)0x8000);
+  for (; i + 8 <= count; i += 8) {
+    __m128i d = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(dest + i)), bias);
+    __m128i s = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src + i)), bias);
+    _mm_storeu_si128((__m128i *)(dest + i), _mm_xor_si128(_mm_max_epi16(d, s), bias));
+  }
+#endif
+  for (; i < count; ++i) {
+    dest[i] = max(src[i], dest[i]);
+  }
+}
+
+/**
+ * Stores d + s * scale into each of the count elements of d.
+ */
+static void
+composite_add(float *d, const float *s, size_t count, float scale) {
+  size_t i = 0;
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+  __m128 k = _mm_set1_ps(scale);
+  for (; i + 4 <= count; i += 4) {
+    __m128 r = _mm_add_ps(_mm_loadu_ps(d + i), _mm_mul_ps(_mm_loadu_ps(s + i), k));
+    _mm_storeu_ps(d + i, r);
+  }
+#endif
+  for (; i < count; ++i) {
+    d[i] = d[i] + s[i] * scale;
+  }
+}
+
+/**
+ * Stores d * s * scale into each of the count elements of d.
+ */
+static void
+composite_mult(float *d, const float *s, size_t count, float scale) {
+  size_t i = 0;
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+  __m128 k = _mm_set1_ps(scale);
+  for (; i + 4 <= count; i += 4) {
+    __m128 r = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(d + i), _mm_loadu_ps(s + i)), k);
+    _mm_storeu_ps(d + i, r);
+  }
+#endif
+  for (; i < count; ++i) {
+    d[i] = d[i] * s[i] * scale;
+  }
+}
+
+/**
+ * Stores the lesser of d and s scaled toward 1.0 into each of the count
+ * elements of d, as darken_sub_image() does.
+ */
+static void
+composite_darken(float *d, const float *s, size_t count, float scale) {
+  size_t i = 0;
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+  __m128 k = _mm_set1_ps(scale);
+  __m128 one = _mm_set1_ps(1.0f);
+  for (; i + 4 <= count; i += 4) {
+    __m128 c = _mm_sub_ps(one, _mm_mul_ps(_mm_sub_ps(one, _mm_loadu_ps(s + i)), k));
+    _mm_storeu_ps(d + i, _mm_min_ps(c, _mm_loadu_ps(d + i)));
+  }
+#endif
+  for (; i < count; ++i) {
+    d[i] = min(1.0f - ((1.0f - s[i]) * scale), d[i]);
+  }
+}
+
+/**
+ * Stores the greater of d and s * scale into each of the count elements of d,
+ * as lighten_sub_image() does.
+ */
+static void
+composite_lighten(float *d, const float *s, size_t count, float scale) {
+  size_t i = 0;
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+  __m128 k = _mm_set1_ps(scale);
+  for (; i + 4 <= count; i += 4) {
+    __m128 c = _mm_mul_ps(_mm_loadu_ps(s + i), k);
+    _mm_storeu_ps(d + i, _mm_max_ps(c, _mm_loadu_ps(d + i)));
+  }
+#endif
+  for (; i < count; ++i) {
+    d[i] = max(s[i] * scale, d[i]);
+  }
+}
+
+// This job composites a range of rows of one image onto another.  The rows
+// are numbered from the top of the sub-image.
+class CompositeJob : public WorkerPool::Job {
+public:
+  virtual void execute(int begin, int end);
+
+private:
+  bool is_linear(const PNMImage &image) const;
+  void read_xels(const PNMImage &image, int x, int y, float *into) const;
+  void write_xels(PNMImage &image, int x, int y, const float *from,
+                  const unsigned char *changed) const;
+  void read_alpha(const PNMImage &image, int x, int y, float *into) const;
+  void write_alpha(PNMImage &image, int x, int y, const float *from) const;
+  void blend_row(float *d, float *d_alpha, const float *s,
+                 const float *s_alpha, unsigned char *changed) const;
+
+public:
+  CompositeOperation _op;
+  PNMImage *_dest;
+  const PNMImage *_src;
+  int _xmin, _ymin;
+  int _xfrom, _yfrom;
+  int _x_size;
+  float _pixel_scale;
+
+  // True if the component values may be combined directly, without
+  // converting them to floats first.
+  bool _direct;
+};
+
+/**
+ * Returns true if the xels of the image are stored linearly in the range
+ * 0..maxval, so that they can be converted as a plain array.
+ */
+bool CompositeJob::
+is_linear(const PNMImage &image) const {
+  return image.get_color_space() == CS_linear &&
+    sizeof(xel) == 3 * sizeof(xelval);
+}
+
+/**
+ * Fills into with the linearized red, green and blue components of _x_size
+ * pixels, beginning at (x, y).
+ */
+void CompositeJob::
+read_xels(const PNMImage &image, int x, int y, float *into) const {
+  if (is_linear(image)) {
+    xelval maxval = image.get_maxval();
+    float inv_maxval = (maxval == 0) ? 0.0f : 1.0f / (float)maxval;
+    const xel *row = image.get_array() + (size_t)y * image.get_x_size() + x;
+    composite_decode((const xelval *)row, into, (size_t)_x_size * 3, inv_maxval);
+
+  } else {
+    for (int i = 0; i < _x_size; ++i) {
+      LRGBColorf rgb = image.get_xel(x + i, y);
+      into[i * 3 + 0] = rgb[0];
+      into[i * 3 + 1] = rgb[1];
+      into[i * 3 + 2] = rgb[2];
+    }
+  }
+}
+
+/**
+ * Stores the linearized red, green and blue components of _x_size pixels,
+ * beginning at (x, y).  If changed is not NULL, only the pixels for which it
+ * is nonzero need to be stored.
+ */
+void CompositeJob::
+write_xels(PNMImage &image, int x, int y, const float *from,
+           const unsigned char *changed) const {
+  if (is_linear(image)) {
+    // Storing the unchanged pixels back is harmless, since the conversion of
+    // a linear value to float and back always returns the same value.
+    xel *row = image.get_array() + (size_t)y * image.get_x_size() + x;
+    composite_encode(from, (xelval *)row, (size_t)_x_size * 3, image.get_maxval());
+
+  } else {
+    for (int i = 0; i < _x_size; ++i) {
+      if (changed == NULL || changed[i]) {
+        image.set_xel(x + i, y, LRGBColorf(from[i * 3 + 0], from[i * 3 + 1], from[i * 3 + 2]));
+      }
+    }
+  }
+}
+
+/**
+ * Fills into with the alpha values of _x_size pixels, beginning at (x, y).
+ */
+void CompositeJob::
+read_alpha(const PNMImage &image, int x, int y, float *into) const {
+  xelval maxval = image.get_maxval();
+  float inv_maxval = (maxval == 0) ? 0.0f : 1.0f / (float)maxval;
+  const xelval *row = image.get_alpha_array() + (size_t)y * image.get_x_size() + x;
+  composite_decode(row, into, _x_size, inv_maxval);
+}
+
+/**
+ * Stores the alpha values of _x_size pixels, beginning at (x, y).
+ */
+void CompositeJob::
+write_alpha(PNMImage &image, int x, int y, const float *from) const {
+  xelval *row = image.get_alpha_array() + (size_t)y * image.get_x_size() + x;
+  composite_encode_alpha(from, row, _x_size, image.get_maxval());
+}
+
+/**
+ * Blends one row of the source into the destination, as PNMImage::blend()
+ * does.  d_alpha is NULL if the destination has no alpha channel, and s_alpha
+ * if the source has none.  Sets changed[i] for each pixel that was modified.
+ */
+void CompositeJob::
+blend_row(float *d, float *d_alpha, const float *s,
+          const float *s_alpha, unsigned char *changed) const {
+  for (int i = 0; i < _x_size; ++i) {
+    float alpha = (s_alpha != NULL) ? s_alpha[i] * _pixel_scale : _pixel_scale;
+    float *dp = d + i * 3;
+    const float *sp = s + i * 3;
+
+    if (alpha >= 1.0) {
+      // Completely replace the previous color.
+      if (d_alpha != NULL) {
+        d_alpha[i] = 1.0f;
+      }
+      dp[0] = sp[0];
+      dp[1] = sp[1];
+      dp[2] = sp[2];
+      changed[i] = 1;
+
+    } else if (alpha > 0.0f) {
+      float prev_alpha = (d_alpha != NULL) ? d_alpha[i] : 1.0f;
+
+      if (prev_alpha == 0.0f) {
+        // Nothing there previously; replace with this new color.
+        d_alpha[i] = alpha;
+        dp[0] = sp[0];
+        dp[1] = sp[1];
+        dp[2] = sp[2];
+
+      } else {
+        // Blend the color with the previous color.
+        dp[0] = sp[0] + (1.0f - alpha) * (dp[0] - sp[0]);
+        dp[1] = sp[1] + (1.0f - alpha) * (dp[1] - sp[1]);
+        dp[2] = sp[2] + (1.0f - alpha) * (dp[2] - sp[2]);
+        if (d_alpha != NULL) {
+          d_alpha[i] = prev_alpha + alpha * (1.0f - prev_alpha);
+        }
+      }
+      changed[i] = 1;
+
+    } else {
+      changed[i] = 0;
+    }
+  }
+}
+
+/**
+ * Composites the indicated rows.
+ */
+void CompositeJob::
+execute(int begin, int end) {
+  PNMImage &dest = *_dest;
+  const PNMImage &src = *_src;
+  bool both_alpha = dest.has_alpha() && src.has_alpha();
+  size_t num_xels = (size_t)_x_size * 3;
+
+  pvector<float> d_rgb, s_rgb, d_alpha, s_alpha;
+  pvector<unsigned char> changed;
+  if (!_direct) {
+    d_rgb.resize(num_xels);
+    s_rgb.resize(num_xels);
+    d_alpha.resize(_x_size);
+    s_alpha.resize(_x_size);
+    changed.resize(_x_size);
+  }
+
+  for (int yi = begin; yi < end; ++yi) {
+    int y = _ymin + yi;
+    int sy = _yfrom + yi;
+
+    if (_direct) {
+      // The component values have the same meaning in both images.
+      xel *d = dest.get_array() + (size_t)y * dest.get_x_size() + _xmin;
+      const xel *s = src.get_array() + (size_t)sy * src.get_x_size() + _xfrom;
+      xelval *da = NULL;
+      const xelval *sa = NULL;
+      if (both_alpha) {
+        da = dest.get_alpha_array() + (size_t)y * dest.get_x_size() + _xmin;
+        sa = src.get_alpha_array() + (size_t)sy * src.get_x_size() + _xfrom;
+      }
+
+      switch (_op) {
+      case CO_copy:
+        // The two images may be one and the same.
+        memmove(d, s, _x_size * sizeof(xel));
+        if (both_alpha) {
+          memmove(da, sa, _x_size * sizeof(xelval));
+        }
+        break;
+
+      case CO_darken:
+        composite_min((xelval *)d, (const xelval *)s, num_xels);
+        if (both_alpha) {
+          composite_min(da, sa, _x_size);
+        }
+        break;
+
+      case CO_lighten:
+        composite_max((xelval *)d, (const xelval *)s, num_xels);
+        if (both_alpha) {
+          composite_max(da, sa, _x_size);
+        }
+        break;
+
+      default:
+        nassertv(false);
+      }
+
+    } else {
+      read_xels(src, _xfrom, sy, &s_rgb[0]);
+      if (_op != CO_copy) {
+        read_xels(dest, _xmin, y, &d_rgb[0]);
+      }
+
+      if (_op == CO_blend) {
+        float *da = NULL;
+        const float *sa = NULL;
+        if (src.has_alpha()) {
+          read_alpha(src, _xfrom, sy, &s_alpha[0]);
+          sa = &s_alpha[0];
+        }
+        if (dest.has_alpha()) {
+          read_alpha(dest, _xmin, y, &d_alpha[0]);
+          da = &d_alpha[0];
+        }
+        blend_row(&d_rgb[0], da, &s_rgb[0], sa, &changed[0]);
+        write_xels(dest, _xmin, y, &d_rgb[0], &changed[0]);
+        if (da != NULL) {
+          write_alpha(dest, _xmin, y, da);
+        }
+        continue;
+      }
+
+      if (both_alpha) {
+        read_alpha(src, _xfrom, sy, &s_alpha[0]);
+        if (_op != CO_copy) {
+          read_alpha(dest, _xmin, y, &d_alpha[0]);
+        }
+      }
+
+      float *d = &d_rgb[0];
+      float *da = &d_alpha[0];
+      switch (_op) {
+      case CO_copy:
+        d = &s_rgb[0];
+        da = &s_alpha[0];
+        break;
+
+      case CO_add:
+        composite_add(d, &s_rgb[0], num_xels, _pixel_scale);
+        composite_add(da, &s_alpha[0], both_alpha ? _x_size : 0, _pixel_scale);
+        break;
+
+      case CO_mult:
+        composite_mult(d, &s_rgb[0], num_xels, _pixel_scale);
+        composite_mult(da, &s_alpha[0], both_alpha ? _x_size : 0, _pixel_scale);
+        break;
+
+      case CO_darken:
+        composite_darken(d, &s_rgb[0], num_xels, _pixel_scale);
+        composite_darken(da, &s_alpha[0], both_alpha ? _x_size : 0, _pixel_scale);
+        break;
+
+      case CO_lighten:
+        composite_lighten(d, &s_rgb[0], num_xels, _pixel_scale);
+        composite_lighten(da, &s_alpha[0], both_alpha ? _x_size : 0, _pixel_scale);
+        break;
+
+      default:
+        nassertv(false);
+      }
+
+      write_xels(dest, _xmin, y, d, NULL);
+      if (both_alpha) {
+        write_alpha(dest, _xmin, y, da);
+      }
+    }
+
+    Thread::consider_yield();
+  }
+}
+
+/**
+ * Runs the job over all of the rows of the sub-image, dividing them among the
+ * threads of the WorkerPool.  Small sub-images aren't worth waking up the
+ * other threads for, and neither is an image that is being composited onto
+ * itself, since the rows might overlap.
+ */
+static void
+run_composite_job(CompositeJob &job, int x_size, int y_size) {
+  if (x_size <= 0 || y_size <= 0) {
+    return;
+  }
+  if ((size_t)x_size * (size_t)y_size < 65536 || job._dest == job._src) {
+    job.execute(0, y_size);
+    return;
+  }
+  WorkerPool *pool = WorkerPool::get_global_ptr();
+  pool->run(job, y_size, max(1, y_size / ((pool->get_num_threads() + 1) * 4)));
+}
+
+/**
+ * Copies a rectangular area of another image into a rectangular area of this
+ * image.  Both images must already have been initialized.  The upper-left
+ * corner of the region in both images is specified, and the size of the area;
+ * if the size is omitted, it defaults to the entire other image, or the
+ * largest piece that will fit.
+ */
+void PNMImage::
+copy_sub_image(const PNMImage &copy, int xto, int yto,
+               int xfrom, int yfrom, int x_size, int y_size) {
+  int xmin, ymin, xmax, ymax;
+  setup_sub_image(copy, xto, yto, xfrom, yfrom, x_size, y_size,
+                  xmin, ymin, xmax, ymax);
+
+  CompositeJob job;
+  job._op = CO_copy;
+  job._dest = this;
+  job._src = &copy;
+  job._xmin = xmin;
+  job._ymin = ymin;
+  job._xfrom = xfrom;
+  job._yfrom = yfrom;
+  job._x_size = xmax - xmin;
+  job._pixel_scale = 1.0f;
+
+  // The simple case: no pixel value rescaling is required.
+  job._direct = (get_maxval() == copy.get_maxval() &&
+                 get_color_space() == copy.get_color_space());
+
+  run_composite_job(job, xmax - xmin, ymax - ymin);
+}
+
+/**
+ * Behaves like copy_sub_image(), except the alpha channel of the copy is used
+ * to blend the copy into the destination image, instead of overwriting pixels
+ * unconditionally.
+ *
+ * If pixel_scale is not 1.0, it specifies an amount to scale each *alpha*
+ * value of the source image before applying it to the target image.
+ *
+ * If pixel_scale is 1.0 and the copy has no alpha channel, this degenerates
+ * into copy_sub_image().
+ */
+void PNMImage::
+blend_sub_image(const PNMImage &copy, int xto, int yto,
+                int xfrom, int yfrom, int x_size, int y_size,
+                float pixel_scale) {
+  if (!copy.has_alpha() && pixel_scale == 1.0) {
+    copy_sub_image(copy, xto, yto, xfrom, yfrom, x_size, y_size);
+    return;
+  }
+
+  int xmin, ymin, xmax, ymax;
+  setup_sub_image(copy, xto, yto, xfrom, yfrom, x_size, y_size,
+                  xmin, ymin, xmax, ymax);
+
+  CompositeJob job;
+  job._op = CO_blend;
+  job._dest = this;
+  job._src = &copy;
+  job._xmin = xmin;
+  job._ymin = ymin;
+  job._xfrom = xfrom;
+  job._yfrom = yfrom;
+  job._x_size = xmax - xmin;
+  job._pixel_scale = pixel_scale;
+  job._direct = false;
+
+  run_composite_job(job, xmax - xmin, ymax - ymin);
+}
+
+/**
+ * Behaves like copy_sub_image(), except the copy pixels are added to the
+ * pixels of the destination, after scaling by the specified pixel_scale.
+ * Unlike blend_sub_image(), the alpha channel is not treated specially.
+ */
+void PNMImage::
+add_sub_image(const PNMImage &copy, int xto, int yto,
+              int xfrom, int yfrom, int x_size, int y_size,
+              float pixel_scale) {
+  int xmin, ymin, xmax, ymax;
+  setup_sub_image(copy, xto, yto, xfrom, yfrom, x_size, y_size,
+                  xmin, ymin, xmax, ymax);
+
+  CompositeJob job;
+  job._op = CO_add;
+  job._dest = this;
+  job._src = &copy;
+  job._xmin = xmin;
+  job._ymin = ymin;
+  job._xfrom = xfrom;
+  job._yfrom = yfrom;
+  job._x_size = xmax - xmin;
+  job._pixel_scale = pixel_scale;
+  job._direct = false;
+
+  run_composite_job(job, xmax - xmin, ymax - ymin);
+}
+
+/**
+ * Behaves like copy_sub_image(), except the copy pixels are multiplied to the
+ * pixels of the destination, after scaling by the specified pixel_scale.
+ * Unlike blend_sub_image(), the alpha channel is not treated specially.
+ */
+void PNMImage::
+mult_sub_image(const PNMImage &copy, int xto, int yto,
+               int xfrom, int yfrom, int x_size, int y_size,
+               float pixel_scale) {
+  int xmin, ymin, xmax, ymax;
+  setup_sub_image(copy, xto, yto, xfrom, yfrom, x_size, y_size,
+                  xmin, ymin, xmax, ymax);
+
+  CompositeJob job;
+  job._op = CO_mult;
+  job._dest = this;
+  job._src = &copy;
+  job._xmin = xmin;
+  job._ymin = ymin;
+  job._xfrom = xfrom;
+  job._yfrom = yfrom;
+  job._x_size = xmax - xmin;
+  job._pixel_scale = pixel_scale;
+  job._direct = false;
+
+  run_composite_job(job, xmax - xmin, ymax - ymin);
+}
+
+/**
+ * Behaves like copy_sub_image(), but the resulting color will be the darker
+ * of the source and destination colors at each pixel (and at each R, G, B, A
+ * component value).
+ *
+ * If pixel_scale is not 1.0, it specifies an amount to scale each pixel value
+ * of the source image before applying it to the target image.  The scale is
+ * applied with the center at 1.0: scaling the pixel value smaller brings it
+ * closer to 1.0.
+ */
+void PNMImage::
+darken_sub_image(const PNMImage &copy, int xto, int yto,
+                 int xfrom, int yfrom, int x_size, int y_size,
+                 float pixel_scale) {
+  int xmin, ymin, xmax, ymax;
+  setup_sub_image(copy, xto, yto, xfrom, yfrom, x_size, y_size,
+                  xmin, ymin, xmax, ymax);
+
+  CompositeJob job;
+  job._op = CO_darken;
+  job._dest = this;
+  job._src = &copy;
+  job._xmin = xmin;
+  job._ymin = ymin;
+  job._xfrom = xfrom;
+  job._yfrom = yfrom;
+  job._x_size = xmax - xmin;
+  job._pixel_scale = pixel_scale;
+
+  // The simple case: no pixel value rescaling is required.
+  job._direct = (get_maxval() == copy.get_maxval() && pixel_scale == 1.0f &&
+                 get_color_space() == CS_linear &&
+                 copy.get_color_space() == CS_linear);
+
+  run_composite_job(job, xmax - xmin, ymax - ymin);
+}
+
+/**
+ * Behaves like copy_sub_image(), but the resulting color will be the lighter
+ * of the source and destination colors at each pixel (and at each R, G, B, A
+ * component value).
+ *
+ * If pixel_scale is not 1.0, it specifies an amount to scale each pixel value
+ * of the source image before applying it to the target image.
+ */
+void PNMImage::
+lighten_sub_image(const PNMImage &copy, int xto, int yto,
+                  int xfrom, int yfrom, int x_size, int y_size,
+                  float pixel_scale) {
+  int xmin, ymin, xmax, ymax;
+  setup_sub_image(copy, xto, yto, xfrom, yfrom, x_size, y_size,
+                  xmin, ymin, xmax, ymax);
+
+  CompositeJob job;
+  job._op = CO_lighten;
+  job._dest = this;
+  job._src = &copy;
+  job._xmin = xmin;
+  job._ymin = ymin;
+  job._xfrom = xfrom;
+  job._yfrom = yfrom;
+  job._x_size = xmax - xmin;
+  job._pixel_scale = pixel_scale;
+
+  // The simple case: no pixel value rescaling is required.
+  job._direct = (get_maxval() == copy.get_maxval() && pixel_scale == 1.0f &&
+                 get_color_space() == CS_linear &&
+                 copy.get_color_space() == CS_linear);
+
+  run_composite_job(job, xmax - xmin, ymax - ymin);
+}
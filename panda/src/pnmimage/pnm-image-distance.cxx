@@ -0,0 +1,436 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file pnm-image-distance.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+// This file contains the distance transforms used by the fill_distance_*()
+// and fill_signed_distance() functions of PNMImage and PfmFile.
+//
+// The two-dimensional transforms are separable: each column is transformed
+// on its own, and then each row of the result.  The one-dimensional
+// Euclidean transform is the lower envelope of parabolas described by
+// Felzenszwalb and Huttenlocher in "Distance Transforms of Sampled
+// Functions", which takes linear time regardless of the distances involved.
+// The columns, and then the rows, are independent of each other, so they are
+// divided among the threads of the WorkerPool.
+
+#include "pandabase.h"
+#include "cmath.h"
+#include "thread.h"
+#include "workerPool.h"
+#include "pvector.h"
+
+#include "pnmImage.h"
+#include "pfmFile.h"
+
+// The number of columns that are copied out of the grid at once.  Gathering
+// several neighboring columns makes better use of each cache line.
+static const int distance_column_block = 16;
+
+/**
+ * Computes the squared Euclidean distance transform of the n samples in f,
+ * into d.  v must have room for n elements and z for n + 1.  All values of f
+ * must be finite.
+ */
+static void
+distance_transform_1d(const double *f, double *d, int n, int *v, double *z) {
+  int k = 0;
+  v[0] = 0;
+  z[0] = -HUGE_VAL;
+  z[1] = HUGE_VAL;
+
+  for (int q = 1; q < n; ++q) {
+    double fq = f[q] + (double)q * (double)q;
+    double s;
+    while (true) {
+      int r = v[k];
+      s = (fq - (f[r] + (double)r * (double)r)) / (2.0 * (double)(q - r));
+      if (s > z[k]) {
+        break;
+      }
+      // The parabola at v[k] is hidden entirely by the one at q.
+      --k;
+    }
+    ++k;
+    v[k] = q;
+    z[k] = s;
+    z[k + 1] = HUGE_VAL;
+  }
+
+  k = 0;
+  for (int q = 0; q < n; ++q) {
+    while (z[k + 1] < (double)q) {
+      ++k;
+    }
+    double dq = (double)(q - v[k]);
+    d[q] = dq * dq + f[v[k]];
+  }
+}
+
+/**
+ * Computes the Manhattan distance transform of the n samples in d, in place.
+ */
+static void
+manhattan_transform_1d(double *d, int n) {
+  for (int i = 1; i < n; ++i) {
+    d[i] = min(d[i], d[i - 1] + 1.0);
+  }
+  for (int i = n - 2; i >= 0; --i) {
+    d[i] = min(d[i], d[i + 1] + 1.0);
+  }
+}
+
+// This job transforms a range of columns, or a range of rows, of the grid.
+class DistanceTransformJob : public WorkerPool::Job {
+public:
+  virtual void execute(int begin, int end) {
+    int n = _columns ? _y_size : _x_size;
+    pvector<double> f(n * distance_column_block);
+    pvector<double> d(n);
+    pvector<double> z(n + 1);
+    pvector<int> v(n);
+
+    if (_columns) {
+      for (int x0 = begin; x0 < end; x0 += distance_column_block) {
+        int num_columns = min(distance_column_block, end - x0);
+        for (int y = 0; y < _y_size; ++y) {
+          const float *p = _grid + (size_t)y * _x_size + x0;
+          for (int c = 0; c < num_columns; ++c) {
+            f[c * n + y] = p[c];
+          }
+        }
+        for (int c = 0; c < num_columns; ++c) {
+          transform(&f[c * n], &d[0], n, &v[0], &z[0]);
+        }
+        for (int y = 0; y < _y_size; ++y) {
+          float *p = _grid + (size_t)y * _x_size + x0;
+          for (int c = 0; c < num_columns; ++c) {
+            p[c] = (float)f[c * n + y];
+          }
+        }
+        Thread::consider_yield();
+      }
+    } else {
+      for (int y = begin; y < end; ++y) {
+        float *p = _grid + (size_t)y * _x_size;
+        for (int x = 0; x < _x_size; ++x) {
+          f[x] = p[x];
+        }
+        transform(&f[0], &d[0], n, &v[0], &z[0]);
+        for (int x = 0; x < _x_size; ++x) {
+          p[x] = (float)f[x];
+        }
+        Thread::consider_yield();
+      }
+    }
+  }
+
+  // Transforms the n samples of f in place; d, v and z are scratch space.
+  void transform(double *f, double *d, int n, int *v, double *z) const {
+    if (_border) {
+      // There is a seed just beyond either end of the line.
+      for (int i = 0; i < n; ++i) {
+        double b = (double)min(i + 1, n - i);
+        f[i] = min(f[i], _euclidean ? b * b : b);
+      }
+    }
+    if (_euclidean) {
+      distance_transform_1d(f, d, n, v, z);
+      for (int i = 0; i < n; ++i) {
+        f[i] = d[i];
+      }
+    } else {
+      manhattan_transform_1d(f, n);
+    }
+  }
+
+  float *_grid;
+  int _x_size, _y_size;
+  bool _columns;
+  bool _euclidean;
+  bool _border;
+};
+
+/**
+ * Returns a value that is larger than any distance that can be measured
+ * within a grid of the given size, to stand for the pixels that are not
+ * seeds.  If euclidean is true, this is a squared distance.
+ */
+static float
+get_distance_infinity(int x_size, int y_size, bool euclidean) {
+  if (euclidean) {
+    return (float)x_size * (float)x_size + (float)y_size * (float)y_size;
+  } else {
+    return (float)(x_size + y_size);
+  }
+}
+
+/**
+ * Replaces each value of the x_size * y_size grid, which should be 0 for the
+ * seed points and get_distance_infinity() for all other points, with the
+ * distance to the nearest seed point.  If euclidean is true, this is the
+ * squared Euclidean distance; otherwise, it is the Manhattan distance.  If
+ * border is true, the grid is considered to be surrounded by seed points.
+ */
+static void
+compute_distance_transform(pvector<float> &grid, int x_size, int y_size,
+                           bool euclidean, bool border) {
+  if (x_size == 0 || y_size == 0) {
+    return;
+  }
+  nassertv(grid.size() >= (size_t)x_size * (size_t)y_size);
+
+  DistanceTransformJob job;
+  job._grid = &grid[0];
+  job._x_size = x_size;
+  job._y_size = y_size;
+  job._euclidean = euclidean;
+  job._border = border;
+
+  WorkerPool *pool = WorkerPool::get_global_ptr();
+  int pieces = (pool->get_num_threads() + 1) * 4;
+
+  job._columns = true;
+  pool->run(job, x_size, max(distance_column_block, x_size / pieces));
+
+  job._columns = false;
+  pool->run(job, y_size, max(16, y_size / pieces));
+}
+
+/**
+ * Computes the signed Euclidean distance, in pixels, from each point of the
+ * grid to the edge of the region for which inside is true.  The result is
+ * positive inside the region and negative outside it, and the edge runs
+ * halfway between the pixels on either side of it, so that the pixels
+ * adjacent to the edge are at +/- 0.5.
+ *
+ * If the region is empty or covers the whole grid, there is no edge; the
+ * distance is then measured as the length of the grid's diagonal.
+ */
+static void
+compute_signed_distance(pvector<float> &result, const pvector<bool> &inside,
+                        int x_size, int y_size) {
+  size_t size = (size_t)x_size * (size_t)y_size;
+  float inf = get_distance_infinity(x_size, y_size, true);
+
+  // The distance from each outside pixel to the nearest inside pixel, and
+  // the distance from each inside pixel to the nearest outside pixel.
+  pvector<float> to_inside(size);
+  result.resize(size);
+  for (size_t i = 0; i < size; ++i) {
+    to_inside[i] = inside[i] ? 0.0f : inf;
+    result[i] = inside[i] ? inf : 0.0f;
+  }
+
+  compute_distance_transform(to_inside, x_size, y_size, true, false);
+  compute_distance_transform(result, x_size, y_size, true, false);
+
+  for (size_t i = 0; i < size; ++i) {
+    if (inside[i]) {
+      result[i] = csqrt(result[i]) - 0.5f;
+    } else {
+      result[i] = 0.5f - csqrt(to_inside[i]);
+    }
+  }
+}
+
+/**
+ * Replaces this image with a grayscale image whose gray channel represents
+ * the linear Manhattan distance from the nearest dark pixel in the given mask
+ * image, up to the specified radius value (which also becomes the new
+ * maxval).  radius may range from 0 to maxmaxval.  A dark pixel is defined as
+ * one whose pixel value is < threshold.
+ *
+ * If shrink_from_border is true, then the mask image is considered to be
+ * surrounded by a border of dark pixels; otherwise, the border isn't
+ * considered.
+ *
+ * This can be used, in conjunction with threshold, to shrink a mask image
+ * inwards by a certain number of pixels.
+ *
+ * The mask image may be the same image as this one, in which case it is
+ * destructively modified by this process.
+ */
+void PNMImage::
+fill_distance_inside(const PNMImage &mask, float threshold, int radius, bool shrink_from_border) {
+  nassertv(radius <= PNM_MAXMAXVAL);
+  int x_size = mask.get_x_size();
+  int y_size = mask.get_y_size();
+  xelval threshold_val = mask.to_val(threshold);
+  float inf = get_distance_infinity(x_size, y_size, false);
+
+  pvector<float> grid((size_t)x_size * (size_t)y_size);
+  for (int yi = 0; yi < y_size; ++yi) {
+    for (int xi = 0; xi < x_size; ++xi) {
+      grid[(size_t)yi * x_size + xi] =
+        (mask.get_gray_val(xi, yi) < threshold_val) ? 0.0f : inf;
+    }
+  }
+
+  compute_distance_transform(grid, x_size, y_size, false, shrink_from_border);
+
+  clear(x_size, y_size, 1, radius, NULL, CS_linear);
+  for (int yi = 0; yi < y_size; ++yi) {
+    for (int xi = 0; xi < x_size; ++xi) {
+      float d = grid[(size_t)yi * x_size + xi];
+      set_gray_val(xi, yi, (xelval)min(d, (float)radius));
+    }
+  }
+}
+
+/**
+ * Replaces this image with a grayscale image whose gray channel represents
+ * the linear Manhattan distance from the nearest white pixel in the given
+ * mask image, up to the specified radius value (which also becomes the new
+ * maxval).  radius may range from 0 to maxmaxval.  A white pixel is defined
+ * as one whose pixel value is >= threshold.
+ *
+ * This can be used, in conjunction with threshold, to grow a mask image
+ * outwards by a certain number of pixels.
+ *
+ * The mask image may be the same image as this one, in which case it is
+ * destructively modified by this process.
+ */
+void PNMImage::
+fill_distance_outside(const PNMImage &mask, float threshold, int radius) {
+  nassertv(radius <= PNM_MAXMAXVAL);
+  int x_size = mask.get_x_size();
+  int y_size = mask.get_y_size();
+  xelval threshold_val = mask.to_val(threshold);
+  float inf = get_distance_infinity(x_size, y_size, false);
+
+  pvector<float> grid((size_t)x_size * (size_t)y_size);
+  for (int yi = 0; yi < y_size; ++yi) {
+    for (int xi = 0; xi < x_size; ++xi) {
+      grid[(size_t)yi * x_size + xi] =
+        (mask.get_gray_val(xi, yi) >= threshold_val) ? 0.0f : inf;
+    }
+  }
+
+  compute_distance_transform(grid, x_size, y_size, false, false);
+
+  clear(x_size, y_size, 1, radius, NULL, CS_linear);
+  for (int yi = 0; yi < y_size; ++yi) {
+    for (int xi = 0; xi < x_size; ++xi) {
+      float d = grid[(size_t)yi * x_size + xi];
+      set_gray_val(xi, yi, (xelval)min(d, (float)radius));
+    }
+  }
+}
+
+/**
+ * Replaces this image with a grayscale signed distance field computed from
+ * the given mask image, as used for rendering scalable font glyphs and masks.
+ * A pixel of the mask is inside the shape if its gray value is >= threshold.
+ *
+ * The gray value of each pixel represents the exact Euclidean distance from
+ * the pixel to the edge of the shape: 0.5 on the edge itself, rising to 1.0
+ * at radius pixels inside the shape, and falling to 0.0 at radius pixels
+ * outside it.  The image retains its current maxval.
+ *
+ * The running time does not depend on radius.  The mask image may be the same
+ * image as this one, in which case it is destructively modified by this
+ * process.
+ */
+void PNMImage::
+fill_signed_distance(const PNMImage &mask, float threshold, float radius) {
+  nassertv(radius > 0.0f);
+  int x_size = mask.get_x_size();
+  int y_size = mask.get_y_size();
+  xelval threshold_val = mask.to_val(threshold);
+
+  pvector<bool> inside((size_t)x_size * (size_t)y_size);
+  for (int yi = 0; yi < y_size; ++yi) {
+    for (int xi = 0; xi < x_size; ++xi) {
+      inside[(size_t)yi * x_size + xi] = (mask.get_gray_val(xi, yi) >= threshold_val);
+    }
+  }
+
+  pvector<float> dist;
+  compute_signed_distance(dist, inside, x_size, y_size);
+
+  xelval maxval = get_maxval();
+  clear(x_size, y_size, 1, maxval, NULL, CS_linear);
+
+  float scale = 0.5f / radius;
+  for (int yi = 0; yi < y_size; ++yi) {
+    for (int xi = 0; xi < x_size; ++xi) {
+      float v = dist[(size_t)yi * x_size + xi] * scale + 0.5f;
+      v = min(max(v, 0.0f), 1.0f);
+      set_gray_val(xi, yi, (xelval)(v * maxval + 0.5f));
+    }
+  }
+}
+
+/**
+ * Replaces this PfmFile with a one-channel signed distance field computed
+ * from the given mask.  A point of the mask is inside the shape if it is
+ * present (see has_point()) and its value in the indicated channel is >=
+ * threshold.
+ *
+ * Each value is the exact Euclidean distance, in pixels, from the point to
+ * the edge of the shape, which runs halfway between the points on either side
+ * of it.  It is positive inside the shape and negative outside.  If the shape
+ * is empty or fills the whole file, the distance is measured as the length of
+ * the diagonal.
+ *
+ * The mask may be the same PfmFile as this one, in which case it is
+ * destructively modified by this process.
+ */
+void PfmFile::
+fill_signed_distance(const PfmFile &mask, int channel, PN_float32 threshold) {
+  nassertv(channel >= 0 && channel < mask.get_num_channels());
+  int x_size = mask.get_x_size();
+  int y_size = mask.get_y_size();
+
+  pvector<bool> inside((size_t)x_size * (size_t)y_size);
+  for (int yi = 0; yi < y_size; ++yi) {
+    for (int xi = 0; xi < x_size; ++xi) {
+      inside[(size_t)yi * x_size + xi] =
+        mask.has_point(xi, yi) && mask.get_channel(xi, yi, channel) >= threshold;
+    }
+  }
+
+  pvector<float> dist;
+  compute_signed_distance(dist, inside, x_size, y_size);
+
+  clear(x_size, y_size, 1);
+  if (!dist.empty()) {
+    memcpy(&_table[0], &dist[0], dist.size() * sizeof(PN_float32));
+  }
+}
+
+/**
+ * Replaces this PfmFile with a one-channel signed distance field computed
+ * from the given mask image.  A pixel of the mask is inside the shape if its
+ * gray value is >= threshold.  See the other overload of this method.
+ */
+void PfmFile::
+fill_signed_distance(const PNMImage &mask, float threshold) {
+  int x_size = mask.get_x_size();
+  int y_size = mask.get_y_size();
+  xelval threshold_val = mask.to_val(threshold);
+
+  pvector<bool> inside((size_t)x_size * (size_t)y_size);
+  for (int yi = 0; yi < y_size; ++yi) {
+    for (int xi = 0; xi < x_size; ++xi) {
+      inside[(size_t)yi * x_size + xi] = (mask.get_gray_val(xi, yi) >= threshold_val);
+    }
+  }
+
+  pvector<float> dist;
+  compute_signed_distance(dist, inside, x_size, y_size);
+
+  clear(x_size, y_size, 1);
+  if (!dist.empty()) {
+    memcpy(&_table[0], &dist[0], dist.size() * sizeof(PN_float32));
+  }
+}
@@ -25,89 +25,139 @@ FUNCTION_NAME(IMAGETYPE &dest, const IMAGETYPE &source,
 
   // First, set up a 2-d column-major matrix of StoreTypes, big enough to hold
   // the image xelvals scaled in the A direction only.  This will hold the
-  // adjusted xel data from our first pass.
-
-  StoreType **matrix = (StoreType **)PANDA_MALLOC_ARRAY(dest.ASIZE() * sizeof(StoreType *));
-  StoreType **matrix_weight = (StoreType **)PANDA_MALLOC_ARRAY(dest.ASIZE() * sizeof(StoreType *));
-
-  int a, b;
-
-  for (a=0; a<dest.ASIZE(); a++) {
-    matrix[a] = (StoreType *)PANDA_MALLOC_ARRAY(source.BSIZE() * sizeof(StoreType));
-    matrix_weight[a] = (StoreType *)PANDA_MALLOC_ARRAY(source.BSIZE() * sizeof(StoreType));
-  }
+  // adjusted xel data from our first pass.  Column a begins at element
+  // a * source.BSIZE().
+
+  int dest_a = dest.ASIZE();
+  int dest_b = dest.BSIZE();
+  int source_a = source.ASIZE();
+  int source_b = source.BSIZE();
+
+  size_t matrix_size = (size_t)dest_a * source_b * sizeof(StoreType);
+  StoreType *matrix = (StoreType *)PANDA_MALLOC_ARRAY(matrix_size);
+  StoreType *matrix_weight = (StoreType *)PANDA_MALLOC_ARRAY(matrix_size);
+
+  WorkerPool *pool = WorkerPool::get_global_ptr();
+
+  // First, scale the image in the A direction.  Each row is independent of
+  // the others, so the rows are divided among the threads of the pool.
+  class APass : public WorkerPool::Job {
+  public:
+    virtual void execute(int begin, int end) {
+      int source_a = _source->ASIZE();
+      int dest_a = _dest->ASIZE();
+      int source_b = _source->BSIZE();
+      StoreType *temp_source = (StoreType *)PANDA_MALLOC_ARRAY(source_a * sizeof(StoreType));
+      StoreType *temp_source_weight = (StoreType *)PANDA_MALLOC_ARRAY(source_a * sizeof(StoreType));
+      StoreType *temp_dest = (StoreType *)PANDA_MALLOC_ARRAY(dest_a * sizeof(StoreType));
+      StoreType *temp_dest_weight = (StoreType *)PANDA_MALLOC_ARRAY(dest_a * sizeof(StoreType));
+
+      for (int b = begin; b < end; b++) {
+        memset(temp_source, 0, source_a * sizeof(StoreType));
+        memset(temp_source_weight, 0, source_a * sizeof(StoreType));
+        for (int a = 0; a < source_a; a++) {
+          if (_source->HASVAL(a, b)) {
+            temp_source[a] = (StoreType)(source_max * _source->GETVAL(a, b, _channel));
+            temp_source_weight[a] = filter_max;
+          }
+        }
+
+        _table->filter_sparse_row(temp_dest, temp_dest_weight,
+                                  temp_source, temp_source_weight,
+                                  0, dest_a);
+
+        for (int a = 0; a < dest_a; a++) {
+          _matrix[(size_t)a * source_b + b] = temp_dest[a];
+          _matrix_weight[(size_t)a * source_b + b] = temp_dest_weight[a];
+        }
+      }
 
-  // First, scale the image in the A direction.
-  float scale;
-  StoreType *temp_source, *temp_source_weight, *temp_dest, *temp_dest_weight;
+      PANDA_FREE_ARRAY(temp_source);
+      PANDA_FREE_ARRAY(temp_source_weight);
+      PANDA_FREE_ARRAY(temp_dest);
+      PANDA_FREE_ARRAY(temp_dest_weight);
+      Thread::consider_yield();
+    }
 
-  scale = (float)dest.ASIZE() / (float)source.ASIZE();
-  temp_source = (StoreType *)PANDA_MALLOC_ARRAY(source.ASIZE() * sizeof(StoreType));
-  temp_source_weight = (StoreType *)PANDA_MALLOC_ARRAY(source.ASIZE() * sizeof(StoreType));
-  temp_dest = (StoreType *)PANDA_MALLOC_ARRAY(dest.ASIZE() * sizeof(StoreType));
-  temp_dest_weight = (StoreType *)PANDA_MALLOC_ARRAY(dest.ASIZE() * sizeof(StoreType));
+    const IMAGETYPE *_source;
+    const IMAGETYPE *_dest;
+    int _channel;
+    const FilterTable *_table;
+    StoreType *_matrix;
+    StoreType *_matrix_weight;
+  };
 
   WorkType *filter;
   float filter_width;
+  bool interpolate;
 
-  make_filter(scale, width, filter, filter_width);
+  float scale = (float)dest_a / (float)source_a;
+  make_filter(scale, width, filter, filter_width, interpolate);
+  FilterTable a_table(dest_a, source_a, scale, filter, filter_width, interpolate);
+  PANDA_FREE_ARRAY(filter);
 
-  for (b = 0; b < source.BSIZE(); b++) {
-    memset(temp_source_weight, 0, source.ASIZE() * sizeof(StoreType));
-    for (a = 0; a < source.ASIZE(); a++) {
-      if (source.HASVAL(a, b)) {
-        temp_source[a] = (StoreType)(source_max * source.GETVAL(a, b, channel));
-        temp_source_weight[a] = filter_max;
+  APass a_pass;
+  a_pass._source = &source;
+  a_pass._dest = &dest;
+  a_pass._channel = channel;
+  a_pass._table = &a_table;
+  a_pass._matrix = matrix;
+  a_pass._matrix_weight = matrix_weight;
+  pool->run(a_pass, source_b, get_filter_grain(pool, source_b));
+
+  // Now, scale the image in the B direction.  The rows of the destination
+  // image are divided among the threads, rather than the columns of the
+  // matrix, so that no two threads write to the same part of the image.
+  class BPass : public WorkerPool::Job {
+  public:
+    virtual void execute(int begin, int end) {
+      int dest_a = _dest->ASIZE();
+      int dest_b = _dest->BSIZE();
+      int source_b = _source_b;
+      StoreType *temp_dest = (StoreType *)PANDA_MALLOC_ARRAY(dest_b * sizeof(StoreType));
+      StoreType *temp_dest_weight = (StoreType *)PANDA_MALLOC_ARRAY(dest_b * sizeof(StoreType));
+
+      for (int a = 0; a < dest_a; a++) {
+        _table->filter_sparse_row(temp_dest, temp_dest_weight,
+                                  _matrix + (size_t)a * source_b,
+                                  _matrix_weight + (size_t)a * source_b,
+                                  begin, end);
+
+        for (int b = begin; b < end; b++) {
+          if (temp_dest_weight[b] != 0) {
+            _dest->SETVAL(a, b, _channel, (float)temp_dest[b]/(float)source_max);
+          }
+        }
       }
-    }
 
-    filter_sparse_row(temp_dest, temp_dest_weight, dest.ASIZE(),
-                      temp_source, temp_source_weight, source.ASIZE(),
-                      scale,
-                      filter, filter_width);
-
-    for (a = 0; a < dest.ASIZE(); a++) {
-      matrix[a][b] = temp_dest[a];
-      matrix_weight[a][b] = temp_dest_weight[a];
+      PANDA_FREE_ARRAY(temp_dest);
+      PANDA_FREE_ARRAY(temp_dest_weight);
+      Thread::consider_yield();
     }
-  }
 
-  PANDA_FREE_ARRAY(temp_source);
-  PANDA_FREE_ARRAY(temp_source_weight);
-  PANDA_FREE_ARRAY(temp_dest);
-  PANDA_FREE_ARRAY(temp_dest_weight);
+    IMAGETYPE *_dest;
+    int _source_b;
+    int _channel;
+    const FilterTable *_table;
+    const StoreType *_matrix;
+    const StoreType *_matrix_weight;
+  };
+
+  scale = (float)dest_b / (float)source_b;
+  make_filter(scale, width, filter, filter_width, interpolate);
+  FilterTable b_table(dest_b, source_b, scale, filter, filter_width, interpolate);
   PANDA_FREE_ARRAY(filter);
 
-  // Now, scale the image in the B direction.
-  scale = (float)dest.BSIZE() / (float)source.BSIZE();
-  temp_dest = (StoreType *)PANDA_MALLOC_ARRAY(dest.BSIZE() * sizeof(StoreType));
-  temp_dest_weight = (StoreType *)PANDA_MALLOC_ARRAY(dest.BSIZE() * sizeof(StoreType));
-
-  make_filter(scale, width, filter, filter_width);
-
-  for (a = 0; a < dest.ASIZE(); a++) {
-    filter_sparse_row(temp_dest, temp_dest_weight, dest.BSIZE(),
-                      matrix[a], matrix_weight[a], source.BSIZE(),
-                      scale,
-                      filter, filter_width);
-
-    for (b = 0; b < dest.BSIZE(); b++) {
-      if (temp_dest_weight[b] != 0) {
-        dest.SETVAL(a, b, channel, (float)temp_dest[b]/(float)source_max);
-      }
-    }
-  }
-
-  PANDA_FREE_ARRAY(temp_dest);
-  PANDA_FREE_ARRAY(temp_dest_weight);
-  PANDA_FREE_ARRAY(filter);
+  BPass b_pass;
+  b_pass._dest = &dest;
+  b_pass._source_b = source_b;
+  b_pass._channel = channel;
+  b_pass._table = &b_table;
+  b_pass._matrix = matrix;
+  b_pass._matrix_weight = matrix_weight;
+  pool->run(b_pass, dest_b, get_filter_grain(pool, dest_b));
 
   // Now, clean up our temp matrix and go home!
-
-  for (a = 0; a < dest.ASIZE(); a++) {
-    PANDA_FREE_ARRAY(matrix[a]);
-    PANDA_FREE_ARRAY(matrix_weight[a]);
-  }
   PANDA_FREE_ARRAY(matrix);
   PANDA_FREE_ARRAY(matrix_weight);
 }
@@ -32,10 +32,18 @@
 #include "pandabase.h"
 #include <math.h>
 #include "cmath.h"
+#include "mathNumbers.h"
 #include "thread.h"
+#include "workerPool.h"
+#include "pvector.h"
 
 #include "pnmImage.h"
 #include "pfmFile.h"
+#include "pnmPlanarImage.h"
+
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#endif
 
 // WorkType is an abstraction that allows the filtering process to be
 // recompiled to use either floating-point or integer arithmetic.  On SGI
@@ -92,22 +100,63 @@ static const WorkType source_max = 255;
 static const WorkType filter_max = 255;
 */
 
-// filter_row() filters a single row by convolving with a one-dimensional
-// kernel filter.  The kernel is defined by an array of weights in filter[],
-// where the ith element of filter corresponds to abs(d * scale), if
-// scale>1.0, and abs(d), if scale<=1.0, where d is the offset from the center
-// and varies from -filter_width to filter_width.
+// A FilterTable filters a row by convolving with a one-dimensional kernel
+// filter.  The kernel is defined by an array of weights in filter[], where
+// the ith element of filter corresponds to abs(d * scale), if scale>1.0, and
+// abs(d), if scale<=1.0, where d is the offset from the center and varies
+// from -filter_width to filter_width.
 
 // Note that filter_width is not necessarily the length of the array; it is
 // the radius of interest of the filter function.  The array may need to be
 // larger (by a factor of scale), to adequately cover all the values.
 
-static void
-filter_row(StoreType dest[], int dest_len,
-           const StoreType source[], int source_len,
-           float scale,                    //  == dest_len / source_len
-           const WorkType filter[],
-           float filter_width) {
+// Since the weights that apply to each destination element depend only on
+// its position within the row, they are looked up once, when the table is
+// constructed, and stored consecutively for each destination element.  Each
+// row of the image then only needs a series of short dot products.
+
+class FilterTable {
+public:
+  FilterTable(int dest_len, int source_len,
+              float scale,                    //  == dest_len / source_len
+              const WorkType filter[], float filter_width,
+              bool interpolate);
+
+  void filter_row(StoreType dest[], const StoreType source[],
+                  int begin, int end) const;
+  void filter_sparse_row(StoreType dest[], StoreType dest_weight[],
+                         const StoreType source[],
+                         const StoreType source_weight[],
+                         int begin, int end) const;
+
+private:
+  static INLINE WorkType lookup(const WorkType filter[], float index,
+                                bool interpolate);
+
+  int _dest_len;
+
+  // For each destination element, the first source element that contributes
+  // to it, the number of contributing elements, and the position of their
+  // weights in _weights.
+  pvector<int> _first;
+  pvector<int> _count;
+  pvector<int> _offset;
+  pvector<WorkType> _net_weight;
+  pvector<WorkType> _weights;
+};
+
+/**
+ *
+ */
+FilterTable::
+FilterTable(int dest_len, int source_len, float scale,
+            const WorkType filter[], float filter_width, bool interpolate) :
+  _dest_len(dest_len),
+  _first(dest_len),
+  _count(dest_len),
+  _offset(dest_len),
+  _net_weight(dest_len)
+{
   // If we are expanding the row (scale > 1.0), we need to look at a
   // fractional granularity.  Hence, we scale our filter index by scale.  If
   // we are compressing (scale < 1.0), we don't need to fiddle with the filter
@@ -136,87 +185,112 @@ filter_row(StoreType dest[], int dest_len,
     int right_center = (int)cceil(center);
 
     WorkType net_weight = 0;
-    WorkType net_value = 0;
+    WorkType weight;
+    int source_x;
 
-    int index, source_x;
+    _first[dest_x] = left;
+    _offset[dest_x] = (int)_weights.size();
 
     // This loop is broken into two pieces--the left of center and the right
     // of center--so we don't have to incur the overhead of calling fabs()
     // each time through the loop.
     for (source_x = left; source_x < right_center; source_x++) {
-      index = (int)(iscale * (center - source_x) + 0.5f);
-      net_value += filter[index] * source[source_x];
-      net_weight += filter[index];
+      weight = lookup(filter, iscale * (center - source_x), interpolate);
+      _weights.push_back(weight);
+      net_weight += weight;
     }
 
     for (; source_x <= right; source_x++) {
-      index = (int)(iscale * (source_x - center) + 0.5f);
-      net_value += filter[index] * source[source_x];
-      net_weight += filter[index];
+      weight = lookup(filter, iscale * (source_x - center), interpolate);
+      _weights.push_back(weight);
+      net_weight += weight;
     }
 
+    _count[dest_x] = (int)_weights.size() - _offset[dest_x];
+    _net_weight[dest_x] = net_weight;
+  }
+}
+
+/**
+ * Returns the weight of the kernel at the indicated fractional index into the
+ * filter array.  The box and Gaussian kernels simply take the nearest entry;
+ * the others interpolate between the two nearest entries, since they vary too
+ * steeply for the array's granularity to be fine enough.
+ */
+INLINE WorkType FilterTable::
+lookup(const WorkType filter[], float index, bool interpolate) {
+  if (!interpolate) {
+    return filter[(int)(index + 0.5f)];
+  }
+  int i = (int)index;
+  float t = index - (float)i;
+  return (WorkType)(filter[i] + (filter[i + 1] - filter[i]) * t);
+}
+
+/**
+ * Filters a single row of source_len elements into dest_len elements.  Only
+ * the destination elements in the range [begin, end) are computed.
+ */
+void FilterTable::
+filter_row(StoreType dest[], const StoreType source[],
+           int begin, int end) const {
+  nassertv(begin >= 0 && end <= _dest_len);
+  for (int dest_x = begin; dest_x < end; dest_x++) {
+    const WorkType *weights = &_weights[0] + _offset[dest_x];
+    const StoreType *values = source + _first[dest_x];
+    int count = _count[dest_x];
+    int i = 0;
+    WorkType net_value = 0;
+
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+    // This assumes that WorkType and StoreType are both float.  Wide kernels
+    // are summed four elements at a time, which may round slightly
+    // differently from summing them one at a time.
+    if (count >= 8) {
+      __m128 sum = _mm_setzero_ps();
+      for (; i + 4 <= count; i += 4) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(weights + i),
+                                         _mm_loadu_ps(values + i)));
+      }
+      float lanes[4];
+      _mm_storeu_ps(lanes, sum);
+      net_value = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+#endif
+
+    for (; i < count; i++) {
+      net_value += weights[i] * values[i];
+    }
+
+    WorkType net_weight = _net_weight[dest_x];
     if (net_weight > 0) {
       dest[dest_x] = (StoreType)(net_value / net_weight);
     } else {
       dest[dest_x] = 0;
     }
   }
-  Thread::consider_yield();
 }
 
-// As above, but we also accept an array of weight values per element, to
-// support scaling a sparse array (as in a PfmFile).
-static void
-filter_sparse_row(StoreType dest[], StoreType dest_weight[], int dest_len,
-                  const StoreType source[], const StoreType source_weight[], int source_len,
-                  float scale,                    //  == dest_len / source_len
-                  const WorkType filter[],
-                  float filter_width) {
-  // If we are expanding the row (scale > 1.0), we need to look at a
-  // fractional granularity.  Hence, we scale our filter index by scale.  If
-  // we are compressing (scale < 1.0), we don't need to fiddle with the filter
-  // index, so we leave it at one.
-
-  float iscale;
-  if (scale < 1.0) {
-    iscale = 1.0;
-    filter_width /= scale;
-  } else {
-    iscale = scale;
-  }
-
-  for (int dest_x = 0; dest_x < dest_len; dest_x++) {
-    // The additional offset of 0.5 keeps the pixel centered.
-    float center = (dest_x + 0.5f) / scale - 0.5f;
-
-    // left and right are the starting and ending ranges of the radius of
-    // interest of the filter function.  We need to apply the filter to each
-    // value in this range.
-    int left = max((int)cfloor(center - filter_width), 0);
-    int right = min((int)cceil(center + filter_width), source_len - 1);
-
-    // right_center is the point just to the right of the center.  This allows
-    // us to flip the sign of the offset when we cross the center point.
-    int right_center = (int)cceil(center);
+/**
+ * As above, but we also accept an array of weight values per element, to
+ * support scaling a sparse array (as in a PfmFile).
+ */
+void FilterTable::
+filter_sparse_row(StoreType dest[], StoreType dest_weight[],
+                  const StoreType source[], const StoreType source_weight[],
+                  int begin, int end) const {
+  nassertv(begin >= 0 && end <= _dest_len);
+  for (int dest_x = begin; dest_x < end; dest_x++) {
+    const WorkType *weights = &_weights[0] + _offset[dest_x];
+    const StoreType *values = source + _first[dest_x];
+    const StoreType *value_weights = source_weight + _first[dest_x];
+    int count = _count[dest_x];
 
     WorkType net_weight = 0;
     WorkType net_value = 0;
-
-    int index, source_x;
-
-    // This loop is broken into two pieces--the left of center and the right
-    // of center--so we don't have to incur the overhead of calling fabs()
-    // each time through the loop.
-    for (source_x = left; source_x < right_center; source_x++) {
-      index = (int)(iscale * (center - source_x) + 0.5f);
-      net_value += filter[index] * source[source_x] * source_weight[source_x];
-      net_weight += filter[index] * source_weight[source_x];
-    }
-
-    for (; source_x <= right; source_x++) {
-      index = (int)(iscale * (source_x - center) + 0.5f);
-      net_value += filter[index] * source[source_x] * source_weight[source_x];
-      net_weight += filter[index] * source_weight[source_x];
+    for (int i = 0; i < count; i++) {
+      net_value += weights[i] * values[i] * value_weights[i];
+      net_weight += weights[i] * value_weights[i];
     }
 
     if (net_weight > 0) {
@@ -226,9 +300,16 @@ filter_sparse_row(StoreType dest[], StoreType dest_weight[], int dest_len,
     }
     dest_weight[dest_x] = (StoreType)net_weight;
   }
-  Thread::consider_yield();
 }
 
+// Returns a suitable number of rows or columns to hand to each thread of the
+// WorkerPool at a time.  Each piece should be large enough that the threads
+// don't spend their time contending for the same cache lines at the
+// boundaries.
+static int
+get_filter_grain(WorkerPool *pool, int count) {
+  return max(16, count / ((pool->get_num_threads() + 1) * 4));
+}
 
 // The various filter functions are called before each axis scaling to build
 // an kernel array suitable for the given scaling factor.  Given a scaling
@@ -238,14 +319,19 @@ filter_sparse_row(StoreType dest[], StoreType dest_weight[], int dest_len,
 
 // The values of the elements of filter must completely cover the range
 // 0..filter_max; the array must have enough elements to include all indices
-// corresponding to values in the range -filter_width to filter_width.
+// corresponding to values in the range -filter_width to filter_width, plus
+// one more if interpolate is set, in which case the weights between the
+// elements of the array are linearly interpolated.
 
 typedef void FilterFunction(float scale, float width,
-                            WorkType *&filter, float &filter_width);
+                            WorkType *&filter, float &filter_width,
+                            bool &interpolate);
 
 static void
 box_filter_impl(float scale, float width,
-                WorkType *&filter, float &filter_width) {
+                WorkType *&filter, float &filter_width,
+                bool &interpolate) {
+  interpolate = false;
   float fscale;
   if (scale < 1.0) {
     // If we are compressing the image, we want to expand the range of the
@@ -271,7 +357,9 @@ box_filter_impl(float scale, float width,
 
 static void
 gaussian_filter_impl(float scale, float width,
-                     WorkType *&filter, float &filter_width) {
+                     WorkType *&filter, float &filter_width,
+                     bool &interpolate) {
+  interpolate = false;
   float fscale;
   if (scale < 1.0) {
     // If we are compressing the image, we want to expand the range of the
@@ -308,6 +396,67 @@ gaussian_filter_impl(float scale, float width,
   }
 }
 
+static void
+bilinear_filter_impl(float scale, float width,
+                     WorkType *&filter, float &filter_width,
+                     bool &interpolate) {
+  interpolate = true;
+  float fscale;
+  if (scale < 1.0) {
+    fscale = 1.0 / scale;
+  } else {
+    fscale = scale;
+  }
+
+  // This is a triangle (tent) function, falling linearly from filter_max at
+  // the center to 0 at a distance of width.  With a width of 1.0 and an
+  // enlarged image, this is the same as bilinear interpolation.
+  filter_width = width;
+  int actual_width = (int)cceil((filter_width + 1) * fscale) + 1;
+
+  filter = (WorkType *)PANDA_MALLOC_ARRAY(actual_width * sizeof(WorkType));
+
+  for (int i = 0; i < actual_width; i++) {
+    float x = i / fscale;
+    filter[i] = (x < width) ? (WorkType)(filter_max * (1.0f - x / width)) : 0;
+  }
+}
+
+static void
+lanczos_filter_impl(float scale, float width,
+                    WorkType *&filter, float &filter_width,
+                    bool &interpolate) {
+  interpolate = true;
+  float fscale;
+  if (scale < 1.0) {
+    fscale = 1.0 / scale;
+  } else {
+    fscale = scale;
+  }
+
+  // L(x) = sinc(x) * sinc(x / a) for |x| < a, where a is the width, which is
+  // the number of lobes on either side of the center.  Unlike the other
+  // kernels, this has negative lobes, so it sharpens edges slightly, and the
+  // result may overshoot the range of the source values.
+  float a = max(width, 1.0f);
+  filter_width = a;
+  int actual_width = (int)cceil((filter_width + 1) * fscale) + 1;
+
+  filter = (WorkType *)PANDA_MALLOC_ARRAY(actual_width * sizeof(WorkType));
+
+  for (int i = 0; i < actual_width; i++) {
+    float x = i / fscale;
+    if (x == 0.0f) {
+      filter[i] = filter_max;
+    } else if (x < a) {
+      float px = MathNumbers::pi_f * x;
+      filter[i] = (WorkType)(filter_max * a * csin(px) * csin(px / a) / (px * px));
+    } else {
+      filter[i] = 0;
+    }
+  }
+}
+
 
 // We have a function, defined in pnm-image-filter-core.cxx, that will scale
 // an image in both X and Y directions for a particular channel, by setting up
@@ -541,6 +690,26 @@ gaussian_filter_from(float width, const PNMImage &copy) {
   filter_image(*this, copy, width, &gaussian_filter_impl);
 }
 
+/**
+ * Makes a resized copy of the indicated image into this one using a triangle
+ * filter of the indicated radius.  With a radius of 1.0, enlarging the image
+ * is the same as bilinear interpolation.
+ */
+void PNMImage::
+bilinear_filter_from(float width, const PNMImage &copy) {
+  filter_image(*this, copy, width, &bilinear_filter_impl);
+}
+
+/**
+ * Makes a resized copy of the indicated image into this one using a Lanczos
+ * filter with the indicated number of lobes, usually 2 or 3.  This is sharper
+ * than the other filters, but may produce slight ringing near hard edges.
+ */
+void PNMImage::
+lanczos_filter_from(float width, const PNMImage &copy) {
+  filter_image(*this, copy, width, &lanczos_filter_impl);
+}
+
 // Now we do it again, this time for PfmFile.  In this case we also need to
 // support the sparse variants, since PfmFiles can be incomplete.  However, we
 // don't need to have a different function for each channel.
@@ -663,6 +832,120 @@ gaussian_filter_from(float width, const PfmFile &copy) {
   filter_image(*this, copy, width, &gaussian_filter_impl);
 }
 
+/**
+ * Makes a resized copy of the indicated image into this one using a triangle
+ * filter of the indicated radius.  With a radius of 1.0, enlarging the image
+ * is the same as bilinear interpolation.
+ */
+void PfmFile::
+bilinear_filter_from(float width, const PfmFile &copy) {
+  filter_image(*this, copy, width, &bilinear_filter_impl);
+}
+
+/**
+ * Makes a resized copy of the indicated image into this one using a Lanczos
+ * filter with the indicated number of lobes, usually 2 or 3.  This is sharper
+ * than the other filters, but may produce slight ringing near hard edges.
+ */
+void PfmFile::
+lanczos_filter_from(float width, const PfmFile &copy) {
+  filter_image(*this, copy, width, &lanczos_filter_impl);
+}
+
+// And once more for PNMPlanarImage.  Each channel is stored in a plane of
+// its own, so the values that each pass reads for one channel are close
+// together in memory.
+
+#define FUNCTION_NAME filter_planar_xy
+#define IMAGETYPE PNMPlanarImage
+#define ASIZE get_x_size
+#define BSIZE get_y_size
+#define GETVAL(a, b, channel) get_channel(a, b, channel)
+#define SETVAL(a, b, channel, v) set_channel(a, b, channel, v)
+#include "pnm-image-filter-core.cxx"
+#undef SETVAL
+#undef GETVAL
+#undef BSIZE
+#undef ASIZE
+#undef IMAGETYPE
+#undef FUNCTION_NAME
+
+#define FUNCTION_NAME filter_planar_yx
+#define IMAGETYPE PNMPlanarImage
+#define ASIZE get_y_size
+#define BSIZE get_x_size
+#define GETVAL(a, b, channel) get_channel(b, a, channel)
+#define SETVAL(a, b, channel, v) set_channel(b, a, channel, v)
+#include "pnm-image-filter-core.cxx"
+#undef SETVAL
+#undef GETVAL
+#undef BSIZE
+#undef ASIZE
+#undef IMAGETYPE
+#undef FUNCTION_NAME
+
+
+// filter_image pulls everything together, and filters one image into another.
+// Both images can be the same with no ill effects.
+static void
+filter_image(PNMPlanarImage &dest, const PNMPlanarImage &source,
+             float width, FilterFunction *make_filter) {
+  int num_channels = min(dest.get_num_channels(), source.get_num_channels());
+
+  if (dest.get_x_size() <= dest.get_y_size()) {
+    for (int ci = 0; ci < num_channels; ++ci) {
+      filter_planar_xy(dest, source, width, make_filter, ci);
+    }
+
+  } else {
+    for (int ci = 0; ci < num_channels; ++ci) {
+      filter_planar_yx(dest, source, width, make_filter, ci);
+    }
+  }
+}
+
+/**
+ * Makes a resized copy of the indicated image into this one using the
+ * indicated filter.  The image to be copied is squashed and stretched to
+ * match the dimensions of the current image, applying the appropriate filter
+ * to perform the stretching.
+ */
+void PNMPlanarImage::
+box_filter_from(float width, const PNMPlanarImage &copy) {
+  filter_image(*this, copy, width, &box_filter_impl);
+}
+
+/**
+ * Makes a resized copy of the indicated image into this one using the
+ * indicated filter.  The image to be copied is squashed and stretched to
+ * match the dimensions of the current image, applying the appropriate filter
+ * to perform the stretching.
+ */
+void PNMPlanarImage::
+gaussian_filter_from(float width, const PNMPlanarImage &copy) {
+  filter_image(*this, copy, width, &gaussian_filter_impl);
+}
+
+/**
+ * Makes a resized copy of the indicated image into this one using a triangle
+ * filter of the indicated radius.  With a radius of 1.0, enlarging the image
+ * is the same as bilinear interpolation.
+ */
+void PNMPlanarImage::
+bilinear_filter_from(float width, const PNMPlanarImage &copy) {
+  filter_image(*this, copy, width, &bilinear_filter_impl);
+}
+
+/**
+ * Makes a resized copy of the indicated image into this one using a Lanczos
+ * filter with the indicated number of lobes, usually 2 or 3.  This is sharper
+ * than the other filters, but may produce slight ringing near hard edges.
+ */
+void PNMPlanarImage::
+lanczos_filter_from(float width, const PNMPlanarImage &copy) {
+  filter_image(*this, copy, width, &lanczos_filter_impl);
+}
+
 // The following functions are support for quick_box_filter().
 
 static INLINE void
@@ -739,6 +1022,41 @@ box_filter_region(const PNMImage &image,
   return color;
 }
 
+// This job computes a range of rows of the result of quick_filter_from(),
+// counted from _to_y_begin.
+class QuickFilterJob : public WorkerPool::Job {
+public:
+  virtual void execute(int begin, int end) {
+    for (int to_y = _to_y_begin + begin; to_y < _to_y_begin + end; to_y++) {
+      // Each edge of the box is computed from scratch, rather than carried
+      // over from the previous row or column, but since it is the same
+      // expression, it has the same value.
+      float from_y0 = to_y * _y_scale;
+      float from_y1 = (to_y+1) * _y_scale;
+
+      for (int to_x = _to_x_begin; to_x < _to_x_end; to_x++) {
+        float from_x0 = to_x * _x_scale;
+        float from_x1 = (to_x+1) * _x_scale;
+
+        // Now the box from (from_x0, from_y0) - (from_x1, from_y1) but not
+        // including (from_x1, from_y1) maps to the pixel (to_x, to_y).
+        LColorf color = box_filter_region(*_from,
+                                          from_x0, from_y0, from_x1, from_y1);
+
+        _to->set_xel_a(_to_xoff + to_x, _to_yoff + to_y, color);
+      }
+      Thread::consider_yield();
+    }
+  }
+
+  const PNMImage *_from;
+  PNMImage *_to;
+  float _x_scale, _y_scale;
+  int _to_xoff, _to_yoff;
+  int _to_x_begin, _to_x_end;
+  int _to_y_begin;
+};
+
 /**
  * Resizes from the given image, with a fixed radius of 0.5. This is a very
  * specialized and simple algorithm that doesn't handle dropping below the
@@ -758,36 +1076,20 @@ quick_filter_from(const PNMImage &from, int xborder, int yborder) {
   int to_xoff = xborder / 2;
   int to_yoff = yborder / 2;
 
-  float from_x0, from_x1, from_y0, from_y1;
-  int to_x, to_y;
-
-  float x_scale = (float)from_xs / (float)to_xs;
-  float y_scale = (float)from_ys / (float)to_ys;
-
-  LColorf color;
-
-  from_y0 = max(0, -to_yoff) * y_scale;
-  for (to_y = max(0, -to_yoff);
-       to_y < min(to_ys, get_y_size()-to_yoff);
-       to_y++) {
-    from_y1 = (to_y+1) * y_scale;
-
-    from_x0 = max(0, -to_xoff) * x_scale;
-    for (to_x = max(0, -to_xoff);
-         to_x < min(to_xs, get_x_size()-to_xoff);
-         to_x++) {
-      from_x1 = (to_x+1) * x_scale;
-
-      // Now the box from (from_x0, from_y0) - (from_x1, from_y1) but not
-      // including (from_x1, from_y1) maps to the pixel (to_x, to_y).
-      color = box_filter_region(from,
-                                from_x0, from_y0, from_x1, from_y1);
-
-      set_xel_a(to_xoff + to_x, to_yoff + to_y, color);
-
-      from_x0 = from_x1;
-    }
-    from_y0 = from_y1;
-    Thread::consider_yield();
-  }
+  QuickFilterJob job;
+  job._from = &from;
+  job._to = this;
+  job._x_scale = (float)from_xs / (float)to_xs;
+  job._y_scale = (float)from_ys / (float)to_ys;
+  job._to_xoff = to_xoff;
+  job._to_yoff = to_yoff;
+  job._to_x_begin = max(0, -to_xoff);
+  job._to_x_end = min(to_xs, get_x_size()-to_xoff);
+  job._to_y_begin = max(0, -to_yoff);
+
+  // The rows are independent of each other, so they are divided among the
+  // threads of the WorkerPool.
+  int num_rows = min(to_ys, get_y_size()-to_yoff) - job._to_y_begin;
+  WorkerPool *pool = WorkerPool::get_global_ptr();
+  pool->run(job, num_rows, get_filter_grain(pool, num_rows));
 }
@@ -0,0 +1,619 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file pnm-image-histogram.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+// This file contains the color histogram functions of PNMImageHeader and
+// PNMImage, and the median-cut color quantizer.
+//
+// Rather than inserting every pixel into a HistMap, the colors are counted in
+// an open-addressed hash table keyed on the four components of the pixel
+// packed into one integer.  Each thread of the WorkerPool counts a piece of
+// the image into a table of its own, and the tables are merged at the end.
+// Only the distinct colors that were found are then stored in the HistMap.
+
+#include "pandabase.h"
+#include "thread.h"
+#include "workerPool.h"
+#include "lightMutex.h"
+#include "lightMutexHolder.h"
+#include "pvector.h"
+
+#include "pnmImage.h"
+
+#include <algorithm>
+#include <limits.h>
+
+/**
+ * Packs the four components of a pixel into a single integer.  The integers
+ * sort in the same order as the corresponding PixelSpecs.
+ */
+static INLINE uint64_t
+pack_pixel_key(xelval red, xelval green, xelval blue, xelval alpha) {
+  return ((uint64_t)red << 48) | ((uint64_t)green << 32) |
+    ((uint64_t)blue << 16) | (uint64_t)alpha;
+}
+
+/**
+ * Returns the PixelSpec corresponding to a key made by pack_pixel_key().
+ */
+static INLINE PNMImageHeader::PixelSpec
+unpack_pixel_key(uint64_t key) {
+  return PNMImageHeader::PixelSpec((xelval)(key >> 48), (xelval)(key >> 32),
+                                   (xelval)(key >> 16), (xelval)key);
+}
+
+/**
+ * Returns the key of the nth pixel of the array, as it is recorded in the
+ * histogram of an image of the indicated color type.
+ */
+static INLINE uint64_t
+get_pixel_key(PNMImageHeader::ColorType color_type, const xel *array,
+              const xelval *alpha, int n) {
+  switch (color_type) {
+  case PNMImageHeader::CT_grayscale:
+    return pack_pixel_key(PPM_GETB(array[n]), PPM_GETB(array[n]),
+                          PPM_GETB(array[n]), 0);
+
+  case PNMImageHeader::CT_two_channel:
+    return pack_pixel_key(PPM_GETB(array[n]), PPM_GETB(array[n]),
+                          PPM_GETB(array[n]), alpha[n]);
+
+  case PNMImageHeader::CT_color:
+    return pack_pixel_key(PPM_GETR(array[n]), PPM_GETG(array[n]),
+                          PPM_GETB(array[n]), 0);
+
+  case PNMImageHeader::CT_four_channel:
+    return pack_pixel_key(PPM_GETR(array[n]), PPM_GETG(array[n]),
+                          PPM_GETB(array[n]), alpha[n]);
+
+  default:
+    return 0;
+  }
+}
+
+// An open-addressed hash table that associates an integer with each of a
+// number of pixel keys.  This is used to count the pixels of each color, and
+// later to look up the palette entry for each color.
+class PixelTable {
+public:
+  class Entry {
+  public:
+    uint64_t _key;
+    int _value;
+    bool _used;
+  };
+  typedef pvector<Entry> Entries;
+
+  PixelTable();
+
+  INLINE size_t size() const;
+  INLINE int &operator [] (uint64_t key);
+  INLINE const Entry *find(uint64_t key) const;
+
+  void add_counts(const PixelTable &other);
+  void get_entries(Entries &entries) const;
+  void swap(PixelTable &other);
+
+private:
+  INLINE size_t get_slot(uint64_t key) const;
+  void grow();
+
+  Entries _entries;
+  size_t _num_entries;
+  int _bits;
+};
+
+/**
+ *
+ */
+PixelTable::
+PixelTable() : _num_entries(0), _bits(10) {
+  Entry empty;
+  empty._key = 0;
+  empty._value = 0;
+  empty._used = false;
+  _entries.assign((size_t)1 << _bits, empty);
+}
+
+/**
+ * Returns the number of distinct keys in the table.
+ */
+INLINE size_t PixelTable::
+size() const {
+  return _num_entries;
+}
+
+/**
+ * Returns a reference to the value associated with the indicated key, adding
+ * the key with a value of 0 if it is not already in the table.  The
+ * reference is only valid until the next key is added.
+ */
+INLINE int &PixelTable::
+operator [] (uint64_t key) {
+  size_t mask = _entries.size() - 1;
+  size_t slot = get_slot(key);
+  while (_entries[slot]._used) {
+    if (_entries[slot]._key == key) {
+      return _entries[slot]._value;
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  // The key is not in the table.  Keep the table no more than half full.
+  if ((_num_entries + 1) * 2 > _entries.size()) {
+    grow();
+    return (*this)[key];
+  }
+
+  Entry &entry = _entries[slot];
+  entry._key = key;
+  entry._value = 0;
+  entry._used = true;
+  ++_num_entries;
+  return entry._value;
+}
+
+/**
+ * Returns the entry for the indicated key, or NULL if the key is not in the
+ * table.
+ */
+INLINE const PixelTable::Entry *PixelTable::
+find(uint64_t key) const {
+  size_t mask = _entries.size() - 1;
+  size_t slot = get_slot(key);
+  while (_entries[slot]._used) {
+    if (_entries[slot]._key == key) {
+      return &_entries[slot];
+    }
+    slot = (slot + 1) & mask;
+  }
+  return NULL;
+}
+
+/**
+ * Adds the values of the other table to the values of the same keys in this
+ * table.
+ */
+void PixelTable::
+add_counts(const PixelTable &other) {
+  Entries::const_iterator ei;
+  for (ei = other._entries.begin(); ei != other._entries.end(); ++ei) {
+    if ((*ei)._used) {
+      (*this)[(*ei)._key] += (*ei)._value;
+    }
+  }
+}
+
+// Sorts the entries of a PixelTable by key.
+class CompareKey {
+public:
+  bool operator () (const PixelTable::Entry &a, const PixelTable::Entry &b) const {
+    return a._key < b._key;
+  }
+};
+
+/**
+ * Fills entries with the entries of the table, sorted by key.
+ */
+void PixelTable::
+get_entries(Entries &entries) const {
+  entries.clear();
+  entries.reserve(_num_entries);
+  Entries::const_iterator ei;
+  for (ei = _entries.begin(); ei != _entries.end(); ++ei) {
+    if ((*ei)._used) {
+      entries.push_back(*ei);
+    }
+  }
+
+  std::sort(entries.begin(), entries.end(), CompareKey());
+}
+
+/**
+ * Exchanges the contents of this table with the other table.
+ */
+void PixelTable::
+swap(PixelTable &other) {
+  _entries.swap(other._entries);
+  std::swap(_num_entries, other._num_entries);
+  std::swap(_bits, other._bits);
+}
+
+/**
+ * Returns the slot at which to start looking for the indicated key.
+ */
+INLINE size_t PixelTable::
+get_slot(uint64_t key) const {
+  // Fibonacci hashing: the high bits of the product depend on all of the
+  // bits of the key.
+  static const uint64_t multiplier = ((uint64_t)0x9e3779b9 << 32) | 0x7f4a7c15;
+  return (size_t)((key * multiplier) >> (64 - _bits));
+}
+
+/**
+ * Doubles the number of slots in the table.
+ */
+void PixelTable::
+grow() {
+  Entries old_entries;
+  old_entries.swap(_entries);
+
+  ++_bits;
+  Entry empty;
+  empty._key = 0;
+  empty._value = 0;
+  empty._used = false;
+  _entries.assign((size_t)1 << _bits, empty);
+  _num_entries = 0;
+
+  Entries::const_iterator ei;
+  for (ei = old_entries.begin(); ei != old_entries.end(); ++ei) {
+    if ((*ei)._used) {
+      (*this)[(*ei)._key] = (*ei)._value;
+    }
+  }
+}
+
+// This job counts the colors of a range of pixels into a table of its own,
+// and then adds them to the shared table.
+class HistogramJob : public WorkerPool::Job {
+public:
+  virtual void execute(int begin, int end) {
+    PixelTable table;
+
+    // Neighboring pixels often have the same color, so we count runs of
+    // the same color before looking them up.
+    uint64_t run_key = 0;
+    int run_length = 0;
+    for (int pi = begin; pi < end; ++pi) {
+      uint64_t key = get_pixel_key(_color_type, _array, _alpha, pi);
+      if (run_length != 0 && key == run_key) {
+        ++run_length;
+      } else {
+        if (run_length != 0) {
+          table[run_key] += run_length;
+        }
+        run_key = key;
+        run_length = 1;
+      }
+    }
+    if (run_length != 0) {
+      table[run_key] += run_length;
+    }
+
+    LightMutexHolder holder(_lock);
+    if (_table->size() == 0) {
+      _table->swap(table);
+    } else {
+      _table->add_counts(table);
+    }
+  }
+
+  PNMImageHeader::ColorType _color_type;
+  const xel *_array;
+  const xelval *_alpha;
+  PixelTable *_table;
+  LightMutex _lock;
+};
+
+/**
+ * Counts the pixels of each color in the indicated arrays into the table,
+ * dividing the work among the threads of the WorkerPool.
+ */
+static void
+count_pixels(PixelTable &table, PNMImageHeader::ColorType color_type,
+             const xel *array, const xelval *alpha, int num_pixels) {
+  HistogramJob job;
+  job._color_type = color_type;
+  job._array = array;
+  job._alpha = alpha;
+  job._table = &table;
+
+  if (num_pixels < 65536) {
+    job.execute(0, num_pixels);
+    return;
+  }
+
+  // Each piece ends up with a table of its own that needs to be merged, so
+  // we use fewer, larger pieces than we would for other jobs.
+  WorkerPool *pool = WorkerPool::get_global_ptr();
+  int grain = max(65536, num_pixels / ((pool->get_num_threads() + 1) * 2));
+  pool->run(job, num_pixels, grain);
+}
+
+/**
+ * Computes a histogram of the colors used in the indicated rgb/grayscale
+ * array and/or alpha array.  This is most likely to be useful in a PNMWriter
+ * class, but it is defined at this level in case it has general utilty for
+ * PNMImages.
+ *
+ * Also see PNMImage::make_histogram(), which is a higher-level function.
+ *
+ * The max_colors parameter, if greater than zero, limits the maximum number
+ * of colors we are interested in.  If we encounter more than this number of
+ * colors, the function aborts before completion and returns false; otherwise,
+ * it returns true.
+ */
+bool PNMImageHeader::
+compute_histogram(PNMImageHeader::HistMap &hist,
+                  xel *array, xelval *alpha, int max_colors) {
+  ColorType color_type = get_color_type();
+  if (color_type == CT_invalid) {
+    return false;
+  }
+
+  int num_pixels = _x_size * _y_size;
+  PixelTable table;
+
+  if (max_colors > 0) {
+    // We have to stop as soon as we have seen too many colors, so this is
+    // done on one thread.  The colors that are already in the histogram
+    // count toward the limit.
+    HistMap::const_iterator hi;
+    for (hi = hist.begin(); hi != hist.end(); ++hi) {
+      const PixelSpec &pixel = (*hi).first;
+      table[pack_pixel_key(pixel._red, pixel._green, pixel._blue, pixel._alpha)];
+    }
+
+    uint64_t run_key = 0;
+    int run_length = 0;
+    for (int pi = 0; pi < num_pixels; ++pi) {
+      uint64_t key = get_pixel_key(color_type, array, alpha, pi);
+      if (run_length != 0 && key == run_key) {
+        ++run_length;
+        continue;
+      }
+      if (run_length != 0) {
+        table[run_key] += run_length;
+      }
+      run_key = key;
+      run_length = 1;
+
+      table[key];
+      if ((int)table.size() > max_colors) {
+        return false;
+      }
+    }
+    if (run_length != 0) {
+      table[run_key] += run_length;
+    }
+
+  } else {
+    count_pixels(table, color_type, array, alpha, num_pixels);
+  }
+
+  // Now record the counts in the histogram.  Since the entries are sorted,
+  // each one belongs right after the previous one.
+  PixelTable::Entries entries;
+  table.get_entries(entries);
+
+  HistMap::iterator hi = hist.begin();
+  PixelTable::Entries::const_iterator ei;
+  for (ei = entries.begin(); ei != entries.end(); ++ei) {
+    hi = hist.insert(hi, HistMap::value_type(unpack_pixel_key((*ei)._key), 0));
+    (*hi).second += (*ei)._value;
+  }
+
+  return true;
+}
+
+// A range of the colors being quantized, which will be replaced by a single
+// palette entry.
+class QuantizeBox {
+public:
+  size_t _begin, _end;
+
+  // The component with the widest range of values, and that range.
+  int _component;
+  int _range;
+};
+
+// Sorts PixelSpecCounts by the value of one of their components.
+class CompareComponent {
+public:
+  CompareComponent(int component) : _component(component) { }
+  bool operator () (const PNMImageHeader::PixelSpecCount &a,
+                    const PNMImageHeader::PixelSpecCount &b) const {
+    return a._pixel[_component] < b._pixel[_component];
+  }
+
+  int _component;
+};
+
+/**
+ * Finds the component of the colors in the box that has the widest range of
+ * values.
+ */
+static void
+measure_box(QuantizeBox &box, const PNMImageHeader::PixelCount &colors) {
+  int min_value[4] = { INT_MAX, INT_MAX, INT_MAX, INT_MAX };
+  int max_value[4] = { 0, 0, 0, 0 };
+  for (size_t i = box._begin; i < box._end; ++i) {
+    for (int c = 0; c < 4; ++c) {
+      int value = colors[i]._pixel[c];
+      min_value[c] = min(min_value[c], value);
+      max_value[c] = max(max_value[c], value);
+    }
+  }
+
+  box._component = 0;
+  box._range = max_value[0] - min_value[0];
+  for (int c = 1; c < 4; ++c) {
+    if (max_value[c] - min_value[c] > box._range) {
+      box._component = c;
+      box._range = max_value[c] - min_value[c];
+    }
+  }
+}
+
+// This job replaces the color of each of a range of pixels with its palette
+// entry.
+class QuantizeJob : public WorkerPool::Job {
+public:
+  virtual void execute(int begin, int end) {
+    for (int pi = begin; pi < end; ++pi) {
+      uint64_t key = get_pixel_key(_color_type, _array, _alpha, pi);
+      const PixelTable::Entry *entry = _table->find(key);
+      nassertv(entry != NULL);
+      const PNMImageHeader::PixelSpec &pixel = (*_palette)[entry->_value];
+
+      switch (_color_type) {
+      case PNMImageHeader::CT_two_channel:
+        _alpha[pi] = pixel._alpha;
+        // Fall through.
+
+      case PNMImageHeader::CT_grayscale:
+        PPM_PUTB(_array[pi], pixel._blue);
+        break;
+
+      case PNMImageHeader::CT_four_channel:
+        _alpha[pi] = pixel._alpha;
+        // Fall through.
+
+      case PNMImageHeader::CT_color:
+        PPM_ASSIGN(_array[pi], pixel._red, pixel._green, pixel._blue);
+        break;
+
+      default:
+        break;
+      }
+    }
+  }
+
+  PNMImageHeader::ColorType _color_type;
+  xel *_array;
+  xelval *_alpha;
+  const PixelTable *_table;
+  const PNMImageHeader::Palette *_palette;
+};
+
+/**
+ * Reduces the number of unique colors in the image to (at most) the given
+ * count, using the median cut algorithm.  The colors are repeatedly divided
+ * into two groups along the component with the widest range, at the median
+ * of the pixels, and each pixel is then replaced by the average color of its
+ * group.  The alpha channel, if any, is quantized along with the color.
+ *
+ * This is useful before writing an image to a file format that can store a
+ * palette.  The pixels are counted and replaced on the threads of the
+ * WorkerPool.
+ */
+void PNMImage::
+quantize(size_t max_colors) {
+  nassertv(max_colors > 0);
+  ColorType color_type = get_color_type();
+  if (color_type == CT_invalid || _array == NULL) {
+    return;
+  }
+
+  int num_pixels = _x_size * _y_size;
+  PixelTable table;
+  count_pixels(table, color_type, _array, _alpha, num_pixels);
+  if (table.size() <= max_colors) {
+    // Nothing to do.
+    return;
+  }
+
+  PixelTable::Entries entries;
+  table.get_entries(entries);
+
+  PixelCount colors;
+  colors.reserve(entries.size());
+  PixelTable::Entries::const_iterator ei;
+  for (ei = entries.begin(); ei != entries.end(); ++ei) {
+    colors.push_back(PixelSpecCount(unpack_pixel_key((*ei)._key), (*ei)._value));
+  }
+
+  // Keep splitting the box with the widest range until we have enough boxes,
+  // or until no box contains more than one distinct color.
+  pvector<QuantizeBox> boxes;
+  QuantizeBox box;
+  box._begin = 0;
+  box._end = colors.size();
+  measure_box(box, colors);
+  boxes.push_back(box);
+
+  while (boxes.size() < max_colors) {
+    size_t widest = 0;
+    for (size_t bi = 1; bi < boxes.size(); ++bi) {
+      if (boxes[bi]._range > boxes[widest]._range) {
+        widest = bi;
+      }
+    }
+    QuantizeBox &split = boxes[widest];
+    if (split._range == 0) {
+      break;
+    }
+
+    std::sort(colors.begin() + split._begin, colors.begin() + split._end,
+              CompareComponent(split._component));
+
+    // Find the median pixel, weighting each color by its count.
+    int64_t total = 0;
+    for (size_t i = split._begin; i < split._end; ++i) {
+      total += colors[i]._count;
+    }
+    int64_t sum = 0;
+    size_t mid = split._begin;
+    while (mid < split._end - 1 && (sum + colors[mid]._count) * 2 <= total) {
+      sum += colors[mid]._count;
+      ++mid;
+    }
+    mid = max(mid, split._begin + 1);
+
+    QuantizeBox upper;
+    upper._begin = mid;
+    upper._end = split._end;
+    split._end = mid;
+    measure_box(split, colors);
+    measure_box(upper, colors);
+    boxes.push_back(upper);
+  }
+
+  // Each box becomes one palette entry, the average of its pixels.  Record
+  // the palette index of each color in the table.
+  Palette palette;
+  palette.reserve(boxes.size());
+  pvector<QuantizeBox>::const_iterator bi;
+  for (bi = boxes.begin(); bi != boxes.end(); ++bi) {
+    int64_t count = 0;
+    int64_t sums[4] = { 0, 0, 0, 0 };
+    for (size_t i = (*bi)._begin; i < (*bi)._end; ++i) {
+      const PixelSpecCount &color = colors[i];
+      count += color._count;
+      for (int c = 0; c < 4; ++c) {
+        sums[c] += (int64_t)color._pixel[c] * color._count;
+      }
+      table[pack_pixel_key(color._pixel._red, color._pixel._green,
+                           color._pixel._blue, color._pixel._alpha)] = (int)palette.size();
+    }
+
+    palette.push_back(PixelSpec((xelval)((sums[0] + count / 2) / count),
+                                (xelval)((sums[1] + count / 2) / count),
+                                (xelval)((sums[2] + count / 2) / count),
+                                (xelval)((sums[3] + count / 2) / count)));
+  }
+
+  QuantizeJob job;
+  job._color_type = color_type;
+  job._array = _array;
+  job._alpha = _alpha;
+  job._table = &table;
+  job._palette = &palette;
+
+  if (num_pixels < 65536) {
+    job.execute(0, num_pixels);
+  } else {
+    WorkerPool *pool = WorkerPool::get_global_ptr();
+    pool->run(job, num_pixels, max(65536, num_pixels / ((pool->get_num_threads() + 1) * 4)));
+  }
+}
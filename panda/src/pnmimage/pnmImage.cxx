@@ -548,6 +548,23 @@ set_color_space(ColorSpace color_space) {
           col.g = decode_sRGB_uchar((unsigned char) col.g);
           col.b = decode_sRGB_uchar((unsigned char) col.b);
         }
+      } else if (_color_space == CS_sRGB) {
+        // Decode a row at a time, which lets us use the vectorized decoder.
+        pvector<float> buffer((size_t)_x_size * 3);
+        for (int y = 0; y < _y_size; ++y) {
+          xel *row_array = row(y);
+          for (int x = 0; x < _x_size; ++x) {
+            buffer[x * 3 + 0] = row_array[x].r * _inv_maxval;
+            buffer[x * 3 + 1] = row_array[x].g * _inv_maxval;
+            buffer[x * 3 + 2] = row_array[x].b * _inv_maxval;
+          }
+          decode_sRGB_float(&buffer[0], &buffer[0], buffer.size(), 3);
+          for (int x = 0; x < _x_size; ++x) {
+            row_array[x].r = clamp_val((int)(buffer[x * 3 + 0] * _maxval + 0.5f));
+            row_array[x].g = clamp_val((int)(buffer[x * 3 + 1] * _maxval + 0.5f));
+            row_array[x].b = clamp_val((int)(buffer[x * 3 + 2] * _maxval + 0.5f));
+          }
+        }
       } else {
         for (int x = 0; x < _x_size; ++x) {
           for (int y = 0; y < _y_size; ++y) {
@@ -569,6 +586,23 @@ set_color_space(ColorSpace color_space) {
           col.g = encode_sRGB_uchar((unsigned char) col.g);
           col.b = encode_sRGB_uchar((unsigned char) col.b);
         }
+      } else if (_color_space == CS_linear) {
+        // Encode a row at a time, which lets us use the vectorized encoder.
+        pvector<float> buffer((size_t)_x_size * 3);
+        for (int y = 0; y < _y_size; ++y) {
+          xel *row_array = row(y);
+          for (int x = 0; x < _x_size; ++x) {
+            buffer[x * 3 + 0] = row_array[x].r * _inv_maxval;
+            buffer[x * 3 + 1] = row_array[x].g * _inv_maxval;
+            buffer[x * 3 + 2] = row_array[x].b * _inv_maxval;
+          }
+          encode_sRGB_float(&buffer[0], &buffer[0], buffer.size(), 3);
+          for (int x = 0; x < _x_size; ++x) {
+            row_array[x].r = clamp_val((int)(buffer[x * 3 + 0] * _maxval + 0.5f));
+            row_array[x].g = clamp_val((int)(buffer[x * 3 + 1] * _maxval + 0.5f));
+            row_array[x].b = clamp_val((int)(buffer[x * 3 + 2] * _maxval + 0.5f));
+          }
+        }
       } else {
         for (int x = 0; x < _x_size; ++x) {
           for (int y = 0; y < _y_size; ++y) {
@@ -1061,303 +1095,6 @@ set_alpha_array(xelval *alpha) {
   _alpha = alpha;
 }
 
-/**
- * Copies a rectangular area of another image into a rectangular area of this
- * image.  Both images must already have been initialized.  The upper-left
- * corner of the region in both images is specified, and the size of the area;
- * if the size is omitted, it defaults to the entire other image, or the
- * largest piece that will fit.
- */
-void PNMImage::
-copy_sub_image(const PNMImage &copy, int xto, int yto,
-               int xfrom, int yfrom, int x_size, int y_size) {
-  int xmin, ymin, xmax, ymax;
-  setup_sub_image(copy, xto, yto, xfrom, yfrom, x_size, y_size,
-                  xmin, ymin, xmax, ymax);
-
-  if (get_maxval() == copy.get_maxval() &&
-      get_color_space() == copy.get_color_space()) {
-    // The simple case: no pixel value rescaling is required.
-    int x, y;
-    for (y = ymin; y < ymax; y++) {
-      for (x = xmin; x < xmax; x++) {
-        set_xel_val(x, y, copy.get_xel_val(x - xmin + xfrom, y - ymin + yfrom));
-      }
-    }
-
-    if (has_alpha() && copy.has_alpha()) {
-      for (y = ymin; y < ymax; y++) {
-        for (x = xmin; x < xmax; x++) {
-          set_alpha_val(x, y, copy.get_alpha_val(x - xmin + xfrom, y - ymin + yfrom));
-        }
-      }
-    }
-
-  } else {
-    // The harder case: rescale pixel values according to maxval.
-    int x, y;
-    for (y = ymin; y < ymax; y++) {
-      for (x = xmin; x < xmax; x++) {
-        set_xel(x, y, copy.get_xel(x - xmin + xfrom, y - ymin + yfrom));
-      }
-    }
-
-    if (has_alpha() && copy.has_alpha()) {
-      for (y = ymin; y < ymax; y++) {
-        for (x = xmin; x < xmax; x++) {
-          set_alpha(x, y, copy.get_alpha(x - xmin + xfrom, y - ymin + yfrom));
-        }
-      }
-    }
-  }
-}
-
-/**
- * Behaves like copy_sub_image(), except the alpha channel of the copy is used
- * to blend the copy into the destination image, instead of overwriting pixels
- * unconditionally.
- *
- * If pixel_scale is not 1.0, it specifies an amount to scale each *alpha*
- * value of the source image before applying it to the target image.
- *
- * If pixel_scale is 1.0 and the copy has no alpha channel, this degenerates
- * into copy_sub_image().
- */
-void PNMImage::
-blend_sub_image(const PNMImage &copy, int xto, int yto,
-                int xfrom, int yfrom, int x_size, int y_size,
-                float pixel_scale) {
-  if (!copy.has_alpha() && pixel_scale == 1.0) {
-    copy_sub_image(copy, xto, yto, xfrom, yfrom, x_size, y_size);
-    return;
-  }
-
-  int xmin, ymin, xmax, ymax;
-  setup_sub_image(copy, xto, yto, xfrom, yfrom, x_size, y_size,
-                  xmin, ymin, xmax, ymax);
-
-  int x, y;
-  if (copy.has_alpha()) {
-    for (y = ymin; y < ymax; y++) {
-      for (x = xmin; x < xmax; x++) {
-        blend(x, y, copy.get_xel(x - xmin + xfrom, y - ymin + yfrom),
-              copy.get_alpha(x - xmin + xfrom, y - ymin + yfrom) * pixel_scale);
-      }
-    }
-  } else {
-    for (y = ymin; y < ymax; y++) {
-      for (x = xmin; x < xmax; x++) {
-        blend(x, y, copy.get_xel(x - xmin + xfrom, y - ymin + yfrom),
-              pixel_scale);
-      }
-    }
-  }
-}
-
-/**
- * Behaves like copy_sub_image(), except the copy pixels are added to the
- * pixels of the destination, after scaling by the specified pixel_scale.
- * Unlike blend_sub_image(), the alpha channel is not treated specially.
- */
-void PNMImage::
-add_sub_image(const PNMImage &copy, int xto, int yto,
-              int xfrom, int yfrom, int x_size, int y_size,
-              float pixel_scale) {
-  int xmin, ymin, xmax, ymax;
-  setup_sub_image(copy, xto, yto, xfrom, yfrom, x_size, y_size,
-                  xmin, ymin, xmax, ymax);
-
-  int x, y;
-  if (has_alpha() && copy.has_alpha()) {
-    for (y = ymin; y < ymax; y++) {
-      for (x = xmin; x < xmax; x++) {
-        set_alpha(x, y, get_alpha(x, y) + copy.get_alpha(x, y) * pixel_scale);
-      }
-    }
-  }
-
-  for (y = ymin; y < ymax; y++) {
-    for (x = xmin; x < xmax; x++) {
-      LRGBColorf rgb1 = get_xel(x, y);
-      LRGBColorf rgb2 = copy.get_xel(x, y);
-      set_xel(x, y,
-              rgb1[0] + rgb2[0] * pixel_scale,
-              rgb1[1] + rgb2[1] * pixel_scale,
-              rgb1[2] + rgb2[2] * pixel_scale);
-    }
-  }
-}
-
-/**
- * Behaves like copy_sub_image(), except the copy pixels are multiplied to the
- * pixels of the destination, after scaling by the specified pixel_scale.
- * Unlike blend_sub_image(), the alpha channel is not treated specially.
- */
-void PNMImage::
-mult_sub_image(const PNMImage &copy, int xto, int yto,
-               int xfrom, int yfrom, int x_size, int y_size,
-               float pixel_scale) {
-  int xmin, ymin, xmax, ymax;
-  setup_sub_image(copy, xto, yto, xfrom, yfrom, x_size, y_size,
-                  xmin, ymin, xmax, ymax);
-
-  int x, y;
-  if (has_alpha() && copy.has_alpha()) {
-    for (y = ymin; y < ymax; y++) {
-      for (x = xmin; x < xmax; x++) {
-        set_alpha(x, y, get_alpha(x, y) * copy.get_alpha(x, y) * pixel_scale);
-      }
-    }
-  }
-
-  for (y = ymin; y < ymax; y++) {
-    for (x = xmin; x < xmax; x++) {
-      LRGBColorf rgb1 = get_xel(x, y);
-      LRGBColorf rgb2 = copy.get_xel(x, y);
-      set_xel(x, y,
-              rgb1[0] * rgb2[0] * pixel_scale,
-              rgb1[1] * rgb2[1] * pixel_scale,
-              rgb1[2] * rgb2[2] * pixel_scale);
-    }
-  }
-}
-
-/**
- * Behaves like copy_sub_image(), but the resulting color will be the darker
- * of the source and destination colors at each pixel (and at each R, G, B, A
- * component value).
- *
- * If pixel_scale is not 1.0, it specifies an amount to scale each pixel value
- * of the source image before applying it to the target image.  The scale is
- * applied with the center at 1.0: scaling the pixel value smaller brings it
- * closer to 1.0.
- */
-void PNMImage::
-darken_sub_image(const PNMImage &copy, int xto, int yto,
-                 int xfrom, int yfrom, int x_size, int y_size,
-                 float pixel_scale) {
-  int xmin, ymin, xmax, ymax;
-  setup_sub_image(copy, xto, yto, xfrom, yfrom, x_size, y_size,
-                  xmin, ymin, xmax, ymax);
-
-  if (get_maxval() == copy.get_maxval() && pixel_scale == 1.0f &&
-      get_color_space() == CS_linear && copy.get_color_space() == CS_linear) {
-    // The simple case: no pixel value rescaling is required.
-    int x, y;
-    for (y = ymin; y < ymax; y++) {
-      for (x = xmin; x < xmax; x++) {
-        xel c = copy.get_xel_val(x - xmin + xfrom, y - ymin + yfrom);
-        xel o = get_xel_val(x, y);
-        xel p;
-        PPM_ASSIGN(p, min(c.r, o.r), min(c.g, o.g), min(c.b, o.b));
-        set_xel_val(x, y, p);
-      }
-    }
-
-    if (has_alpha() && copy.has_alpha()) {
-      for (y = ymin; y < ymax; y++) {
-        for (x = xmin; x < xmax; x++) {
-          xelval c = copy.get_alpha_val(x - xmin + xfrom, y - ymin + yfrom);
-          xelval o = get_alpha_val(x, y);
-          set_alpha_val(x, y, min(c, o));
-        }
-      }
-    }
-
-  } else {
-    // The harder case: rescale pixel values according to maxval.
-    int x, y;
-    for (y = ymin; y < ymax; y++) {
-      for (x = xmin; x < xmax; x++) {
-        LRGBColorf c = copy.get_xel(x - xmin + xfrom, y - ymin + yfrom);
-        LRGBColorf o = get_xel(x, y);
-        LRGBColorf p;
-        p.set(min(1.0f - ((1.0f - c[0]) * pixel_scale), o[0]),
-              min(1.0f - ((1.0f - c[1]) * pixel_scale), o[1]),
-              min(1.0f - ((1.0f - c[2]) * pixel_scale), o[2]));
-        set_xel(x, y, p);
-      }
-    }
-
-    if (has_alpha() && copy.has_alpha()) {
-      for (y = ymin; y < ymax; y++) {
-        for (x = xmin; x < xmax; x++) {
-          float c = copy.get_alpha(x - xmin + xfrom, y - ymin + yfrom);
-          float o = get_alpha(x, y);
-          set_alpha(x, y, min(1.0f - ((1.0f - c) * pixel_scale), o));
-        }
-      }
-    }
-  }
-}
-
-/**
- * Behaves like copy_sub_image(), but the resulting color will be the lighter
- * of the source and destination colors at each pixel (and at each R, G, B, A
- * component value).
- *
- * If pixel_scale is not 1.0, it specifies an amount to scale each pixel value
- * of the source image before applying it to the target image.
- */
-void PNMImage::
-lighten_sub_image(const PNMImage &copy, int xto, int yto,
-                  int xfrom, int yfrom, int x_size, int y_size,
-                  float pixel_scale) {
-  int xmin, ymin, xmax, ymax;
-  setup_sub_image(copy, xto, yto, xfrom, yfrom, x_size, y_size,
-                  xmin, ymin, xmax, ymax);
-
-  if (get_maxval() == copy.get_maxval() && pixel_scale == 1.0f &&
-      get_color_space() == CS_linear && copy.get_color_space() == CS_linear) {
-    // The simple case: no pixel value rescaling is required.
-    int x, y;
-    for (y = ymin; y < ymax; y++) {
-      for (x = xmin; x < xmax; x++) {
-        xel c = copy.get_xel_val(x - xmin + xfrom, y - ymin + yfrom);
-        xel o = get_xel_val(x, y);
-        xel p;
-        PPM_ASSIGN(p, max(c.r, o.r), max(c.g, o.g), max(c.b, o.b));
-        set_xel_val(x, y, p);
-      }
-    }
-
-    if (has_alpha() && copy.has_alpha()) {
-      for (y = ymin; y < ymax; y++) {
-        for (x = xmin; x < xmax; x++) {
-          xelval c = copy.get_alpha_val(x - xmin + xfrom, y - ymin + yfrom);
-          xelval o = get_alpha_val(x, y);
-          set_alpha_val(x, y, max(c, o));
-        }
-      }
-    }
-
-  } else {
-    // The harder case: rescale pixel values according to maxval.
-    int x, y;
-    for (y = ymin; y < ymax; y++) {
-      for (x = xmin; x < xmax; x++) {
-        LRGBColorf c = copy.get_xel(x - xmin + xfrom, y - ymin + yfrom);
-        LRGBColorf o = get_xel(x, y);
-        LRGBColorf p;
-        p.set(max(c[0] * pixel_scale, o[0]),
-              max(c[1] * pixel_scale, o[1]),
-              max(c[2] * pixel_scale, o[2]));
-        set_xel(x, y, p);
-      }
-    }
-
-    if (has_alpha() && copy.has_alpha()) {
-      for (y = ymin; y < ymax; y++) {
-        for (x = xmin; x < xmax; x++) {
-          float c = copy.get_alpha(x - xmin + xfrom, y - ymin + yfrom);
-          float o = get_alpha(x, y);
-          set_alpha(x, y, max(c * pixel_scale, o));
-        }
-      }
-    }
-  }
-}
-
 /**
  * Selectively copies each pixel from either one source or another source,
  * depending on the pixel value of the indicated channel of select_image.
@@ -1576,86 +1313,6 @@ threshold(const PNMImage &select_image, int channel, float threshold,
   }
 }
 
-/**
- * Replaces this image with a grayscale image whose gray channel represents
- * the linear Manhattan distance from the nearest dark pixel in the given mask
- * image, up to the specified radius value (which also becomes the new
- * maxval).  radius may range from 0 to maxmaxval; smaller values will compute
- * faster.  A dark pixel is defined as one whose pixel value is < threshold.
- *
- * If shrink_from_border is true, then the mask image is considered to be
- * surrounded by a border of dark pixels; otherwise, the border isn't
- * considered.
- *
- * This can be used, in conjunction with threshold, to shrink a mask image
- * inwards by a certain number of pixels.
- *
- * The mask image may be the same image as this one, in which case it is
- * destructively modified by this process.
- */
-void PNMImage::
-fill_distance_inside(const PNMImage &mask, float threshold, int radius, bool shrink_from_border) {
-  nassertv(radius <= PNM_MAXMAXVAL);
-  PNMImage dist(mask.get_x_size(), mask.get_y_size(), 1, radius, NULL, CS_linear);
-  dist.fill_val(radius);
-
-  xelval threshold_val = mask.to_val(threshold);
-
-  for (int yi = 0; yi < mask.get_y_size(); ++yi) {
-    for (int xi = 0; xi < mask.get_x_size(); ++xi) {
-      if (mask.get_gray_val(xi, yi) < threshold_val) {
-        dist.do_fill_distance(xi, yi, 0);
-      }
-    }
-  }
-
-  if (shrink_from_border) {
-    // Also measure from the image border.
-    for (int yi = 0; yi < mask.get_y_size(); ++yi) {
-      dist.do_fill_distance(0, yi, 1);
-      dist.do_fill_distance(mask.get_x_size() - 1, yi, 1);
-    }
-    for (int xi = 0; xi < mask.get_x_size(); ++xi) {
-      dist.do_fill_distance(xi, 0, 1);
-      dist.do_fill_distance(xi, mask.get_y_size() - 1, 1);
-    }
-  }
-
-  take_from(dist);
-}
-
-/**
- * Replaces this image with a grayscale image whose gray channel represents
- * the linear Manhattan distance from the nearest white pixel in the given
- * mask image, up to the specified radius value (which also becomes the new
- * maxval).  radius may range from 0 to maxmaxval; smaller values will compute
- * faster.  A white pixel is defined as one whose pixel value is >= threshold.
- *
- * This can be used, in conjunction with threshold, to grow a mask image
- * outwards by a certain number of pixels.
- *
- * The mask image may be the same image as this one, in which case it is
- * destructively modified by this process.
- */
-void PNMImage::
-fill_distance_outside(const PNMImage &mask, float threshold, int radius) {
-  nassertv(radius <= PNM_MAXMAXVAL);
-  PNMImage dist(mask.get_x_size(), mask.get_y_size(), 1, radius, NULL, CS_linear);
-  dist.fill_val(radius);
-
-  xelval threshold_val = mask.to_val(threshold);
-
-  for (int yi = 0; yi < mask.get_y_size(); ++yi) {
-    for (int xi = 0; xi < mask.get_x_size(); ++xi) {
-      if (mask.get_gray_val(xi, yi) >= threshold_val) {
-        dist.do_fill_distance(xi, yi, 0);
-      }
-    }
-  }
-
-  take_from(dist);
-}
-
 /**
  * index_image is a WxH grayscale image, while pixel_values is an Nx1 color
  * (or grayscale) image.  Typically pixel_values will be a 256x1 image.
@@ -1931,12 +1588,26 @@ make_histogram(PNMImage::Histogram &histogram) {
  */
 void PNMImage::
 perlin_noise_fill(float sx, float sy, int table_size, unsigned long seed) {
-  float x, y;
-  float noise;
   PerlinNoise2 perlin (sx * _x_size, sy * _y_size, table_size, seed);
-  for (x = 0; x < _x_size; ++x) {
-    for (y = 0; y < _y_size; ++y) {
-      noise = perlin.noise(x, y);
+
+  pvector<double> xs(_x_size);
+  pvector<double> ys(_y_size);
+  for (int x = 0; x < _x_size; ++x) {
+    xs[x] = (float)x;
+  }
+  for (int y = 0; y < _y_size; ++y) {
+    ys[y] = (float)y;
+  }
+
+  pvector<double> grid((size_t)_x_size * _y_size);
+  if (!grid.empty()) {
+    perlin.noise_grid(&grid[0], &xs[0], _x_size, &ys[0], _y_size);
+  }
+
+  for (int y = 0; y < _y_size; ++y) {
+    const double *row = &grid[(size_t)y * _x_size];
+    for (int x = 0; x < _x_size; ++x) {
+      float noise = (float)row[x];
       set_xel(x, y, 0.5 * (noise + 1.0));
     }
   }
@@ -1948,11 +1619,24 @@ perlin_noise_fill(float sx, float sy, int table_size, unsigned long seed) {
  */
 void PNMImage::
 perlin_noise_fill(StackedPerlinNoise2 &perlin) {
-  float x, y;
-  float noise;
-  for (x = 0; x < _x_size; ++x) {
-    for (y = 0; y < _y_size; ++y) {
-      noise = perlin.noise(x / (float) _x_size, y / (float) _y_size);
+  pvector<double> xs(_x_size);
+  pvector<double> ys(_y_size);
+  for (int x = 0; x < _x_size; ++x) {
+    xs[x] = (float)x / (float)_x_size;
+  }
+  for (int y = 0; y < _y_size; ++y) {
+    ys[y] = (float)y / (float)_y_size;
+  }
+
+  pvector<double> grid((size_t)_x_size * _y_size);
+  if (!grid.empty()) {
+    perlin.noise_grid(&grid[0], &xs[0], _x_size, &ys[0], _y_size);
+  }
+
+  for (int y = 0; y < _y_size; ++y) {
+    const double *row = &grid[(size_t)y * _x_size];
+    for (int x = 0; x < _x_size; ++x) {
+      float noise = (float)row[x];
       set_xel(x, y, 0.5 * (noise + 1.0));
     }
   }
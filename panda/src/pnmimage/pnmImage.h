@@ -223,8 +223,12 @@ PUBLISHED:
                          float pixel_scale = 1.0);
   void threshold(const PNMImage &select_image, int channel, float threshold,
                  const PNMImage &lt, const PNMImage &ge);
+
+  // The bodies for the distance functions can be found in the file
+  // pnm-image-distance.cxx.
   BLOCKING void fill_distance_inside(const PNMImage &mask, float threshold, int radius, bool shrink_from_border);
   BLOCKING void fill_distance_outside(const PNMImage &mask, float threshold, int radius);
+  BLOCKING void fill_signed_distance(const PNMImage &mask, float threshold, float radius);
 
   void indirect_1d_lookup(const PNMImage &index_image, int channel,
                           const PNMImage &pixel_values);
@@ -250,10 +254,13 @@ PUBLISHED:
   void unfiltered_stretch_from(const PNMImage &copy);
   void box_filter_from(float radius, const PNMImage &copy);
   void gaussian_filter_from(float radius, const PNMImage &copy);
+  void bilinear_filter_from(float radius, const PNMImage &copy);
+  void lanczos_filter_from(float radius, const PNMImage &copy);
   void quick_filter_from(const PNMImage &copy,
                          int xborder = 0, int yborder = 0);
 
   void make_histogram(Histogram &hist);
+  BLOCKING void quantize(size_t max_colors);
   void perlin_noise_fill(float sx, float sy, int table_size = 256,
                          unsigned long seed = 0);
   void perlin_noise_fill(StackedPerlinNoise2 &perlin);
@@ -379,69 +379,6 @@ output(ostream &out) const {
       << _num_channels << " channels, " << _maxval << " maxval.";
 }
 
-/**
- * Computes a histogram of the colors used in the indicated rgb/grayscale
- * array and/or alpha array.  This is most likely to be useful in a PNMWriter
- * class, but it is defined at this level in case it has general utilty for
- * PNMImages.
- *
- * Also see PNMImage::make_histogram(), which is a higher-level function.
- *
- * The max_colors parameter, if greater than zero, limits the maximum number
- * of colors we are interested in.  If we encounter more than this number of
- * colors, the function aborts before completion and returns false; otherwise,
- * it returns true.
- */
-bool PNMImageHeader::
-compute_histogram(PNMImageHeader::HistMap &hist,
-                  xel *array, xelval *alpha, int max_colors) {
-  int num_pixels = _x_size * _y_size;
-  int pi;
-
-  switch (get_color_type()) {
-  case CT_invalid:
-    return false;
-
-  case CT_grayscale:
-    for (pi = 0; pi < num_pixels; pi++) {
-      record_color(hist, PixelSpec(PPM_GETB(array[pi])));
-      if (max_colors > 0 && (int)hist.size() > max_colors) {
-        return false;
-      }
-    }
-    return true;
-
-  case CT_two_channel:
-    for (pi = 0; pi < num_pixels; pi++) {
-      record_color(hist, PixelSpec(PPM_GETB(array[pi]), alpha[pi]));
-      if (max_colors > 0 && (int)hist.size() > max_colors) {
-        return false;
-      }
-    }
-    return true;
-
-  case CT_color:
-    for (pi = 0; pi < num_pixels; pi++) {
-      record_color(hist, PixelSpec(PPM_GETR(array[pi]), PPM_GETG(array[pi]), PPM_GETB(array[pi])));
-      if (max_colors > 0 && (int)hist.size() > max_colors) {
-        return false;
-      }
-    }
-    return true;
-
-  case CT_four_channel:
-    for (pi = 0; pi < num_pixels; pi++) {
-      record_color(hist, PixelSpec(PPM_GETR(array[pi]), PPM_GETG(array[pi]), PPM_GETB(array[pi]), alpha[pi]));
-      if (max_colors > 0 && (int)hist.size() > max_colors) {
-        return false;
-      }
-    }
-    return true;
-  }
-
-  return false;
-}
-
 /**
  * Returns a linear list of all of the colors in the image, similar to
  * compute_histogram().
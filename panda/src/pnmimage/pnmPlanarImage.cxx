@@ -0,0 +1,482 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file pnmPlanarImage.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "pnmPlanarImage.h"
+#include "pnmImage.h"
+#include "pfmFile.h"
+#include "thread.h"
+#include "workerPool.h"
+
+#include <string.h>
+
+// This job copies a range of rows from a PNMImage or a PfmFile into the
+// planes of a PNMPlanarImage.  Exactly one of _pnmimage and _pfm is set.
+class PNMPlanarImage::LoadJob : public WorkerPool::Job {
+public:
+  virtual void execute(int begin, int end) {
+    int x_size = _image->_x_size;
+    int num_channels = _image->_num_channels;
+    pvector<float> rows((size_t)x_size * num_channels);
+
+    for (int yi = begin; yi < end; ++yi) {
+      if (_pnmimage != NULL) {
+        for (int xi = 0; xi < x_size; ++xi) {
+          switch (num_channels) {
+          case 1:
+            rows[xi] = _pnmimage->get_gray(xi, yi);
+            break;
+
+          case 2:
+            rows[xi] = _pnmimage->get_gray(xi, yi);
+            rows[x_size + xi] = _pnmimage->get_alpha(xi, yi);
+            break;
+
+          case 3:
+            {
+              LRGBColorf xel = _pnmimage->get_xel(xi, yi);
+              rows[xi] = xel[0];
+              rows[x_size + xi] = xel[1];
+              rows[x_size * 2 + xi] = xel[2];
+            }
+            break;
+
+          case 4:
+            {
+              LColorf xel = _pnmimage->get_xel_a(xi, yi);
+              rows[xi] = xel[0];
+              rows[x_size + xi] = xel[1];
+              rows[x_size * 2 + xi] = xel[2];
+              rows[x_size * 3 + xi] = xel[3];
+            }
+            break;
+          }
+        }
+
+      } else {
+        const PN_float32 *point = &_pfm->get_table()[0] + (size_t)yi * x_size * num_channels;
+        for (int xi = 0; xi < x_size; ++xi) {
+          for (int c = 0; c < num_channels; ++c) {
+            rows[c * x_size + xi] = point[c];
+          }
+          point += num_channels;
+        }
+      }
+
+      for (int c = 0; c < num_channels; ++c) {
+        _image->set_row(c, yi, &rows[c * x_size]);
+      }
+      Thread::consider_yield();
+    }
+  }
+
+  PNMPlanarImage *_image;
+  const PNMImage *_pnmimage;
+  const PfmFile *_pfm;
+};
+
+// This job copies a range of rows from the planes of a PNMPlanarImage into a
+// PNMImage or into the table of a PfmFile.  Exactly one of _pnmimage and
+// _table is set.
+class PNMPlanarImage::StoreJob : public WorkerPool::Job {
+public:
+  virtual void execute(int begin, int end) {
+    int x_size = _image->_x_size;
+    int num_channels = _image->_num_channels;
+    pvector<float> rows((size_t)x_size * num_channels);
+
+    for (int yi = begin; yi < end; ++yi) {
+      for (int c = 0; c < num_channels; ++c) {
+        _image->get_row(c, yi, &rows[c * x_size]);
+      }
+
+      if (_pnmimage != NULL) {
+        for (int xi = 0; xi < x_size; ++xi) {
+          switch (num_channels) {
+          case 1:
+            _pnmimage->set_gray(xi, yi, rows[xi]);
+            break;
+
+          case 2:
+            _pnmimage->set_gray(xi, yi, rows[xi]);
+            _pnmimage->set_alpha(xi, yi, rows[x_size + xi]);
+            break;
+
+          case 3:
+            _pnmimage->set_xel(xi, yi, rows[xi], rows[x_size + xi],
+                               rows[x_size * 2 + xi]);
+            break;
+
+          case 4:
+            _pnmimage->set_xel_a(xi, yi, rows[xi], rows[x_size + xi],
+                                 rows[x_size * 2 + xi], rows[x_size * 3 + xi]);
+            break;
+          }
+        }
+
+      } else {
+        PN_float32 *point = _table + (size_t)yi * x_size * num_channels;
+        for (int xi = 0; xi < x_size; ++xi) {
+          for (int c = 0; c < num_channels; ++c) {
+            point[c] = rows[c * x_size + xi];
+          }
+          point += num_channels;
+        }
+      }
+      Thread::consider_yield();
+    }
+  }
+
+  const PNMPlanarImage *_image;
+  PNMImage *_pnmimage;
+  PN_float32 *_table;
+};
+
+/**
+ * Runs the job over all of the rows of an image of the indicated size,
+ * dividing them among the threads of the WorkerPool.  Small images aren't
+ * worth waking up the other threads for.
+ */
+static void
+run_planar_job(WorkerPool::Job &job, int x_size, int y_size) {
+  if ((size_t)x_size * (size_t)y_size < 65536) {
+    job.execute(0, y_size);
+    return;
+  }
+  WorkerPool *pool = WorkerPool::get_global_ptr();
+  pool->run(job, y_size, max(1, y_size / ((pool->get_num_threads() + 1) * 4)));
+}
+
+/**
+ *
+ */
+PNMPlanarImage::
+PNMPlanarImage() {
+  clear();
+}
+
+/**
+ * Allocates an image of the indicated size, with all values set to zero.
+ */
+PNMPlanarImage::
+PNMPlanarImage(int x_size, int y_size, int num_channels,
+               StorageType storage_type) {
+  clear(x_size, y_size, num_channels, storage_type);
+}
+
+/**
+ *
+ */
+PNMPlanarImage::
+PNMPlanarImage(const PNMPlanarImage &copy) :
+  PNMImageHeader(copy),
+  _storage_type(copy._storage_type),
+  _float_table(copy._float_table),
+  _half_table(copy._half_table)
+{
+}
+
+/**
+ *
+ */
+void PNMPlanarImage::
+operator = (const PNMPlanarImage &copy) {
+  PNMImageHeader::operator = (copy);
+  _storage_type = copy._storage_type;
+  _float_table = copy._float_table;
+  _half_table = copy._half_table;
+}
+
+/**
+ * Eliminates all data in the image.
+ */
+void PNMPlanarImage::
+clear() {
+  _x_size = 0;
+  _y_size = 0;
+  _num_channels = 0;
+  _storage_type = ST_float;
+
+  // Actually release the memory, rather than just emptying the tables.
+  vector_float().swap(_float_table);
+  pvector<uint16_t>().swap(_half_table);
+}
+
+/**
+ * Resets to an empty image of the indicated size, with all values set to
+ * zero, stored in the indicated way.
+ */
+void PNMPlanarImage::
+clear(int x_size, int y_size, int num_channels, StorageType storage_type) {
+  nassertv(x_size >= 0 && y_size >= 0);
+  nassertv((num_channels > 0 && num_channels <= 4) ||
+           (x_size == 0 && y_size == 0 && num_channels == 0));
+
+  _x_size = x_size;
+  _y_size = y_size;
+  _num_channels = num_channels;
+  _storage_type = storage_type;
+
+  size_t size = get_plane_size() * num_channels;
+  if (storage_type == ST_half) {
+    vector_float().swap(_float_table);
+    pvector<uint16_t>(size, (uint16_t)0).swap(_half_table);
+  } else {
+    vector_float(size, 0.0f).swap(_float_table);
+    pvector<uint16_t>().swap(_half_table);
+  }
+}
+
+/**
+ * Fills the image with the data from the indicated PNMImage, converted to
+ * linear floating-point values, as by PfmFile::load().  The storage type of
+ * the image is retained.
+ */
+bool PNMPlanarImage::
+load(const PNMImage &pnmimage) {
+  if (!pnmimage.is_valid()) {
+    clear();
+    return false;
+  }
+
+  clear(pnmimage.get_x_size(), pnmimage.get_y_size(),
+        pnmimage.get_num_channels(), _storage_type);
+
+  LoadJob job;
+  job._image = this;
+  job._pnmimage = &pnmimage;
+  job._pfm = NULL;
+  run_planar_job(job, _x_size, _y_size);
+  return true;
+}
+
+/**
+ * Fills the image with the data from the indicated PfmFile.  The storage type
+ * of the image is retained.  The scale and no-data value of the PfmFile are
+ * not preserved.
+ */
+bool PNMPlanarImage::
+load(const PfmFile &pfm) {
+  if (!pfm.is_valid()) {
+    clear();
+    return false;
+  }
+
+  clear(pfm.get_x_size(), pfm.get_y_size(), pfm.get_num_channels(),
+        _storage_type);
+
+  LoadJob job;
+  job._image = this;
+  job._pnmimage = NULL;
+  job._pfm = &pfm;
+  run_planar_job(job, _x_size, _y_size);
+  return true;
+}
+
+/**
+ * Copies the data to the indicated PNMImage, converting to RGB values, as by
+ * PfmFile::store().
+ */
+bool PNMPlanarImage::
+store(PNMImage &pnmimage) const {
+  if (!is_valid()) {
+    pnmimage.clear();
+    return false;
+  }
+
+  pnmimage.clear(_x_size, _y_size, _num_channels, PGM_MAXMAXVAL);
+
+  StoreJob job;
+  job._image = this;
+  job._pnmimage = &pnmimage;
+  job._table = NULL;
+  run_planar_job(job, _x_size, _y_size);
+  return true;
+}
+
+/**
+ * Copies the data to the indicated PfmFile, interleaving the channels.
+ */
+bool PNMPlanarImage::
+store(PfmFile &pfm) const {
+  if (!is_valid()) {
+    pfm.clear();
+    return false;
+  }
+
+  pfm.clear(_x_size, _y_size, _num_channels);
+
+  // Borrow the table that was allocated by clear(), and fill it in.
+  vector_float table;
+  pfm.swap_table(table);
+
+  StoreJob job;
+  job._image = this;
+  job._pnmimage = NULL;
+  job._table = &table[0];
+  run_planar_job(job, _x_size, _y_size);
+
+  pfm.swap_table(table);
+  return true;
+}
+
+/**
+ * Changes the way in which the values of the image are stored, converting the
+ * existing values.  Converting to ST_half loses precision; values beyond the
+ * range of a half-precision float become infinite.
+ */
+void PNMPlanarImage::
+set_storage_type(StorageType storage_type) {
+  if (storage_type == _storage_type) {
+    return;
+  }
+
+  size_t size = get_plane_size() * _num_channels;
+  if (storage_type == ST_half) {
+    pvector<uint16_t> table(size);
+    for (size_t i = 0; i < size; ++i) {
+      table[i] = pack_half(_float_table[i]);
+    }
+    _half_table.swap(table);
+    vector_float().swap(_float_table);
+
+  } else {
+    vector_float table(size);
+    for (size_t i = 0; i < size; ++i) {
+      table[i] = unpack_half(_half_table[i]);
+    }
+    _float_table.swap(table);
+    pvector<uint16_t>().swap(_half_table);
+  }
+
+  _storage_type = storage_type;
+}
+
+/**
+ * Returns the values of all channels at the indicated pixel.  Channels beyond
+ * the number of channels of the image are returned as zero.
+ */
+LPoint4f PNMPlanarImage::
+get_point4(int x, int y) const {
+  LPoint4f point = LPoint4f::zero();
+  for (int c = 0; c < _num_channels; ++c) {
+    point[c] = get_channel(x, y, c);
+  }
+  return point;
+}
+
+/**
+ * Replaces the values of all channels at the indicated pixel.  Components
+ * beyond the number of channels of the image are ignored.
+ */
+void PNMPlanarImage::
+set_point4(int x, int y, const LVecBase4f &point) {
+  for (int c = 0; c < _num_channels; ++c) {
+    set_channel(x, y, c, point[c]);
+  }
+}
+
+/**
+ * Sets all of the values of all channels to the indicated value.
+ */
+void PNMPlanarImage::
+fill(float value) {
+  for (int c = 0; c < _num_channels; ++c) {
+    fill_channel(c, value);
+  }
+}
+
+/**
+ * Sets all of the values of the indicated channel to the indicated value.
+ */
+void PNMPlanarImage::
+fill_channel(int c, float value) {
+  nassertv(c >= 0 && c < _num_channels);
+  size_t size = get_plane_size();
+  if (_storage_type == ST_half) {
+    uint16_t *plane = get_half_plane(c);
+    std::fill(plane, plane + size, pack_half(value));
+  } else {
+    float *plane = get_float_plane(c);
+    std::fill(plane, plane + size, value);
+  }
+}
+
+/**
+ * Copies the indicated channel of the other image, which must have the same
+ * size as this one, into the indicated channel of this image.  The other
+ * image may be this same image.
+ */
+void PNMPlanarImage::
+copy_channel(int to_c, const PNMPlanarImage &other, int from_c) {
+  nassertv(to_c >= 0 && to_c < _num_channels);
+  nassertv(from_c >= 0 && from_c < other._num_channels);
+  nassertv(other._x_size == _x_size && other._y_size == _y_size);
+
+  if (&other == this && to_c == from_c) {
+    return;
+  }
+
+  size_t size = get_plane_size();
+  if (_storage_type == other._storage_type) {
+    if (_storage_type == ST_half) {
+      memcpy(get_half_plane(to_c), other.get_half_plane(from_c),
+             size * sizeof(uint16_t));
+    } else {
+      memcpy(get_float_plane(to_c), other.get_float_plane(from_c),
+             size * sizeof(float));
+    }
+    return;
+  }
+
+  pvector<float> row(_x_size);
+  for (int yi = 0; yi < _y_size; ++yi) {
+    other.get_row(from_c, yi, &row[0]);
+    set_row(to_c, yi, &row[0]);
+  }
+}
+
+/**
+ * Copies the _x_size values of the indicated row of the indicated channel
+ * into the given array, converting them to floats if necessary.
+ */
+void PNMPlanarImage::
+get_row(int c, int y, float *into) const {
+  nassertv(c >= 0 && c < _num_channels && y >= 0 && y < _y_size);
+  size_t start = c * get_plane_size() + (size_t)y * _x_size;
+  if (_storage_type == ST_half) {
+    const uint16_t *from = &_half_table[start];
+    for (int xi = 0; xi < _x_size; ++xi) {
+      into[xi] = unpack_half(from[xi]);
+    }
+  } else {
+    memcpy(into, &_float_table[start], _x_size * sizeof(float));
+  }
+}
+
+/**
+ * Replaces the _x_size values of the indicated row of the indicated channel
+ * with those in the given array, converting them as necessary.
+ */
+void PNMPlanarImage::
+set_row(int c, int y, const float *from) {
+  nassertv(c >= 0 && c < _num_channels && y >= 0 && y < _y_size);
+  size_t start = c * get_plane_size() + (size_t)y * _x_size;
+  if (_storage_type == ST_half) {
+    uint16_t *into = &_half_table[start];
+    for (int xi = 0; xi < _x_size; ++xi) {
+      into[xi] = pack_half(from[xi]);
+    }
+  } else {
+    memcpy(&_float_table[start], from, _x_size * sizeof(float));
+  }
+}
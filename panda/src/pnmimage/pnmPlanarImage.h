@@ -0,0 +1,113 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file pnmPlanarImage.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef PNMPLANARIMAGE_H
+#define PNMPLANARIMAGE_H
+
+#include "pandabase.h"
+#include "pnmImageHeader.h"
+#include "luse.h"
+#include "pvector.h"
+#include "vector_float.h"
+#include "pack_half.h"
+
+class PNMImage;
+class PfmFile;
+
+/**
+ * An image of linearized floating-point values, like a PfmFile, except that
+ * each channel is stored in its own plane, one after the other, rather than
+ * interleaved.  This keeps the values of one channel together in memory,
+ * which suits filters that operate on one channel at a time, such as
+ * box_filter_from() and the other resizing filters.
+ *
+ * The values may optionally be stored as 16-bit half-precision floats, which
+ * halves the memory needed for a large image, at the cost of precision.  The
+ * values are converted to and from 32-bit floats whenever they are accessed.
+ *
+ * This is meant as a compact working copy of a PNMImage or PfmFile; use
+ * load() and store() to convert between them.  PNMImage itself always keeps
+ * its pixels interleaved, since it hands out references to them through
+ * get_array() and get_xel_val(); this class does not change that.
+ */
+class EXPCL_PANDA_PNMIMAGE PNMPlanarImage : public PNMImageHeader {
+PUBLISHED:
+  enum StorageType {
+    ST_float,
+    ST_half
+  };
+
+  PNMPlanarImage();
+  PNMPlanarImage(int x_size, int y_size, int num_channels,
+                 StorageType storage_type = ST_float);
+  PNMPlanarImage(const PNMPlanarImage &copy);
+  void operator = (const PNMPlanarImage &copy);
+
+  void clear();
+  void clear(int x_size, int y_size, int num_channels,
+             StorageType storage_type = ST_float);
+
+  BLOCKING bool load(const PNMImage &pnmimage);
+  BLOCKING bool load(const PfmFile &pfm);
+  BLOCKING bool store(PNMImage &pnmimage) const;
+  BLOCKING bool store(PfmFile &pfm) const;
+
+  INLINE bool is_valid() const;
+  MAKE_PROPERTY(valid, is_valid);
+
+  INLINE StorageType get_storage_type() const;
+  void set_storage_type(StorageType storage_type);
+  MAKE_PROPERTY(storage_type, get_storage_type, set_storage_type);
+
+  INLINE size_t get_num_bytes() const;
+
+  INLINE float get_channel(int x, int y, int c) const;
+  INLINE void set_channel(int x, int y, int c, float value);
+  LPoint4f get_point4(int x, int y) const;
+  void set_point4(int x, int y, const LVecBase4f &point);
+
+  void fill(float value);
+  void fill_channel(int c, float value);
+  void copy_channel(int to_c, const PNMPlanarImage &other, int from_c);
+
+  BLOCKING void box_filter_from(float radius, const PNMPlanarImage &copy);
+  BLOCKING void gaussian_filter_from(float radius, const PNMPlanarImage &copy);
+  BLOCKING void bilinear_filter_from(float radius, const PNMPlanarImage &copy);
+  BLOCKING void lanczos_filter_from(float radius, const PNMPlanarImage &copy);
+
+public:
+  void get_row(int c, int y, float *into) const;
+  void set_row(int c, int y, const float *from);
+
+  INLINE float *get_float_plane(int c);
+  INLINE const float *get_float_plane(int c) const;
+  INLINE uint16_t *get_half_plane(int c);
+  INLINE const uint16_t *get_half_plane(int c) const;
+
+private:
+  INLINE size_t get_plane_size() const;
+
+  class LoadJob;
+  class StoreJob;
+
+  StorageType _storage_type;
+
+  // Only one of these is used, depending on _storage_type.  Each holds
+  // _num_channels planes of _x_size * _y_size values.
+  vector_float _float_table;
+  pvector<uint16_t> _half_table;
+};
+
+#include "pnmPlanarImage.I"
+
+#endif
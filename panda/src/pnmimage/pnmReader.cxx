@@ -226,6 +226,89 @@ read_row(xel *, xelval *, int, int) {
 }
 
 
+/**
+ * Returns true if this particular PNMReader is capable of reading the image
+ * directly into a buffer in the layout used by a Texture's ram image, via
+ * read_ram_image(), without going through a PNMImage.  This should be called
+ * before prepare_read(), and is only meaningful if set_read_size() has not
+ * been called.
+ *
+ * The default implementation supports this if the image can be read one row
+ * at a time, and it has a maxval of 255 or 65535.
+ */
+bool PNMReader::
+supports_read_ram_image() const {
+  return supports_read_row() && (_maxval == 255 || _maxval == 65535);
+}
+
+/**
+ * If supports_read_ram_image(), above, returns true, this function may be
+ * called after prepare_read() to read the entire image directly into the
+ * indicated buffer, which must have room for _x_size * _y_size pixels.
+ *
+ * The data is stored the way a Texture stores it: the rows from bottom to
+ * top, and the components of each pixel in the order blue, green, red, alpha
+ * (or gray, alpha), with get_num_channels() components per pixel.  Each
+ * component is one byte if the maxval is 255, or an unsigned short in native
+ * byte order if it is 65535.
+ *
+ * Returns the number of rows correctly read.
+ */
+int PNMReader::
+read_ram_image(unsigned char *data) {
+  if (!is_valid()) {
+    return 0;
+  }
+  nassertr(_x_shift == 0 && _y_shift == 0, 0);
+  nassertr(_maxval == 255 || _maxval == 65535, 0);
+
+  int num_channels = get_num_channels();
+  bool get_alpha = has_alpha();
+  size_t row_size = (size_t)_x_size * num_channels;
+
+  xel *array = (xel *)PANDA_MALLOC_ARRAY(_x_size * sizeof(xel));
+  xelval *alpha = (xelval *)PANDA_MALLOC_ARRAY(_x_size * sizeof(xelval));
+
+  int y;
+  for (y = 0; y < _y_size; ++y) {
+    if (!read_row(array, alpha, _x_size, _y_size)) {
+      break;
+    }
+
+    size_t offset = row_size * (_y_size - 1 - y);
+    if (_maxval == 255) {
+      unsigned char *p = data + offset;
+      for (int x = 0; x < _x_size; ++x) {
+        *p++ = (unsigned char)PPM_GETB(array[x]);
+        if (num_channels >= 3) {
+          *p++ = (unsigned char)PPM_GETG(array[x]);
+          *p++ = (unsigned char)PPM_GETR(array[x]);
+        }
+        if (get_alpha) {
+          *p++ = (unsigned char)alpha[x];
+        }
+      }
+    } else {
+      unsigned short *p = (unsigned short *)data + offset;
+      for (int x = 0; x < _x_size; ++x) {
+        *p++ = (unsigned short)PPM_GETB(array[x]);
+        if (num_channels >= 3) {
+          *p++ = (unsigned short)PPM_GETG(array[x]);
+          *p++ = (unsigned short)PPM_GETR(array[x]);
+        }
+        if (get_alpha) {
+          *p++ = (unsigned short)alpha[x];
+        }
+      }
+    }
+    Thread::consider_yield();
+  }
+
+  PANDA_FREE_ARRAY(array);
+  PANDA_FREE_ARRAY(alpha);
+  return y;
+}
+
 /**
  * Returns true if this particular PNMReader can read from a general stream
  * (including pipes, etc.), or false if the reader must occasionally fseek()
@@ -236,6 +319,39 @@ supports_stream_read() const {
   return false;
 }
 
+/**
+ * Swaps the red and blue components of each of the x_size pixels in the
+ * indicated row, in place, to convert a row read in RGB order into the BGR
+ * order expected by read_ram_image().  Does nothing to a grayscale row.
+ */
+void PNMReader::
+swap_red_blue(unsigned char *row, int x_size, int num_channels,
+              int component_width) {
+  if (num_channels < 3) {
+    return;
+  }
+
+  if (component_width == 1) {
+    unsigned char *p = row;
+    unsigned char *pend = row + (size_t)x_size * num_channels;
+    while (p < pend) {
+      unsigned char t = p[0];
+      p[0] = p[2];
+      p[2] = t;
+      p += num_channels;
+    }
+  } else {
+    unsigned short *p = (unsigned short *)row;
+    unsigned short *pend = p + (size_t)x_size * num_channels;
+    while (p < pend) {
+      unsigned short t = p[0];
+      p[0] = p[2];
+      p[2] = t;
+      p += num_channels;
+    }
+  }
+}
+
 /**
  * Determines the reduction factor between the original size and the requested
  * size, returned as an exponent of power of 2 (that is, a bit shift).
@@ -41,10 +41,17 @@ public:
   virtual bool supports_read_row() const;
   virtual bool read_row(xel *array, xelval *alpha, int x_size, int y_size);
 
+  virtual bool supports_read_ram_image() const;
+  virtual int read_ram_image(unsigned char *data);
+
   virtual bool supports_stream_read() const;
 
   INLINE bool is_valid() const;
 
+protected:
+  static void swap_red_blue(unsigned char *row, int x_size,
+                            int num_channels, int component_width);
+
 private:
   int get_reduction_shift(int orig_size, int new_size);
 
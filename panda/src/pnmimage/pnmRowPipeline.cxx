@@ -0,0 +1,395 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file pnmRowPipeline.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "pnmRowPipeline.h"
+#include "pnmImageHeader.h"
+#include "pnmReader.h"
+#include "pnmWriter.h"
+#include "pnmFileType.h"
+#include "convert_srgb.h"
+#include "config_pnmimage.h"
+#include "pdeque.h"
+#include "cmath.h"
+#include "thread.h"
+
+/**
+ *
+ */
+PNMRowPipeline::
+PNMRowPipeline() :
+  _has_output_size(false),
+  _output_x_size(0),
+  _output_y_size(0),
+  _num_channels(0),
+  _maxval(0)
+{
+}
+
+/**
+ * Adds an operation that transforms every pixel using the operation
+ * (Ro,Go,Bo) = conv.xform_point(Ri,Gi,Bi), like PNMImage::remix_channels().
+ */
+void PNMRowPipeline::
+add_remix_channels(const LMatrix4 &conv) {
+  Operation op;
+  op._type = OT_remix_channels;
+  op._conv = LCAST(float, conv);
+  _operations.push_back(op);
+}
+
+/**
+ * Adds an operation that raises each channel to the indicated exponent, like
+ * PNMImage::apply_exponent().
+ */
+void PNMRowPipeline::
+add_apply_exponent(float red_exponent, float green_exponent,
+                   float blue_exponent, float alpha_exponent) {
+  Operation op;
+  op._type = OT_apply_exponent;
+  op._exponent.set(red_exponent, green_exponent, blue_exponent, alpha_exponent);
+  _operations.push_back(op);
+}
+
+/**
+ * Adds an operation that encodes the RGB channels from linear to the sRGB
+ * color space.
+ */
+void PNMRowPipeline::
+add_linear_to_srgb() {
+  Operation op;
+  op._type = OT_linear_to_srgb;
+  _operations.push_back(op);
+}
+
+/**
+ * Adds an operation that decodes the RGB channels from the sRGB color space
+ * to linear.
+ */
+void PNMRowPipeline::
+add_srgb_to_linear() {
+  Operation op;
+  op._type = OT_srgb_to_linear;
+  _operations.push_back(op);
+}
+
+/**
+ * Reads the indicated image file, a few rows at a time, and writes the result
+ * of the operations to the indicated output file.  The output file type is
+ * deduced from its extension, unless output_type is specified.  Returns true
+ * on success, false on failure.
+ */
+bool PNMRowPipeline::
+process(const Filename &input, const Filename &output,
+        PNMFileType *input_type, PNMFileType *output_type) {
+  PNMImageHeader header;
+  PNMReader *reader = header.make_reader(input, input_type);
+  if (reader == (PNMReader *)NULL) {
+    return false;
+  }
+
+  PNMWriter *writer = header.make_writer(output, output_type);
+  if (writer == (PNMWriter *)NULL) {
+    delete reader;
+    return false;
+  }
+
+  return process(reader, writer);
+}
+
+/**
+ * Reads the image from the indicated reader, a few rows at a time, and writes
+ * the result of the operations to the indicated writer.  Both objects are
+ * deleted when this returns.  Returns true on success, false on failure.
+ */
+bool PNMRowPipeline::
+process(PNMReader *reader, PNMWriter *writer) {
+  if (reader == (PNMReader *)NULL || writer == (PNMWriter *)NULL) {
+    delete reader;
+    delete writer;
+    return false;
+  }
+
+  if (!reader->is_valid() || !writer->is_valid()) {
+    delete reader;
+    delete writer;
+    return false;
+  }
+
+  reader->prepare_read();
+
+  if (reader->is_floating_point() || !reader->supports_read_row()) {
+    pnmimage_cat.error()
+      << "Cannot read " << reader->get_type()->get_name()
+      << " images one row at a time.\n";
+    delete reader;
+    delete writer;
+    return false;
+  }
+
+  if (!writer->supports_integer() || !writer->supports_write_row()) {
+    pnmimage_cat.error()
+      << "Cannot write " << writer->get_type()->get_name()
+      << " images one row at a time.\n";
+    delete reader;
+    delete writer;
+    return false;
+  }
+
+  int source_x_size = reader->get_x_size();
+  int source_y_size = reader->get_y_size();
+  int dest_x_size = _has_output_size ? _output_x_size : source_x_size;
+  int dest_y_size = _has_output_size ? _output_y_size : source_y_size;
+
+  writer->copy_header_from(*reader);
+  writer->set_x_size(dest_x_size);
+  writer->set_y_size(dest_y_size);
+  if (_num_channels != 0) {
+    writer->set_num_channels(_num_channels);
+  }
+  if (_maxval != 0) {
+    writer->set_maxval(_maxval);
+  }
+
+  if (source_x_size <= 0 || source_y_size <= 0 || !writer->write_header()) {
+    delete reader;
+    delete writer;
+    return false;
+  }
+
+  // Set up the horizontal box filter.  Destination pixel x covers the source
+  // pixels from x * x_scale to (x + 1) * x_scale.
+  float x_scale = (float)source_x_size / (float)dest_x_size;
+  _x_first.resize(dest_x_size);
+  _x_offset.resize(dest_x_size + 1);
+  _x_weights.clear();
+  for (int x = 0; x < dest_x_size; ++x) {
+    float x0 = x * x_scale;
+    float x1 = (x + 1) * x_scale;
+    int first = min((int)x0, source_x_size - 1);
+    int last = max(min((int)cceil(x1), source_x_size) - 1, first);
+
+    _x_first[x] = first;
+    _x_offset[x] = (int)_x_weights.size();
+    float total = 0.0f;
+    for (int sx = first; sx <= last; ++sx) {
+      float weight = max(min(x1, (float)(sx + 1)) - max(x0, (float)sx), 0.0f);
+      _x_weights.push_back(weight);
+      total += weight;
+    }
+    if (total > 0.0f) {
+      for (int i = _x_offset[x]; i < (int)_x_weights.size(); ++i) {
+        _x_weights[i] /= total;
+      }
+    } else {
+      _x_weights[_x_offset[x]] = 1.0f;
+    }
+  }
+  _x_offset[dest_x_size] = (int)_x_weights.size();
+
+  xel *read_array = (xel *)PANDA_MALLOC_ARRAY(source_x_size * sizeof(xel));
+  xelval *read_alpha = (xelval *)PANDA_MALLOC_ARRAY(source_x_size * sizeof(xelval));
+  xel *write_array = (xel *)PANDA_MALLOC_ARRAY(dest_x_size * sizeof(xel));
+  xelval *write_alpha = (xelval *)PANDA_MALLOC_ARRAY(dest_x_size * sizeof(xelval));
+
+  // The band holds the source rows, already filtered down to the destination
+  // width, that are needed for the current destination row.  The first row in
+  // the band is source row next_source_y - band.size().
+  pdeque<Row> band;
+  int next_source_y = 0;
+
+  float y_scale = (float)source_y_size / (float)dest_y_size;
+  Row dest_row(dest_x_size * 4);
+  bool success = true;
+
+  for (int y = 0; y < dest_y_size && success; ++y) {
+    float y0 = y * y_scale;
+    float y1 = (y + 1) * y_scale;
+    int first = min((int)y0, source_y_size - 1);
+    int last = max(min((int)cceil(y1), source_y_size) - 1, first);
+
+    // Drop the rows we no longer need, and read in the ones we do.
+    while (!band.empty() && next_source_y - (int)band.size() < first) {
+      band.pop_front();
+    }
+    while (next_source_y <= last) {
+      band.push_back(Row());
+      if (!read_row(reader, read_array, read_alpha, band.back())) {
+        pnmimage_cat.error()
+          << "Image data is truncated at row " << next_source_y << ".\n";
+        success = false;
+        break;
+      }
+      ++next_source_y;
+    }
+    if (!success) {
+      break;
+    }
+
+    int band_first = next_source_y - (int)band.size();
+    fill(dest_row.begin(), dest_row.end(), 0.0f);
+    float total = 0.0f;
+    for (int sy = first; sy <= last; ++sy) {
+      float weight = max(min(y1, (float)(sy + 1)) - max(y0, (float)sy), 0.0f);
+      if (weight > 0.0f) {
+        const Row &row = band[sy - band_first];
+        for (size_t i = 0; i < dest_row.size(); ++i) {
+          dest_row[i] += row[i] * weight;
+        }
+        total += weight;
+      }
+    }
+    if (total > 0.0f) {
+      float inv_total = 1.0f / total;
+      for (size_t i = 0; i < dest_row.size(); ++i) {
+        dest_row[i] *= inv_total;
+      }
+    } else {
+      dest_row = band[first - band_first];
+    }
+
+    apply_operations(dest_row);
+    if (!write_row(writer, dest_row, write_array, write_alpha)) {
+      success = false;
+    }
+    Thread::consider_yield();
+  }
+
+  PANDA_FREE_ARRAY(read_array);
+  PANDA_FREE_ARRAY(read_alpha);
+  PANDA_FREE_ARRAY(write_array);
+  PANDA_FREE_ARRAY(write_alpha);
+
+  delete reader;
+  delete writer;
+  return success;
+}
+
+/**
+ * Reads the next row from the reader into the indicated buffers, and filters
+ * it down to the destination width, as four floats per pixel.  Returns true
+ * on success, false if the row could not be read.
+ */
+bool PNMRowPipeline::
+read_row(PNMReader *reader, xel *array, xelval *alpha, Row &row) {
+  int x_size = reader->get_x_size();
+  if (!reader->read_row(array, alpha, x_size, reader->get_y_size())) {
+    return false;
+  }
+
+  float scale = 1.0f / (float)reader->get_maxval();
+  bool is_grayscale = reader->is_grayscale();
+  bool has_alpha = reader->has_alpha();
+
+  int dest_x_size = (int)_x_first.size();
+  row.assign(dest_x_size * 4, 0.0f);
+  for (int x = 0; x < dest_x_size; ++x) {
+    float *p = &row[x * 4];
+    int sx = _x_first[x];
+    for (int i = _x_offset[x]; i < _x_offset[x + 1]; ++i, ++sx) {
+      float weight = _x_weights[i] * scale;
+      if (is_grayscale) {
+        float gray = PPM_GETB(array[sx]) * weight;
+        p[0] += gray;
+        p[1] += gray;
+        p[2] += gray;
+      } else {
+        p[0] += PPM_GETR(array[sx]) * weight;
+        p[1] += PPM_GETG(array[sx]) * weight;
+        p[2] += PPM_GETB(array[sx]) * weight;
+      }
+      p[3] += has_alpha ? alpha[sx] * weight : _x_weights[i];
+    }
+  }
+  return true;
+}
+
+/**
+ * Applies each of the operations, in order, to the indicated row.
+ */
+void PNMRowPipeline::
+apply_operations(Row &row) const {
+  size_t num_pixels = row.size() / 4;
+  Operations::const_iterator oi;
+  for (oi = _operations.begin(); oi != _operations.end(); ++oi) {
+    const Operation &op = (*oi);
+    float *p = &row[0];
+
+    switch (op._type) {
+    case OT_remix_channels:
+      for (size_t i = 0; i < num_pixels; ++i, p += 4) {
+        LVecBase3f color = op._conv.xform_point(LPoint3f(p[0], p[1], p[2]));
+        p[0] = color[0];
+        p[1] = color[1];
+        p[2] = color[2];
+      }
+      break;
+
+    case OT_apply_exponent:
+      for (size_t i = 0; i < num_pixels; ++i, p += 4) {
+        for (int c = 0; c < 4; ++c) {
+          if (op._exponent[c] != 1.0f) {
+            p[c] = cpow(max(p[c], 0.0f), op._exponent[c]);
+          }
+        }
+      }
+      break;
+
+    case OT_linear_to_srgb:
+      for (size_t i = 0; i < num_pixels; ++i, p += 4) {
+        p[0] = encode_sRGB_float(p[0]);
+        p[1] = encode_sRGB_float(p[1]);
+        p[2] = encode_sRGB_float(p[2]);
+      }
+      break;
+
+    case OT_srgb_to_linear:
+      for (size_t i = 0; i < num_pixels; ++i, p += 4) {
+        p[0] = decode_sRGB_float(p[0]);
+        p[1] = decode_sRGB_float(p[1]);
+        p[2] = decode_sRGB_float(p[2]);
+      }
+      break;
+    }
+  }
+}
+
+/**
+ * Converts the indicated row to the writer's format, in the indicated
+ * buffers, and writes it out.  Returns true on success, false on failure.
+ */
+bool PNMRowPipeline::
+write_row(PNMWriter *writer, const Row &row, xel *array, xelval *alpha) const {
+  float maxval = (float)writer->get_maxval();
+  bool is_grayscale = writer->is_grayscale();
+  bool has_alpha = writer->has_alpha();
+
+  size_t num_pixels = row.size() / 4;
+  const float *p = &row[0];
+  for (size_t x = 0; x < num_pixels; ++x, p += 4) {
+    if (is_grayscale) {
+      float bright = p[0] * lumin_red + p[1] * lumin_grn + p[2] * lumin_blu;
+      xelval gray = (xelval)(min(max(bright, 0.0f), 1.0f) * maxval + 0.5f);
+      PPM_ASSIGN(array[x], gray, gray, gray);
+    } else {
+      PPM_ASSIGN(array[x],
+                 (xelval)(min(max(p[0], 0.0f), 1.0f) * maxval + 0.5f),
+                 (xelval)(min(max(p[1], 0.0f), 1.0f) * maxval + 0.5f),
+                 (xelval)(min(max(p[2], 0.0f), 1.0f) * maxval + 0.5f));
+    }
+    if (has_alpha) {
+      alpha[x] = (xelval)(min(max(p[3], 0.0f), 1.0f) * maxval + 0.5f);
+    }
+  }
+
+  return writer->write_row(array, alpha);
+}
@@ -0,0 +1,115 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file pnmRowPipeline.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef PNMROWPIPELINE_H
+#define PNMROWPIPELINE_H
+
+#include "pandabase.h"
+#include "pnmimage_base.h"
+#include "luse.h"
+#include "pvector.h"
+#include "filename.h"
+
+class PNMFileType;
+class PNMReader;
+class PNMWriter;
+
+/**
+ * Converts an image file to another, a few rows at a time, without ever
+ * holding the whole image in memory.  This is useful for resizing or
+ * converting very large images, which may not fit in memory as a PNMImage.
+ *
+ * The image is optionally resized first, with a box filter, like
+ * PNMImage::quick_filter_from().  Then each row is passed through the chain
+ * of operations that have been added, in the order they were added, and
+ * written out.  At most a handful of rows are held in memory at any one time.
+ *
+ * This requires an image type whose PNMReader supports read_row(), and a
+ * type whose PNMWriter supports write_row().
+ */
+class EXPCL_PANDA_PNMIMAGE PNMRowPipeline {
+PUBLISHED:
+  PNMRowPipeline();
+
+  INLINE void set_output_size(int x_size, int y_size);
+  INLINE void clear_output_size();
+  INLINE bool has_output_size() const;
+  INLINE int get_output_x_size() const;
+  INLINE int get_output_y_size() const;
+
+  INLINE void set_num_channels(int num_channels);
+  INLINE int get_num_channels() const;
+  MAKE_PROPERTY(num_channels, get_num_channels, set_num_channels);
+
+  INLINE void set_maxval(xelval maxval);
+  INLINE xelval get_maxval() const;
+  MAKE_PROPERTY(maxval, get_maxval, set_maxval);
+
+  void add_remix_channels(const LMatrix4 &conv);
+  void add_apply_exponent(float red_exponent, float green_exponent,
+                          float blue_exponent, float alpha_exponent = 1.0f);
+  INLINE void add_gamma_correct(float from_gamma, float to_gamma);
+  void add_linear_to_srgb();
+  void add_srgb_to_linear();
+  INLINE int get_num_operations() const;
+  INLINE void clear_operations();
+
+  BLOCKING bool process(const Filename &input, const Filename &output,
+                        PNMFileType *input_type = NULL,
+                        PNMFileType *output_type = NULL);
+
+public:
+  bool process(PNMReader *reader, PNMWriter *writer);
+
+private:
+  enum OperationType {
+    OT_remix_channels,
+    OT_apply_exponent,
+    OT_linear_to_srgb,
+    OT_srgb_to_linear,
+  };
+
+  class Operation {
+  public:
+    OperationType _type;
+    LMatrix4f _conv;
+    LVecBase4f _exponent;
+  };
+  typedef pvector<Operation> Operations;
+
+  // Rows are held as four floats per pixel, red, green, blue and alpha.
+  typedef pvector<float> Row;
+
+  bool read_row(PNMReader *reader, xel *array, xelval *alpha, Row &row);
+  void apply_operations(Row &row) const;
+  bool write_row(PNMWriter *writer, const Row &row,
+                 xel *array, xelval *alpha) const;
+
+  bool _has_output_size;
+  int _output_x_size;
+  int _output_y_size;
+  int _num_channels;
+  xelval _maxval;
+  Operations _operations;
+
+  // Used while processing: the horizontal box filter, with the first source
+  // pixel that contributes to each destination pixel, and the coverage of
+  // each of the pixels from there on.
+  pvector<int> _x_first;
+  pvector<int> _x_offset;
+  pvector<float> _x_weights;
+};
+
+#include "pnmRowPipeline.I"
+
+#endif
@@ -0,0 +1,237 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_composite.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "pnmImage.h"
+#include "trueClock.h"
+#include <stdlib.h>
+
+// A benchmark of the PNMImage *_sub_image() functions, compared with the
+// straightforward per-pixel implementations that they replaced, which are
+// reproduced below.  It also reports the largest difference between the
+// results of each pair, in raw component values.
+
+static const int image_size = 2048;
+static const int num_passes = 3;
+
+static void
+ref_copy(PNMImage &dest, const PNMImage &copy, float) {
+  for (int y = 0; y < dest.get_y_size(); y++) {
+    for (int x = 0; x < dest.get_x_size(); x++) {
+      dest.set_xel(x, y, copy.get_xel(x, y));
+      dest.set_alpha(x, y, copy.get_alpha(x, y));
+    }
+  }
+}
+
+static void
+ref_blend(PNMImage &dest, const PNMImage &copy, float pixel_scale) {
+  for (int y = 0; y < dest.get_y_size(); y++) {
+    for (int x = 0; x < dest.get_x_size(); x++) {
+      dest.blend(x, y, copy.get_xel(x, y), copy.get_alpha(x, y) * pixel_scale);
+    }
+  }
+}
+
+static void
+ref_add(PNMImage &dest, const PNMImage &copy, float pixel_scale) {
+  for (int y = 0; y < dest.get_y_size(); y++) {
+    for (int x = 0; x < dest.get_x_size(); x++) {
+      dest.set_alpha(x, y, dest.get_alpha(x, y) + copy.get_alpha(x, y) * pixel_scale);
+      LRGBColorf rgb1 = dest.get_xel(x, y);
+      LRGBColorf rgb2 = copy.get_xel(x, y);
+      dest.set_xel(x, y, rgb1 + rgb2 * pixel_scale);
+    }
+  }
+}
+
+static void
+ref_mult(PNMImage &dest, const PNMImage &copy, float pixel_scale) {
+  for (int y = 0; y < dest.get_y_size(); y++) {
+    for (int x = 0; x < dest.get_x_size(); x++) {
+      dest.set_alpha(x, y, dest.get_alpha(x, y) * copy.get_alpha(x, y) * pixel_scale);
+      LRGBColorf rgb1 = dest.get_xel(x, y);
+      LRGBColorf rgb2 = copy.get_xel(x, y);
+      dest.set_xel(x, y,
+                   rgb1[0] * rgb2[0] * pixel_scale,
+                   rgb1[1] * rgb2[1] * pixel_scale,
+                   rgb1[2] * rgb2[2] * pixel_scale);
+    }
+  }
+}
+
+static void
+ref_darken(PNMImage &dest, const PNMImage &copy, float pixel_scale) {
+  for (int y = 0; y < dest.get_y_size(); y++) {
+    for (int x = 0; x < dest.get_x_size(); x++) {
+      LRGBColorf c = copy.get_xel(x, y);
+      LRGBColorf o = dest.get_xel(x, y);
+      dest.set_xel(x, y,
+                   min(1.0f - ((1.0f - c[0]) * pixel_scale), o[0]),
+                   min(1.0f - ((1.0f - c[1]) * pixel_scale), o[1]),
+                   min(1.0f - ((1.0f - c[2]) * pixel_scale), o[2]));
+      float ca = copy.get_alpha(x, y);
+      dest.set_alpha(x, y, min(1.0f - ((1.0f - ca) * pixel_scale), dest.get_alpha(x, y)));
+    }
+  }
+}
+
+static void
+ref_lighten(PNMImage &dest, const PNMImage &copy, float pixel_scale) {
+  for (int y = 0; y < dest.get_y_size(); y++) {
+    for (int x = 0; x < dest.get_x_size(); x++) {
+      LRGBColorf c = copy.get_xel(x, y);
+      LRGBColorf o = dest.get_xel(x, y);
+      dest.set_xel(x, y,
+                   max(c[0] * pixel_scale, o[0]),
+                   max(c[1] * pixel_scale, o[1]),
+                   max(c[2] * pixel_scale, o[2]));
+      dest.set_alpha(x, y, max(copy.get_alpha(x, y) * pixel_scale, dest.get_alpha(x, y)));
+    }
+  }
+}
+
+static void
+new_copy(PNMImage &dest, const PNMImage &copy, float) {
+  dest.copy_sub_image(copy, 0, 0);
+}
+
+static void
+new_blend(PNMImage &dest, const PNMImage &copy, float pixel_scale) {
+  dest.blend_sub_image(copy, 0, 0, 0, 0, -1, -1, pixel_scale);
+}
+
+static void
+new_add(PNMImage &dest, const PNMImage &copy, float pixel_scale) {
+  dest.add_sub_image(copy, 0, 0, 0, 0, -1, -1, pixel_scale);
+}
+
+static void
+new_mult(PNMImage &dest, const PNMImage &copy, float pixel_scale) {
+  dest.mult_sub_image(copy, 0, 0, 0, 0, -1, -1, pixel_scale);
+}
+
+static void
+new_darken(PNMImage &dest, const PNMImage &copy, float pixel_scale) {
+  dest.darken_sub_image(copy, 0, 0, 0, 0, -1, -1, pixel_scale);
+}
+
+static void
+new_lighten(PNMImage &dest, const PNMImage &copy, float pixel_scale) {
+  dest.lighten_sub_image(copy, 0, 0, 0, 0, -1, -1, pixel_scale);
+}
+
+typedef void CompositeFunc(PNMImage &dest, const PNMImage &copy, float pixel_scale);
+
+static float
+random_unit() {
+  return (float)rand() / (float)RAND_MAX;
+}
+
+static void
+fill_random(PNMImage &image) {
+  for (int y = 0; y < image.get_y_size(); y++) {
+    for (int x = 0; x < image.get_x_size(); x++) {
+      float r = random_unit();
+      float g = random_unit();
+      float b = random_unit();
+      image.set_xel_a(x, y, r, g, b, random_unit());
+    }
+  }
+}
+
+// Returns the best time of num_passes calls to func, leaving the result of
+// the last one in result.
+static double
+time_func(CompositeFunc *func, PNMImage &result, const PNMImage &dest,
+          const PNMImage &copy, float pixel_scale) {
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double best = 1e9;
+  for (int p = 0; p < num_passes; ++p) {
+    result = dest;
+    double start = clock->get_short_time();
+    func(result, copy, pixel_scale);
+    best = min(best, clock->get_short_time() - start);
+  }
+  return best;
+}
+
+static int
+max_difference(const PNMImage &a, const PNMImage &b) {
+  int diff = 0;
+  for (int y = 0; y < a.get_y_size(); y++) {
+    for (int x = 0; x < a.get_x_size(); x++) {
+      xel pa = a.get_xel_val(x, y);
+      xel pb = b.get_xel_val(x, y);
+      diff = max(diff, abs((int)pa.r - (int)pb.r));
+      diff = max(diff, abs((int)pa.g - (int)pb.g));
+      diff = max(diff, abs((int)pa.b - (int)pb.b));
+      diff = max(diff, abs((int)a.get_alpha_val(x, y) - (int)b.get_alpha_val(x, y)));
+    }
+  }
+  return diff;
+}
+
+static int
+mpixels_per_second(const PNMImage &image, double seconds) {
+  return (int)((double)image.get_x_size() * image.get_y_size() / seconds / 1000000.0);
+}
+
+static void
+run_case(const char *name, CompositeFunc *ref, CompositeFunc *func,
+         const PNMImage &dest, const PNMImage &copy, float pixel_scale) {
+  PNMImage ref_result, new_result;
+  double ref_time = time_func(ref, ref_result, dest, copy, pixel_scale);
+  double new_time = time_func(func, new_result, dest, copy, pixel_scale);
+
+  nout << "  " << name << ": per-pixel " << (int)(ref_time * 1000.0)
+       << " ms (" << mpixels_per_second(dest, ref_time) << " Mpixels/s), row-wise "
+       << (int)(new_time * 1000.0) << " ms ("
+       << mpixels_per_second(dest, new_time) << " Mpixels/s), max diff "
+       << max_difference(ref_result, new_result) << "\n";
+}
+
+static void
+run_all(const char *label, const PNMImage &dest, const PNMImage &copy) {
+  nout << label << ":\n";
+  run_case("copy", &ref_copy, &new_copy, dest, copy, 1.0f);
+  run_case("blend", &ref_blend, &new_blend, dest, copy, 0.75f);
+  run_case("add", &ref_add, &new_add, dest, copy, 0.5f);
+  run_case("mult", &ref_mult, &new_mult, dest, copy, 1.0f);
+  run_case("darken", &ref_darken, &new_darken, dest, copy, 1.0f);
+  run_case("darken, scaled", &ref_darken, &new_darken, dest, copy, 0.5f);
+  run_case("lighten", &ref_lighten, &new_lighten, dest, copy, 1.0f);
+  run_case("lighten, scaled", &ref_lighten, &new_lighten, dest, copy, 0.5f);
+}
+
+int
+main() {
+  srand(1);
+
+  PNMImage dest(image_size, image_size, 4, 255);
+  PNMImage copy(image_size, image_size, 4, 255);
+  fill_random(dest);
+  fill_random(copy);
+  run_all("8-bit onto 8-bit", dest, copy);
+
+  PNMImage copy16(image_size, image_size, 4, 65535);
+  fill_random(copy16);
+  run_all("16-bit onto 8-bit", dest, copy16);
+
+  PNMImage dest_srgb(image_size, image_size, 4, 255, NULL, CS_sRGB);
+  PNMImage copy_srgb(image_size, image_size, 4, 255, NULL, CS_sRGB);
+  fill_random(dest_srgb);
+  fill_random(copy_srgb);
+  run_all("sRGB onto sRGB", dest_srgb, copy_srgb);
+
+  return 0;
+}
@@ -0,0 +1,147 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_convert_srgb.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "convert_srgb.h"
+#include "trueClock.h"
+#include "pvector.h"
+#include "vector_uchar.h"
+
+// A benchmark of the batch sRGB conversion functions in convert_srgb.h,
+// compared with converting one value at a time.  It also reports the largest
+// difference between the batch and the per-value results.
+
+// The number of values to convert, and the number of times to convert them;
+// the best of these times is reported.
+static const size_t num_values = 16 * 1024 * 1024;
+static const int num_passes = 5;
+
+typedef void BatchFunc(const float *from, float *into, size_t count,
+                       int num_components);
+
+static void
+report(const char *name, double seconds) {
+  nout << "  " << name << ": "
+       << (int)(num_values / seconds / 1000000.0) << " Mvalues/s\n";
+}
+
+static float
+max_error(const pvector<float> &a, const pvector<float> &b) {
+  float error = 0.0f;
+  for (size_t i = 0; i < a.size(); ++i) {
+    error = max(error, (float)fabs(a[i] - b[i]));
+  }
+  return error;
+}
+
+static void
+test_float(const char *label, const pvector<float> &from,
+           float (*scalar)(float), BatchFunc *sse2, BatchFunc *avx2) {
+  TrueClock *clock = TrueClock::get_global_ptr();
+  pvector<float> expected(num_values);
+  pvector<float> into(num_values);
+
+  nout << label << ":\n";
+
+  double best = 1e9;
+  for (int p = 0; p < num_passes; ++p) {
+    double start = clock->get_short_time();
+    for (size_t i = 0; i < num_values; ++i) {
+      expected[i] = scalar(from[i]);
+    }
+    best = min(best, clock->get_short_time() - start);
+  }
+  report("scalar", best);
+
+  if (has_sse2_sRGB_encode()) {
+    best = 1e9;
+    for (int p = 0; p < num_passes; ++p) {
+      double start = clock->get_short_time();
+      sse2(&from[0], &into[0], num_values, 1);
+      best = min(best, clock->get_short_time() - start);
+    }
+    report("SSE2", best);
+    nout << "    max error " << max_error(expected, into) << "\n";
+  } else {
+    nout << "  SSE2: not available\n";
+  }
+
+  if (has_avx2_sRGB_encode()) {
+    best = 1e9;
+    for (int p = 0; p < num_passes; ++p) {
+      double start = clock->get_short_time();
+      avx2(&from[0], &into[0], num_values, 1);
+      best = min(best, clock->get_short_time() - start);
+    }
+    report("AVX2", best);
+    nout << "    max error " << max_error(expected, into) << "\n";
+  } else {
+    nout << "  AVX2: not available\n";
+  }
+}
+
+static float
+decode_scalar(float value) {
+  return decode_sRGB_float(value);
+}
+
+static float
+encode_scalar(float value) {
+  return encode_sRGB_float(value);
+}
+
+int
+main() {
+  pvector<float> from(num_values);
+  for (size_t i = 0; i < num_values; ++i) {
+    from[i] = (float)(i % 4096) / 4095.0f;
+  }
+
+  test_float("decode float", from, &decode_scalar,
+             &decode_sRGB_float_sse2, &decode_sRGB_float_avx2);
+  test_float("encode float", from, &encode_scalar,
+             &encode_sRGB_float_sse2, &encode_sRGB_float_avx2);
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  vector_uchar expected(num_values);
+  vector_uchar into(num_values);
+
+  nout << "encode uchar:\n";
+
+  double best = 1e9;
+  for (int p = 0; p < num_passes; ++p) {
+    double start = clock->get_short_time();
+    for (size_t i = 0; i < num_values; ++i) {
+      expected[i] = encode_sRGB_uchar(from[i]);
+    }
+    best = min(best, clock->get_short_time() - start);
+  }
+  report("per-value", best);
+
+  best = 1e9;
+  for (int p = 0; p < num_passes; ++p) {
+    double start = clock->get_short_time();
+    encode_sRGB_uchar(&from[0], &into[0], num_values, 1);
+    best = min(best, clock->get_short_time() - start);
+  }
+  report("batch", best);
+
+  int mismatches = 0;
+  for (size_t i = 0; i < num_values; ++i) {
+    if (abs((int)expected[i] - (int)into[i]) > 1) {
+      ++mismatches;
+    }
+  }
+  nout << "    " << mismatches << " values off by more than 1\n";
+
+  return 0;
+}
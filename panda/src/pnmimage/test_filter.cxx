@@ -0,0 +1,285 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_filter.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "pandabase.h"
+#include "pfmFile.h"
+#include "pnmPlanarImage.h"
+#include "workerPool.h"
+#include "trueClock.h"
+#include "load_prc_file.h"
+#include "cmath.h"
+#include <stdlib.h>
+
+// A benchmark of PfmFile::box_filter_from() and gaussian_filter_from(),
+// compared with the implementation that they replaced, which looked up the
+// kernel weights afresh for every row and ran in a single thread; it is
+// reproduced below.  It also reports the largest difference between the
+// results of each pair.
+//
+// The optional argument is the number of threads in the WorkerPool that the
+// new implementation uses, as for the worker-pool-threads variable; run it
+// once with 0 and once without an argument to compare single- and
+// multi-threaded throughput.
+
+static const int num_passes = 3;
+
+typedef void OldFilterFunction(float scale, float width,
+                               float *&filter, float &filter_width);
+
+static void
+old_filter_row(float dest[], int dest_len,
+               const float source[], int source_len,
+               float scale, const float filter[], float filter_width) {
+  float iscale;
+  if (scale < 1.0f) {
+    iscale = 1.0f;
+    filter_width /= scale;
+  } else {
+    iscale = scale;
+  }
+
+  for (int dest_x = 0; dest_x < dest_len; dest_x++) {
+    float center = (dest_x + 0.5f) / scale - 0.5f;
+    int left = max((int)cfloor(center - filter_width), 0);
+    int right = min((int)cceil(center + filter_width), source_len - 1);
+    int right_center = (int)cceil(center);
+
+    float net_weight = 0;
+    float net_value = 0;
+    int index, source_x;
+
+    for (source_x = left; source_x < right_center; source_x++) {
+      index = (int)(iscale * (center - source_x) + 0.5f);
+      net_value += filter[index] * source[source_x];
+      net_weight += filter[index];
+    }
+
+    for (; source_x <= right; source_x++) {
+      index = (int)(iscale * (source_x - center) + 0.5f);
+      net_value += filter[index] * source[source_x];
+      net_weight += filter[index];
+    }
+
+    if (net_weight > 0) {
+      dest[dest_x] = net_value / net_weight;
+    } else {
+      dest[dest_x] = 0;
+    }
+  }
+}
+
+static void
+old_box_filter(float scale, float width,
+               float *&filter, float &filter_width) {
+  float fscale = (scale < 1.0f) ? 1.0f / scale : scale;
+  filter_width = width;
+  int actual_width = (int)cceil((filter_width + 1) * fscale) + 1;
+
+  filter = (float *)PANDA_MALLOC_ARRAY(actual_width * sizeof(float));
+  for (int i = 0; i < actual_width; i++) {
+    filter[i] = (i <= filter_width * fscale) ? 1.0f : 0.0f;
+  }
+}
+
+static void
+old_gaussian_filter(float scale, float width,
+                    float *&filter, float &filter_width) {
+  float fscale = (scale < 1.0f) ? 1.0f / scale : scale;
+  float sigma = width / 2;
+  filter_width = 3.0f * sigma;
+  int actual_width = (int)cceil((filter_width + 1) * fscale);
+
+  filter = (float *)PANDA_MALLOC_ARRAY(actual_width * sizeof(float));
+  float div = 2 * sigma * sigma;
+  for (int i = 0; i < actual_width; i++) {
+    float x = i / fscale;
+    filter[i] = (float)exp(-x * x / div);
+  }
+}
+
+// The old two-pass filter of one channel, scaling by X first, then by Y.
+static void
+old_filter_channel(PfmFile &dest, const PfmFile &source, float width,
+                   OldFilterFunction *make_filter, int channel) {
+  int dest_a = dest.get_x_size();
+  int dest_b = dest.get_y_size();
+  int source_a = source.get_x_size();
+  int source_b = source.get_y_size();
+
+  pvector<float> matrix((size_t)dest_a * source_b);
+  pvector<float> temp_source(source_a);
+  pvector<float> temp_dest(max(dest_a, dest_b));
+
+  float *filter;
+  float filter_width;
+
+  float scale = (float)dest_a / (float)source_a;
+  make_filter(scale, width, filter, filter_width);
+  for (int b = 0; b < source_b; b++) {
+    for (int a = 0; a < source_a; a++) {
+      temp_source[a] = source.get_channel(a, b, channel);
+    }
+    old_filter_row(&temp_dest[0], dest_a, &temp_source[0], source_a,
+                   scale, filter, filter_width);
+    for (int a = 0; a < dest_a; a++) {
+      matrix[(size_t)a * source_b + b] = temp_dest[a];
+    }
+  }
+  PANDA_FREE_ARRAY(filter);
+
+  scale = (float)dest_b / (float)source_b;
+  make_filter(scale, width, filter, filter_width);
+  for (int a = 0; a < dest_a; a++) {
+    old_filter_row(&temp_dest[0], dest_b, &matrix[(size_t)a * source_b],
+                   source_b, scale, filter, filter_width);
+    for (int b = 0; b < dest_b; b++) {
+      dest.set_channel(a, b, channel, temp_dest[b]);
+    }
+  }
+  PANDA_FREE_ARRAY(filter);
+}
+
+static void
+fill_random(PfmFile &pfm) {
+  for (int y = 0; y < pfm.get_y_size(); y++) {
+    for (int x = 0; x < pfm.get_x_size(); x++) {
+      for (int c = 0; c < pfm.get_num_channels(); c++) {
+        pfm.set_channel(x, y, c, (float)rand() / (float)RAND_MAX);
+      }
+    }
+  }
+}
+
+static float
+max_difference(const PfmFile &a, const PfmFile &b) {
+  float diff = 0.0f;
+  for (int y = 0; y < a.get_y_size(); y++) {
+    for (int x = 0; x < a.get_x_size(); x++) {
+      for (int c = 0; c < a.get_num_channels(); c++) {
+        diff = max(diff, (float)fabs(a.get_channel(x, y, c) - b.get_channel(x, y, c)));
+      }
+    }
+  }
+  return diff;
+}
+
+static void
+report(const char *name, int dest_size, double seconds) {
+  nout << "  " << name << ": " << (int)(seconds * 1000.0) << " ms, "
+       << (int)((double)dest_size * dest_size / seconds / 1000000.0)
+       << " Mpixels/s\n";
+}
+
+static void
+run_case(const char *label, bool gaussian, int source_size, int dest_size,
+         float width) {
+  TrueClock *clock = TrueClock::get_global_ptr();
+
+  PfmFile source;
+  source.clear(source_size, source_size, 1);
+  fill_random(source);
+
+  PfmFile old_result, new_result;
+  old_result.clear(dest_size, dest_size, 1);
+  new_result.clear(dest_size, dest_size, 1);
+
+  nout << label << ":\n";
+
+  double best = 1e9;
+  for (int p = 0; p < num_passes; ++p) {
+    double start = clock->get_short_time();
+    old_filter_channel(old_result, source, width,
+                       gaussian ? &old_gaussian_filter : &old_box_filter, 0);
+    best = min(best, clock->get_short_time() - start);
+  }
+  report("old", dest_size, best);
+
+  best = 1e9;
+  for (int p = 0; p < num_passes; ++p) {
+    double start = clock->get_short_time();
+    if (gaussian) {
+      new_result.gaussian_filter_from(width, source);
+    } else {
+      new_result.box_filter_from(width, source);
+    }
+    best = min(best, clock->get_short_time() - start);
+  }
+  report("new", dest_size, best);
+  nout << "    max diff " << max_difference(old_result, new_result) << "\n";
+}
+
+// Also compares filtering a three-channel PfmFile with filtering the same
+// image held in a PNMPlanarImage, in both storage types.
+static void
+run_planar_case(int source_size, int dest_size, float width) {
+  TrueClock *clock = TrueClock::get_global_ptr();
+
+  PfmFile source;
+  source.clear(source_size, source_size, 3);
+  fill_random(source);
+
+  PfmFile pfm_result;
+  pfm_result.clear(dest_size, dest_size, 3);
+
+  nout << "gaussian " << source_size << " -> " << dest_size
+       << ", three channels:\n";
+
+  double best = 1e9;
+  for (int p = 0; p < num_passes; ++p) {
+    double start = clock->get_short_time();
+    pfm_result.gaussian_filter_from(width, source);
+    best = min(best, clock->get_short_time() - start);
+  }
+  report("PfmFile", dest_size, best);
+
+  for (int st = 0; st < 2; ++st) {
+    PNMPlanarImage::StorageType storage_type =
+      (st == 0) ? PNMPlanarImage::ST_float : PNMPlanarImage::ST_half;
+    PNMPlanarImage planar_source;
+    planar_source.load(source);
+    planar_source.set_storage_type(storage_type);
+    PNMPlanarImage planar_result(dest_size, dest_size, 3, storage_type);
+
+    best = 1e9;
+    for (int p = 0; p < num_passes; ++p) {
+      double start = clock->get_short_time();
+      planar_result.gaussian_filter_from(width, planar_source);
+      best = min(best, clock->get_short_time() - start);
+    }
+    report((st == 0) ? "PNMPlanarImage, float" : "PNMPlanarImage, half",
+           dest_size, best);
+
+    PfmFile planar_pfm;
+    planar_result.store(planar_pfm);
+    nout << "    max diff " << max_difference(pfm_result, planar_pfm) << "\n";
+  }
+}
+
+int
+main(int argc, char *argv[]) {
+  if (argc > 1) {
+    load_prc_file_data("", string("worker-pool-threads ") + argv[1]);
+  }
+  srand(1);
+
+  nout << "WorkerPool has " << WorkerPool::get_global_ptr()->get_num_threads()
+       << " threads besides the calling thread.\n";
+
+  run_case("box 2048 -> 1024, radius 1", false, 2048, 1024, 1.0f);
+  run_case("gaussian 2048 -> 1024, radius 1", true, 2048, 1024, 1.0f);
+  run_case("gaussian 1024 -> 2048, radius 1", true, 1024, 2048, 1.0f);
+  run_case("gaussian 2048 -> 512, radius 2", true, 2048, 512, 2.0f);
+  run_planar_case(2048, 1024, 1.0f);
+
+  return 0;
+}
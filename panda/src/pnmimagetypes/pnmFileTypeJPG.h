@@ -71,6 +71,8 @@ public:
 
     virtual void prepare_read();
     virtual int read_data(xel *array, xelval *alpha);
+    virtual bool supports_read_ram_image() const;
+    virtual int read_ram_image(unsigned char *data);
 
   private:
     struct jpeg_decompress_struct _cinfo;
@@ -305,10 +305,20 @@ Reader(PNMFileType *type, istream *file, bool owns_file, string magic_number) :
 void PNMFileTypeJPG::Reader::
 prepare_read() {
   if (_has_read_size && _read_x_size != 0 && _read_y_size != 0) {
+#if JPEG_LIB_VERSION >= 70 || defined(LIBJPEG_TURBO_VERSION)
+    // This libjpeg can scale down by any multiple of 1/8 while decoding.
+    // Choose the smallest scale that still yields at least the requested
+    // size, so that any remaining filtering only has to shrink the image.
+    int x_num = (8 * _read_x_size + (int)_cinfo.image_width - 1) / (int)_cinfo.image_width;
+    int y_num = (8 * _read_y_size + (int)_cinfo.image_height - 1) / (int)_cinfo.image_height;
+    _cinfo.scale_num = min(max(max(x_num, y_num), 1), 8);
+    _cinfo.scale_denom = 8;
+#else
     // Attempt to get the scale close to our target scale.
     int x_reduction = _cinfo.image_width / _read_x_size;
     int y_reduction = _cinfo.image_height / _read_y_size;
     _cinfo.scale_denom = max(min(x_reduction, y_reduction), 1);
+#endif
   }
 
   /* Step 7: Start decompressor */
@@ -419,4 +429,50 @@ read_data(xel *array, xelval *) {
   return _y_size;
 }
 
+/**
+ * Returns true if this particular PNMReader is capable of reading the image
+ * directly into a buffer in the layout used by a Texture's ram image, via
+ * read_ram_image().
+ */
+bool PNMFileTypeJPG::Reader::
+supports_read_ram_image() const {
+  return _is_valid && _maxval == 255 &&
+    (_cinfo.out_color_space == JCS_GRAYSCALE ||
+     _cinfo.out_color_space == JCS_RGB);
+}
+
+/**
+ * Reads the entire image directly into the indicated buffer, in the layout
+ * used by a Texture's ram image.  See PNMReader::read_ram_image().
+ *
+ * Each scanline is decompressed straight into its final place in the buffer,
+ * at the size chosen by prepare_read().
+ */
+int PNMFileTypeJPG::Reader::
+read_ram_image(unsigned char *data) {
+  if (!_is_valid) {
+    return 0;
+  }
+  nassertr(_cinfo.output_components == _num_channels, 0);
+  nassertr(_cinfo.output_components == 1 || _cinfo.output_components == 3, 0);
+
+  size_t row_stride = (size_t)_cinfo.output_width * _cinfo.output_components;
+
+  while (_cinfo.output_scanline < _cinfo.output_height) {
+    JSAMPROW row = (JSAMPROW)(data + row_stride * (_cinfo.output_height - 1 - _cinfo.output_scanline));
+    jpeg_read_scanlines(&_cinfo, &row, 1);
+    swap_red_blue(row, _x_size, _num_channels, 1);
+    Thread::consider_yield();
+  }
+
+  jpeg_finish_decompress(&_cinfo);
+
+  if (_jerr.pub.num_warnings) {
+    pnmimage_jpg_cat.warning()
+      << "Jpeg data may be corrupt" << endl;
+  }
+
+  return _y_size;
+}
+
 #endif  // HAVE_JPEG
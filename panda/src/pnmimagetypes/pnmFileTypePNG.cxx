@@ -408,6 +408,74 @@ read_data(xel *array, xelval *alpha_data) {
   return _y_size;
 }
 
+/**
+ * Returns true if this particular PNMReader is capable of reading the image
+ * directly into a buffer in the layout used by a Texture's ram image, via
+ * read_ram_image().
+ */
+bool PNMFileTypePNG::Reader::
+supports_read_ram_image() const {
+  return is_valid() && (_maxval == 255 || _maxval == 65535);
+}
+
+/**
+ * Reads the entire image directly into the indicated buffer, in the layout
+ * used by a Texture's ram image.  See PNMReader::read_ram_image().
+ *
+ * libpng decodes each row straight into its final place in the buffer, so
+ * that all that remains is to swap the red and blue components, and the
+ * bytes of 16-bit components on little-endian machines.
+ */
+int PNMFileTypePNG::Reader::
+read_ram_image(unsigned char *data) {
+  if (!is_valid()) {
+    return 0;
+  }
+  nassertr(_maxval == 255 || _maxval == 65535, 0);
+
+  int component_width = (_maxval > 255) ? 2 : 1;
+  size_t row_byte_length = (size_t)_x_size * _num_channels * component_width;
+  int num_rows = _y_size;
+
+  png_bytep *rows = (png_bytep *)PANDA_MALLOC_ARRAY(num_rows * sizeof(png_bytep));
+  for (int yi = 0; yi < num_rows; yi++) {
+    rows[yi] = data + row_byte_length * (num_rows - 1 - yi);
+  }
+
+  if (setjmp(_jmpbuf)) {
+    // This is the ANSI C way to handle exceptions.  If setjmp(), above,
+    // returns true, it means that libpng detected an exception while
+    // executing the code that reads the image, below.
+    PANDA_FREE_ARRAY(rows);
+    free_png();
+    return 0;
+  }
+
+  png_read_image(_png, rows);
+
+  for (int yi = 0; yi < num_rows; yi++) {
+#ifndef WORDS_BIGENDIAN
+    if (component_width == 2) {
+      png_bytep p = rows[yi];
+      png_bytep pend = p + row_byte_length;
+      while (p < pend) {
+        png_byte t = p[0];
+        p[0] = p[1];
+        p[1] = t;
+        p += 2;
+      }
+    }
+#endif
+    swap_red_blue(rows[yi], _x_size, _num_channels, component_width);
+  }
+
+  PANDA_FREE_ARRAY(rows);
+
+  png_read_end(_png, NULL);
+
+  return _y_size;
+}
+
 /**
  * Releases the internal PNG structures and marks the reader invalid.
  */
@@ -52,6 +52,8 @@ public:
     virtual ~Reader();
 
     virtual int read_data(xel *array, xelval *alpha_data);
+    virtual bool supports_read_ram_image() const;
+    virtual int read_ram_image(unsigned char *data);
 
   private:
     void free_png();
@@ -135,8 +135,12 @@ public:
   virtual bool is_floating_point();
   virtual bool read_pfm(PfmFile &pfm);
   virtual int read_data(xel *array, xelval *alpha);
+  virtual bool supports_read_ram_image() const;
+  virtual int read_ram_image(unsigned char *data);
 
 private:
+  stbi_uc *load_data(int &rows);
+
   bool _is_float;
   stbi__context _context;
   unsigned char _buffer[1024];
@@ -440,37 +444,12 @@ read_data(xel *array, xelval *alpha) {
     return 0;
   }
 
-  // Reposition the file at the beginning.
-  if (_context.img_buffer_end == _context.img_buffer_original_end) {
-    // All we need to do is rewind the buffer.
-    stbi__rewind(&_context);
-
-  } else {
-    // We need to reinitialize the context.
-    _file->seekg(0, ios::beg);
-    if (_file->tellg() != (streampos)0) {
-      pnmimage_cat.error()
-        << "Could not reposition file pointer to the beginning.\n";
-      return false;
-    }
-
-    stbi__start_callbacks(&_context, &io_callbacks, (void *)_file);
-  }
-
-  int cols = 0;
   int rows = 0;
-  int comp = _num_channels;
-  stbi_uc *data = stbi__load_main(&_context, &cols, &rows, &comp, _num_channels);
-
+  stbi_uc *data = load_data(rows);
   if (data == NULL) {
-    pnmimage_cat.error()
-      << "stbi_load failure: " << stbi_failure_reason() << "\n";
     return 0;
   }
 
-  nassertr(cols == _x_size, 0);
-  nassertr(comp == _num_channels, 0);
-
   size_t pixels = (size_t)_x_size * (size_t)rows;
   stbi_uc *ptr = data;
   switch (_num_channels) {
@@ -508,6 +487,82 @@ read_data(xel *array, xelval *alpha) {
   return rows;
 }
 
+/**
+ * Returns true if this particular PNMReader is capable of reading the image
+ * directly into a buffer in the layout used by a Texture's ram image, via
+ * read_ram_image().
+ */
+bool StbImageReader::
+supports_read_ram_image() const {
+  return _is_valid && !_is_float;
+}
+
+/**
+ * Reads the entire image directly into the indicated buffer, in the layout
+ * used by a Texture's ram image.  See PNMReader::read_ram_image().
+ */
+int StbImageReader::
+read_ram_image(unsigned char *data) {
+  if (!is_valid()) {
+    return 0;
+  }
+
+  int rows = 0;
+  stbi_uc *image = load_data(rows);
+  if (image == NULL) {
+    return 0;
+  }
+
+  size_t row_size = (size_t)_x_size * _num_channels;
+  for (int y = 0; y < rows; ++y) {
+    unsigned char *dest = data + row_size * (_y_size - 1 - y);
+    memcpy(dest, image + row_size * y, row_size);
+    swap_red_blue(dest, _x_size, _num_channels, 1);
+  }
+
+  stbi_image_free(image);
+  return rows;
+}
+
+/**
+ * Rewinds the file and decodes the entire image with stb_image, as 8-bit
+ * components.  Fills in rows with the number of rows decoded, and returns
+ * the data, which must be freed with stbi_image_free(), or NULL on failure.
+ */
+stbi_uc *StbImageReader::
+load_data(int &rows) {
+  // Reposition the file at the beginning.
+  if (_context.img_buffer_end == _context.img_buffer_original_end) {
+    // All we need to do is rewind the buffer.
+    stbi__rewind(&_context);
+
+  } else {
+    // We need to reinitialize the context.
+    _file->seekg(0, ios::beg);
+    if (_file->tellg() != (streampos)0) {
+      pnmimage_cat.error()
+        << "Could not reposition file pointer to the beginning.\n";
+      return NULL;
+    }
+
+    stbi__start_callbacks(&_context, &io_callbacks, (void *)_file);
+  }
+
+  int cols = 0;
+  int comp = _num_channels;
+  stbi_uc *data = stbi__load_main(&_context, &cols, &rows, &comp, _num_channels);
+
+  if (data == NULL) {
+    pnmimage_cat.error()
+      << "stbi_load failure: " << stbi_failure_reason() << "\n";
+    return NULL;
+  }
+
+  nassertr(cols == _x_size, NULL);
+  nassertr(comp == _num_channels, NULL);
+  return data;
+}
+
 /**
  * Registers the current object as something that can be read from a Bam file.
  */
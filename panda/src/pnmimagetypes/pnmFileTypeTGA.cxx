@@ -355,6 +355,65 @@ read_data(xel *array, xelval *alpha) {
   return rows;
 }
 
+/**
+ * Returns true if this particular PNMReader is capable of reading the image
+ * directly into a buffer in the layout used by a Texture's ram image, via
+ * read_ram_image().
+ */
+bool PNMFileTypeTGA::Reader::
+supports_read_ram_image() const {
+  return _is_valid && _maxval == 255;
+}
+
+/**
+ * Reads the entire image directly into the indicated buffer, in the layout
+ * used by a Texture's ram image.  See PNMReader::read_ram_image().
+ */
+int PNMFileTypeTGA::Reader::
+read_ram_image(unsigned char *data) {
+  nassertr(_maxval == 255, 0);
+  bool get_color = !is_grayscale();
+  bool get_alpha = has_alpha();
+  size_t row_size = (size_t)cols * _num_channels;
+
+  pixel value;
+  gray alpha = 0;
+
+  int truerow = 0;
+  int baserow = 0;
+  for ( int row = 0; row < rows; ++row )
+    {
+    // The rows are stored in the buffer from bottom to top.
+    int realrow = truerow;
+    if ( tga_head->OrgBit != 0 )
+        realrow = rows - realrow - 1;
+
+    unsigned char *p = data + row_size * realrow;
+    for ( int col = 0; col < cols; ++col )
+        {
+        get_pixel( _file, &value, (int) tga_head->PixelSize, &alpha );
+        *p++ = (unsigned char)PPM_GETB(value);
+        if ( get_color )
+            {
+            *p++ = (unsigned char)PPM_GETG(value);
+            *p++ = (unsigned char)PPM_GETR(value);
+            }
+        if ( get_alpha )
+            *p++ = (unsigned char)alpha;
+        }
+    if ( tga_head->IntrLve == TGA_IL_Four )
+        truerow += 4;
+    else if ( tga_head->IntrLve == TGA_IL_Two )
+        truerow += 2;
+    else
+        ++truerow;
+    if ( truerow >= rows )
+        truerow = ++baserow;
+    }
+
+  return rows;
+}
+
 /**
  *
  */
@@ -51,6 +51,8 @@ public:
     virtual ~Reader();
 
     virtual int read_data(xel *array, xelval *alpha);
+    virtual bool supports_read_ram_image() const;
+    virtual int read_ram_image(unsigned char *data);
 
   private:
     void readtga ( istream* ifp, struct ImageHeader* tgaP, const string &magic_number );
@@ -0,0 +1,252 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file bamSimplify.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "bamSimplify.h"
+
+#include "loader.h"
+#include "loaderOptions.h"
+#include "bamFile.h"
+#include "lodNode.h"
+#include "sceneGraphReducer.h"
+
+/**
+ *
+ */
+BamSimplify::
+BamSimplify() {
+  set_program_brief("reduce the triangle count of models, or generate LODs");
+  set_program_description
+    ("This program reads one or more egg or bam files, reduces the number "
+     "of triangles in each by collapsing edges in order of least error, and "
+     "writes the result to a bam file.  UV seams, hard normal edges and "
+     "open boundaries are preserved.\n\n"
+
+     "If -levels is specified, the output is instead an LODNode with the "
+     "indicated number of levels of detail: the original model, followed by "
+     "successively simplified versions of it, each with -ratio times as "
+     "many triangles as the previous level.");
+
+  clear_runlines();
+  add_runline("[opts] input.egg output.bam");
+  add_runline("[opts] -o output.bam input.egg");
+  add_runline("[opts] -d dirname input.egg [input.egg ...]");
+
+  add_option
+    ("o", "filename", 0,
+     "Specify the filename to which the resulting .bam file will be written.  "
+     "This is only valid when there is a single input file.",
+     &BamSimplify::dispatch_filename, &_got_output_filename, &_output_filename);
+
+  add_option
+    ("d", "dirname", 0,
+     "Specify the directory into which the resulting .bam files will be "
+     "written, one for each input file, named after the input file.",
+     &BamSimplify::dispatch_filename, &_got_output_dirname, &_output_dirname);
+
+  add_option
+    ("ratio", "ratio", 0,
+     "Specify the fraction of triangles to keep.  When generating LODs, "
+     "this is applied once per level.  The default is 0.5.",
+     &BamSimplify::dispatch_double, NULL, &_ratio);
+
+  add_option
+    ("levels", "count", 0,
+     "Generate an LODNode with the indicated number of levels, including "
+     "the original model as the first level.",
+     &BamSimplify::dispatch_int, NULL, &_num_levels);
+
+  add_option
+    ("near", "distance", 0,
+     "Specify the distance at which the first level of detail switches to "
+     "the second.  The default is 50.",
+     &BamSimplify::dispatch_double, NULL, &_near_distance);
+
+  add_option
+    ("factor", "factor", 0,
+     "Specify the factor by which each switch distance is farther than the "
+     "previous one.  The default is 2.",
+     &BamSimplify::dispatch_double, NULL, &_distance_factor);
+
+  add_option
+    ("maxerror", "error", 0,
+     "Specify the largest error, as a squared distance in model units, that "
+     "any one edge collapse is allowed to introduce.  Simplification stops "
+     "short of the requested ratio when this is reached.  The default is "
+     "no limit.",
+     &BamSimplify::dispatch_double, NULL, &_max_error);
+
+  add_option
+    ("unused", "", 0,
+     "Remove the vertices that are no longer used after simplifying.  This "
+     "is not recommended when generating LODs, since otherwise all of the "
+     "levels can share the same vertex data.",
+     &BamSimplify::dispatch_none, &_remove_unused);
+
+  _ratio = 0.5;
+  _num_levels = 0;
+  _near_distance = 50.0;
+  _distance_factor = 2.0;
+  _max_error = -1.0;
+}
+
+/**
+ *
+ */
+void BamSimplify::
+run() {
+  bool all_ok = true;
+  Filenames::const_iterator fi;
+  for (fi = _input_filenames.begin(); fi != _input_filenames.end(); ++fi) {
+    Filename output_filename = _output_filename;
+    if (_got_output_dirname) {
+      output_filename = Filename(_output_dirname, (*fi).get_basename_wo_extension() + ".bam");
+    }
+    if (!process_model(*fi, output_filename)) {
+      all_ok = false;
+    }
+  }
+
+  if (!all_ok) {
+    exit(1);
+  }
+}
+
+/**
+ *
+ */
+bool BamSimplify::
+handle_args(ProgramBase::Args &args) {
+  if (!_got_output_filename && !_got_output_dirname && args.size() == 2) {
+    // The last parameter is the output filename.
+    _got_output_filename = true;
+    _output_filename = Filename::from_os_specific(args.back());
+    args.pop_back();
+  }
+
+  if (args.empty()) {
+    nout << "You must specify the model file(s) to read on the command line.\n";
+    return false;
+  }
+
+  if (_got_output_filename && _got_output_dirname) {
+    nout << "Specify either -o or -d, but not both.\n";
+    return false;
+  }
+
+  if (!_got_output_dirname) {
+    if (!_got_output_filename) {
+      nout << "You must specify the output filename with -o, or an output "
+           << "directory with -d.\n";
+      return false;
+    }
+    if (args.size() > 1) {
+      nout << "Use -d to specify an output directory when processing "
+           << "multiple files.\n";
+      return false;
+    }
+  }
+
+  if (_ratio <= 0.0 || _ratio > 1.0) {
+    nout << "-ratio must be greater than 0 and no more than 1.\n";
+    return false;
+  }
+
+  ProgramBase::Args::const_iterator ai;
+  for (ai = args.begin(); ai != args.end(); ++ai) {
+    _input_filenames.push_back(Filename::from_os_specific(*ai));
+  }
+
+  return true;
+}
+
+/**
+ * Loads the indicated model, simplifies it, and writes it to the indicated
+ * bam file.  Returns true on success.
+ */
+bool BamSimplify::
+process_model(const Filename &input_filename, const Filename &output_filename) {
+  Loader *loader = Loader::get_global_ptr();
+  LoaderOptions options(LoaderOptions::LF_search |
+                        LoaderOptions::LF_report_errors |
+                        LoaderOptions::LF_no_cache);
+  PT(PandaNode) model = loader->load_sync(input_filename, options);
+  if (model == (PandaNode *)NULL) {
+    nout << "Unable to load " << input_filename << "\n";
+    return false;
+  }
+
+  PT(PandaNode) result;
+  if (_num_levels > 0) {
+    result = make_lod(model);
+
+  } else {
+    SceneGraphReducer gr;
+    gr.simplify(model, _ratio, _max_error);
+    result = model;
+  }
+
+  if (_remove_unused) {
+    SceneGraphReducer gr;
+    gr.remove_unused_vertices(result);
+  }
+
+  output_filename.make_dir();
+  nout << "Writing " << output_filename << "\n";
+  BamFile bam_file;
+  if (!bam_file.open_write(output_filename)) {
+    nout << "Error in writing.\n";
+    return false;
+  }
+
+  if (!bam_file.write_object(result)) {
+    nout << "Error in writing.\n";
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Builds an LODNode with the requested number of levels from the indicated
+ * model.
+ */
+PT(PandaNode) BamSimplify::
+make_lod(PandaNode *model) {
+  PT(LODNode) lod = new LODNode(model->get_name());
+
+  double ratio = 1.0;
+  double out = 0.0;
+  double in = _near_distance;
+  for (int level = 0; level < _num_levels; ++level) {
+    if (level == _num_levels - 1) {
+      // The last level remains visible out to any distance.
+      in = 1.0e30;
+    }
+    lod->add_simplified_level(model, ratio, in, out, _max_error);
+
+    nout << "  level " << level << ": ratio " << ratio << ", " << out
+         << " to " << in << "\n";
+    ratio *= _ratio;
+    out = in;
+    in *= _distance_factor;
+  }
+
+  return lod.p();
+}
+
+int main(int argc, char *argv[]) {
+  BamSimplify prog;
+  prog.parse_command_line(argc, argv);
+  prog.run();
+  return 0;
+}
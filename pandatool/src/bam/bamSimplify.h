@@ -0,0 +1,58 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file bamSimplify.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef BAMSIMPLIFY_H
+#define BAMSIMPLIFY_H
+
+#include "pandatoolbase.h"
+
+#include "programBase.h"
+#include "filename.h"
+#include "pandaNode.h"
+#include "pvector.h"
+
+/**
+ * A program to generate simplified versions of models, or LODNodes with
+ * several automatically simplified levels of detail, in batch.
+ */
+class BamSimplify : public ProgramBase {
+public:
+  BamSimplify();
+
+  void run();
+
+protected:
+  virtual bool handle_args(Args &args);
+
+private:
+  bool process_model(const Filename &input_filename,
+                     const Filename &output_filename);
+  PT(PandaNode) make_lod(PandaNode *model);
+
+  typedef pvector<Filename> Filenames;
+  Filenames _input_filenames;
+
+  bool _got_output_filename;
+  Filename _output_filename;
+  bool _got_output_dirname;
+  Filename _output_dirname;
+
+  double _ratio;
+  int _num_levels;
+  double _near_distance;
+  double _distance_factor;
+  double _max_error;
+  bool _remove_unused;
+};
+
+#endif
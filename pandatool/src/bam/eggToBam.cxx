@@ -74,6 +74,23 @@ EggToBam() :
      "variable.",
      &EggToBam::dispatch_int, &_has_egg_combine_geoms, &_egg_combine_geoms);
 
+  add_option
+    ("vcache", "", 0,
+     "Reorders the triangles and vertices of each Geom for better use of "
+     "the post-transform vertex cache, and reports the average cache miss "
+     "ratio before and after.  This is the same as setting the "
+     "egg-optimize-vertex-cache Config.prc variable.",
+     &EggToBam::dispatch_none, &_optimize_vertex_cache);
+
+  add_option
+    ("vcompress", "", 0,
+     "Stores vertex positions, normals and texture coordinates in compact "
+     "encodings (16-bit quantized positions, octahedral normals, and "
+     "half-precision texture coordinates), which roughly halves the size of "
+     "the vertex data.  This is the same as setting the "
+     "egg-compress-vertices Config.prc variable.",
+     &EggToBam::dispatch_none, &_compress_vertices);
+
   add_option
     ("suppress-hidden", "flag", 0,
      "Specifies whether to suppress hidden geometry.  If this is nonzero, "
@@ -209,6 +226,8 @@ EggToBam() :
   _force_complete = true;
   _egg_flatten = 0;
   _egg_combine_geoms = 0;
+  _optimize_vertex_cache = false;
+  _compress_vertices = false;
   _egg_suppress_hidden = 1;
   _tex_txopz = false;
   _ctex_quality = "best";
@@ -229,6 +248,13 @@ run() {
     egg_combine_geoms = (_egg_combine_geoms != 0);
   }
 
+  if (_optimize_vertex_cache) {
+    egg_optimize_vertex_cache = true;
+  }
+  if (_compress_vertices) {
+    egg_compress_vertices = true;
+  }
+
   // We always set egg_suppress_hidden.
   egg_suppress_hidden = _egg_suppress_hidden;
 
@@ -54,6 +54,8 @@ private:
   int _egg_flatten;
   bool _has_egg_combine_geoms;
   int _egg_combine_geoms;
+  bool _optimize_vertex_cache;
+  bool _compress_vertices;
   bool _egg_suppress_hidden;
   bool _ls;
   bool _has_compression_quality;